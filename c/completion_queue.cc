@@ -0,0 +1,121 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "c/completion_queue.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+
+#if defined(__linux__) || defined(__ANDROID__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#define LITERT_LM_HAS_EVENTFD 1
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#define LITERT_LM_HAS_PIPE 1
+#endif
+
+namespace litert::lm {
+
+absl::StatusOr<std::unique_ptr<CompletionQueue>> CompletionQueue::Create() {
+#if defined(LITERT_LM_HAS_EVENTFD)
+  const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (fd < 0) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create eventfd: ", std::strerror(errno)));
+  }
+  return absl::WrapUnique(new CompletionQueue(fd, fd));
+#elif defined(LITERT_LM_HAS_PIPE)
+  int fds[2];
+  if (pipe(fds) != 0) {
+    return absl::InternalError(
+        absl::StrCat("Failed to create pipe: ", std::strerror(errno)));
+  }
+  for (int fd : fds) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+  }
+  return absl::WrapUnique(new CompletionQueue(fds[0], fds[1]));
+#else
+  return absl::WrapUnique(new CompletionQueue(-1, -1));
+#endif
+}
+
+CompletionQueue::~CompletionQueue() {
+#if defined(LITERT_LM_HAS_EVENTFD) || defined(LITERT_LM_HAS_PIPE)
+  close(read_fd_);
+  if (write_fd_ != read_fd_) {
+    close(write_fd_);
+  }
+#endif
+}
+
+void CompletionQueue::Push(Event event) {
+  absl::MutexLock lock(&mutex_);
+  events_.push_back(std::move(event));
+  if (events_.size() == 1) {
+    Signal();
+  }
+}
+
+std::vector<CompletionQueue::Event> CompletionQueue::Drain(size_t max_events) {
+  std::vector<Event> events;
+  absl::MutexLock lock(&mutex_);
+  const size_t num_events = std::min(max_events, events_.size());
+  events.reserve(num_events);
+  for (size_t i = 0; i < num_events; ++i) {
+    events.push_back(std::move(events_.front()));
+    events_.pop_front();
+  }
+  if (num_events > 0 && events_.empty()) {
+    ClearSignal();
+  }
+  return events;
+}
+
+void CompletionQueue::Signal() {
+#if defined(LITERT_LM_HAS_EVENTFD)
+  const uint64_t one = 1;
+  (void)!write(write_fd_, &one, sizeof(one));
+#elif defined(LITERT_LM_HAS_PIPE)
+  const char byte = 1;
+  (void)!write(write_fd_, &byte, sizeof(byte));
+#endif
+}
+
+void CompletionQueue::ClearSignal() {
+#if defined(LITERT_LM_HAS_EVENTFD)
+  uint64_t count;
+  (void)!read(read_fd_, &count, sizeof(count));
+#elif defined(LITERT_LM_HAS_PIPE)
+  char buffer[16];
+  while (read(read_fd_, buffer, sizeof(buffer)) > 0) {
+  }
+#endif
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,100 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_C_COMPLETION_QUEUE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_C_COMPLETION_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// A thread-safe queue of stream events, produced by the inference threads and
+// drained by the caller from its own event loop.
+//
+// The queue exposes a file descriptor which is readable while the queue holds
+// events, so it can be registered with epoll/poll/select. The descriptor is
+// only signaled when the queue goes from empty to non-empty, so a consumer
+// draining in batches is woken up once per batch rather than once per token.
+//
+//   ASSIGN_OR_RETURN(auto queue, CompletionQueue::Create());
+//   // Register queue->fd() for readability with the event loop, then on wake:
+//   for (auto& event : queue->Drain(/*max_events=*/64)) { ... }
+class CompletionQueue {
+ public:
+  enum class EventType {
+    // A chunk of generated text.
+    kChunk,
+    // The request completed successfully. No more events follow for it.
+    kDone,
+    // The request failed; `text` holds the error message. No more events
+    // follow for it.
+    kError,
+  };
+
+  struct Event {
+    // The caller supplied id of the request the event belongs to.
+    uint64_t request_id;
+    EventType type;
+    std::string text;
+  };
+
+  // Creates a queue. Fails if the file descriptor can not be created.
+  static absl::StatusOr<std::unique_ptr<CompletionQueue>> Create();
+
+  ~CompletionQueue();
+
+  CompletionQueue(const CompletionQueue&) = delete;
+  CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+  // Returns the file descriptor which is readable while events are pending,
+  // or -1 if the platform does not support it. In that case, the caller has
+  // to poll Drain() instead.
+  int fd() const { return read_fd_; }
+
+  // Appends an event to the queue. May be called from any thread.
+  void Push(Event event);
+
+  // Removes and returns up to `max_events` events in the order they were
+  // pushed. The file descriptor is reset once the queue becomes empty.
+  std::vector<Event> Drain(size_t max_events);
+
+ private:
+  CompletionQueue(int read_fd, int write_fd)
+      : read_fd_(read_fd), write_fd_(write_fd) {}
+
+  // Marks the file descriptor readable / not readable.
+  void Signal() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ClearSignal() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // On Linux both are the same eventfd; elsewhere they are the two ends of a
+  // pipe.
+  const int read_fd_;
+  const int write_fd_;
+
+  absl::Mutex mutex_;
+  std::deque<Event> events_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_C_COMPLETION_QUEUE_H_
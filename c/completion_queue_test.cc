@@ -0,0 +1,106 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "c/completion_queue.h"
+
+#include <poll.h>
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace litert::lm {
+namespace {
+
+using EventType = CompletionQueue::EventType;
+
+bool IsReadable(int fd) {
+  pollfd poll_fd = {.fd = fd, .events = POLLIN, .revents = 0};
+  return poll(&poll_fd, 1, /*timeout=*/0) == 1 && (poll_fd.revents & POLLIN);
+}
+
+TEST(CompletionQueueTest, DrainReturnsEventsInOrder) {
+  auto queue = CompletionQueue::Create();
+  ASSERT_TRUE(queue.ok());
+  (*queue)->Push({.request_id = 1, .type = EventType::kChunk, .text = "a"});
+  (*queue)->Push({.request_id = 2, .type = EventType::kChunk, .text = "b"});
+  (*queue)->Push({.request_id = 1, .type = EventType::kDone, .text = ""});
+
+  auto events = (*queue)->Drain(/*max_events=*/2);
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].request_id, 1);
+  EXPECT_EQ(events[0].text, "a");
+  EXPECT_EQ(events[1].request_id, 2);
+  EXPECT_EQ(events[1].text, "b");
+
+  events = (*queue)->Drain(/*max_events=*/2);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].type, EventType::kDone);
+  EXPECT_TRUE((*queue)->Drain(/*max_events=*/2).empty());
+}
+
+TEST(CompletionQueueTest, FdIsReadableWhileEventsArePending) {
+  auto queue = CompletionQueue::Create();
+  ASSERT_TRUE(queue.ok());
+  const int fd = (*queue)->fd();
+  ASSERT_GE(fd, 0);
+  EXPECT_FALSE(IsReadable(fd));
+
+  (*queue)->Push({.request_id = 1, .type = EventType::kChunk, .text = "a"});
+  (*queue)->Push({.request_id = 1, .type = EventType::kChunk, .text = "b"});
+  EXPECT_TRUE(IsReadable(fd));
+
+  // Still readable after a partial drain.
+  EXPECT_EQ((*queue)->Drain(/*max_events=*/1).size(), 1);
+  EXPECT_TRUE(IsReadable(fd));
+
+  EXPECT_EQ((*queue)->Drain(/*max_events=*/1).size(), 1);
+  EXPECT_FALSE(IsReadable(fd));
+}
+
+TEST(CompletionQueueTest, PushFromManyThreads) {
+  auto queue = CompletionQueue::Create();
+  ASSERT_TRUE(queue.ok());
+  constexpr int kNumThreads = 8;
+  constexpr int kNumEventsPerThread = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&queue, t] {
+      for (int i = 0; i < kNumEventsPerThread; ++i) {
+        (*queue)->Push({.request_id = static_cast<uint64_t>(t),
+                        .type = EventType::kChunk,
+                        .text = std::to_string(i)});
+      }
+    });
+  }
+  int num_events = 0;
+  std::vector<int> next_index(kNumThreads, 0);
+  while (num_events < kNumThreads * kNumEventsPerThread) {
+    for (const auto& event : (*queue)->Drain(/*max_events=*/64)) {
+      // Events of a single producer keep their order.
+      EXPECT_EQ(event.text, std::to_string(next_index[event.request_id]++));
+      ++num_events;
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_FALSE(IsReadable((*queue)->fd()));
+}
+
+}  // namespace
+}  // namespace litert::lm
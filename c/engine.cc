@@ -15,6 +15,7 @@
 #include "c/engine.h"
 
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <optional>
@@ -28,11 +29,14 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "c/completion_queue.h"
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/conversation/conversation.h"
 #include "runtime/conversation/io_types.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -41,6 +45,23 @@
 
 namespace {
 
+// Returns the error message reported when a request ends in `task_state`
+// without completing.
+const char* GetTaskEndErrorMessage(litert::lm::TaskState task_state) {
+  switch (task_state) {
+    case litert::lm::TaskState::kMaxNumTokensReached:
+      return "Max number of tokens reached.";
+    case litert::lm::TaskState::kCancelled:
+    case litert::lm::TaskState::kDependentTaskCancelled:
+      return "The request was cancelled.";
+    case litert::lm::TaskState::kFailed:
+    case litert::lm::TaskState::kDependentTaskFailed:
+      return "The request failed.";
+    default:
+      return "The request did not complete.";
+  }
+}
+
 absl::AnyInvocable<void(absl::StatusOr<litert::lm::Responses>)> CreateCallback(
     LiteRtLmStreamCallback callback, void* callback_data) {
   return [callback,
@@ -50,13 +71,13 @@ absl::AnyInvocable<void(absl::StatusOr<litert::lm::Responses>)> CreateCallback(
                responses.status().ToString().c_str());
       return;
     }
-    if (responses->GetTaskState() == litert::lm::TaskState::kDone) {
+    const litert::lm::TaskState task_state = responses->GetTaskState();
+    if (task_state == litert::lm::TaskState::kDone) {
       callback(callback_data, /*text=*/nullptr, /*is_final=*/true,
                /*error_message=*/nullptr);
-    } else if (responses->GetTaskState() ==
-               litert::lm::TaskState::kMaxNumTokensReached) {
+    } else if (litert::lm::IsTaskEndState(task_state)) {
       callback(callback_data, /*text=*/nullptr, /*is_final=*/true,
-               "Max number of tokens reached.");
+               GetTaskEndErrorMessage(task_state));
     } else {
       for (const auto& text : responses->GetTexts()) {
         callback(callback_data, text.data(), /*is_final=*/false,
@@ -89,6 +110,128 @@ CreateConversationCallback(LiteRtLmStreamCallback callback, void* user_data) {
   };
 }
 
+// Creates a callback pushing the responses of the request `request_id` onto
+// `queue`, mirroring the events of `CreateCallback`. Every task end state
+// pushes exactly one terminal event. Empty chunks are skipped.
+absl::AnyInvocable<void(absl::StatusOr<litert::lm::Responses>)>
+CreateQueueCallback(litert::lm::CompletionQueue* queue, uint64_t request_id) {
+  using EventType = litert::lm::CompletionQueue::EventType;
+  return [queue,
+          request_id](absl::StatusOr<litert::lm::Responses> responses) {
+    if (!responses.ok()) {
+      queue->Push({request_id, EventType::kError,
+                   responses.status().ToString()});
+      return;
+    }
+    const litert::lm::TaskState task_state = responses->GetTaskState();
+    if (task_state == litert::lm::TaskState::kDone) {
+      queue->Push({request_id, EventType::kDone, ""});
+    } else if (litert::lm::IsTaskEndState(task_state)) {
+      queue->Push({request_id, EventType::kError,
+                   GetTaskEndErrorMessage(task_state)});
+    } else {
+      for (const auto& text : responses->GetTexts()) {
+        if (!text.empty()) {
+          queue->Push({request_id, EventType::kChunk, std::string(text)});
+        }
+      }
+    }
+  };
+}
+
+// Creates a callback pushing the messages of the request `request_id` onto
+// `queue`, mirroring the events of `CreateConversationCallback`.
+absl::AnyInvocable<void(absl::StatusOr<litert::lm::Message>)>
+CreateConversationQueueCallback(litert::lm::CompletionQueue* queue,
+                                uint64_t request_id) {
+  using EventType = litert::lm::CompletionQueue::EventType;
+  return [queue, request_id](absl::StatusOr<litert::lm::Message> message) {
+    if (!message.ok()) {
+      queue->Push({request_id, EventType::kError, message.status().ToString()});
+      return;
+    }
+    if (auto* json_msg = std::get_if<litert::lm::JsonMessage>(&*message)) {
+      if (json_msg->is_null()) {  // End of stream marker
+        queue->Push({request_id, EventType::kDone, ""});
+      } else {
+        queue->Push({request_id, EventType::kChunk, json_msg->dump()});
+      }
+    } else {
+      queue->Push({request_id, EventType::kError, "Unsupported message type"});
+    }
+  };
+}
+
+// Converts the C input data to the engine inputs.
+std::vector<litert::lm::InputData> ToEngineInputs(const InputData* inputs,
+                                                  size_t num_inputs) {
+  std::vector<litert::lm::InputData> engine_inputs;
+  engine_inputs.reserve(num_inputs);
+  for (size_t i = 0; i < num_inputs; ++i) {
+    switch (inputs[i].type) {
+      case kInputText:
+        engine_inputs.emplace_back(litert::lm::InputText(std::string(
+            static_cast<const char*>(inputs[i].data), inputs[i].size)));
+        break;
+      case kInputImage:
+        engine_inputs.emplace_back(litert::lm::InputImage(std::string(
+            static_cast<const char*>(inputs[i].data), inputs[i].size)));
+        break;
+      case kInputImageEnd:
+        engine_inputs.emplace_back(litert::lm::InputImageEnd());
+        break;
+      case kInputAudio:
+        engine_inputs.emplace_back(litert::lm::InputAudio(std::string(
+            static_cast<const char*>(inputs[i].data), inputs[i].size)));
+        break;
+      case kInputAudioEnd:
+        engine_inputs.emplace_back(litert::lm::InputAudioEnd());
+        break;
+    }
+  }
+  return engine_inputs;
+}
+
+// Converts the C attachments into media attachments. Only image and audio
+// inputs can be attached to a message.
+absl::StatusOr<std::vector<litert::lm::MediaAttachment>> ToMediaAttachments(
+    const InputData* attachments, size_t num_attachments) {
+  std::vector<litert::lm::MediaAttachment> media_attachments;
+  media_attachments.reserve(num_attachments);
+  for (size_t i = 0; i < num_attachments; ++i) {
+    std::string bytes(static_cast<const char*>(attachments[i].data),
+                      attachments[i].size);
+    if (attachments[i].type == kInputImage) {
+      media_attachments.emplace_back(litert::lm::InputImage(std::move(bytes)));
+    } else if (attachments[i].type == kInputAudio) {
+      media_attachments.emplace_back(litert::lm::InputAudio(std::move(bytes)));
+    } else {
+      return absl::InvalidArgumentError(
+          "Only image and audio inputs can be attached to a message.");
+    }
+  }
+  return media_attachments;
+}
+
+// Returns the log-probabilities of the generated tokens of the response at
+// `index`, or nullptr if they are not available.
+const std::vector<litert::lm::TokenLogProbs>* GetTokenLogProbsAt(
+    const litert::lm::Responses& responses, int index) {
+  const auto& token_logprobs = responses.GetTokenLogProbs();
+  if (!token_logprobs.has_value() || index < 0 ||
+      index >= token_logprobs->size()) {
+    return nullptr;
+  }
+  return &(*token_logprobs)[index];
+}
+
+void ToCTokenLogProb(const litert::lm::TokenLogProb& token_logprob,
+                     LiteRtLmTokenLogProb* logprob) {
+  logprob->token_id = token_logprob.token_id;
+  logprob->token = token_logprob.token.c_str();
+  logprob->logprob = token_logprob.logprob;
+}
+
 }  // namespace
 
 using ::litert::lm::Conversation;
@@ -102,6 +245,7 @@ using ::litert::lm::Message;
 using ::litert::lm::ModelAssets;
 using ::litert::lm::Responses;
 using ::litert::lm::SessionConfig;
+using ::litert::lm::StreamingChunkPolicy;
 using ::litert::lm::proto::SamplerParameters;
 
 struct LiteRtLmEngineSettings {
@@ -124,6 +268,12 @@ struct LiteRtLmBenchmarkInfo {
   litert::lm::BenchmarkInfo benchmark_info;
 };
 
+struct LiteRtLmMetricsSnapshot {
+  litert::lm::MetricsSnapshot snapshot;
+  // Rendered on creation so that the returned text is owned by the snapshot.
+  std::string prometheus_text;
+};
+
 struct LiteRtLmConversation {
   std::unique_ptr<Conversation> conversation;
 };
@@ -140,6 +290,12 @@ struct LiteRtLmConversationConfig {
   std::unique_ptr<ConversationConfig> config;
 };
 
+struct LiteRtLmCompletionQueue {
+  std::unique_ptr<litert::lm::CompletionQueue> queue;
+  // The events returned by the last drain, which own the event texts.
+  std::vector<litert::lm::CompletionQueue::Event> drained_events;
+};
+
 extern "C" {
 
 SamplerParameters::Type ToSamplerParametersType(Type type) {
@@ -170,6 +326,33 @@ void litert_lm_session_config_set_max_output_tokens(
   }
 }
 
+void litert_lm_session_config_set_num_top_logprobs(
+    LiteRtLmSessionConfig* config, int num_top_logprobs) {
+  if (config && config->config) {
+    config->config->SetNumTopLogProbs(num_top_logprobs);
+  }
+}
+
+void litert_lm_session_config_set_streaming_chunk_policy(
+    LiteRtLmSessionConfig* config, int max_tokens, int max_bytes,
+    int max_delay_ms) {
+  if (config && config->config) {
+    StreamingChunkPolicy& policy =
+        config->config->GetMutableStreamingChunkPolicy();
+    policy.max_tokens = max_tokens;
+    policy.max_bytes = max_bytes;
+    policy.max_delay = max_delay_ms > 0 ? absl::Milliseconds(max_delay_ms)
+                                        : absl::InfiniteDuration();
+  }
+}
+
+void litert_lm_session_config_add_stop_string(LiteRtLmSessionConfig* config,
+                                              const char* stop_string) {
+  if (config && config->config && stop_string && *stop_string) {
+    config->config->GetMutableStopStrings().push_back(stop_string);
+  }
+}
+
 void litert_lm_session_config_set_sampler_params(
     LiteRtLmSessionConfig* config,
     const LiteRtLmSamplerParams* sampler_params) {
@@ -471,40 +654,90 @@ int litert_lm_session_generate_content_stream(LiteRtLmSession* session,
   if (!session || !session->session) {
     return -1;
   }
-  std::vector<litert::lm::InputData> engine_inputs;
-  engine_inputs.reserve(num_inputs);
-  for (size_t i = 0; i < num_inputs; ++i) {
-    switch (inputs[i].type) {
-      case kInputText:
-        engine_inputs.emplace_back(litert::lm::InputText(std::string(
-            static_cast<const char*>(inputs[i].data), inputs[i].size)));
-        break;
-      case kInputImage:
-        engine_inputs.emplace_back(litert::lm::InputImage(std::string(
-            static_cast<const char*>(inputs[i].data), inputs[i].size)));
-        break;
-      case kInputImageEnd:
-        engine_inputs.emplace_back(litert::lm::InputImageEnd());
+  absl::Status status = session->session->GenerateContentStream(
+      ToEngineInputs(inputs, num_inputs),
+      CreateCallback(callback, callback_data));
+
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to start content stream: " << status;
+    // No need to delete callbacks, unique_ptr handles it if not moved.
+    return static_cast<int>(status.code());
+  }
+  return 0;  // The call is non-blocking and returns immediately.
+}
+
+LiteRtLmCompletionQueue* litert_lm_completion_queue_create() {
+  auto queue = litert::lm::CompletionQueue::Create();
+  if (!queue.ok()) {
+    ABSL_LOG(ERROR) << "Failed to create completion queue: " << queue.status();
+    return nullptr;
+  }
+  return new LiteRtLmCompletionQueue{std::move(*queue)};
+}
+
+void litert_lm_completion_queue_delete(LiteRtLmCompletionQueue* queue) {
+  delete queue;
+}
+
+int litert_lm_completion_queue_get_fd(const LiteRtLmCompletionQueue* queue) {
+  if (!queue) {
+    return -1;
+  }
+  return queue->queue->fd();
+}
+
+size_t litert_lm_completion_queue_drain(LiteRtLmCompletionQueue* queue,
+                                        LiteRtLmStreamEvent* events,
+                                        size_t max_events) {
+  if (!queue || !events) {
+    return 0;
+  }
+  queue->drained_events = queue->queue->Drain(max_events);
+  for (size_t i = 0; i < queue->drained_events.size(); ++i) {
+    const auto& event = queue->drained_events[i];
+    events[i].request_id = event.request_id;
+    events[i].text_size = event.text.size();
+    switch (event.type) {
+      case litert::lm::CompletionQueue::EventType::kChunk:
+        events[i].type = kStreamEventChunk;
+        events[i].text = event.text.c_str();
         break;
-      case kInputAudio:
-        engine_inputs.emplace_back(litert::lm::InputAudio(std::string(
-            static_cast<const char*>(inputs[i].data), inputs[i].size)));
+      case litert::lm::CompletionQueue::EventType::kDone:
+        events[i].type = kStreamEventDone;
+        events[i].text = nullptr;
         break;
-      case kInputAudioEnd:
-        engine_inputs.emplace_back(litert::lm::InputAudioEnd());
+      case litert::lm::CompletionQueue::EventType::kError:
+        events[i].type = kStreamEventError;
+        events[i].text = event.text.c_str();
         break;
     }
   }
+  return queue->drained_events.size();
+}
 
+int litert_lm_session_generate_content_async(LiteRtLmSession* session,
+                                             const InputData* inputs,
+                                             size_t num_inputs,
+                                             LiteRtLmCompletionQueue* queue,
+                                             uint64_t request_id) {
+  if (!session || !session->session || !queue) {
+    return -1;
+  }
   absl::Status status = session->session->GenerateContentStream(
-      std::move(engine_inputs), CreateCallback(callback, callback_data));
-
+      ToEngineInputs(inputs, num_inputs),
+      CreateQueueCallback(queue->queue.get(), request_id));
   if (!status.ok()) {
-    ABSL_LOG(ERROR) << "Failed to start content stream: " << status;
-    // No need to delete callbacks, unique_ptr handles it if not moved.
+    ABSL_LOG(ERROR) << "Failed to start content generation: " << status;
     return static_cast<int>(status.code());
   }
-  return 0;  // The call is non-blocking and returns immediately.
+  return 0;
+}
+
+void litert_lm_session_cancel_process(LiteRtLmSession* session) {
+  if (!session || !session->session) {
+    return;
+  }
+  session->session->CancelProcess();
 }
 
 void litert_lm_responses_delete(LiteRtLmResponses* responses) {
@@ -531,6 +764,66 @@ const char* litert_lm_responses_get_response_text_at(
   return responses->responses.GetTexts()[index].data();
 }
 
+int litert_lm_responses_get_num_tokens_at(const LiteRtLmResponses* responses,
+                                          int index) {
+  if (!responses) {
+    return 0;
+  }
+  const auto* token_logprobs = GetTokenLogProbsAt(responses->responses, index);
+  if (!token_logprobs) {
+    return 0;
+  }
+  return token_logprobs->size();
+}
+
+bool litert_lm_responses_get_token_logprob_at(
+    const LiteRtLmResponses* responses, int index, int token_index,
+    LiteRtLmTokenLogProb* logprob) {
+  if (!responses || !logprob) {
+    return false;
+  }
+  const auto* token_logprobs = GetTokenLogProbsAt(responses->responses, index);
+  if (!token_logprobs || token_index < 0 ||
+      token_index >= token_logprobs->size()) {
+    return false;
+  }
+  ToCTokenLogProb((*token_logprobs)[token_index].token, logprob);
+  return true;
+}
+
+int litert_lm_responses_get_num_top_logprobs_at(
+    const LiteRtLmResponses* responses, int index, int token_index) {
+  if (!responses) {
+    return 0;
+  }
+  const auto* token_logprobs = GetTokenLogProbsAt(responses->responses, index);
+  if (!token_logprobs || token_index < 0 ||
+      token_index >= token_logprobs->size()) {
+    return 0;
+  }
+  return (*token_logprobs)[token_index].top_logprobs.size();
+}
+
+bool litert_lm_responses_get_top_logprob_at(const LiteRtLmResponses* responses,
+                                            int index, int token_index,
+                                            int rank,
+                                            LiteRtLmTokenLogProb* logprob) {
+  if (!responses || !logprob) {
+    return false;
+  }
+  const auto* token_logprobs = GetTokenLogProbsAt(responses->responses, index);
+  if (!token_logprobs || token_index < 0 ||
+      token_index >= token_logprobs->size()) {
+    return false;
+  }
+  const auto& top_logprobs = (*token_logprobs)[token_index].top_logprobs;
+  if (rank < 0 || rank >= top_logprobs.size()) {
+    return false;
+  }
+  ToCTokenLogProb(top_logprobs[rank], logprob);
+  return true;
+}
+
 LiteRtLmBenchmarkInfo* litert_lm_session_get_benchmark_info(
     LiteRtLmSession* session) {
   if (!session || !session->session) {
@@ -613,6 +906,68 @@ double litert_lm_benchmark_info_get_decode_tokens_per_sec_at(
   return benchmark_info->benchmark_info.GetDecodeTokensPerSec(index);
 }
 
+LiteRtLmMetricsSnapshot* litert_lm_engine_get_metrics_snapshot(
+    LiteRtLmEngine* engine) {
+  if (!engine || !engine->engine) {
+    return nullptr;
+  }
+  auto snapshot = engine->engine->GetMetricsSnapshot();
+  if (!snapshot.ok()) {
+    ABSL_LOG(ERROR) << "Failed to get metrics snapshot: " << snapshot.status();
+    return nullptr;
+  }
+  std::string prometheus_text = snapshot->ToPrometheusText();
+  return new LiteRtLmMetricsSnapshot{std::move(*snapshot),
+                                     std::move(prometheus_text)};
+}
+
+void litert_lm_metrics_snapshot_delete(LiteRtLmMetricsSnapshot* snapshot) {
+  delete snapshot;
+}
+
+int litert_lm_metrics_snapshot_get_num_metrics(
+    const LiteRtLmMetricsSnapshot* snapshot) {
+  if (!snapshot) {
+    return 0;
+  }
+  return static_cast<int>(snapshot->snapshot.metrics().size());
+}
+
+const char* litert_lm_metrics_snapshot_get_name_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index) {
+  if (!snapshot || index < 0 ||
+      index >= snapshot->snapshot.metrics().size()) {
+    return nullptr;
+  }
+  return snapshot->snapshot.metrics()[index].name.c_str();
+}
+
+int64_t litert_lm_metrics_snapshot_get_value_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index) {
+  if (!snapshot || index < 0 ||
+      index >= snapshot->snapshot.metrics().size()) {
+    return 0;
+  }
+  return snapshot->snapshot.metrics()[index].value;
+}
+
+double litert_lm_metrics_snapshot_get_histogram_sum_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index) {
+  if (!snapshot || index < 0 ||
+      index >= snapshot->snapshot.metrics().size()) {
+    return 0.0;
+  }
+  return snapshot->snapshot.metrics()[index].histogram.sum;
+}
+
+const char* litert_lm_metrics_snapshot_get_prometheus_text(
+    const LiteRtLmMetricsSnapshot* snapshot) {
+  if (!snapshot) {
+    return nullptr;
+  }
+  return snapshot->prometheus_text.c_str();
+}
+
 LiteRtLmConversation* litert_lm_conversation_create(
     LiteRtLmEngine* engine, LiteRtLmConversationConfig* conversation_config) {
   if (!engine || !engine->engine) {
@@ -676,6 +1031,44 @@ LiteRtLmJsonResponse* litert_lm_conversation_send_message(
   return c_response;
 }
 
+LiteRtLmJsonResponse* litert_lm_conversation_send_message_with_attachments(
+    LiteRtLmConversation* conversation, const char* message_json,
+    const InputData* attachments, size_t num_attachments) {
+  if (!conversation || !conversation->conversation ||
+      (!attachments && num_attachments > 0)) {
+    return nullptr;
+  }
+  nlohmann::json json_message =
+      nlohmann::json::parse(message_json, /*cb=*/nullptr,
+                            /*allow_exceptions=*/false);
+  if (json_message.is_discarded()) {
+    ABSL_LOG(ERROR) << "Failed to parse message JSON.";
+    return nullptr;
+  }
+  auto media_attachments = ToMediaAttachments(attachments, num_attachments);
+  if (!media_attachments.ok()) {
+    ABSL_LOG(ERROR) << "Failed to read attachments: "
+                    << media_attachments.status();
+    return nullptr;
+  }
+  litert::lm::OptionalArgs optional_args;
+  optional_args.attachments = *std::move(media_attachments);
+  auto response = conversation->conversation->SendMessage(
+      json_message, std::move(optional_args));
+  if (!response.ok()) {
+    ABSL_LOG(ERROR) << "Failed to send message: " << response.status();
+    return nullptr;
+  }
+  auto* json_response = std::get_if<JsonMessage>(&*response);
+  if (!json_response) {
+    ABSL_LOG(ERROR) << "Response is not a JSON message.";
+    return nullptr;
+  }
+  auto* c_response = new LiteRtLmJsonResponse;
+  c_response->json_string = json_response->dump();
+  return c_response;
+}
+
 void litert_lm_json_response_delete(LiteRtLmJsonResponse* response) {
   delete response;
 }
@@ -712,6 +1105,30 @@ int litert_lm_conversation_send_message_stream(
   return 0;
 }
 
+int litert_lm_conversation_send_message_async(
+    LiteRtLmConversation* conversation, const char* message_json,
+    LiteRtLmCompletionQueue* queue, uint64_t request_id) {
+  if (!conversation || !conversation->conversation || !queue) {
+    return -1;
+  }
+  nlohmann::json json_message =
+      nlohmann::json::parse(message_json, /*cb=*/nullptr,
+                            /*allow_exceptions=*/false);
+  if (json_message.is_discarded()) {
+    ABSL_LOG(ERROR) << "Failed to parse message JSON.";
+    return -1;
+  }
+
+  absl::Status status = conversation->conversation->SendMessageAsync(
+      json_message,
+      CreateConversationQueueCallback(queue->queue.get(), request_id));
+  if (!status.ok()) {
+    ABSL_LOG(ERROR) << "Failed to start message: " << status;
+    return static_cast<int>(status.code());
+  }
+  return 0;
+}
+
 void litert_lm_conversation_cancel_process(LiteRtLmConversation* conversation) {
   if (!conversation || !conversation->conversation) {
     return;
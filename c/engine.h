@@ -62,6 +62,12 @@ typedef struct LiteRtLmSessionConfig LiteRtLmSessionConfig;
 // Opaque pointer for LiteRT LM Conversation Config.
 typedef struct LiteRtLmConversationConfig LiteRtLmConversationConfig;
 
+// Opaque pointer for a LiteRT LM Completion Queue.
+typedef struct LiteRtLmCompletionQueue LiteRtLmCompletionQueue;
+
+// Opaque pointer for a snapshot of the LiteRT LM Engine metrics.
+typedef struct LiteRtLmMetricsSnapshot LiteRtLmMetricsSnapshot;
+
 // Represents the type of sampler.
 typedef enum {
   kTypeUnspecified = 0,
@@ -83,6 +89,15 @@ typedef struct {
   int32_t seed;
 } LiteRtLmSamplerParams;
 
+// The log-probability of a single token.
+typedef struct {
+  int32_t token_id;
+  // The decoded text of the token. Owned by the `LiteRtLmResponses` it was read
+  // from and valid only for its lifetime.
+  const char* token;
+  float logprob;
+} LiteRtLmTokenLogProb;
+
 // Creates a LiteRT LM Session Config.
 // The caller is responsible for destroying the config using
 // `litert_lm_session_config_delete`.
@@ -97,6 +112,39 @@ LITERT_LM_C_API_EXPORT
 void litert_lm_session_config_set_max_output_tokens(
     LiteRtLmSessionConfig* config, int max_output_tokens);
 
+// Sets the number of most likely alternatives reported with the
+// log-probability of each generated token. Log-probabilities are only computed
+// when it is positive, and require the CPU sampler backend.
+// @param config The config to modify.
+// @param num_top_logprobs The number of top alternatives per token.
+LITERT_LM_C_API_EXPORT
+void litert_lm_session_config_set_num_top_logprobs(
+    LiteRtLmSessionConfig* config, int num_top_logprobs);
+
+// Sets how the streamed responses are coalesced into chunks, to reduce the
+// number of callback calls. A chunk is sent as soon as it holds
+// `max_tokens` decode steps, or `max_bytes` bytes of text of any candidate, or
+// its first step was held back for `max_delay_ms` milliseconds. The pending
+// chunk is always sent when the decode stops, fails or is cancelled. 0 disables
+// a limit. By default, every decode step is sent on its own.
+// @param config The config to modify.
+// @param max_tokens The maximum number of decode steps per chunk.
+// @param max_bytes The number of bytes of text from which a chunk is sent.
+// @param max_delay_ms The maximum delay of a decode step, in milliseconds.
+LITERT_LM_C_API_EXPORT
+void litert_lm_session_config_set_streaming_chunk_policy(
+    LiteRtLmSessionConfig* config, int max_tokens, int max_bytes,
+    int max_delay_ms);
+
+// Adds a stop string to this session config. Decoding stops as soon as the
+// generated text contains it, even across token boundaries, and the returned
+// text ends right before it.
+// @param config The config to modify.
+// @param stop_string The null-terminated, non-empty stop string.
+LITERT_LM_C_API_EXPORT
+void litert_lm_session_config_add_stop_string(LiteRtLmSessionConfig* config,
+                                              const char* stop_string);
+
 // Sets the sampler parameters for this session config.
 // @param config The config to modify.
 // @param sampler_params The sampler parameters to use.
@@ -283,6 +331,56 @@ LITERT_LM_C_API_EXPORT
 const char* litert_lm_responses_get_response_text_at(
     const LiteRtLmResponses* responses, int index);
 
+// Returns the number of generated tokens with log-probabilities for the
+// response at a given index.
+//
+// @param responses The responses object.
+// @param index The index of the response.
+// @return The number of tokens, or 0 if log-probabilities were not requested
+//   or index is out of bounds.
+LITERT_LM_C_API_EXPORT
+int litert_lm_responses_get_num_tokens_at(const LiteRtLmResponses* responses,
+                                          int index);
+
+// Reads the log-probability of a generated token of the response at a given
+// index.
+//
+// @param responses The responses object.
+// @param index The index of the response.
+// @param token_index The index of the token within the response.
+// @param logprob The output log-probability.
+// @return true on success, false if any index is out of bounds.
+LITERT_LM_C_API_EXPORT
+bool litert_lm_responses_get_token_logprob_at(
+    const LiteRtLmResponses* responses, int index, int token_index,
+    LiteRtLmTokenLogProb* logprob);
+
+// Returns the number of top alternatives reported for a generated token of
+// the response at a given index.
+//
+// @param responses The responses object.
+// @param index The index of the response.
+// @param token_index The index of the token within the response.
+// @return The number of top alternatives, or 0 if any index is out of bounds.
+LITERT_LM_C_API_EXPORT
+int litert_lm_responses_get_num_top_logprobs_at(
+    const LiteRtLmResponses* responses, int index, int token_index);
+
+// Reads one of the top alternatives of a generated token of the response at a
+// given index. The alternatives are in descending order of probability.
+//
+// @param responses The responses object.
+// @param index The index of the response.
+// @param token_index The index of the token within the response.
+// @param rank The rank of the alternative.
+// @param logprob The output log-probability.
+// @return true on success, false if any index is out of bounds.
+LITERT_LM_C_API_EXPORT
+bool litert_lm_responses_get_top_logprob_at(const LiteRtLmResponses* responses,
+                                            int index, int token_index,
+                                            int rank,
+                                            LiteRtLmTokenLogProb* logprob);
+
 // Retrieves the benchmark information from the session. The caller is
 // responsible for destroying the benchmark info using
 // `litert_lm_benchmark_info_delete`.
@@ -363,6 +461,70 @@ LITERT_LM_C_API_EXPORT
 double litert_lm_benchmark_info_get_decode_tokens_per_sec_at(
     const LiteRtLmBenchmarkInfo* benchmark_info, int index);
 
+// Takes a snapshot of the engine's live metrics (queue depth, token counts,
+// latency histograms, ...). Unlike the benchmark info, the metrics are always
+// collected and cover all sessions of the engine. The caller is responsible
+// for destroying the snapshot using `litert_lm_metrics_snapshot_delete`.
+//
+// @param engine The engine to get the metrics from.
+// @return A pointer to the snapshot, or NULL on failure.
+LITERT_LM_C_API_EXPORT
+LiteRtLmMetricsSnapshot* litert_lm_engine_get_metrics_snapshot(
+    LiteRtLmEngine* engine);
+
+// Destroys a LiteRT LM Metrics Snapshot object.
+//
+// @param snapshot The snapshot to destroy.
+LITERT_LM_C_API_EXPORT
+void litert_lm_metrics_snapshot_delete(LiteRtLmMetricsSnapshot* snapshot);
+
+// Returns the number of metrics in the snapshot.
+//
+// @param snapshot The snapshot object.
+// @return The number of metrics. The metrics are sorted by name.
+LITERT_LM_C_API_EXPORT
+int litert_lm_metrics_snapshot_get_num_metrics(
+    const LiteRtLmMetricsSnapshot* snapshot);
+
+// Returns the name of the metric at a given index.
+//
+// @param snapshot The snapshot object.
+// @param index The index of the metric.
+// @return The name of the metric, or NULL if the index is out of bounds. The
+// returned string is owned by the snapshot.
+LITERT_LM_C_API_EXPORT
+const char* litert_lm_metrics_snapshot_get_name_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index);
+
+// Returns the value of the metric at a given index. For histograms this is
+// the number of observations.
+//
+// @param snapshot The snapshot object.
+// @param index The index of the metric.
+// @return The value of the metric, or 0 if the index is out of bounds.
+LITERT_LM_C_API_EXPORT
+int64_t litert_lm_metrics_snapshot_get_value_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index);
+
+// Returns the sum of the observations of the histogram at a given index.
+//
+// @param snapshot The snapshot object.
+// @param index The index of the metric.
+// @return The sum of the observations, or 0 if the index is out of bounds or
+// the metric is not a histogram.
+LITERT_LM_C_API_EXPORT
+double litert_lm_metrics_snapshot_get_histogram_sum_at(
+    const LiteRtLmMetricsSnapshot* snapshot, int index);
+
+// Returns the snapshot in the Prometheus text exposition format.
+//
+// @param snapshot The snapshot object.
+// @return The Prometheus text, or NULL on failure. The returned string is
+// owned by the snapshot.
+LITERT_LM_C_API_EXPORT
+const char* litert_lm_metrics_snapshot_get_prometheus_text(
+    const LiteRtLmMetricsSnapshot* snapshot);
+
 // Callback for streaming responses.
 // `callback_data` is a pointer to user-defined data passed to the stream
 // function. `chunk` is the piece of text from the stream. It's only valid for
@@ -391,6 +553,91 @@ int litert_lm_session_generate_content_stream(LiteRtLmSession* session,
                                               LiteRtLmStreamCallback callback,
                                               void* callback_data);
 
+// Represents the type of an event drained from a completion queue.
+typedef enum {
+  // A chunk of the response.
+  kStreamEventChunk = 0,
+  // The request completed. No more events follow for the request.
+  kStreamEventDone = 1,
+  // The request failed. No more events follow for the request.
+  kStreamEventError = 2,
+} LiteRtLmStreamEventType;
+
+// An event drained from a completion queue.
+typedef struct {
+  // The id the caller passed when starting the request.
+  uint64_t request_id;
+  LiteRtLmStreamEventType type;
+  // The chunk for kStreamEventChunk, the error message for kStreamEventError
+  // and NULL for kStreamEventDone. Null-terminated, owned by the queue and
+  // valid until the next drain or the deletion of the queue.
+  const char* text;
+  // The size of `text` in bytes, excluding the null terminator.
+  size_t text_size;
+} LiteRtLmStreamEvent;
+
+// Creates a completion queue, which collects the events of asynchronous
+// requests so that a single thread can multiplex many in-flight generations
+// from its own event loop. The caller is responsible for destroying the queue
+// using `litert_lm_completion_queue_delete`, after all requests using it have
+// delivered their final event.
+// @return A pointer to the created queue, or NULL on failure.
+LITERT_LM_C_API_EXPORT
+LiteRtLmCompletionQueue* litert_lm_completion_queue_create();
+
+// Destroys a completion queue.
+// @param queue The queue to destroy.
+LITERT_LM_C_API_EXPORT
+void litert_lm_completion_queue_delete(LiteRtLmCompletionQueue* queue);
+
+// Returns a file descriptor which polls readable while the queue holds events,
+// suitable for epoll, poll or select. It is an eventfd on Linux and Android
+// and a pipe on other POSIX systems. The descriptor is owned by the queue;
+// the caller must not read from or close it.
+// @param queue The queue.
+// @return The file descriptor, or -1 if not supported on this platform, in
+//   which case the caller has to drain the queue periodically.
+LITERT_LM_C_API_EXPORT
+int litert_lm_completion_queue_get_fd(const LiteRtLmCompletionQueue* queue);
+
+// Moves up to `max_events` pending events into `events`, in the order they
+// were produced. Never blocks. The file descriptor stops polling readable once
+// the queue is empty.
+// @param queue The queue to drain.
+// @param events The array receiving the events.
+// @param max_events The capacity of `events`.
+// @return The number of events written to `events`.
+LITERT_LM_C_API_EXPORT
+size_t litert_lm_completion_queue_drain(LiteRtLmCompletionQueue* queue,
+                                        LiteRtLmStreamEvent* events,
+                                        size_t max_events);
+
+// Generates content from the input prompt and delivers the response as events
+// on the completion queue instead of invoking a callback. This is a
+// non-blocking call.
+//
+// @param session The session to use for generation.
+// @param inputs An array of InputData structs representing the multimodal
+//   input.
+// @param num_inputs The number of InputData structs in the array.
+// @param queue The queue receiving the events of the request.
+// @param request_id An id chosen by the caller, reported with every event of
+//   the request.
+// @return 0 on success, non-zero on failure to start the request.
+LITERT_LM_C_API_EXPORT
+int litert_lm_session_generate_content_async(LiteRtLmSession* session,
+                                             const InputData* inputs,
+                                             size_t num_inputs,
+                                             LiteRtLmCompletionQueue* queue,
+                                             uint64_t request_id);
+
+// Cancels the ongoing inference process of the session, for asynchronous
+// inference. A request on a completion queue still ends with an error event.
+//
+// @param session The session to cancel the inference for.
+LITERT_LM_C_API_EXPORT
+void litert_lm_session_cancel_process(LiteRtLmSession* session);
+
 // Creates a LiteRT LM Conversation. The caller is responsible for destroying
 // the conversation using `litert_lm_conversation_delete`.
 //
@@ -420,6 +667,24 @@ LITERT_LM_C_API_EXPORT
 LiteRtLmJsonResponse* litert_lm_conversation_send_message(
     LiteRtLmConversation* conversation, const char* message_json);
 
+// Sends a message whose image and audio content items reference binary
+// attachments instead of embedding base64 blobs, e.g.
+// {"type": "image", "attachment": 0}, where 0 is the index of the attachment in
+// `attachments`. This is a blocking call.
+//
+// @param conversation The conversation to use.
+// @param message_json A JSON string representing the message to send.
+// @param attachments An array of kInputImage or kInputAudio InputData structs
+//   holding the encoded media bytes. The bytes are only read during the call.
+// @param num_attachments The number of InputData structs in the array.
+// @return A pointer to the JSON response, or NULL on failure. The caller is
+//   responsible for deleting the response using
+//   `litert_lm_json_response_delete`.
+LITERT_LM_C_API_EXPORT
+LiteRtLmJsonResponse* litert_lm_conversation_send_message_with_attachments(
+    LiteRtLmConversation* conversation, const char* message_json,
+    const InputData* attachments, size_t num_attachments);
+
 // Destroys a LiteRT LM Json Response object.
 //
 // @param response The response to destroy.
@@ -451,6 +716,22 @@ int litert_lm_conversation_send_message_stream(
     LiteRtLmConversation* conversation, const char* message_json,
     LiteRtLmStreamCallback callback, void* callback_data);
 
+// Sends a message to the conversation and delivers the response as events on
+// the completion queue instead of invoking a callback. The text of each chunk
+// event is a JSON message, as passed to the stream callback. This is a
+// non-blocking call.
+//
+// @param conversation The conversation to use.
+// @param message_json A JSON string representing the message to send.
+// @param queue The queue receiving the events of the request.
+// @param request_id An id chosen by the caller, reported with every event of
+//   the request.
+// @return 0 on success, non-zero on failure to start the request.
+LITERT_LM_C_API_EXPORT
+int litert_lm_conversation_send_message_async(
+    LiteRtLmConversation* conversation, const char* message_json,
+    LiteRtLmCompletionQueue* queue, uint64_t request_id);
+
 // Cancels the ongoing inference process, for asynchronous inference.
 //
 // @param conversation The conversation to cancel the inference for.
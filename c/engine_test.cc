@@ -1,19 +1,28 @@
 #include "c/engine.h"
 
+#if !defined(_WIN32)
+#include <poll.h>
+#endif
+
 #include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/status_matchers.h"  // from @com_google_absl
 #include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/conversation/conversation.h"
 #include "runtime/conversation/io_types.h"
 #include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/llm_executor_settings.h"
 
@@ -29,6 +38,10 @@ struct LiteRtLmConversationConfig {
   std::unique_ptr<litert::lm::ConversationConfig> config;
 };
 
+struct LiteRtLmResponses {
+  litert::lm::Responses responses;
+};
+
 namespace {
 
 std::string GetTestdataPath(const std::string& filename) {
@@ -61,6 +74,9 @@ using SessionConfigPtr =
 using ConversationConfigPtr =
     std::unique_ptr<LiteRtLmConversationConfig,
                     decltype(&litert_lm_conversation_config_delete)>;
+using CompletionQueuePtr =
+    std::unique_ptr<LiteRtLmCompletionQueue,
+                    decltype(&litert_lm_completion_queue_delete)>;
 
 TEST(EngineCTest, CreateSettingsWithNoVisionAndAudioBackend) {
   const std::string task_path = "test_model_path_1";
@@ -151,6 +167,84 @@ TEST(EngineCTest, CreateSessionConfigWithSamplerParams) {
   EXPECT_EQ(params.seed(), 1234);
 }
 
+TEST(EngineCTest, CreateSessionConfigWithNumTopLogProbs) {
+  SessionConfigPtr config(litert_lm_session_config_create(),
+                          &litert_lm_session_config_delete);
+  ASSERT_NE(config, nullptr);
+  EXPECT_EQ(config->config->GetNumTopLogProbs(), 0);
+
+  litert_lm_session_config_set_num_top_logprobs(config.get(), 3);
+  EXPECT_EQ(config->config->GetNumTopLogProbs(), 3);
+}
+
+TEST(EngineCTest, CreateSessionConfigWithStreamingChunkPolicy) {
+  SessionConfigPtr config(litert_lm_session_config_create(),
+                          &litert_lm_session_config_delete);
+  ASSERT_NE(config, nullptr);
+
+  litert_lm_session_config_set_streaming_chunk_policy(config.get(), 8, 256,
+                                                      50);
+  const auto& policy = config->config->GetStreamingChunkPolicy();
+  EXPECT_EQ(policy.max_tokens, 8);
+  EXPECT_EQ(policy.max_bytes, 256);
+  EXPECT_EQ(policy.max_delay, absl::Milliseconds(50));
+
+  litert_lm_session_config_set_streaming_chunk_policy(config.get(), 0, 0, 0);
+  EXPECT_EQ(config->config->GetStreamingChunkPolicy().max_delay,
+            absl::InfiniteDuration());
+}
+
+TEST(EngineCTest, CreateSessionConfigWithStopStrings) {
+  SessionConfigPtr config(litert_lm_session_config_create(),
+                          &litert_lm_session_config_delete);
+  ASSERT_NE(config, nullptr);
+  EXPECT_TRUE(config->config->GetStopStrings().empty());
+
+  litert_lm_session_config_add_stop_string(config.get(), "\nObservation:");
+  // Empty strings are ignored.
+  litert_lm_session_config_add_stop_string(config.get(), "");
+  litert_lm_session_config_add_stop_string(config.get(), nullptr);
+  EXPECT_THAT(config->config->GetStopStrings(),
+              testing::ElementsAre("\nObservation:"));
+}
+
+TEST(EngineCTest, ResponsesTokenLogProbs) {
+  auto* c_responses = new LiteRtLmResponses{
+      litert::lm::Responses(litert::lm::TaskState::kDone, {"Hi"}, {0.0f})};
+  ResponsesPtr responses(c_responses, &litert_lm_responses_delete);
+  // Log-probabilities were not requested.
+  EXPECT_EQ(litert_lm_responses_get_num_tokens_at(responses.get(), 0), 0);
+
+  litert::lm::TokenLogProbs token_logprobs;
+  token_logprobs.token = {.token_id = 7, .token = "Hi", .logprob = -0.5f};
+  token_logprobs.top_logprobs = {
+      {.token_id = 7, .token = "Hi", .logprob = -0.5f},
+      {.token_id = 9, .token = "Hey", .logprob = -1.5f}};
+  c_responses->responses.GetMutableTokenLogProbs() =
+      std::vector<std::vector<litert::lm::TokenLogProbs>>{{token_logprobs}};
+
+  EXPECT_EQ(litert_lm_responses_get_num_tokens_at(responses.get(), 0), 1);
+  EXPECT_EQ(litert_lm_responses_get_num_tokens_at(responses.get(), 1), 0);
+  LiteRtLmTokenLogProb logprob;
+  ASSERT_TRUE(litert_lm_responses_get_token_logprob_at(responses.get(), 0, 0,
+                                                       &logprob));
+  EXPECT_EQ(logprob.token_id, 7);
+  EXPECT_STREQ(logprob.token, "Hi");
+  EXPECT_FLOAT_EQ(logprob.logprob, -0.5f);
+  EXPECT_FALSE(litert_lm_responses_get_token_logprob_at(responses.get(), 0, 1,
+                                                        &logprob));
+
+  EXPECT_EQ(litert_lm_responses_get_num_top_logprobs_at(responses.get(), 0, 0),
+            2);
+  ASSERT_TRUE(litert_lm_responses_get_top_logprob_at(responses.get(), 0, 0,
+                                                     /*rank=*/1, &logprob));
+  EXPECT_EQ(logprob.token_id, 9);
+  EXPECT_STREQ(logprob.token, "Hey");
+  EXPECT_FLOAT_EQ(logprob.logprob, -1.5f);
+  EXPECT_FALSE(litert_lm_responses_get_top_logprob_at(responses.get(), 0, 0,
+                                                      /*rank=*/2, &logprob));
+}
+
 TEST(EngineCTest, CreateSessionConfigWithNoSamplerParams) {
   SessionConfigPtr config(litert_lm_session_config_create(),
                           &litert_lm_session_config_delete);
@@ -660,6 +754,48 @@ TEST(EngineCTest, ConversationSendMessage) {
   EXPECT_GT(strlen(response_str), 0);
 }
 
+TEST(EngineCTest, ConversationSendMessageWithAttachments) {
+  const std::string task_path = GetTestdataPath(
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task");
+
+  EngineSettingsPtr settings(
+      litert_lm_engine_settings_create(task_path.c_str(), "cpu",
+                                       /* vision_backend_str */ nullptr,
+                                       /* audio_backend_str */ nullptr),
+      &litert_lm_engine_settings_delete);
+  ASSERT_NE(settings, nullptr);
+  litert_lm_engine_settings_set_max_num_tokens(settings.get(), 16);
+
+  EnginePtr engine(litert_lm_engine_create(settings.get()),
+                   &litert_lm_engine_delete);
+  ASSERT_NE(engine, nullptr);
+
+  ConversationPtr conversation(
+      litert_lm_conversation_create(engine.get(),
+                                    /*conversation_config=*/nullptr),
+      &litert_lm_conversation_delete);
+  ASSERT_NE(conversation, nullptr);
+
+  const char* message_json =
+      R"({"role": "user", "content": [{"type": "text", "text": "Hello"}]})";
+  // Only image and audio inputs can be attached.
+  const char text[] = "Hello";
+  InputData text_attachment = {kInputText, text, sizeof(text) - 1};
+  EXPECT_EQ(litert_lm_conversation_send_message_with_attachments(
+                conversation.get(), message_json, &text_attachment, 1),
+            nullptr);
+
+  JsonResponsePtr response(
+      litert_lm_conversation_send_message_with_attachments(
+          conversation.get(), message_json, /*attachments=*/nullptr,
+          /*num_attachments=*/0),
+      &litert_lm_json_response_delete);
+  ASSERT_NE(response, nullptr);
+  const char* response_str = litert_lm_json_response_get_string(response.get());
+  ASSERT_NE(response_str, nullptr);
+  EXPECT_GT(strlen(response_str), 0);
+}
+
 TEST(EngineCTest, ConversationSendMessageWithConfig) {
   // 1. Create an engine.
   const std::string task_path = GetTestdataPath(
@@ -785,6 +921,137 @@ TEST(EngineCTest, GenerateContentStream) {
   EXPECT_GT(callback_data.response.length(), 0);
 }
 
+TEST(EngineCTest, GenerateContentAsyncWithCompletionQueue) {
+  const std::string task_path = GetTestdataPath(
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task");
+
+  EngineSettingsPtr settings(
+      litert_lm_engine_settings_create(task_path.c_str(), "cpu",
+                                       /* vision_backend_str */ nullptr,
+                                       /* audio_backend_str */ nullptr),
+      &litert_lm_engine_settings_delete);
+  ASSERT_NE(settings, nullptr);
+  litert_lm_engine_settings_set_max_num_tokens(settings.get(), 16);
+
+  EnginePtr engine(litert_lm_engine_create(settings.get()),
+                   &litert_lm_engine_delete);
+  ASSERT_NE(engine, nullptr);
+
+  SessionPtr session(litert_lm_engine_create_session(
+                         engine.get(), /* session_config */ nullptr),
+                     &litert_lm_session_delete);
+  ASSERT_NE(session, nullptr);
+
+  CompletionQueuePtr queue(litert_lm_completion_queue_create(),
+                           &litert_lm_completion_queue_delete);
+  ASSERT_NE(queue, nullptr);
+  const int fd = litert_lm_completion_queue_get_fd(queue.get());
+
+  const char* prompt = "Hello world!";
+  InputData input_data;
+  input_data.type = kInputText;
+  input_data.data = prompt;
+  input_data.size = strlen(prompt);
+  constexpr uint64_t kRequestId = 42;
+  ASSERT_EQ(litert_lm_session_generate_content_async(
+                session.get(), &input_data, 1, queue.get(), kRequestId),
+            0);
+
+  std::string response;
+  std::optional<LiteRtLmStreamEvent> final_event;
+  LiteRtLmStreamEvent events[8];
+  while (!final_event.has_value()) {
+#if !defined(_WIN32)
+    if (fd >= 0) {
+      pollfd poll_fd = {.fd = fd, .events = POLLIN, .revents = 0};
+      ASSERT_EQ(poll(&poll_fd, 1, /*timeout=*/10000), 1);
+    }
+#endif
+    const size_t num_events =
+        litert_lm_completion_queue_drain(queue.get(), events, 8);
+    for (size_t i = 0; i < num_events; ++i) {
+      EXPECT_EQ(events[i].request_id, kRequestId);
+      if (events[i].type == kStreamEventChunk) {
+        response.append(events[i].text, events[i].text_size);
+      } else {
+        final_event = events[i];
+      }
+    }
+  }
+
+  // This model is too small and generate random output, so the result may be
+  // either success or failure due to maximum kv-cache size reached.
+  if (final_event->type == kStreamEventError) {
+    EXPECT_THAT(final_event->text,
+                testing::HasSubstr("Max number of tokens reached."));
+  } else {
+    EXPECT_EQ(final_event->type, kStreamEventDone);
+  }
+  EXPECT_GT(response.length(), 0);
+}
+
+TEST(EngineCTest, GenerateContentAsyncWithCompletionQueueAndCancel) {
+  const std::string task_path = GetTestdataPath(
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task");
+
+  EngineSettingsPtr settings(
+      litert_lm_engine_settings_create(task_path.c_str(), "cpu",
+                                       /* vision_backend_str */ nullptr,
+                                       /* audio_backend_str */ nullptr),
+      &litert_lm_engine_settings_delete);
+  ASSERT_NE(settings, nullptr);
+  litert_lm_engine_settings_set_max_num_tokens(settings.get(), 512);
+
+  EnginePtr engine(litert_lm_engine_create(settings.get()),
+                   &litert_lm_engine_delete);
+  ASSERT_NE(engine, nullptr);
+
+  SessionPtr session(litert_lm_engine_create_session(
+                         engine.get(), /* session_config */ nullptr),
+                     &litert_lm_session_delete);
+  ASSERT_NE(session, nullptr);
+
+  CompletionQueuePtr queue(litert_lm_completion_queue_create(),
+                           &litert_lm_completion_queue_delete);
+  ASSERT_NE(queue, nullptr);
+  const int fd = litert_lm_completion_queue_get_fd(queue.get());
+
+  const char* prompt = "Hello world!";
+  InputData input_data;
+  input_data.type = kInputText;
+  input_data.data = prompt;
+  input_data.size = strlen(prompt);
+  constexpr uint64_t kRequestId = 7;
+  ASSERT_EQ(litert_lm_session_generate_content_async(
+                session.get(), &input_data, 1, queue.get(), kRequestId),
+            0);
+
+  litert_lm_session_cancel_process(session.get());
+
+  // The cancelled request must still end with exactly one terminal event.
+  std::optional<std::string> error_message;
+  LiteRtLmStreamEvent events[8];
+  while (!error_message.has_value()) {
+#if !defined(_WIN32)
+    if (fd >= 0) {
+      pollfd poll_fd = {.fd = fd, .events = POLLIN, .revents = 0};
+      ASSERT_EQ(poll(&poll_fd, 1, /*timeout=*/10000), 1);
+    }
+#endif
+    const size_t num_events =
+        litert_lm_completion_queue_drain(queue.get(), events, 8);
+    for (size_t i = 0; i < num_events; ++i) {
+      EXPECT_EQ(events[i].request_id, kRequestId);
+      ASSERT_NE(events[i].type, kStreamEventDone);
+      if (events[i].type == kStreamEventError) {
+        error_message = std::string(events[i].text);
+      }
+    }
+  }
+  EXPECT_THAT(*error_message, testing::AnyOf(testing::HasSubstr("CANCELLED"),
+                                             testing::HasSubstr("cancelled")));
+}
+
 TEST(EngineCTest, ConversationSendMessageStream) {
   const std::string task_path = GetTestdataPath(
       "litert_lm/runtime/testdata/test_lm_new_metadata.task");
@@ -925,4 +1192,66 @@ TEST(EngineCTest, Benchmark) {
               0.0);
   }
 }
+
+using MetricsSnapshotPtr =
+    std::unique_ptr<LiteRtLmMetricsSnapshot,
+                    decltype(&litert_lm_metrics_snapshot_delete)>;
+
+TEST(EngineCTest, MetricsSnapshot) {
+  const std::string task_path = GetTestdataPath(
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task");
+
+  EngineSettingsPtr settings(
+      litert_lm_engine_settings_create(task_path.c_str(), "cpu",
+                                       /* vision_backend_str */ nullptr,
+                                       /* audio_backend_str */ nullptr),
+      &litert_lm_engine_settings_delete);
+  ASSERT_NE(settings, nullptr);
+  litert_lm_engine_settings_set_max_num_tokens(settings.get(), 16);
+
+  EnginePtr engine(litert_lm_engine_create(settings.get()),
+                   &litert_lm_engine_delete);
+  ASSERT_NE(engine, nullptr);
+
+  SessionPtr session(litert_lm_engine_create_session(
+                         engine.get(), /* session_config */ nullptr),
+                     &litert_lm_session_delete);
+  ASSERT_NE(session, nullptr);
+
+  const char* prompt = "Hello world!";
+  InputData input_data;
+  input_data.type = kInputText;
+  input_data.data = prompt;
+  input_data.size = strlen(prompt);
+  ResponsesPtr responses(
+      litert_lm_session_generate_content(session.get(), &input_data, 1),
+      &litert_lm_responses_delete);
+  ASSERT_NE(responses, nullptr);
+
+  MetricsSnapshotPtr snapshot(
+      litert_lm_engine_get_metrics_snapshot(engine.get()),
+      &litert_lm_metrics_snapshot_delete);
+  ASSERT_NE(snapshot, nullptr);
+
+  int num_metrics = litert_lm_metrics_snapshot_get_num_metrics(snapshot.get());
+  ASSERT_GT(num_metrics, 0);
+  bool found_sessions_created = false;
+  for (int i = 0; i < num_metrics; ++i) {
+    const char* name = litert_lm_metrics_snapshot_get_name_at(snapshot.get(), i);
+    ASSERT_NE(name, nullptr);
+    if (std::string(name) == "litert_lm_sessions_created_total") {
+      found_sessions_created = true;
+      EXPECT_EQ(litert_lm_metrics_snapshot_get_value_at(snapshot.get(), i), 1);
+    }
+  }
+  EXPECT_TRUE(found_sessions_created);
+  EXPECT_EQ(litert_lm_metrics_snapshot_get_name_at(snapshot.get(), num_metrics),
+            nullptr);
+
+  const char* text =
+      litert_lm_metrics_snapshot_get_prometheus_text(snapshot.get());
+  ASSERT_NE(text, nullptr);
+  EXPECT_THAT(std::string(text),
+              ::testing::HasSubstr("litert_lm_sessions_created_total 1\n"));
+}
 }  // namespace
@@ -75,6 +75,7 @@ fun benchmark(
       LiteRtLmJni.nativeCreateConversation(
         enginePointer,
         null, // SamplerConfig
+        null, // StreamingChunkConfig
         "[]", // messagesJsonString
         "[]", // toolsDescriptionJsonString
         false, // enableConversationConstrainedDecoding
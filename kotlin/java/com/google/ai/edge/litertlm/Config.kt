@@ -80,6 +80,8 @@ data class EngineConfig(
  *   default values.
  * @property systemMessage The system message to be used in the conversation. If set, it will
  *   prepend to [initialMessages].
+ * @property streamingChunkConfig How streamed responses are coalesced into chunks. If `null`, every
+ *   decode step is delivered on its own.
  */
 data class ConversationConfig(
   val systemInstruction: Contents? = null,
@@ -90,6 +92,7 @@ data class ConversationConfig(
   @Deprecated("Use systemInstruction instead. e.g., systemInstrction = Contents.of(\"Be helpful\")")
   val systemMessage: Message? = null,
   val automaticToolCalling: Boolean = true,
+  val streamingChunkConfig: StreamingChunkConfig? = null,
 )
 
 /**
@@ -113,10 +116,37 @@ data class SamplerConfig(
   }
 }
 
+/**
+ * Configuration for coalescing streamed responses into chunks, to save the per-chunk callback
+ * overhead at high token rates. A chunk is delivered as soon as any of the limits is reached, and
+ * the pending chunk is always delivered when the response ends.
+ *
+ * @property maxTokens The maximum number of decode steps in a chunk. 0 for no limit.
+ * @property maxBytes The number of bytes of text from which a chunk is delivered. 0 for no limit.
+ * @property maxDelayMs The maximum time in milliseconds the first decode step of a chunk is held
+ *   back. 0 for no limit.
+ */
+data class StreamingChunkConfig(
+  val maxTokens: Int = 1,
+  val maxBytes: Int = 0,
+  val maxDelayMs: Int = 0,
+) {
+  init {
+    require(maxTokens >= 0) { "maxTokens should be non-negative, but got $maxTokens." }
+    require(maxBytes >= 0) { "maxBytes should be non-negative, but got $maxBytes." }
+    require(maxDelayMs >= 0) { "maxDelayMs should be non-negative, but got $maxDelayMs." }
+  }
+}
+
 /**
  * Configuration for a LiteRT-LM [Session].
  *
  * @property samplerConfig Configuration for the sampling process. If `null`, then uses the engine's
  *   default values.
+ * @property streamingChunkConfig How streamed responses are coalesced into chunks. If `null`, every
+ *   decode step is delivered on its own.
  */
-data class SessionConfig(val samplerConfig: SamplerConfig? = null)
+data class SessionConfig(
+  val samplerConfig: SamplerConfig? = null,
+  val streamingChunkConfig: StreamingChunkConfig? = null,
+)
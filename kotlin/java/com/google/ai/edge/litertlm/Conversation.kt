@@ -95,12 +95,21 @@ class Conversation(
   fun sendMessage(message: Message, extraContext: Map<String, Any> = emptyMap()): Message {
     checkIsAlive()
 
-    var currentMessageJson = message.toJson()
+    val attachments = mutableListOf<ByteArray>()
+    var currentMessageJson = message.toJson(attachments)
+    var currentAttachments = attachments.toTypedArray()
     var extraContextJsonString = extraContext.toJsonObject().toString()
 
     for (i in 0..<RECURRING_TOOL_CALL_LIMIT) {
       val responseJsonString =
-        LiteRtLmJni.nativeSendMessage(handle, currentMessageJson.toString(), extraContextJsonString)
+        LiteRtLmJni.nativeSendMessage(
+          handle,
+          currentMessageJson.toString(),
+          extraContextJsonString,
+          currentAttachments,
+        )
+      // Tool responses sent in the following iterations carry no media.
+      currentAttachments = emptyArray()
       val responseJsonObject = JsonParser.parseString(responseJsonString).asJsonObject
 
       if (responseJsonObject.has("tool_calls")) {
@@ -179,10 +188,13 @@ class Conversation(
     val extraContextJsonString = extraContext.toJsonObject().toString()
 
     val jniCallback = JniMessageCallbackImpl(callback)
+    val attachments = mutableListOf<ByteArray>()
+    val messageJsonString = message.toJson(attachments).toString()
     LiteRtLmJni.nativeSendMessageAsync(
       handle,
-      message.toJson().toString(),
+      messageJsonString,
       extraContextJsonString,
+      attachments.toTypedArray(),
       jniCallback,
     )
   }
@@ -371,6 +383,7 @@ class Conversation(
           handle,
           localToolResponse.toString(),
           "{}",
+          emptyArray(),
           this@JniMessageCallbackImpl,
         )
         pendingToolResponseJSONMessage = null // Clear after sending
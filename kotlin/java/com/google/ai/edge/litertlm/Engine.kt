@@ -143,6 +143,7 @@ class Engine(val engineConfig: EngineConfig) : AutoCloseable {
         LiteRtLmJni.nativeCreateConversation(
           handle!!, // Using !! is okay. Checked initialization already.
           conversationConfig.samplerConfig,
+          conversationConfig.streamingChunkConfig,
           messagesJson.toString(),
           toolManager.getToolsDescription().toString(),
           ExperimentalFlags.enableConversationConstrainedDecoding,
@@ -165,7 +166,13 @@ class Engine(val engineConfig: EngineConfig) : AutoCloseable {
       checkInitialized()
 
       // Using !! is okay. Checked initialization already.
-      return Session(LiteRtLmJni.nativeCreateSession(handle!!, sessionConfig.samplerConfig))
+      return Session(
+        LiteRtLmJni.nativeCreateSession(
+          handle!!,
+          sessionConfig.samplerConfig,
+          sessionConfig.streamingChunkConfig,
+        )
+      )
     }
   }
 
@@ -91,9 +91,14 @@ internal object LiteRtLmJni {
    *
    * @param enginePointer A pointer to the native engine instance.
    * @param samplerConfig The sampler configuration.
+   * @param streamingChunkConfig The streaming chunk configuration.
    * @return A pointer to the native session instance.
    */
-  external fun nativeCreateSession(enginePointer: Long, samplerConfig: SamplerConfig?): Long
+  external fun nativeCreateSession(
+    enginePointer: Long,
+    samplerConfig: SamplerConfig?,
+    streamingChunkConfig: StreamingChunkConfig?,
+  ): Long
 
   /**
    * Delete the LiteRT-LM session.
@@ -181,6 +186,7 @@ internal object LiteRtLmJni {
    *
    * @param enginePointer A pointer to the native engine instance.
    * @param samplerConfig The sampler configuration.
+   * @param streamingChunkConfig The streaming chunk configuration.
    * @param systemMessageJsonString The system instruction to be used in the conversation.
    * @param toolsDescriptionJsonString A json string of a list of tool definitions (Open API json).
    *   could be used.
@@ -191,6 +197,7 @@ internal object LiteRtLmJni {
   external fun nativeCreateConversation(
     enginePointer: Long,
     samplerConfig: SamplerConfig?,
+    streamingChunkConfig: StreamingChunkConfig?,
     messageJsonString: String,
     toolsDescriptionJsonString: String,
     enableConversationConstrainedDecoding: Boolean,
@@ -210,12 +217,14 @@ internal object LiteRtLmJni {
    *
    * @param conversationPointer A pointer to the native conversation instance.
    * @param messageJsonString The message to be processed by the native conversation instance.
+   * @param attachments The media bytes referenced by the message items by index.
    * @param callback The callback to receive the streaming responses.
    */
   external fun nativeSendMessageAsync(
     conversationPointer: Long,
     messageJsonString: String,
     extraContextJsonString: String,
+    attachments: Array<ByteArray>,
     callback: JniMessageCallback,
   )
 
@@ -224,12 +233,14 @@ internal object LiteRtLmJni {
    *
    * @param conversationPointer A pointer to the native conversation instance.
    * @param messageJsonString The message to be processed by the native conversation instance.
+   * @param attachments The media bytes referenced by the message items by index.
    * @return The response message in JSON string format.
    */
   external fun nativeSendMessage(
     conversationPointer: Long,
     messageJsonString: String,
     extraContextJsonString: String,
+    attachments: Array<ByteArray>,
   ): String
 
   /**
@@ -39,12 +39,17 @@ internal constructor(
   val toolCalls: List<ToolCall> = emptyList(),
 ) {
 
-  /** Convert to [JsonObject]. Used internally. */
-  internal fun toJson() =
+  /**
+   * Convert to [JsonObject]. Used internally.
+   *
+   * If [attachments] is given, media bytes are appended to it and referenced by index instead of
+   * being base64 encoded into the JSON.
+   */
+  internal fun toJson(attachments: MutableList<ByteArray>? = null) =
     JsonObject().apply {
       addProperty("role", role.value)
       if (contents.contents.isNotEmpty()) {
-        add("content", contents.toJson())
+        add("content", contents.toJson(attachments))
       }
       if (toolCalls.isNotEmpty()) {
         val toolCallsJson = JsonArray()
@@ -98,10 +103,10 @@ internal constructor(
 
 class Contents private constructor(val contents: List<Content>) {
   /** Convert to [JsonObject]. Used internally. */
-  internal fun toJson() =
+  internal fun toJson(attachments: MutableList<ByteArray>? = null) =
     JsonArray().apply {
       for (content in contents) {
-        this.add(content.toJson())
+        this.add(if (attachments != null) content.toJson(attachments) else content.toJson())
       }
     }
 
@@ -143,6 +148,12 @@ sealed class Content {
   /** Convert to [JsonObject]. Used internally. */
   internal abstract fun toJson(): JsonObject
 
+  /**
+   * Convert to [JsonObject], passing media bytes as [attachments] instead of base64 encoding them.
+   * Used internally.
+   */
+  internal open fun toJson(attachments: MutableList<ByteArray>): JsonObject = toJson()
+
   /** Text. */
   data class Text(val text: String) : Content() {
     override fun toJson() =
@@ -162,6 +173,13 @@ sealed class Content {
         addProperty("type", "image")
         addProperty("blob", Base64.encode(bytes))
       }
+
+    override fun toJson(attachments: MutableList<ByteArray>) =
+      JsonObject().apply {
+        addProperty("type", "image")
+        addProperty("attachment", attachments.size)
+        attachments.add(bytes)
+      }
   }
 
   /** Image provided by a file. */
@@ -181,6 +199,13 @@ sealed class Content {
         addProperty("type", "audio")
         addProperty("blob", Base64.encode(bytes))
       }
+
+    override fun toJson(attachments: MutableList<ByteArray>) =
+      JsonObject().apply {
+        addProperty("type", "audio")
+        addProperty("attachment", attachments.size)
+        attachments.add(bytes)
+      }
   }
 
   /** Audio provided by a file. */
@@ -33,6 +33,7 @@
 #include "litert/c/internal/litert_logging.h"  // from @litert
 #include "runtime/conversation/conversation.h"
 #include "runtime/conversation/io_types.h"
+#include "runtime/conversation/model_data_processor/data_utils.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
 #include "runtime/engine/engine_settings.h"
@@ -76,6 +77,7 @@ using litert::lm::ModelAssets;
 using litert::lm::Preface;
 using litert::lm::Responses;
 using litert::lm::SessionConfig;
+using litert::lm::StreamingChunkPolicy;
 using litert::lm::proto::SamplerParameters;
 
 void ThrowLiteRtLmJniException(JNIEnv* env, const std::string& message) {
@@ -296,6 +298,33 @@ SamplerParameters CreateSamplerParamsFromJni(JNIEnv* env,
   return sampler_params;
 }
 
+// Converts a Kotlin StreamingChunkConfig into the streaming chunk policy of a
+// session. The flush strings of the policy are kept.
+void SetStreamingChunkPolicyFromJni(JNIEnv* env,
+                                    jobject streaming_chunk_config_obj,
+                                    StreamingChunkPolicy& policy) {
+  jclass config_cls = env->GetObjectClass(streaming_chunk_config_obj);
+
+  jmethodID get_max_tokens_mid =
+      env->GetMethodID(config_cls, "getMaxTokens", "()I");
+  policy.max_tokens =
+      env->CallIntMethod(streaming_chunk_config_obj, get_max_tokens_mid);
+
+  jmethodID get_max_bytes_mid =
+      env->GetMethodID(config_cls, "getMaxBytes", "()I");
+  policy.max_bytes =
+      env->CallIntMethod(streaming_chunk_config_obj, get_max_bytes_mid);
+
+  jmethodID get_max_delay_ms_mid =
+      env->GetMethodID(config_cls, "getMaxDelayMs", "()I");
+  const int max_delay_ms =
+      env->CallIntMethod(streaming_chunk_config_obj, get_max_delay_ms_mid);
+  policy.max_delay = max_delay_ms > 0 ? absl::Milliseconds(max_delay_ms)
+                                      : absl::InfiniteDuration();
+
+  env->DeleteLocalRef(config_cls);
+}
+
 nlohmann::ordered_json GetExtraContextJson(JNIEnv* env,
                                            jstring extra_context_json_string) {
   const char* extra_context_chars =
@@ -308,6 +337,27 @@ nlohmann::ordered_json GetExtraContextJson(JNIEnv* env,
   return extra_context_json;
 }
 
+// Wraps the attached media byte arrays into media attachments, typed after the
+// message items referencing them.
+absl::StatusOr<std::vector<litert::lm::MediaAttachment>> GetMediaAttachments(
+    JNIEnv* env, const nlohmann::ordered_json& message,
+    jobjectArray attachments) {
+  std::vector<std::string> buffers;
+  const jsize num_attachments =
+      attachments == nullptr ? 0 : env->GetArrayLength(attachments);
+  buffers.reserve(num_attachments);
+  for (jsize i = 0; i < num_attachments; ++i) {
+    auto bytes =
+        static_cast<jbyteArray>(env->GetObjectArrayElement(attachments, i));
+    std::string& buffer =
+        buffers.emplace_back(env->GetArrayLength(bytes), '\0');
+    env->GetByteArrayRegion(bytes, 0, buffer.size(),
+                            reinterpret_cast<jbyte*>(buffer.data()));
+    env->DeleteLocalRef(bytes);
+  }
+  return litert::lm::CreateMediaAttachments(message, std::move(buffers));
+}
+
 }  // namespace
 
 extern "C" {
@@ -593,13 +643,19 @@ JNI_METHOD(nativeDeleteEngine)(JNIEnv* env, jclass thiz, jlong engine_pointer) {
 
 LITERTLM_JNIEXPORT jlong JNICALL
 JNI_METHOD(nativeCreateSession)(JNIEnv* env, jclass thiz, jlong engine_pointer,
-                                jobject sampler_config_obj) {
+                                jobject sampler_config_obj,
+                                jobject streaming_chunk_config_obj) {
   auto session_config = SessionConfig::CreateDefault();
 
   if (sampler_config_obj != nullptr) {
     session_config.GetMutableSamplerParams() =
         CreateSamplerParamsFromJni(env, sampler_config_obj);
   }
+  if (streaming_chunk_config_obj != nullptr) {
+    SetStreamingChunkPolicyFromJni(
+        env, streaming_chunk_config_obj,
+        session_config.GetMutableStreamingChunkPolicy());
+  }
 
   Engine* engine = reinterpret_cast<Engine*>(engine_pointer);
   auto session = engine->CreateSession(session_config);
@@ -798,7 +854,8 @@ JNI_METHOD(nativeConversationGetBenchmarkInfo)(JNIEnv* env, jclass thiz,
 
 LITERTLM_JNIEXPORT jlong JNICALL JNI_METHOD(nativeCreateConversation)(
     JNIEnv* env, jclass thiz, jlong engine_pointer, jobject sampler_config_obj,
-    jstring messages_json_string, jstring tools_description_json_string,
+    jobject streaming_chunk_config_obj, jstring messages_json_string,
+    jstring tools_description_json_string,
     jboolean enable_constrained_decoding) {
   Engine* engine = reinterpret_cast<Engine*>(engine_pointer);
 
@@ -808,6 +865,11 @@ LITERTLM_JNIEXPORT jlong JNICALL JNI_METHOD(nativeCreateConversation)(
     session_config.GetMutableSamplerParams() =
         CreateSamplerParamsFromJni(env, sampler_config_obj);
   }
+  if (streaming_chunk_config_obj != nullptr) {
+    SetStreamingChunkPolicyFromJni(
+        env, streaming_chunk_config_obj,
+        session_config.GetMutableStreamingChunkPolicy());
+  }
 
   // Create the Preface from the system instruction and tools.
   JsonPreface json_preface;
@@ -865,7 +927,7 @@ LITERTLM_JNIEXPORT void JNICALL JNI_METHOD(nativeDeleteConversation)(
 LITERTLM_JNIEXPORT void JNICALL JNI_METHOD(nativeSendMessageAsync)(
     JNIEnv* env, jclass thiz, jlong conversation_pointer,
     jstring messageJSONString, jstring extraContextJsonString,
-    jobject callback) {
+    jobjectArray attachments, jobject callback) {
   JavaVM* jvm = nullptr;
   if (env->GetJavaVM(&jvm) != JNI_OK) {
     ThrowLiteRtLmJniException(env, "Failed to get JavaVM");
@@ -886,6 +948,13 @@ LITERTLM_JNIEXPORT void JNICALL JNI_METHOD(nativeSendMessageAsync)(
   if (!extra_context.is_null() && !extra_context.empty()) {
     optional_args.extra_context = extra_context;
   }
+  auto media_attachments = GetMediaAttachments(env, json_message, attachments);
+  if (!media_attachments.ok()) {
+    ThrowLiteRtLmJniException(env, "Failed to read attachments: " +
+                                       media_attachments.status().ToString());
+    return;
+  }
+  optional_args.attachments = *std::move(media_attachments);
 
   jobject callback_global = env->NewGlobalRef(callback);
   jclass callback_class = env->GetObjectClass(callback_global);
@@ -964,7 +1033,8 @@ LITERTLM_JNIEXPORT void JNICALL JNI_METHOD(nativeSendMessageAsync)(
 
 LITERTLM_JNIEXPORT jstring JNICALL JNI_METHOD(nativeSendMessage)(
     JNIEnv* env, jclass thiz, jlong conversation_pointer,
-    jstring messageJSONString, jstring extraContextJsonString) {
+    jstring messageJSONString, jstring extraContextJsonString,
+    jobjectArray attachments) {
   Conversation* conversation =
       reinterpret_cast<Conversation*>(conversation_pointer);
 
@@ -979,6 +1049,13 @@ LITERTLM_JNIEXPORT jstring JNICALL JNI_METHOD(nativeSendMessage)(
   if (!extra_context.is_null() && !extra_context.empty()) {
     optional_args.extra_context = extra_context;
   }
+  auto media_attachments = GetMediaAttachments(env, json_message, attachments);
+  if (!media_attachments.ok()) {
+    ThrowLiteRtLmJniException(env, "Failed to read attachments: " +
+                                       media_attachments.status().ToString());
+    return nullptr;
+  }
+  optional_args.attachments = *std::move(media_attachments);
 
   auto response =
       conversation->SendMessage(json_message, std::move(optional_args));
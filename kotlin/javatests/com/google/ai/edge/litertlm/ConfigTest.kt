@@ -0,0 +1,59 @@
+/*
+ * Copyright 2025 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+package com.google.ai.edge.litertlm
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNull
+import org.junit.Assert.assertThrows
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.junit.runners.JUnit4
+
+@RunWith(JUnit4::class)
+class ConfigTest {
+
+  @Test
+  fun streamingChunkConfig_defaultsToOneDecodeStepPerChunk() {
+    val config = StreamingChunkConfig()
+
+    assertEquals(1, config.maxTokens)
+    assertEquals(0, config.maxBytes)
+    assertEquals(0, config.maxDelayMs)
+  }
+
+  @Test
+  fun streamingChunkConfig_rejectsNegativeLimits() {
+    assertThrows(IllegalArgumentException::class.java) { StreamingChunkConfig(maxTokens = -1) }
+    assertThrows(IllegalArgumentException::class.java) { StreamingChunkConfig(maxBytes = -1) }
+    assertThrows(IllegalArgumentException::class.java) { StreamingChunkConfig(maxDelayMs = -1) }
+  }
+
+  @Test
+  fun sessionAndConversationConfigs_carryStreamingChunkConfig() {
+    val streamingChunkConfig = StreamingChunkConfig(maxTokens = 8, maxBytes = 256, maxDelayMs = 50)
+
+    assertNull(SessionConfig().streamingChunkConfig)
+    assertNull(ConversationConfig().streamingChunkConfig)
+    assertEquals(
+      streamingChunkConfig,
+      SessionConfig(streamingChunkConfig = streamingChunkConfig).streamingChunkConfig,
+    )
+    assertEquals(
+      streamingChunkConfig,
+      ConversationConfig(streamingChunkConfig = streamingChunkConfig).streamingChunkConfig,
+    )
+  }
+}
@@ -22,6 +22,9 @@ import dataclasses
 import enum
 from typing import Any
 
+# Any object implementing the buffer protocol, e.g. bytes or a numpy array.
+Buffer = Any
+
 
 class Backend(enum.Enum):
   """Hardware backends for LiteRT-LM."""
@@ -57,8 +60,90 @@ class AbstractEngine(abc.ABC):
     del exc_type, exc_val, exc_tb
 
   @abc.abstractmethod
-  def create_conversation(self) -> AbstractConversation:
-    """Creates a new conversation for this engine."""
+  def create_conversation(
+      self,
+      streaming_max_tokens: int = 1,
+      streaming_max_bytes: int = 0,
+      streaming_max_delay_ms: int = 0,
+  ) -> AbstractConversation:
+    """Creates a new conversation for this engine.
+
+    The streaming limits coalesce the chunks of `send_message_async`, to save
+    the per-chunk overhead at high token rates. A chunk is sent as soon as any
+    limit is reached, and the pending chunk is always sent when the response
+    ends.
+
+    Args:
+        streaming_max_tokens: The maximum number of decode steps in a chunk. 0
+          for no limit.
+        streaming_max_bytes: The number of bytes of text from which a chunk is
+          sent. 0 for no limit.
+        streaming_max_delay_ms: The maximum time in milliseconds the first
+          decode step of a chunk is held back. 0 for no limit.
+
+    Returns:
+        The new conversation.
+    """
+
+  @abc.abstractmethod
+  def generate(
+      self,
+      text: str,
+      num_top_logprobs: int = 0,
+      max_output_tokens: int | None = None,
+  ) -> dict[str, Any]:
+    """Generates a response to the text in a new session.
+
+    Args:
+        text: The input prompt.
+        num_top_logprobs: If positive, the log probability of each generated
+          token and of its num_top_logprobs most likely alternatives is
+          returned. Requires the CPU sampler.
+        max_output_tokens: The maximum number of tokens to generate.
+
+    Returns:
+        A dictionary with "texts", one string per output candidate and, when
+        num_top_logprobs is positive, "token_logprobs", one dict per candidate
+        with the numpy arrays "token_ids" and "logprobs" of shape
+        [num_tokens], and "top_token_ids" and "top_logprobs" of shape
+        [num_tokens, num_top_logprobs]. The tokens line up with the text, so
+        the tokens of a trimmed stop string are not included.
+    """
+
+  @abc.abstractmethod
+  def tokenize(self, text: str) -> Any:
+    """Encodes text into token ids.
+
+    Args:
+        text: The text to encode.
+
+    Returns:
+        A 1D int32 numpy array of token ids. The array shares memory with the
+        native token buffer.
+    """
+
+  @abc.abstractmethod
+  def detokenize(self, token_ids: Any) -> str:
+    """Decodes token ids into text.
+
+    Args:
+        token_ids: A 1D contiguous int32 numpy array or buffer of token ids.
+
+    Returns:
+        The decoded text.
+    """
+
+  @abc.abstractmethod
+  def get_metrics(self) -> dict[str, Any]:
+    """Returns a snapshot of the engine's live metrics.
+
+    Counters and gauges map to ints. Histograms map to a dict with "count",
+    "sum" and cumulative "buckets" as (upper_bound, count) pairs.
+    """
+
+  @abc.abstractmethod
+  def get_metrics_prometheus_text(self) -> str:
+    """Returns the engine's live metrics in the Prometheus text format."""
 
 
 class AbstractConversation(abc.ABC):
@@ -76,12 +161,22 @@ class AbstractConversation(abc.ABC):
     del exc_type, exc_val, exc_tb
 
   @abc.abstractmethod
-  def send_message(self, message: str | dict[str, Any]) -> dict[str, Any]:
+  def send_message(
+      self,
+      message: str | dict[str, Any],
+      attachments: collections.abc.Sequence[Buffer] = (),
+  ) -> dict[str, Any]:
     """Sends a message and returns the response.
 
     Args:
         message: The input message to send to the model. Example: "Hello" or
           {"role": "user", "content": "Hello"}.
+        attachments: The encoded image or audio bytes referenced by the content
+          items of the message by index, e.g. {"type": "image", "attachment":
+          0}. This avoids base64 encoding the media into the message. Any
+          contiguous buffer is accepted (bytes, bytearray, memoryview or a
+          uint8 numpy array). The bytes are copied once into the native
+          message, so the buffers can be reused after the call.
 
     Returns:
         A dictionary containing the model's response. The structure is:
@@ -90,15 +185,38 @@ class AbstractConversation(abc.ABC):
 
   @abc.abstractmethod
   def send_message_async(
-      self, message: str | dict[str, Any]
+      self,
+      message: str | dict[str, Any],
+      attachments: collections.abc.Sequence[Buffer] = (),
   ) -> collections.abc.Iterator[dict[str, Any]]:
     """Sends a message and streams the response.
 
     Args:
         message: The input message to send to the model. Example: "Hello" or
           {"role": "user", "content": "Hello"}.
+        attachments: The encoded image or audio bytes referenced by the content
+          items of the message by index, see `send_message`.
 
     Returns:
         An iterator yielding dictionaries containing chunks of the model's
         response.
     """
+
+  @abc.abstractmethod
+  def score(
+      self, target_texts: collections.abc.Sequence[str]
+  ) -> dict[str, Any]:
+    """Scores target texts as continuations of the conversation.
+
+    The conversation history is not modified.
+
+    Args:
+        target_texts: The candidate continuations to score.
+
+    Returns:
+        A dictionary with "scores", a float32 numpy array with the log
+        likelihood of each target text, "token_lengths", an int32 numpy array
+        with the number of tokens of each target text and, when the model
+        provides them, "token_scores", a list with one float32 numpy array per
+        target text. The arrays share memory with the native buffers.
+    """
@@ -12,15 +12,25 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <limits>
 #include <map>
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "nanobind/nanobind.h"
+#include "nanobind/ndarray.h"
 #include "nanobind/stl/optional.h"  // IWYU pragma: keep
 #include "nanobind/stl/shared_ptr.h"
+#include "nanobind/stl/string.h"  // IWYU pragma: keep
 #include "nanobind/stl/string_view.h"  // IWYU pragma: keep
 #include "nanobind/stl/unique_ptr.h"   // IWYU pragma: keep
 #include "nanobind/stl/variant.h"      // IWYU pragma: keep
@@ -32,9 +42,14 @@
 #include "absl/time/time.h"  // from @com_google_absl
 #include "nanobind_json/nanobind_json.hpp"  // from @nanobind_json  // IWYU pragma: keep
 #include "litert/c/internal/litert_logging.h"  // from @litert
+#include "runtime/components/tokenizer.h"
 #include "runtime/conversation/conversation.h"
+#include "runtime/conversation/model_data_processor/data_utils.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
 #include "tflite/core/c/c_api_types.h"  // from @litert
 #include "tflite/logger.h"  // from @litert
 #include "tflite/minimal_logging.h"  // from @litert
@@ -55,6 +70,71 @@ namespace litert::lm {
 
 namespace nb = nanobind;
 
+// A read-only, C-contiguous host buffer passed from Python: bytes, bytearray,
+// memoryview or a numpy array. The data is read in place.
+using PyByteBuffer = nb::ndarray<const uint8_t, nb::c_contig, nb::device::cpu>;
+using PyTokenIds =
+    nb::ndarray<const int, nb::ndim<1>, nb::c_contig, nb::device::cpu>;
+
+// Helper to hand a native vector over to Python as a 1D numpy array without
+// copying its elements. The array owns the vector and frees it when the last
+// Python reference goes away.
+template <typename T>
+nb::ndarray<nb::numpy, T, nb::ndim<1>> ToNumpy(std::vector<T> values) {
+  auto owned = std::make_unique<std::vector<T>>(std::move(values));
+  T* data = owned->data();
+  const size_t size = owned->size();
+  nb::capsule owner(owned.release(), [](void* ptr) noexcept {
+    delete static_cast<std::vector<T>*>(ptr);
+  });
+  return nb::ndarray<nb::numpy, T, nb::ndim<1>>(data, {size}, owner);
+}
+
+// Same as ToNumpy, for a row-major 2D array of shape [rows, cols].
+template <typename T>
+nb::ndarray<nb::numpy, T, nb::ndim<2>> ToNumpy2D(std::vector<T> values,
+                                                 size_t rows, size_t cols) {
+  auto owned = std::make_unique<std::vector<T>>(std::move(values));
+  T* data = owned->data();
+  nb::capsule owner(owned.release(), [](void* ptr) noexcept {
+    delete static_cast<std::vector<T>*>(ptr);
+  });
+  return nb::ndarray<nb::numpy, T, nb::ndim<2>>(data, {rows, cols}, owner);
+}
+
+// Helper to convert the log-probabilities of the tokens of one candidate into
+// a Python dict of numpy arrays, one entry per token.
+nb::dict ToTokenLogProbsDict(const std::vector<TokenLogProbs>& candidate,
+                             int num_top_logprobs) {
+  const size_t num_tokens = candidate.size();
+  const size_t num_top = num_top_logprobs;
+  std::vector<int> token_ids;
+  std::vector<float> logprobs;
+  token_ids.reserve(num_tokens);
+  logprobs.reserve(num_tokens);
+  // Tokens with fewer alternatives are padded with id -1 and logprob -inf.
+  std::vector<int> top_token_ids(num_tokens * num_top, -1);
+  std::vector<float> top_logprobs(num_tokens * num_top,
+                                  -std::numeric_limits<float>::infinity());
+  for (size_t i = 0; i < num_tokens; ++i) {
+    token_ids.push_back(candidate[i].token.token_id);
+    logprobs.push_back(candidate[i].token.logprob);
+    const std::vector<TokenLogProb>& top = candidate[i].top_logprobs;
+    for (size_t j = 0; j < std::min(num_top, top.size()); ++j) {
+      top_token_ids[i * num_top + j] = top[j].token_id;
+      top_logprobs[i * num_top + j] = top[j].logprob;
+    }
+  }
+  nb::dict result;
+  result["token_ids"] = ToNumpy(std::move(token_ids));
+  result["logprobs"] = ToNumpy(std::move(logprobs));
+  result["top_token_ids"] =
+      ToNumpy2D(std::move(top_token_ids), num_tokens, num_top);
+  result["top_logprobs"] =
+      ToNumpy2D(std::move(top_logprobs), num_tokens, num_top);
+  return result;
+}
+
 // Helper to convert Python dict or str to JSON message.
 nlohmann::json ParseJsonMessage(const nb::handle& message) {
   if (nb::isinstance<nb::dict>(message)) {
@@ -66,6 +146,26 @@ nlohmann::json ParseJsonMessage(const nb::handle& message) {
   throw std::runtime_error("Message must be a dict or a str.");
 }
 
+// Helper to wrap the attached media buffers into the optional arguments of a
+// message. The buffers are typed after the message items referencing them.
+OptionalArgs ParseAttachments(const nlohmann::json& message,
+                              const std::vector<PyByteBuffer>& attachments) {
+  OptionalArgs optional_args;
+  if (attachments.empty()) {
+    return optional_args;
+  }
+  std::vector<std::string> buffers;
+  buffers.reserve(attachments.size());
+  for (const PyByteBuffer& attachment : attachments) {
+    buffers.emplace_back(reinterpret_cast<const char*>(attachment.data()),
+                         attachment.nbytes());
+  }
+  optional_args.attachments = VALUE_OR_THROW(
+      CreateMediaAttachments(nlohmann::ordered_json(message),
+                             std::move(buffers)));
+  return optional_args;
+}
+
 // Helper to extract C++ Backend from Python Backend enum.
 Backend ParseBackend(const nb::handle& handle,
                      Backend default_val = Backend::CPU) {
@@ -280,17 +380,153 @@ NB_MODULE(litert_lm_ext, module) {
              nb::handle traceback) { nb::inst_destruct(self); },
           nb::arg("exc_type").none(), nb::arg("exc_value").none(),
           nb::arg("traceback").none())
-      .def("create_conversation", [](const nb::object& self) {
-        Engine& engine = nb::cast<Engine&>(self);
-
-        auto config = ConversationConfig::Builder().Build(engine);
-
-        auto conversation =
-            VALUE_OR_THROW(Conversation::Create(engine, *config));
+      .def(
+          "create_conversation",
+          [](const nb::object& self, int streaming_max_tokens,
+             int streaming_max_bytes, int streaming_max_delay_ms) {
+            Engine& engine = nb::cast<Engine&>(self);
+            if (streaming_max_tokens < 0 || streaming_max_bytes < 0 ||
+                streaming_max_delay_ms < 0) {
+              throw std::invalid_argument(
+                  "The streaming limits must be non-negative.");
+            }
 
-        nb::object py_conversation = nb::cast(std::move(conversation));
-        return py_conversation;
-      });
+            SessionConfig session_config = SessionConfig::CreateDefault();
+            StreamingChunkPolicy& policy =
+                session_config.GetMutableStreamingChunkPolicy();
+            policy.max_tokens = streaming_max_tokens;
+            policy.max_bytes = streaming_max_bytes;
+            policy.max_delay = streaming_max_delay_ms > 0
+                                   ? absl::Milliseconds(streaming_max_delay_ms)
+                                   : absl::InfiniteDuration();
+            auto config = VALUE_OR_THROW(ConversationConfig::Builder()
+                                             .SetSessionConfig(session_config)
+                                             .Build(engine));
+
+            auto conversation =
+                VALUE_OR_THROW(Conversation::Create(engine, config));
+
+            nb::object py_conversation = nb::cast(std::move(conversation));
+            return py_conversation;
+          },
+          nb::arg("streaming_max_tokens") = 1,
+          nb::arg("streaming_max_bytes") = 0,
+          nb::arg("streaming_max_delay_ms") = 0,
+          "Creates a conversation. The streaming limits coalesce the chunks "
+          "of send_message_async: a chunk is sent once it holds "
+          "streaming_max_tokens decode steps or streaming_max_bytes bytes of "
+          "text, or after streaming_max_delay_ms milliseconds. 0 means no "
+          "limit.")
+      .def(
+          "generate",
+          [](Engine& self, const std::string& text, int num_top_logprobs,
+             std::optional<int> max_output_tokens) {
+            SessionConfig session_config = SessionConfig::CreateDefault();
+            session_config.SetNumTopLogProbs(num_top_logprobs);
+            if (max_output_tokens.has_value()) {
+              session_config.SetMaxOutputTokens(*max_output_tokens);
+            }
+            absl::StatusOr<Responses> responses;
+            {
+              nb::gil_scoped_release release;
+              auto session = self.CreateSession(session_config);
+              if (!session.ok()) {
+                responses = session.status();
+              } else {
+                std::vector<InputData> inputs;
+                inputs.emplace_back(InputText(text));
+                responses = (*session)->GenerateContent(std::move(inputs));
+              }
+            }
+            Responses result = VALUE_OR_THROW(std::move(responses));
+
+            nb::dict output;
+            output["texts"] = result.GetTexts();
+            if (result.GetTokenLogProbs().has_value()) {
+              nb::list token_logprobs;
+              for (const auto& candidate : *result.GetTokenLogProbs()) {
+                token_logprobs.append(
+                    ToTokenLogProbsDict(candidate, num_top_logprobs));
+              }
+              output["token_logprobs"] = token_logprobs;
+            }
+            return output;
+          },
+          nb::arg("text"), nb::arg("num_top_logprobs") = 0,
+          nb::arg("max_output_tokens") = nb::none(),
+          "Generates a response to `text` in a new session. Returns a dict "
+          "with 'texts' (one str per candidate) and, when num_top_logprobs is "
+          "positive, 'token_logprobs' (one dict per candidate with the numpy "
+          "arrays 'token_ids' and 'logprobs' of shape [num_tokens], and "
+          "'top_token_ids' and 'top_logprobs' of shape [num_tokens, "
+          "num_top_logprobs]).")
+      .def(
+          "tokenize",
+          [](const Engine& self, absl::string_view text) {
+            absl::StatusOr<TokenIds> token_ids;
+            {
+              nb::gil_scoped_release release;
+              token_ids = self.GetTokenizer().TextToTokenIds(text);
+            }
+            return ToNumpy(VALUE_OR_THROW(std::move(token_ids)));
+          },
+          nb::arg("text"),
+          "Encodes `text` into a 1D int32 numpy array of token ids.")
+      .def(
+          "detokenize",
+          [](const Engine& self, const PyTokenIds& token_ids) {
+            TokenIds ids(token_ids.data(), token_ids.data() + token_ids.size());
+            absl::StatusOr<std::string> text;
+            {
+              nb::gil_scoped_release release;
+              text = self.GetTokenizer().TokenIdsToText(ids);
+            }
+            return VALUE_OR_THROW(std::move(text));
+          },
+          nb::arg("token_ids"),
+          "Decodes a 1D int32 array (or any int32 buffer) of token ids.")
+      .def(
+          "get_metrics",
+          [](const Engine& self) {
+            MetricsSnapshot snapshot =
+                VALUE_OR_THROW(self.GetMetricsSnapshot());
+            nb::dict metrics;
+            for (const MetricSnapshot& metric : snapshot.metrics()) {
+              if (metric.type != MetricType::kHistogram) {
+                metrics[nb::str(metric.name.c_str())] = metric.value;
+                continue;
+              }
+              nb::list buckets;
+              int64_t cumulative = 0;
+              for (size_t i = 0; i < metric.histogram.bucket_counts.size();
+                   ++i) {
+                cumulative += metric.histogram.bucket_counts[i];
+                const double upper_bound =
+                    i < metric.histogram.upper_bounds.size()
+                        ? metric.histogram.upper_bounds[i]
+                        : std::numeric_limits<double>::infinity();
+                buckets.append(nb::make_tuple(upper_bound, cumulative));
+              }
+              nb::dict histogram;
+              histogram["count"] = metric.histogram.count;
+              histogram["sum"] = metric.histogram.sum;
+              histogram["buckets"] = buckets;
+              metrics[nb::str(metric.name.c_str())] = histogram;
+            }
+            return metrics;
+          },
+          "Returns a snapshot of the engine's live metrics as a dict. "
+          "Counters and gauges map to ints; histograms map to a dict with "
+          "'count', 'sum' and cumulative 'buckets' as (upper_bound, count) "
+          "pairs.")
+      .def(
+          "get_metrics_prometheus_text",
+          [](const Engine& self) {
+            return VALUE_OR_THROW(self.GetMetricsSnapshot())
+                .ToPrometheusText();
+          },
+          "Returns a snapshot of the engine's live metrics in the Prometheus "
+          "text exposition format.");
 
   nb::class_<Conversation>(module, "Conversation", nb::dynamic_attr())
       // Support for Python context managers (with statement).
@@ -307,9 +543,11 @@ NB_MODULE(litert_lm_ext, module) {
       .def("cancel_process", &Conversation::CancelProcess)
       .def(
           "send_message",
-          [](Conversation& self, const nb::handle& message) {
+          [](Conversation& self, const nb::handle& message,
+             const std::vector<PyByteBuffer>& attachments) {
             nlohmann::json json_message = ParseJsonMessage(message);
-            absl::StatusOr<Message> result = self.SendMessage(json_message);
+            absl::StatusOr<Message> result = self.SendMessage(
+                json_message, ParseAttachments(json_message, attachments));
             Message message_variant = VALUE_OR_THROW(std::move(result));
 
             if (!std::holds_alternative<JsonMessage>(message_variant)) {
@@ -320,17 +558,21 @@ NB_MODULE(litert_lm_ext, module) {
             return static_cast<nlohmann::json>(
                 std::get<JsonMessage>(message_variant));
           },
-          nb::arg("message"))
+          nb::arg("message"),
+          nb::arg("attachments") = std::vector<PyByteBuffer>())
       .def(
           "send_message_async",
-          [](Conversation& self, const nb::handle& message) {
+          [](Conversation& self, const nb::handle& message,
+             const std::vector<PyByteBuffer>& attachments) {
             nlohmann::json json_message = ParseJsonMessage(message);
             auto iterator = std::make_shared<MessageIterator>();
 
             absl::Status status = self.SendMessageAsync(
-                json_message, [iterator](absl::StatusOr<Message> message) {
+                json_message,
+                [iterator](absl::StatusOr<Message> message) {
                   iterator->Push(std::move(message));
-                });
+                },
+                ParseAttachments(json_message, attachments));
 
             if (!status.ok()) {
               std::stringstream error_msg_stream;
@@ -339,7 +581,41 @@ NB_MODULE(litert_lm_ext, module) {
             }
             return iterator;
           },
-          nb::arg("message"));
+          nb::arg("message"),
+          nb::arg("attachments") = std::vector<PyByteBuffer>())
+      .def(
+          "score",
+          [](Conversation& self, const std::vector<std::string>& target_texts) {
+            std::vector<absl::string_view> targets(target_texts.begin(),
+                                                   target_texts.end());
+            absl::StatusOr<Responses> responses;
+            {
+              nb::gil_scoped_release release;
+              responses = self.RunTextScoring(targets);
+            }
+            Responses result = VALUE_OR_THROW(std::move(responses));
+
+            nb::dict scores;
+            scores["scores"] = ToNumpy(std::move(result.GetMutableScores()));
+            if (result.GetTokenLengths().has_value()) {
+              scores["token_lengths"] =
+                  ToNumpy(std::move(*result.GetMutableTokenLengths()));
+            }
+            if (result.GetTokenScores().has_value()) {
+              nb::list token_scores;
+              for (std::vector<float>& per_token :
+                   *result.GetMutableTokenScores()) {
+                token_scores.append(ToNumpy(std::move(per_token)));
+              }
+              scores["token_scores"] = token_scores;
+            }
+            return scores;
+          },
+          nb::arg("target_texts"),
+          "Scores each target text as a continuation of the conversation. "
+          "Returns a dict with 'scores' (float32 array of log likelihoods), "
+          "'token_lengths' (int32 array) and, when the model provides them, "
+          "'token_scores' (one float32 array per target text).");
 
   // Expose the MessageIterator to Python so that it can be used in a
   // standard `for chunk in stream:` loop. We bind Python's iterator protocol
@@ -0,0 +1,56 @@
+# Copyright 2026 The ODML Authors.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+
+from absl.testing import absltest
+
+from litert_lm.python import litert_lm_ext
+
+
+class LitertLmExtTest(absltest.TestCase):
+
+  def setUp(self):
+    super().setUp()
+    model_path = os.path.join(
+        os.environ.get("TEST_SRCDIR", ""),
+        "litert_lm/runtime/testdata/test_lm.litertlm",
+    )
+    # Only 32 tokens, so that the test model ends gracefully and quickly.
+    self.engine = self.enter_context(
+        litert_lm_ext.Engine(
+            model_path, max_num_tokens=32, cache_dir=":nocache"
+        )
+    )
+
+  def test_create_conversation_rejects_negative_streaming_limits(self):
+    with self.assertRaises(ValueError):
+      self.engine.create_conversation(streaming_max_tokens=-1)
+    with self.assertRaises(ValueError):
+      self.engine.create_conversation(streaming_max_bytes=-1)
+    with self.assertRaises(ValueError):
+      self.engine.create_conversation(streaming_max_delay_ms=-1)
+
+  def test_send_message_async_without_streaming_limits_sends_one_chunk(self):
+    with self.engine.create_conversation(
+        streaming_max_tokens=0
+    ) as conversation:
+      chunks = list(conversation.send_message_async("Hello"))
+
+    # Without any limit, the whole response is held back until decoding stops.
+    self.assertLen(chunks, 1)
+
+
+if __name__ == "__main__":
+  absltest.main()
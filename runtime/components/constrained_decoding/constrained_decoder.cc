@@ -16,8 +16,11 @@
 
 #include <cstdint>
 #include <limits>
+#include <vector>
 
+#include "absl/functional/function_ref.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/synchronization/blocking_counter.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_element_type.h"  // from @litert
 #include "litert/cc/litert_layout.h"  // from @litert
@@ -30,6 +33,37 @@
 
 namespace litert::lm {
 
+absl::Status ConstrainedDecoder::ForEachSequence(
+    absl::FunctionRef<absl::Status(int)> fn) {
+  if (thread_pool_ == nullptr || batch_size_ <= 1) {
+    for (int b = 0; b < batch_size_; ++b) {
+      RETURN_IF_ERROR(fn(b));
+    }
+    return absl::OkStatus();
+  }
+  // Sequence 0 runs on the calling thread, which would otherwise sit idle
+  // waiting for the others.
+  std::vector<absl::Status> statuses(batch_size_);
+  absl::BlockingCounter pending(batch_size_ - 1);
+  for (int b = 1; b < batch_size_; ++b) {
+    absl::Status scheduled =
+        thread_pool_->Schedule([&fn, &statuses, &pending, b]() {
+          statuses[b] = fn(b);
+          pending.DecrementCount();
+        });
+    if (!scheduled.ok()) {
+      statuses[b] = fn(b);
+      pending.DecrementCount();
+    }
+  }
+  statuses[0] = fn(0);
+  pending.Wait();
+  for (const absl::Status& status : statuses) {
+    RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ConstrainedDecoder::UpdateConstraintState(
     const ::litert::TensorBuffer& next_token_ids) {
   LITERT_ASSIGN_OR_RETURN(auto next_token_ids_span,
@@ -42,7 +76,7 @@ absl::Status ConstrainedDecoder::UpdateConstraintState(
   RET_CHECK_EQ(next_token_ids.size(), batch_size_)
       << "Batch size [" << next_token_ids.size()
       << "] does not match the expected batch size [" << batch_size_ << "].";
-  for (int i = 0; i < batch_size_; ++i) {
+  return ForEachSequence([&](int i) -> absl::Status {
     auto& constraint_state = constraint_states_[i];
     ASSIGN_OR_RETURN(
         constraint_state,
@@ -50,8 +84,8 @@ absl::Status ConstrainedDecoder::UpdateConstraintState(
     if (constraint_->IsEnded(*constraint_state)) {
       constraint_state = constraint_->Start();
     }
-  }
-  return absl::OkStatus();
+    return absl::OkStatus();
+  });
 }
 
 absl::Status ConstrainedDecoder::MaskLogits(::litert::TensorBuffer& logits) {
@@ -89,18 +123,18 @@ absl::Status ConstrainedDecoder::MaskLogits(
   RET_CHECK_EQ(batch_size, batch_size_)
       << "Batch size [" << batch_size
       << "] does not match the expected batch size [" << batch_size_ << "].";
-  for (int b = 0; b < batch_size; ++b) {
-    auto& constraint_state = constraint_states_[b];
+  // Each sequence only touches its own row of the logits.
+  return ForEachSequence([&](int b) -> absl::Status {
     ASSIGN_OR_RETURN(auto bitmap,
-                     constraint_->ComputeBitmap(*constraint_state));
+                     constraint_->ComputeBitmap(*constraint_states_[b]));
     for (int i = 0; i < vocab_size; ++i) {
       if (!bitmap->Get(i)) {
         logits.data()[b * vocab_size + i] =
             std::numeric_limits<float>::lowest();
       }
     }
-  }
-  return absl::OkStatus();
+    return absl::OkStatus();
+  });
 }
 
 absl::Status ConstrainedDecoder::MaskLogits(
@@ -122,17 +156,17 @@ absl::Status ConstrainedDecoder::MaskLogits(
   RET_CHECK_EQ(batch_size, batch_size_)
       << "Batch size [" << batch_size
       << "] does not match the expected batch size [" << batch_size_ << "].";
-  for (int b = 0; b < batch_size; ++b) {
-    auto& constraint_state = constraint_states_[b];
+  // Each sequence only touches its own row of the logits.
+  return ForEachSequence([&](int b) -> absl::Status {
     ASSIGN_OR_RETURN(auto bitmap,
-                     constraint_->ComputeBitmap(*constraint_state));
+                     constraint_->ComputeBitmap(*constraint_states_[b]));
     for (int i = 0; i < vocab_size; ++i) {
       if (!bitmap->Get(i)) {
         logits.data()[b * vocab_size + i] = tflite::half::min();
       }
     }
-  }
-  return absl::OkStatus();
+    return absl::OkStatus();
+  });
 }
 
 }  // namespace litert::lm
@@ -20,11 +20,14 @@
 #include <memory>
 #include <vector>
 
+#include "absl/base/nullability.h"  // from @com_google_absl
+#include "absl/functional/function_ref.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/constrained_decoding/constraint.h"
+#include "runtime/framework/threadpool.h"
 #include "tflite/types/half.h"  // from @litert
 
 namespace litert::lm {
@@ -52,8 +55,16 @@ class ConstrainedDecoder {
   // @param constraint The constraint to apply during decoding. The caller
   // retains ownership and must ensure it outlives the decoder.
   // @param batch_size The number of sequences in the batch.
-  explicit ConstrainedDecoder(Constraint* constraint, int batch_size)
-      : constraint_(constraint), batch_size_(batch_size) {
+  // @param thread_pool Optional pool used to compute the next states and the
+  // bitmaps of the sequences in parallel. The constraint must then support
+  // concurrent calls on distinct states. If null, or if batch_size is 1, the
+  // sequences are processed one after another on the calling thread. The
+  // caller retains ownership and must ensure it outlives the decoder.
+  explicit ConstrainedDecoder(Constraint* constraint, int batch_size,
+                              ThreadPool* absl_nullable thread_pool = nullptr)
+      : constraint_(constraint),
+        batch_size_(batch_size),
+        thread_pool_(thread_pool) {
     constraint_states_.reserve(batch_size_);
     std::generate_n(std::back_inserter(constraint_states_), batch_size_,
                     [&]() { return constraint_->Start(); });
@@ -98,9 +109,15 @@ class ConstrainedDecoder {
   Constraint* GetConstraint() const { return constraint_; }
 
  private:
+  // Runs `fn` for every sequence index in [0, batch_size_) and returns the
+  // first error, if any. The calls run in parallel on `thread_pool_` when it
+  // is set, and the function returns only once all of them have finished.
+  absl::Status ForEachSequence(absl::FunctionRef<absl::Status(int)> fn);
+
   // The constraint to be applied.
   Constraint* constraint_;
   const int batch_size_;
+  ThreadPool* absl_nullable thread_pool_;
   // The current constraint states.
   std::vector<std::unique_ptr<Constraint::State>> constraint_states_;
 };
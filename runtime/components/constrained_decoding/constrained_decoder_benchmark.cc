@@ -0,0 +1,136 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for ConstrainedDecoder::MaskLogits and the Bitmap types it
+// reads the allowed tokens from.
+//
+// bazel run -c opt //runtime/components/constrained_decoding:constrained_decoder_benchmark
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "litert/cc/litert_layout.h"  // from @litert
+#include "runtime/components/constrained_decoding/bitmap.h"
+#include "runtime/components/constrained_decoding/constrained_decoder.h"
+#include "runtime/components/constrained_decoding/constraint.h"
+#include "runtime/components/constrained_decoding/fake_constraint.h"
+
+namespace litert::lm {
+namespace {
+
+// A packed bitmap allowing every `stride`-th token, which is representative
+// of the dense bitmaps produced by grammar based constraints.
+class PackedBitmap : public Bitmap {
+ public:
+  PackedBitmap(int vocab_size, int stride) : bits_((vocab_size + 31) / 32) {
+    for (int i = 0; i < vocab_size; i += stride) {
+      bits_[i / 32] |= 1u << (i % 32);
+    }
+  }
+
+  bool Get(int index) const override {
+    return (bits_[index / 32] >> (index % 32)) & 1u;
+  }
+
+ private:
+  std::vector<uint32_t> bits_;
+};
+
+// A stateless constraint returning the same bitmap for every state.
+class StaticConstraint : public Constraint {
+ public:
+  // stride == 0 allows all tokens.
+  StaticConstraint(int vocab_size, int stride)
+      : vocab_size_(vocab_size), stride_(stride) {}
+
+  std::unique_ptr<State> Start() const override {
+    return std::make_unique<State>();
+  }
+  bool IsEnded(const State& state) const override { return false; }
+  int GetVocabularySize() const override { return vocab_size_; }
+  absl::StatusOr<std::unique_ptr<State>> ComputeNext(
+      const State& state, int token) const override {
+    return std::make_unique<State>();
+  }
+  absl::StatusOr<std::unique_ptr<Bitmap>> ComputeBitmap(
+      const State& state) const override {
+    if (stride_ == 0) {
+      return std::make_unique<AllAllowedBitmap>();
+    }
+    return std::make_unique<PackedBitmap>(vocab_size_, stride_);
+  }
+
+ private:
+  const int vocab_size_;
+  const int stride_;
+};
+
+// Args: vocab_size, batch_size, stride (0: all allowed, -1: single token).
+void BM_ConstrainedDecoder_MaskLogits(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int batch_size = state.range(1);
+  const int stride = state.range(2);
+  std::unique_ptr<Constraint> constraint;
+  if (stride < 0) {
+    constraint = std::make_unique<FakeConstraint>(std::vector<int>{1, 2, 3},
+                                                  vocab_size);
+  } else {
+    constraint = std::make_unique<StaticConstraint>(vocab_size, stride);
+  }
+  ConstrainedDecoder decoder(constraint.get(), batch_size);
+  std::vector<float> logits(batch_size * vocab_size, 1.0f);
+  const std::vector<Layout::Dim> dims = {batch_size, 1, vocab_size};
+  for (auto _ : state) {
+    auto status =
+        decoder.MaskLogits(absl::MakeSpan(logits), absl::MakeConstSpan(dims));
+    benchmark::DoNotOptimize(status);
+    benchmark::DoNotOptimize(logits.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * vocab_size);
+}
+BENCHMARK(BM_ConstrainedDecoder_MaskLogits)
+    ->ArgNames({"vocab", "batch", "stride"})
+    ->ArgsProduct({{32000, 262144}, {1, 4}, {-1, 0, 2, 64}});
+
+// Args: vocab_size, stride (0: all allowed).
+void BM_Bitmap_Get(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int stride = state.range(1);
+  std::unique_ptr<Bitmap> bitmap;
+  if (stride == 0) {
+    bitmap = std::make_unique<AllAllowedBitmap>();
+  } else {
+    bitmap = std::make_unique<PackedBitmap>(vocab_size, stride);
+  }
+  for (auto _ : state) {
+    int num_allowed = 0;
+    for (int i = 0; i < vocab_size; ++i) {
+      num_allowed += bitmap->Get(i);
+    }
+    benchmark::DoNotOptimize(num_allowed);
+  }
+  state.SetItemsProcessed(state.iterations() * vocab_size);
+}
+BENCHMARK(BM_Bitmap_Get)
+    ->ArgNames({"vocab", "stride"})
+    ->ArgsProduct({{32000, 262144}, {0, 2}});
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
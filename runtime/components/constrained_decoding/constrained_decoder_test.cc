@@ -27,6 +27,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/c/litert_model_types.h"  // from @litert
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "litert/cc/litert_expected.h"  // from @litert
@@ -38,6 +39,7 @@
 #include "runtime/components/constrained_decoding/constraint_provider.h"
 #include "runtime/components/constrained_decoding/fst_constraint_config.h"
 #include "runtime/components/constrained_decoding/fst_constraint_provider.h"
+#include "runtime/framework/threadpool.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "sentencepiece_processor.h"  // from @sentencepiece
 
@@ -228,6 +230,39 @@ TEST_F(ConstrainedDecoderTest, UpdateStateAndMaskLogitsBatchSize2) {
   }
 }
 
+TEST_F(ConstrainedDecoderTest, UpdateStateAndMaskLogitsWithThreadPool) {
+  ASSERT_OK_AND_ASSIGN(auto constraint,
+                       provider_->CreateConstraint(
+                           FstConstraintArg{.constraint_string = "ab|c"}));
+  ThreadPool thread_pool("constraint_test", /*max_num_threads=*/2);
+  ConstrainedDecoder constrained_decoder(constraint.get(), /*batch_size=*/3,
+                                         &thread_pool);
+
+  std::vector<int> token_ids = {spm_processor_.PieceToId("a"),
+                                spm_processor_.PieceToId("c"),
+                                spm_processor_.PieceToId("a")};
+  ASSERT_OK(
+      constrained_decoder.UpdateConstraintState(absl::MakeSpan(token_ids)));
+
+  std::vector<float> logits(vocab_size_ * 3, 1.0f);
+  std::vector<::litert::Layout::Dim> logits_dims = {3, 1, vocab_size_};
+  ASSERT_OK(
+      constrained_decoder.MaskLogits(absl::MakeSpan(logits), logits_dims));
+
+  // Each candidate is masked from its own state: "b" is the only token allowed
+  // after "a", and "<e>" is the only token allowed after "c".
+  for (int b = 0; b < 3; ++b) {
+    const int allowed_token_id =
+        b == 1 ? spm_processor_.PieceToId("<e>") : spm_processor_.PieceToId("b");
+    for (int i = 0; i < vocab_size_; ++i) {
+      EXPECT_EQ(logits[b * vocab_size_ + i],
+                i == allowed_token_id ? 1.0f
+                                      : std::numeric_limits<float>::lowest())
+          << "candidate " << b << ", token " << i;
+    }
+  }
+}
+
 TEST_F(ConstrainedDecoderTest, UpdateStateFailsWithWrongBatchSize) {
   ASSERT_OK_AND_ASSIGN(
       auto constraint,
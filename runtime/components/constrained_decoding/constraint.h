@@ -27,6 +27,11 @@ namespace litert::lm {
 // be maintained by the executor during decoding.
 
 // A constraint is always created by the ConstraintProvider.
+//
+// The states of the output candidates are advanced in parallel, so
+// implementations must support concurrent calls to ComputeNext() and
+// ComputeBitmap() on distinct states. Any cache shared across states must be
+// synchronized.
 class Constraint {
  public:
   // The state of the constraint.
@@ -23,10 +23,11 @@ class MockTokenizer : public Tokenizer {
  public:
   MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
   MOCK_METHOD(absl::StatusOr<TokenIds>, TextToTokenIds, (absl::string_view),
-              (override));
-  MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view), (override));
+              (const, override));
+  MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view),
+              (const, override));
   MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText, (const TokenIds&),
-              (override));
+              (const, override));
   MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
 };
 
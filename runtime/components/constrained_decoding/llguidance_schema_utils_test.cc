@@ -109,7 +109,8 @@ class SimpleTokenizer : public Tokenizer {
     return TokenizerType::kSentencePiece;
   }
 
-  absl::StatusOr<TokenIds> TextToTokenIds(absl::string_view text) override {
+  absl::StatusOr<TokenIds> TextToTokenIds(
+      absl::string_view text) const override {
     TokenIds ids;
     absl::string_view remaining_text = text;
 
@@ -140,7 +141,7 @@ class SimpleTokenizer : public Tokenizer {
     return ids;
   }
 
-  absl::StatusOr<int> TokenToId(absl::string_view token) override {
+  absl::StatusOr<int> TokenToId(absl::string_view token) const override {
     auto it = vocab_.find(token);
     if (it != vocab_.end()) {
       return it->second;
@@ -148,7 +149,8 @@ class SimpleTokenizer : public Tokenizer {
     return absl::NotFoundError(absl::StrCat("Token not found: ", token));
   }
 
-  absl::StatusOr<std::string> TokenIdsToText(const TokenIds& ids) override {
+  absl::StatusOr<std::string> TokenIdsToText(
+      const TokenIds& ids) const override {
     std::string text;
     for (int id : ids) {
       auto it = id_to_piece_.find(id);
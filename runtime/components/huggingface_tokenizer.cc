@@ -53,7 +53,7 @@ HuggingFaceTokenizer::CreateFromJson(const std::string& json) {
 
 // Encodes the given text into a TensorBuffer of token ids.
 absl::StatusOr<std::vector<int>> HuggingFaceTokenizer::TextToTokenIds(
-    absl::string_view text) {
+    absl::string_view text) const {
   {
     // Disable leak check as Google's default leak checker does not properly
     // support Rust's lazy_static initialization.
@@ -63,13 +63,14 @@ absl::StatusOr<std::vector<int>> HuggingFaceTokenizer::TextToTokenIds(
   }
 }
 
-absl::StatusOr<int> HuggingFaceTokenizer::TokenToId(absl::string_view token) {
+absl::StatusOr<int> HuggingFaceTokenizer::TokenToId(
+    absl::string_view token) const {
   return tokenizer_->TokenToId(std::string{token});
 }
 
 // Decodes the given TensorBuffer of token ids into a vector of strings.
 absl::StatusOr<std::string> HuggingFaceTokenizer::TokenIdsToText(
-    const std::vector<int>& token_ids) {
+    const std::vector<int>& token_ids) const {
   {
     absl::LeakCheckDisabler disabler;
     // Disable leak check as Google's default leak checker does not properly
@@ -44,15 +44,15 @@ class HuggingFaceTokenizer : public Tokenizer {
 
   // Encodes the given text into a sequence of token ids.
   absl::StatusOr<std::vector<int>> TextToTokenIds(
-      absl::string_view text) override;
+      absl::string_view text) const override;
 
-  absl::StatusOr<int> TokenToId(absl::string_view token) override;
+  absl::StatusOr<int> TokenToId(absl::string_view token) const override;
 
   // Decodes the given sequence of token ids into a string.
   // Returns absl::DataLossError if any of the tokens are part of an incomplete
   // BPE sequence.
   absl::StatusOr<std::string> TokenIdsToText(
-      const std::vector<int>& token_ids) override;
+      const std::vector<int>& token_ids) const override;
 
   std::vector<std::string> GetTokens() const override;
 
@@ -16,9 +16,11 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_PREPROCESSOR_AUDIO_PREPROCESSOR_H_
 
 #include <array>
+#include <optional>
 #include <ostream>
 
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
 
@@ -72,6 +74,9 @@ class AudioPreprocessorConfig {
     os << "  mel_low_hz: " << config.GetMelLowHz() << "\n";
     os << "  mel_high_hz: " << config.GetMelHighHz() << "\n";
     os << "  mel_floor: " << config.GetMelFloor() << "\n";
+    if (config.GetSilenceTrimming().has_value()) {
+      os << "  silence_trimming: " << *config.GetSilenceTrimming() << "\n";
+    }
     os << "}";
     return os;
   }
@@ -109,6 +114,13 @@ class AudioPreprocessorConfig {
   float GetMelHighHz() const { return mel_high_hz_; }
   // The floor value of the Mel spectrogram.
   float GetMelFloor() const { return mel_floor_; }
+  // The voice activity detection used to trim the silence from the audio
+  // before computing the spectrogram. No silence is trimmed if not set. The
+  // audio passed to consecutive Preprocess calls is trimmed as one utterance,
+  // which ends when the preprocessor is reset.
+  const std::optional<SilenceTrimmingConfig>& GetSilenceTrimming() const {
+    return silence_trimming_;
+  }
 
   // Setter APIs.
   void SetSampleRateHz(int sample_rate_hz) { sample_rate_hz_ = sample_rate_hz; }
@@ -129,6 +141,10 @@ class AudioPreprocessorConfig {
   void SetMelLowHz(float mel_low_hz) { mel_low_hz_ = mel_low_hz; }
   void SetMelHighHz(float mel_high_hz) { mel_high_hz_ = mel_high_hz; }
   void SetMelFloor(float mel_floor) { mel_floor_ = mel_floor; }
+  void SetSilenceTrimming(
+      std::optional<SilenceTrimmingConfig> silence_trimming) {
+    silence_trimming_ = silence_trimming;
+  }
 
   // The Mel Spectrogram means used for Universal Speech Model (USM) during
   // preprocessing.
@@ -259,6 +275,7 @@ class AudioPreprocessorConfig {
   float mel_floor_;
   float input_scale_;
   float pre_emphasis_factor_;
+  std::optional<SilenceTrimmingConfig> silence_trimming_;
 };
 
 // Interface for audio preprocessing.
@@ -272,6 +289,13 @@ class AudioPreprocessor {
 
   // Reset the audio preprocessor to the initial state.
   virtual void Reset() = 0;
+
+  // Returns the number of audio samples preprocessed and removed by the
+  // silence trimming since the creation of the preprocessor. Empty if the
+  // preprocessor does not trim silence.
+  virtual SilenceTrimmingStats GetSilenceTrimmingStats() const {
+    return SilenceTrimmingStats();
+  }
 };
 
 }  // namespace litert::lm
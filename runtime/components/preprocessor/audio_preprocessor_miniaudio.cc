@@ -19,6 +19,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -35,6 +36,7 @@
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/preprocessor/audio_preprocessor.h"
 #include "runtime/components/preprocessor/mel_filterbank.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
 #include "miniaudio.h"  // from @miniaudio
@@ -134,8 +136,9 @@ absl::Status AudioPreprocessorMiniAudio::PcmFramesToSpectrogram(
                  scaled_pcm_frames.begin(),
                  [&input_scale](float x) { return x * input_scale; });
   std::vector<std::vector<float>> windowed_signals;
-  const int num_frames = 1 + (pcm_frames.size() - config_.GetFrameLength()) /
-                                 config_.GetHopLength();
+  const int num_frames = std::max<int>(
+      0, 1 + (static_cast<int>(pcm_frames.size()) - config_.GetFrameLength()) /
+                 config_.GetHopLength());
   windowed_signals.reserve(num_frames);
   int input_start = 0;
   while (GetNextWindowOfSamples(scaled_pcm_frames, input_start)) {
@@ -217,15 +220,22 @@ AudioPreprocessorMiniAudio::Create(const AudioPreprocessorConfig& config) {
   RETURN_IF_ERROR(mel_filterbank->Initialize(
       config.GetFftBins(), config.GetSampleRateHz(), config.GetNumMelBins(),
       config.GetMelLowHz(), config.GetMelHighHz()));
-  return absl::WrapUnique(
-      new AudioPreprocessorMiniAudio(config, std::move(mel_filterbank)));
+  std::optional<SilenceTrimmer> silence_trimmer;
+  if (config.GetSilenceTrimming().has_value()) {
+    ASSIGN_OR_RETURN(silence_trimmer,
+                     SilenceTrimmer::Create(config.GetSampleRateHz(),
+                                            *config.GetSilenceTrimming()));
+  }
+  return absl::WrapUnique(new AudioPreprocessorMiniAudio(
+      config, std::move(mel_filterbank), std::move(silence_trimmer)));
 }
 
 // The preprocessing steps are:
 // 1. Decode the audio bytes to PCM frames.
-// 2. Convert PCM frames to spectrograms. (STFT)
-// 3. Convert spectrograms to log mel spectrograms. (Mel filterbank)
-// 4. Create a tensor buffer for the log mel spectrograms.
+// 2. Trim the silence from the PCM frames, if configured.
+// 3. Convert PCM frames to spectrograms. (STFT)
+// 4. Convert spectrograms to log mel spectrograms. (Mel filterbank)
+// 5. Create a tensor buffer for the log mel spectrograms.
 absl::StatusOr<InputAudio> AudioPreprocessorMiniAudio::Preprocess(
     const InputAudio& input_audio) {
   if (input_audio.IsTensorBuffer()) {
@@ -247,6 +257,20 @@ absl::StatusOr<InputAudio> AudioPreprocessorMiniAudio::Preprocess(
                                 config_.GetSampleRateHz(), decoded_pcm_frames));
     pcm_frames = decoded_pcm_frames;
   }
+  // Every removed sample saves the work of the spectrogram, the audio encoder
+  // and the prefill of the audio tokens. The silence at the end of the audio
+  // is held back by the trimmer until the next call shows whether it is a
+  // pause or the end of the utterance.
+  std::vector<float> trimmed_pcm_frames;
+  if (silence_trimmer_.has_value()) {
+    silence_trimmer_->Trim(pcm_frames, trimmed_pcm_frames);
+    ABSL_LOG(INFO) << "Kept " << trimmed_pcm_frames.size() * 1000 /
+                                     config_.GetSampleRateHz()
+                   << " ms of audio from "
+                   << pcm_frames.size() * 1000 / config_.GetSampleRateHz()
+                   << " ms after silence trimming.";
+    pcm_frames = trimmed_pcm_frames;
+  }
   std::vector<float> spectrograms;
   RETURN_IF_ERROR(PcmFramesToSpectrogram(pcm_frames, spectrograms));
 
@@ -16,6 +16,7 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_PREPROCESSOR_AUDIO_PREPROCESSOR_MINIAUDIO_H_
 
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include "absl/types/span.h"  // from @com_google_absl
 #include "runtime/components/preprocessor/audio_preprocessor.h"
 #include "runtime/components/preprocessor/mel_filterbank.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/engine/io_types.h"
 
 namespace litert::lm {
@@ -66,10 +68,19 @@ class AudioPreprocessorMiniAudio : public AudioPreprocessor {
   //   with shape (1, num_frames, num_mel_bins).
   absl::StatusOr<InputAudio> Preprocess(const InputAudio& input_audio) override;
 
-  // Resets the preprocessor to its initial state.
+  // Resets the preprocessor to its initial state. This ends the utterance
+  // whose silence is being trimmed; the silence trimming stats are kept.
   void Reset() override {
     input_queue_.clear();
     samples_to_next_step_ = config_.GetFrameLength();
+    if (silence_trimmer_.has_value()) {
+      silence_trimmer_->Reset();
+    }
+  }
+
+  SilenceTrimmingStats GetSilenceTrimmingStats() const override {
+    return silence_trimmer_.has_value() ? silence_trimmer_->GetStats()
+                                        : SilenceTrimmingStats();
   }
 
   // Copy constructor for cloning the audio preprocessor.
@@ -77,7 +88,8 @@ class AudioPreprocessorMiniAudio : public AudioPreprocessor {
       : config_(other.config_),
         mel_filterbank_(nullptr),
         input_queue_(other.input_queue_),
-        samples_to_next_step_(other.samples_to_next_step_) {
+        samples_to_next_step_(other.samples_to_next_step_),
+        silence_trimmer_(other.silence_trimmer_) {
     mel_filterbank_ = std::make_unique<MelFilterbank>();
     ABSL_CHECK_OK(mel_filterbank_->Initialize(
         other.config_.GetFftBins(), other.config_.GetSampleRateHz(),
@@ -97,16 +109,19 @@ class AudioPreprocessorMiniAudio : public AudioPreprocessor {
         other.config_.GetMelHighHz()));
     input_queue_ = other.input_queue_;
     samples_to_next_step_ = other.samples_to_next_step_;
+    silence_trimmer_ = other.silence_trimmer_;
     return *this;
   }
 
  private:
   explicit AudioPreprocessorMiniAudio(
       const AudioPreprocessorConfig& config,
-      std::unique_ptr<MelFilterbank> mel_filterbank)
+      std::unique_ptr<MelFilterbank> mel_filterbank,
+      std::optional<SilenceTrimmer> silence_trimmer)
       : config_(config),
         mel_filterbank_(std::move(mel_filterbank)),
-        input_queue_(std::vector<float>()) {
+        input_queue_(std::vector<float>()),
+        silence_trimmer_(std::move(silence_trimmer)) {
     samples_to_next_step_ = config_.GetFrameLength();
   }
 
@@ -123,6 +138,9 @@ class AudioPreprocessorMiniAudio : public AudioPreprocessor {
   std::unique_ptr<MelFilterbank> mel_filterbank_;
   std::vector<float> input_queue_;
   int samples_to_next_step_;
+  // Set if the silence is trimmed. Keeps the silence of the utterance whose
+  // fate is not known yet.
+  std::optional<SilenceTrimmer> silence_trimmer_;
 };
 
 }  // namespace litert::lm
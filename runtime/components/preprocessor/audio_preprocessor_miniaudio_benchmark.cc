@@ -0,0 +1,96 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for AudioPreprocessorMiniAudio: wav decoding plus mel
+// spectrogram extraction, and the spectrogram alone on PCM input.
+//
+// bazel run -c opt //runtime/components/preprocessor:audio_preprocessor_miniaudio_benchmark
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "runtime/components/preprocessor/audio_preprocessor.h"
+#include "runtime/components/preprocessor/audio_preprocessor_miniaudio.h"
+#include "runtime/engine/io_types.h"
+
+namespace litert::lm {
+namespace {
+
+// Relative to the runfiles directory `bazel run` starts the binary in.
+constexpr char kAudioPath[] = "runtime/components/testdata/audio_sample.wav";
+
+std::string ReadFile(const char* path) {
+  std::ifstream file_stream(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file_stream.rdbuf();
+  return buffer.str();
+}
+
+void BM_AudioPreprocessor_PreprocessWav(benchmark::State& state) {
+  const std::string audio_bytes = ReadFile(kAudioPath);
+  if (audio_bytes.empty()) {
+    state.SkipWithError("Failed to read audio_sample.wav.");
+    return;
+  }
+  auto preprocessor = AudioPreprocessorMiniAudio::Create(
+      AudioPreprocessorConfig::CreateDefaultUsmConfig());
+  if (!preprocessor.ok()) {
+    state.SkipWithError(preprocessor.status().ToString());
+    return;
+  }
+  for (auto _ : state) {
+    auto audio = (*preprocessor)->Preprocess(InputAudio(audio_bytes));
+    benchmark::DoNotOptimize(audio);
+    (*preprocessor)->Reset();
+  }
+  state.SetBytesProcessed(state.iterations() * audio_bytes.size());
+}
+BENCHMARK(BM_AudioPreprocessor_PreprocessWav);
+
+// Args: clip length in milliseconds.
+void BM_AudioPreprocessor_PreprocessPcm(benchmark::State& state) {
+  const AudioPreprocessorConfig config =
+      AudioPreprocessorConfig::CreateDefaultUsmConfig();
+  auto preprocessor = AudioPreprocessorMiniAudio::Create(config);
+  if (!preprocessor.ok()) {
+    state.SkipWithError(preprocessor.status().ToString());
+    return;
+  }
+  const int num_samples = config.GetSampleRateHz() * state.range(0) / 1000;
+  std::vector<float> pcm_frames(num_samples);
+  for (int i = 0; i < num_samples; ++i) {
+    pcm_frames[i] = 0.5f * std::sin(2.0f * M_PI * 440.0f * i /
+                                    config.GetSampleRateHz());
+  }
+  for (auto _ : state) {
+    auto audio = (*preprocessor)->Preprocess(InputAudio(pcm_frames));
+    benchmark::DoNotOptimize(audio);
+    (*preprocessor)->Reset();
+  }
+  state.SetItemsProcessed(state.iterations() * num_samples);
+}
+BENCHMARK(BM_AudioPreprocessor_PreprocessPcm)
+    ->ArgNames({"ms"})
+    ->Arg(1000)
+    ->Arg(5000)
+    ->Arg(30000);
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
@@ -38,6 +38,7 @@
 #include "litert/cc/litert_options.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/preprocessor/audio_preprocessor.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/util/status_macros.h"
 #include "runtime/util/test_utils.h"  // NOLINT
@@ -419,6 +420,114 @@ TEST(AudioPreprocessorMiniAudioTest, UsmPreprocessingCopy) {
   }
 }
 
+TEST(AudioPreprocessorMiniAudioTest, UsmPreprocessingTrimsSilence) {
+  AudioPreprocessorConfig config =
+      AudioPreprocessorConfig::CreateDefaultUsmConfig();
+  ASSERT_OK_AND_ASSIGN(auto raw_audio_data, GetRawAudioData());
+  std::vector<float> pcm_frames;
+  ASSERT_OK(AudioPreprocessorMiniAudio::DecodeAudio(
+      raw_audio_data, config.GetNumChannels(), config.GetSampleRateHz(),
+      pcm_frames));
+  // Two seconds of silence before and after the speech.
+  const int num_silence_samples = 2 * config.GetSampleRateHz();
+  pcm_frames.insert(pcm_frames.begin(), num_silence_samples, 0.0f);
+  pcm_frames.insert(pcm_frames.end(), num_silence_samples, 0.0f);
+
+  ASSERT_OK_AND_ASSIGN(auto preprocessor,
+                       AudioPreprocessorMiniAudio::Create(config));
+  ASSERT_OK_AND_ASSIGN(auto preprocessed_audio,
+                       preprocessor->Preprocess(InputAudio(pcm_frames)));
+  ASSERT_OK_AND_ASSIGN(auto untrimmed_tensor,
+                       preprocessed_audio.GetPreprocessedAudioTensor());
+  ASSERT_OK_AND_ASSIGN(auto untrimmed_mel_spectrogram,
+                       GetDataAsVector<float>(*untrimmed_tensor));
+
+  SilenceTrimmingConfig silence_trimming;
+  config.SetSilenceTrimming(silence_trimming);
+  ASSERT_OK_AND_ASSIGN(auto trimming_preprocessor,
+                       AudioPreprocessorMiniAudio::Create(config));
+  ASSERT_OK_AND_ASSIGN(
+      auto trimmed_audio,
+      trimming_preprocessor->Preprocess(InputAudio(pcm_frames)));
+  ASSERT_OK_AND_ASSIGN(auto trimmed_tensor,
+                       trimmed_audio.GetPreprocessedAudioTensor());
+  ASSERT_OK_AND_ASSIGN(auto trimmed_mel_spectrogram,
+                       GetDataAsVector<float>(*trimmed_tensor));
+
+  // The added silence is removed, except for the padding around the speech.
+  // The trailing silence is only counted once the utterance ends.
+  trimming_preprocessor->Reset();
+  const SilenceTrimmingStats stats =
+      trimming_preprocessor->GetSilenceTrimmingStats();
+  EXPECT_EQ(stats.num_input_samples, pcm_frames.size());
+  EXPECT_GE(stats.num_removed_samples,
+            2 * (num_silence_samples - silence_trimming.padding_ms *
+                                           config.GetSampleRateHz() / 1000));
+  const int num_removed_frames =
+      (untrimmed_mel_spectrogram.size() - trimmed_mel_spectrogram.size()) /
+      config.GetNumMelBins();
+  EXPECT_NEAR(num_removed_frames,
+              stats.num_removed_samples / config.GetHopLength(), 1);
+
+  // The stats are kept across utterances.
+  ASSERT_OK(trimming_preprocessor->Preprocess(InputAudio(pcm_frames)));
+  trimming_preprocessor->Reset();
+  EXPECT_EQ(trimming_preprocessor->GetSilenceTrimmingStats().num_input_samples,
+            2 * pcm_frames.size());
+}
+
+TEST(AudioPreprocessorMiniAudioTest, UsmPreprocessingTrimsSilenceAcrossCalls) {
+  AudioPreprocessorConfig config =
+      AudioPreprocessorConfig::CreateDefaultUsmConfig();
+  config.SetSilenceTrimming(SilenceTrimmingConfig());
+  ASSERT_OK_AND_ASSIGN(auto raw_audio_data, GetRawAudioData());
+  std::vector<float> pcm_frames;
+  ASSERT_OK(AudioPreprocessorMiniAudio::DecodeAudio(
+      raw_audio_data, config.GetNumChannels(), config.GetSampleRateHz(),
+      pcm_frames));
+  // A long pause in the middle of the speech.
+  const int num_silence_samples = 2 * config.GetSampleRateHz();
+  pcm_frames.insert(pcm_frames.begin() + pcm_frames.size() / 2,
+                    num_silence_samples, 0.0f);
+
+  ASSERT_OK_AND_ASSIGN(auto preprocessor,
+                       AudioPreprocessorMiniAudio::Create(config));
+  ASSERT_OK_AND_ASSIGN(auto whole_audio,
+                       preprocessor->Preprocess(InputAudio(pcm_frames)));
+  preprocessor->Reset();
+  ASSERT_OK_AND_ASSIGN(auto whole_tensor,
+                       whole_audio.GetPreprocessedAudioTensor());
+  ASSERT_OK_AND_ASSIGN(auto whole_mel_spectrogram,
+                       GetDataAsVector<float>(*whole_tensor));
+
+  // The audio is split in the middle of the pause, which is shortened as if
+  // the audio came in one call.
+  const std::vector<float> front_half(
+      pcm_frames.begin(),
+      pcm_frames.begin() + (pcm_frames.size() + num_silence_samples) / 2);
+  const std::vector<float> back_half(
+      pcm_frames.begin() + front_half.size(), pcm_frames.end());
+  ASSERT_OK_AND_ASSIGN(auto front_audio,
+                       preprocessor->Preprocess(InputAudio(front_half)));
+  ASSERT_OK_AND_ASSIGN(auto back_audio,
+                       preprocessor->Preprocess(InputAudio(back_half)));
+  ASSERT_OK_AND_ASSIGN(auto front_tensor,
+                       front_audio.GetPreprocessedAudioTensor());
+  ASSERT_OK_AND_ASSIGN(auto back_tensor,
+                       back_audio.GetPreprocessedAudioTensor());
+  ASSERT_OK_AND_ASSIGN(auto chunked_mel_spectrogram,
+                       GetDataAsVector<float>(*front_tensor));
+  ASSERT_OK_AND_ASSIGN(auto back_mel_spectrogram,
+                       GetDataAsVector<float>(*back_tensor));
+  chunked_mel_spectrogram.insert(chunked_mel_spectrogram.end(),
+                                 back_mel_spectrogram.begin(),
+                                 back_mel_spectrogram.end());
+  ASSERT_EQ(chunked_mel_spectrogram.size(), whole_mel_spectrogram.size());
+  for (int i = 0; i < whole_mel_spectrogram.size(); ++i) {
+    EXPECT_NEAR(chunked_mel_spectrogram[i], whole_mel_spectrogram[i], 1e-5);
+  }
+}
+
 #endif  // !defined(WIN32) && !defined(_WIN32) && !defined(__WIN32__) &&
         // !defined(__NT__) && !defined(_WIN64)
 
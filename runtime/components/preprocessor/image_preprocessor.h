@@ -57,9 +57,21 @@ class ImagePreprocessParameter {
     patchify_config_ = patchify_config;
   }
 
+  // Gets whether a large image may first be reduced by a power of two, by
+  // averaging blocks of pixels in linear light, before it is resampled to the
+  // target size. Disabled by default.
+  bool IsFastDownscaleEnabled() const { return fast_downscale_; }
+
+  // Sets whether a large image may first be reduced by a power of two. The
+  // reduced image is never smaller than the target size, so the final resize
+  // still filters it, but the result differs slightly from resampling the
+  // full resolution image. The image is still decoded at full resolution.
+  void SetFastDownscale(bool enabled) { fast_downscale_ = enabled; }
+
  private:
   Dimensions dimensions_;
   std::optional<PatchifyConfig> patchify_config_;
+  bool fast_downscale_ = false;
 };
 
 // Preprocessor for image.
@@ -0,0 +1,224 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/preprocessor/silence_trimmer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+// A range of samples [start, end).
+struct SampleRange {
+  int64_t start;
+  int64_t end;
+};
+
+// Returns the energy of the frame in dB relative to a full scale sine wave,
+// whose mean square is 0.5.
+float FrameEnergyDb(absl::Span<const float> frame) {
+  double sum_of_squares = 0;
+  for (float sample : frame) {
+    sum_of_squares += static_cast<double>(sample) * sample;
+  }
+  const double mean_square = sum_of_squares / frame.size();
+  return 10.0 * std::log10(2.0 * mean_square +
+                           std::numeric_limits<double>::min());
+}
+
+absl::Status ValidateConfig(int sample_rate_hz,
+                            const SilenceTrimmingConfig& config) {
+  if (sample_rate_hz <= 0) {
+    return absl::InvalidArgumentError("The sample rate must be positive.");
+  }
+  if (config.frame_ms <= 0 || config.padding_ms < 0 ||
+      config.max_pause_ms < 0) {
+    return absl::InvalidArgumentError(
+        "The silence trimming frame length must be positive, and the padding "
+        "and maximum pause must not be negative.");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status TrimSilence(absl::Span<const float> pcm_frames, int sample_rate_hz,
+                         const SilenceTrimmingConfig& config,
+                         std::vector<float>& trimmed_pcm_frames,
+                         SilenceTrimmingStats& stats) {
+  RETURN_IF_ERROR(ValidateConfig(sample_rate_hz, config));
+  const int64_t num_samples = pcm_frames.size();
+  stats.num_input_samples += num_samples;
+  trimmed_pcm_frames.clear();
+
+  const int64_t frame_length =
+      std::max<int64_t>(1, int64_t{sample_rate_hz} * config.frame_ms / 1000);
+  const int64_t num_frames = (num_samples + frame_length - 1) / frame_length;
+  std::vector<float> energies_db(num_frames);
+  for (int64_t i = 0; i < num_frames; ++i) {
+    const int64_t start = i * frame_length;
+    energies_db[i] = FrameEnergyDb(pcm_frames.subspan(
+        start, std::min(frame_length, num_samples - start)));
+  }
+  float threshold_db = config.min_energy_db;
+  if (num_frames > 0) {
+    threshold_db = std::max(
+        threshold_db,
+        *std::max_element(energies_db.begin(), energies_db.end()) +
+            config.relative_energy_db);
+  }
+
+  // The voiced regions, widened by the padding and merged when they overlap.
+  const int64_t padding =
+      int64_t{sample_rate_hz} * config.padding_ms / 1000;
+  std::vector<SampleRange> regions;
+  for (int64_t i = 0; i < num_frames; ++i) {
+    if (energies_db[i] < threshold_db) {
+      continue;
+    }
+    const SampleRange range = {
+        std::max<int64_t>(0, i * frame_length - padding),
+        std::min(num_samples, (i + 1) * frame_length + padding)};
+    if (!regions.empty() && range.start <= regions.back().end) {
+      regions.back().end = range.end;
+    } else {
+      regions.push_back(range);
+    }
+  }
+  if (regions.empty()) {
+    trimmed_pcm_frames.assign(pcm_frames.begin(), pcm_frames.end());
+    return absl::OkStatus();
+  }
+
+  // The long pauses keep their beginning and end, so that the speech around
+  // them fades out and in as recorded.
+  const int64_t max_pause =
+      int64_t{sample_rate_hz} * config.max_pause_ms / 1000;
+  for (int i = 0; i + 1 < regions.size(); ++i) {
+    const int64_t pause = regions[i + 1].start - regions[i].end;
+    if (pause <= max_pause) {
+      regions[i].end = regions[i + 1].start;
+    } else {
+      regions[i].end += max_pause / 2;
+      regions[i + 1].start -= max_pause - max_pause / 2;
+    }
+  }
+
+  for (const SampleRange& region : regions) {
+    trimmed_pcm_frames.insert(trimmed_pcm_frames.end(),
+                              pcm_frames.begin() + region.start,
+                              pcm_frames.begin() + region.end);
+  }
+  stats.num_removed_samples += num_samples - trimmed_pcm_frames.size();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<SilenceTrimmer> SilenceTrimmer::Create(
+    int sample_rate_hz, const SilenceTrimmingConfig& config) {
+  RETURN_IF_ERROR(ValidateConfig(sample_rate_hz, config));
+  return SilenceTrimmer(sample_rate_hz, config);
+}
+
+SilenceTrimmer::SilenceTrimmer(int sample_rate_hz,
+                               const SilenceTrimmingConfig& config)
+    : frame_length_(std::max<int64_t>(
+          1, int64_t{sample_rate_hz} * config.frame_ms / 1000)),
+      padding_(int64_t{sample_rate_hz} * config.padding_ms / 1000),
+      min_energy_db_(config.min_energy_db),
+      relative_energy_db_(config.relative_energy_db),
+      max_energy_db_(-std::numeric_limits<float>::infinity()) {
+  // Same split of a long pause as TrimSilence.
+  const int64_t max_pause =
+      int64_t{sample_rate_hz} * config.max_pause_ms / 1000;
+  pause_head_length_ = max_pause / 2;
+  pause_tail_length_ = max_pause - max_pause / 2 + padding_;
+  partial_frame_.reserve(frame_length_);
+}
+
+void SilenceTrimmer::Trim(absl::Span<const float> pcm_frames,
+                          std::vector<float>& trimmed_pcm_frames) {
+  stats_.num_input_samples += pcm_frames.size();
+  while (!pcm_frames.empty()) {
+    const int64_t num_samples = std::min<int64_t>(
+        pcm_frames.size(), frame_length_ - partial_frame_.size());
+    partial_frame_.insert(partial_frame_.end(), pcm_frames.begin(),
+                          pcm_frames.begin() + num_samples);
+    pcm_frames.remove_prefix(num_samples);
+    if (static_cast<int64_t>(partial_frame_.size()) == frame_length_) {
+      TrimFrame(partial_frame_, trimmed_pcm_frames);
+      partial_frame_.clear();
+    }
+  }
+}
+
+void SilenceTrimmer::TrimFrame(absl::Span<const float> frame,
+                               std::vector<float>& trimmed_pcm_frames) {
+  const float energy_db = FrameEnergyDb(frame);
+  max_energy_db_ = std::max(max_energy_db_, energy_db);
+  if (energy_db >= std::max(min_energy_db_,
+                            max_energy_db_ + relative_energy_db_)) {
+    // Speech resumes: the held back silence was a pause, or the padding
+    // before the first voiced frame.
+    trimmed_pcm_frames.insert(trimmed_pcm_frames.end(), held_head_.begin(),
+                              held_head_.end());
+    trimmed_pcm_frames.insert(trimmed_pcm_frames.end(), held_tail_.begin(),
+                              held_tail_.end());
+    trimmed_pcm_frames.insert(trimmed_pcm_frames.end(), frame.begin(),
+                              frame.end());
+    held_head_.clear();
+    held_tail_.clear();
+    voiced_ = true;
+    silence_length_ = 0;
+    return;
+  }
+  // Before the first voiced frame, only its padding may be kept.
+  const int64_t max_tail_length = voiced_ ? pause_tail_length_ : padding_;
+  for (float sample : frame) {
+    if (voiced_ && silence_length_ < padding_) {
+      // The padding after a voiced frame is kept either way.
+      trimmed_pcm_frames.push_back(sample);
+    } else if (voiced_ && silence_length_ < padding_ + pause_head_length_) {
+      held_head_.push_back(sample);
+    } else {
+      held_tail_.push_back(sample);
+      if (static_cast<int64_t>(held_tail_.size()) > max_tail_length) {
+        held_tail_.pop_front();
+        ++stats_.num_removed_samples;
+      }
+    }
+    ++silence_length_;
+  }
+}
+
+void SilenceTrimmer::Reset() {
+  stats_.num_removed_samples +=
+      held_head_.size() + held_tail_.size() + partial_frame_.size();
+  held_head_.clear();
+  held_tail_.clear();
+  partial_frame_.clear();
+  max_energy_db_ = -std::numeric_limits<float>::infinity();
+  voiced_ = false;
+  silence_length_ = 0;
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,147 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_PREPROCESSOR_SILENCE_TRIMMER_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_PREPROCESSOR_SILENCE_TRIMMER_H_
+
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// Configuration of the energy based voice activity detection used to trim the
+// silence from the audio before it is turned into a spectrogram.
+//
+// The audio is split into frames of `frame_ms`. A frame is voiced if its
+// energy is above both `min_energy_db` and the energy of the loudest frame plus
+// `relative_energy_db`. The voiced regions are widened by `padding_ms` on each
+// side, so that the onsets and releases of the speech are kept. Everything
+// before the first and after the last voiced region is removed, and the pauses
+// between the voiced regions are shortened to `max_pause_ms`.
+struct SilenceTrimmingConfig {
+  // The length of the frames the energy is computed on.
+  int frame_ms = 20;
+  // The absolute energy threshold of a voiced frame, in dB relative to a full
+  // scale sine wave.
+  float min_energy_db = -50.0f;
+  // The energy threshold of a voiced frame relative to the loudest frame.
+  float relative_energy_db = -35.0f;
+  // The audio kept around each voiced region.
+  int padding_ms = 100;
+  // The longest pause kept between two voiced regions.
+  int max_pause_ms = 300;
+
+  friend std::ostream& operator<<(std::ostream& os,
+                                  const SilenceTrimmingConfig& config) {
+    os << "SilenceTrimmingConfig { frame_ms: " << config.frame_ms
+       << ", min_energy_db: " << config.min_energy_db
+       << ", relative_energy_db: " << config.relative_energy_db
+       << ", padding_ms: " << config.padding_ms
+       << ", max_pause_ms: " << config.max_pause_ms << " }";
+    return os;
+  }
+};
+
+// The amount of audio seen and removed by the silence trimming.
+struct SilenceTrimmingStats {
+  int64_t num_input_samples = 0;
+  int64_t num_removed_samples = 0;
+};
+
+// Removes the leading and trailing silence of `pcm_frames` and shortens its
+// long pauses, following `config`. The result is deterministic for a given
+// input. The audio is kept as is when no frame is voiced, so that a quiet
+// recording is not dropped altogether.
+// Args:
+//   - pcm_frames: The mono PCM frames, in [-1, 1].
+//   - sample_rate_hz: The sample rate of `pcm_frames`.
+//   - config: The configuration of the voice activity detection.
+//   - trimmed_pcm_frames: The PCM frames with the silence removed.
+//   - stats: Incremented by the number of input and removed samples.
+absl::Status TrimSilence(absl::Span<const float> pcm_frames, int sample_rate_hz,
+                         const SilenceTrimmingConfig& config,
+                         std::vector<float>& trimmed_pcm_frames,
+                         SilenceTrimmingStats& stats);
+
+// Trims the silence of an utterance that arrives in consecutive chunks, e.g.
+// the chunks of a recording fed to a streaming audio preprocessor. It follows
+// the rules of TrimSilence across the chunks, holding back the silence whose
+// fate depends on the audio that follows: a pause is only shortened, and the
+// trailing silence only dropped, once it is known which one it is. Unlike
+// TrimSilence, the voiced frames are detected relative to the loudest frame
+// seen so far, the last incomplete frame of the utterance is dropped, and an
+// utterance without any voiced frame is dropped altogether.
+class SilenceTrimmer {
+ public:
+  // Returns InvalidArgumentError if the sample rate or `config` is invalid.
+  static absl::StatusOr<SilenceTrimmer> Create(
+      int sample_rate_hz, const SilenceTrimmingConfig& config);
+
+  // Appends the audio of the utterance that is known to be kept, up to and
+  // including `pcm_frames`, to `trimmed_pcm_frames`.
+  void Trim(absl::Span<const float> pcm_frames,
+            std::vector<float>& trimmed_pcm_frames);
+
+  // Ends the utterance, dropping the silence held back at its end and its last
+  // incomplete frame.
+  void Reset();
+
+  // Returns the number of samples received and removed since the creation of
+  // the trimmer, over all utterances. The samples held back are only counted
+  // as removed once the utterance ends.
+  const SilenceTrimmingStats& GetStats() const { return stats_; }
+
+ private:
+  SilenceTrimmer(int sample_rate_hz, const SilenceTrimmingConfig& config);
+
+  // Classifies one frame of `frame_length_` samples and appends the audio
+  // that is known to be kept to `trimmed_pcm_frames`.
+  void TrimFrame(absl::Span<const float> frame,
+                 std::vector<float>& trimmed_pcm_frames);
+
+  int64_t frame_length_;
+  int64_t padding_;
+  // The beginning of a long pause that is kept.
+  int64_t pause_head_length_;
+  // The end of a long pause that is kept, including the padding of the
+  // following voiced region.
+  int64_t pause_tail_length_;
+  float min_energy_db_;
+  float relative_energy_db_;
+
+  // The samples of the current frame received so far.
+  std::vector<float> partial_frame_;
+  float max_energy_db_;
+  // Whether a voiced frame was seen in the utterance.
+  bool voiced_ = false;
+  // The number of unvoiced samples since the last voiced frame, or since the
+  // start of the utterance.
+  int64_t silence_length_ = 0;
+  // The beginning of the current pause, kept if speech resumes.
+  std::vector<float> held_head_;
+  // The end of the current pause, or the leading silence before the first
+  // voiced frame, kept if speech resumes.
+  std::deque<float> held_tail_;
+  SilenceTrimmingStats stats_;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_PREPROCESSOR_SILENCE_TRIMMER_H_
@@ -0,0 +1,229 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/components/preprocessor/silence_trimmer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+using ::testing::status::StatusIs;
+
+constexpr int kSampleRateHz = 16000;
+// The number of samples in one millisecond.
+constexpr int kSamplesPerMs = kSampleRateHz / 1000;
+
+void AppendSilence(int duration_ms, std::vector<float>& pcm_frames) {
+  pcm_frames.insert(pcm_frames.end(), duration_ms * kSamplesPerMs, 0.0f);
+}
+
+void AppendTone(int duration_ms, std::vector<float>& pcm_frames) {
+  for (int i = 0; i < duration_ms * kSamplesPerMs; ++i) {
+    pcm_frames.push_back(0.5f * std::sin(2 * M_PI * 440 * i / kSampleRateHz));
+  }
+}
+
+TEST(SilenceTrimmerTest, TrimsLeadingAndTrailingSilence) {
+  std::vector<float> pcm_frames;
+  AppendSilence(1000, pcm_frames);
+  AppendTone(500, pcm_frames);
+  AppendSilence(2000, pcm_frames);
+
+  SilenceTrimmingConfig config;
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, config, trimmed, stats));
+
+  // The tone and the padding on each side are kept.
+  EXPECT_EQ(trimmed.size(), (500 + 2 * config.padding_ms) * kSamplesPerMs);
+  EXPECT_EQ(stats.num_input_samples, pcm_frames.size());
+  EXPECT_EQ(stats.num_removed_samples, pcm_frames.size() - trimmed.size());
+  EXPECT_FLOAT_EQ(trimmed[config.padding_ms * kSamplesPerMs + 1],
+                  pcm_frames[1000 * kSamplesPerMs + 1]);
+}
+
+TEST(SilenceTrimmerTest, ShortensLongPauses) {
+  std::vector<float> pcm_frames;
+  AppendTone(200, pcm_frames);
+  AppendSilence(3000, pcm_frames);
+  AppendTone(200, pcm_frames);
+
+  SilenceTrimmingConfig config;
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, config, trimmed, stats));
+
+  // The pause between the padded tones is shortened to the maximum pause.
+  EXPECT_EQ(trimmed.size(), (200 + config.padding_ms + config.max_pause_ms +
+                             config.padding_ms + 200) *
+                                kSamplesPerMs);
+}
+
+TEST(SilenceTrimmerTest, KeepsShortPauses) {
+  std::vector<float> pcm_frames;
+  AppendTone(200, pcm_frames);
+  AppendSilence(100, pcm_frames);
+  AppendTone(200, pcm_frames);
+
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, SilenceTrimmingConfig(),
+                        trimmed, stats));
+
+  EXPECT_EQ(trimmed, pcm_frames);
+  EXPECT_EQ(stats.num_removed_samples, 0);
+}
+
+TEST(SilenceTrimmerTest, KeepsAudioWithoutVoice) {
+  std::vector<float> pcm_frames;
+  AppendSilence(500, pcm_frames);
+
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, SilenceTrimmingConfig(),
+                        trimmed, stats));
+
+  EXPECT_EQ(trimmed, pcm_frames);
+  EXPECT_EQ(stats.num_removed_samples, 0);
+}
+
+TEST(SilenceTrimmerTest, AccumulatesStats) {
+  std::vector<float> pcm_frames;
+  AppendSilence(1000, pcm_frames);
+  AppendTone(500, pcm_frames);
+
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, SilenceTrimmingConfig(),
+                        trimmed, stats));
+  const int64_t removed = stats.num_removed_samples;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, SilenceTrimmingConfig(),
+                        trimmed, stats));
+
+  EXPECT_EQ(stats.num_input_samples, 2 * pcm_frames.size());
+  EXPECT_EQ(stats.num_removed_samples, 2 * removed);
+}
+
+TEST(SilenceTrimmerTest, RejectsInvalidConfig) {
+  SilenceTrimmingConfig config;
+  config.frame_ms = 0;
+  std::vector<float> trimmed;
+  SilenceTrimmingStats stats;
+  EXPECT_THAT(TrimSilence({}, kSampleRateHz, config, trimmed, stats),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+// Feeds `pcm_frames` to `trimmer` in chunks of `chunk_ms` and ends the
+// utterance.
+std::vector<float> TrimInChunks(const std::vector<float>& pcm_frames,
+                                int chunk_ms, SilenceTrimmer& trimmer) {
+  std::vector<float> trimmed;
+  absl::Span<const float> remaining(pcm_frames);
+  while (!remaining.empty()) {
+    const int chunk_size =
+        std::min<int>(remaining.size(), chunk_ms * kSamplesPerMs);
+    trimmer.Trim(remaining.first(chunk_size), trimmed);
+    remaining.remove_prefix(chunk_size);
+  }
+  trimmer.Reset();
+  return trimmed;
+}
+
+TEST(SilenceTrimmerTest, MatchesTrimSilenceAcrossChunks) {
+  std::vector<float> pcm_frames;
+  AppendSilence(1000, pcm_frames);
+  AppendTone(200, pcm_frames);
+  AppendSilence(3000, pcm_frames);
+  AppendTone(200, pcm_frames);
+  AppendSilence(100, pcm_frames);
+  AppendTone(200, pcm_frames);
+  AppendSilence(2000, pcm_frames);
+
+  SilenceTrimmingConfig config;
+  std::vector<float> expected;
+  SilenceTrimmingStats expected_stats;
+  ASSERT_OK(TrimSilence(pcm_frames, kSampleRateHz, config, expected,
+                        expected_stats));
+
+  // Chunks that split frames, pauses and voiced regions alike.
+  for (int chunk_ms : {7, 30, 250, 10000}) {
+    ASSERT_OK_AND_ASSIGN(SilenceTrimmer trimmer,
+                         SilenceTrimmer::Create(kSampleRateHz, config));
+    EXPECT_EQ(TrimInChunks(pcm_frames, chunk_ms, trimmer), expected)
+        << "chunk_ms: " << chunk_ms;
+    EXPECT_EQ(trimmer.GetStats().num_input_samples,
+              expected_stats.num_input_samples);
+    EXPECT_EQ(trimmer.GetStats().num_removed_samples,
+              expected_stats.num_removed_samples);
+  }
+}
+
+TEST(SilenceTrimmerTest, HoldsBackSilenceUntilSpeechResumes) {
+  SilenceTrimmingConfig config;
+  ASSERT_OK_AND_ASSIGN(SilenceTrimmer trimmer,
+                       SilenceTrimmer::Create(kSampleRateHz, config));
+  std::vector<float> chunk;
+  AppendTone(200, chunk);
+  AppendSilence(200, chunk);
+  std::vector<float> trimmed;
+  trimmer.Trim(chunk, trimmed);
+  // Only the padding of the trailing silence is known to be kept.
+  EXPECT_EQ(trimmed.size(), (200 + config.padding_ms) * kSamplesPerMs);
+
+  // The silence was a short pause, which is kept as is.
+  chunk.clear();
+  AppendTone(200, chunk);
+  trimmer.Trim(chunk, trimmed);
+  EXPECT_EQ(trimmed.size(), 600 * kSamplesPerMs);
+  EXPECT_EQ(trimmer.GetStats().num_removed_samples, 0);
+}
+
+TEST(SilenceTrimmerTest, KeepsStatsAcrossUtterances) {
+  std::vector<float> pcm_frames;
+  AppendSilence(1000, pcm_frames);
+  AppendTone(500, pcm_frames);
+  AppendSilence(1000, pcm_frames);
+
+  ASSERT_OK_AND_ASSIGN(
+      SilenceTrimmer trimmer,
+      SilenceTrimmer::Create(kSampleRateHz, SilenceTrimmingConfig()));
+  const std::vector<float> first = TrimInChunks(pcm_frames, 100, trimmer);
+  // The second utterance starts with silence again.
+  EXPECT_EQ(TrimInChunks(pcm_frames, 100, trimmer), first);
+  EXPECT_EQ(trimmer.GetStats().num_input_samples, 2 * pcm_frames.size());
+  EXPECT_EQ(trimmer.GetStats().num_removed_samples,
+            2 * (pcm_frames.size() - first.size()));
+}
+
+TEST(SilenceTrimmerTest, CreateRejectsInvalidConfig) {
+  SilenceTrimmingConfig config;
+  config.padding_ms = -1;
+  EXPECT_THAT(SilenceTrimmer::Create(kSampleRateHz, config),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(SilenceTrimmer::Create(0, SilenceTrimmingConfig()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -15,6 +15,7 @@
 #include "runtime/components/preprocessor/stb_image_preprocessor.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
@@ -29,6 +30,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_ranked_tensor_type.h"  // from @litert
@@ -54,8 +56,124 @@ namespace {
 // channels.
 constexpr int kDesiredChannels = 3;
 
+// Returns the linear light value, in [0, 1], of each sRGB encoded byte.
+const std::array<float, 256>& SrgbToLinearTable() {
+  static const std::array<float, 256>* const kTable = [] {
+    auto* table = new std::array<float, 256>();
+    for (int i = 0; i < 256; ++i) {
+      const float value = i / 255.0f;
+      (*table)[i] = value <= 0.04045f
+                        ? value / 12.92f
+                        : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+    return table;
+  }();
+  return *kTable;
+}
+
+// Encodes a linear light value in [0, 1] as an sRGB byte.
+unsigned char LinearToSrgb(float value) {
+  value = std::clamp(value, 0.0f, 1.0f);
+  const float encoded = value <= 0.0031308f
+                            ? value * 12.92f
+                            : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+  return static_cast<unsigned char>(std::lround(encoded * 255.0f));
+}
+
+// Reduces the image by the largest power of two that keeps it at least as
+// large as the target size, by averaging blocks of pixels. The color channels
+// are averaged in linear light, like the final sRGB aware resize does, and an
+// alpha channel, the last one of a 2 or 4 channel image, as is. The blocks on
+// the right and bottom edges may be partial. The image is reduced one band of
+// rows at a time, so only the reduced image and one row of sums are allocated.
+// Returns an empty vector if the image is not reduced.
+std::vector<unsigned char> DownscaleByPowerOfTwo(
+    const unsigned char* image, int width, int height, int channels,
+    int target_width, int target_height, int& scaled_width,
+    int& scaled_height) {
+  if (target_width <= 0 || target_height <= 0) {
+    return {};
+  }
+  int factor = 1;
+  while (width / (factor * 2) >= target_width &&
+         height / (factor * 2) >= target_height) {
+    factor *= 2;
+  }
+  if (factor == 1) {
+    return {};
+  }
+  scaled_width = (width + factor - 1) / factor;
+  scaled_height = (height + factor - 1) / factor;
+  std::vector<unsigned char> scaled_image(static_cast<size_t>(scaled_width) *
+                                          scaled_height * channels);
+  const std::array<float, 256>& to_linear = SrgbToLinearTable();
+  const int alpha_channel = channels % 2 == 0 ? channels - 1 : -1;
+  std::vector<float> sums(static_cast<size_t>(scaled_width) * channels);
+  for (int y = 0; y < scaled_height; ++y) {
+    std::fill(sums.begin(), sums.end(), 0.0f);
+    const int row_begin = y * factor;
+    const int row_end = std::min(height, row_begin + factor);
+    for (int row = row_begin; row < row_end; ++row) {
+      const unsigned char* pixel =
+          image + static_cast<size_t>(row) * width * channels;
+      for (int x = 0; x < width; ++x) {
+        float* sum = sums.data() + (x / factor) * channels;
+        for (int c = 0; c < channels; ++c) {
+          sum[c] += c == alpha_channel ? pixel[c] / 255.0f
+                                       : to_linear[pixel[c]];
+        }
+        pixel += channels;
+      }
+    }
+    unsigned char* scaled_row =
+        scaled_image.data() + static_cast<size_t>(y) * scaled_width * channels;
+    for (int x = 0; x < scaled_width; ++x) {
+      const int block_width = std::min(width, (x + 1) * factor) - x * factor;
+      const float count = (row_end - row_begin) * block_width;
+      for (int c = 0; c < channels; ++c) {
+        const int i = x * channels + c;
+        const float mean = sums[i] / count;
+        scaled_row[i] =
+            c == alpha_channel
+                ? static_cast<unsigned char>(std::lround(mean * 255.0f))
+                : LinearToSrgb(mean);
+      }
+    }
+  }
+  return scaled_image;
+}
+
+// Resizes the image with the Mitchell filter. If `fast_downscale` is set, a
+// large image is first reduced by a power of two, so that the filter, whose
+// support grows with the downscale ratio, runs on far fewer pixels.
+absl::Status ResizeImage(const unsigned char* image, int width, int height,
+                         int channels, bool fast_downscale,
+                         unsigned char* resized_image, int resized_width,
+                         int resized_height) {
+  std::vector<unsigned char> scaled_image;
+  if (fast_downscale) {
+    int scaled_width = width;
+    int scaled_height = height;
+    scaled_image =
+        DownscaleByPowerOfTwo(image, width, height, channels, resized_width,
+                              resized_height, scaled_width, scaled_height);
+    if (!scaled_image.empty()) {
+      image = scaled_image.data();
+      width = scaled_width;
+      height = scaled_height;
+    }
+  }
+  if (stbir_resize(image, width, height, 0, resized_image, resized_width,
+                   resized_height, 0, static_cast<stbir_pixel_layout>(channels),
+                   STBIR_TYPE_UINT8_SRGB, STBIR_EDGE_CLAMP,
+                   STBIR_FILTER_MITCHELL) == 0) {
+    return absl::InternalError("Failed to resize image.");
+  }
+  return absl::OkStatus();
+}
+
 absl::Status MaybeResizeImageWithSameAspectRatio(
-    std::vector<unsigned char>& image_data,
+    absl::Span<const unsigned char> image_data,
     std::vector<unsigned char>& resized_image_data,
     ImagePreprocessParameter& parameter) {
   const Dimensions& target_dimensions = parameter.GetTargetDimensions();
@@ -69,7 +187,7 @@ absl::Status MaybeResizeImageWithSameAspectRatio(
   const int num_patches = num_patches_h * num_patches_w;
   if (num_patches <= max_num_patches && (height % patch_height == 0) &&
       (width % patch_width == 0)) {
-    resized_image_data = std::move(image_data);
+    resized_image_data.assign(image_data.begin(), image_data.end());
     return absl::OkStatus();
   }
 
@@ -114,29 +232,17 @@ absl::Status MaybeResizeImageWithSameAspectRatio(
   resized_image_data.resize(static_cast<size_t>(target_dimensions[0]) *
                             new_height * new_width * target_dimensions[3]);
 
-  int alpha_channel = -1;
-  if (target_dimensions[3] == 4) {
-    alpha_channel = 3;
-  } else if (target_dimensions[3] == 2) {
-    alpha_channel = 1;
-  }
-
   const int batch_size = target_dimensions[0];
   const int channels = target_dimensions[3];
 
   for (int i = 0; i < batch_size; ++i) {
-    unsigned char* input_data =
+    const unsigned char* input_data =
         image_data.data() + i * height * width * channels;
     unsigned char* output_data =
         resized_image_data.data() + i * new_height * new_width * channels;
-
-    if (stbir_resize(input_data, width, height, 0, output_data, new_width,
-                     new_height, 0,
-                     static_cast<stbir_pixel_layout>(channels),
-                     STBIR_TYPE_UINT8_SRGB, STBIR_EDGE_CLAMP,
-                     STBIR_FILTER_MITCHELL) == 0) {
-      return absl::InternalError("Failed to resize image.");
-    }
+    RETURN_IF_ERROR(ResizeImage(input_data, width, height, channels,
+                                parameter.IsFastDownscaleEnabled(),
+                                output_data, new_width, new_height));
   }
 
   return absl::OkStatus();
@@ -297,11 +403,12 @@ absl::StatusOr<InputImage> StbImagePreprocessor::Preprocess(
     ImagePreprocessParameter updated_parameter = parameter;
     updated_parameter.SetTargetDimensions(
         {1, original_height, original_width, kDesiredChannels});
-    std::vector<unsigned char> image_data(decoded_image,
-                                          decoded_image + num_elements);
     std::vector<unsigned char> resized_image_data;
     RETURN_IF_ERROR(MaybeResizeImageWithSameAspectRatio(
-        image_data, resized_image_data, updated_parameter));
+        absl::MakeConstSpan(decoded_image, num_elements), resized_image_data,
+        updated_parameter));
+    // The full resolution image is no longer needed.
+    decoded_image_ptr.reset();
     // Convert the image to float.
     std::vector<float> float_image(resized_image_data.size());
     for (size_t i = 0; i < resized_image_data.size(); ++i) {
@@ -316,20 +423,13 @@ absl::StatusOr<InputImage> StbImagePreprocessor::Preprocess(
     std::vector<uint8_t> resized_image(static_cast<size_t>(target_width) *
                                        target_height * target_channels);
 
-    int alpha_channel = -1;
-    if (target_channels == 4) {
-      alpha_channel = 3;
-    } else if (target_channels == 2) {
-      alpha_channel = 1;
-    }
-
-    if (stbir_resize(decoded_image, original_width, original_height, 0,
-                     resized_image.data(), target_width, target_height, 0,
-                     static_cast<stbir_pixel_layout>(target_channels),
-                     STBIR_TYPE_UINT8_SRGB, STBIR_EDGE_CLAMP,
-                     STBIR_FILTER_MITCHELL) == 0) {
-      return absl::InternalError("Failed to resize image.");
-    }
+    RETURN_IF_ERROR(ResizeImage(decoded_image, original_width,
+                                original_height, target_channels,
+                                parameter.IsFastDownscaleEnabled(),
+                                resized_image.data(), target_width,
+                                target_height));
+    // The full resolution image is no longer needed.
+    decoded_image_ptr.reset();
     const int num_elements =
         batch_size * target_height * target_width * target_channels;
     const size_t buffer_size = num_elements * sizeof(float);
@@ -0,0 +1,93 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for StbImagePreprocessor: image decode plus resize, and
+// decode plus patchify.
+//
+// bazel run -c opt //runtime/components/preprocessor:stb_image_preprocessor_benchmark
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "runtime/components/preprocessor/image_preprocessor.h"
+#include "runtime/components/preprocessor/stb_image_preprocessor.h"
+#include "runtime/engine/io_types.h"
+
+namespace litert::lm {
+namespace {
+
+// Relative to the runfiles directory `bazel run` starts the binary in.
+constexpr char kImagePath[] =
+    "runtime/components/preprocessor/testdata/apple.png";
+
+std::string ReadFile(const char* path) {
+  std::ifstream file_stream(path, std::ios::binary);
+  std::stringstream buffer;
+  buffer << file_stream.rdbuf();
+  return buffer.str();
+}
+
+// Args: target height and width, and whether the fast downscale is enabled.
+void BM_StbImagePreprocessor_Resize(benchmark::State& state) {
+  const std::string image_bytes = ReadFile(kImagePath);
+  if (image_bytes.empty()) {
+    state.SkipWithError("Failed to read apple.png.");
+    return;
+  }
+  const int size = state.range(0);
+  StbImagePreprocessor preprocessor;
+  ImagePreprocessParameter parameter;
+  parameter.SetTargetDimensions({1, size, size, 3});
+  parameter.SetFastDownscale(state.range(1) != 0);
+  for (auto _ : state) {
+    auto image = preprocessor.Preprocess(InputImage(image_bytes), parameter);
+    benchmark::DoNotOptimize(image);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StbImagePreprocessor_Resize)
+    ->ArgNames({"size", "fast"})
+    ->ArgsProduct({{224, 448, 896}, {0, 1}});
+
+// Args: maximum number of 16x16 patches.
+void BM_StbImagePreprocessor_Patchify(benchmark::State& state) {
+  const std::string image_bytes = ReadFile(kImagePath);
+  if (image_bytes.empty()) {
+    state.SkipWithError("Failed to read apple.png.");
+    return;
+  }
+  StbImagePreprocessor preprocessor;
+  ImagePreprocessParameter parameter;
+  parameter.SetPatchifyConfig({.patch_width = 16,
+                               .patch_height = 16,
+                               .max_num_patches = static_cast<int>(
+                                   state.range(0))});
+  for (auto _ : state) {
+    auto image = preprocessor.Preprocess(InputImage(image_bytes), parameter);
+    benchmark::DoNotOptimize(image);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StbImagePreprocessor_Patchify)
+    ->ArgNames({"max_patches"})
+    ->Arg(256)
+    ->Arg(1024)
+    ->Arg(4096);
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
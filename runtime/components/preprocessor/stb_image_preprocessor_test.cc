@@ -14,6 +14,7 @@
 
 #include "runtime/components/preprocessor/stb_image_preprocessor.h"
 
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <filesystem>  // NOLINT: Required for path manipulation.
@@ -157,6 +158,49 @@ TEST(StbImagePreprocessorTest, PreprocessSuccess) {
       << "B at (223,223)";
 }
 
+TEST(StbImagePreprocessorTest, PreprocessWithFastDownscaleIsCloseToExact) {
+  StbImagePreprocessor preprocessor;
+  const std::string image_path =
+      (std::filesystem::path(::testing::SrcDir()) / kTestdataDir / "apple.png")
+          .string();
+  std::ifstream file_stream(image_path, std::ios::binary);
+  ASSERT_TRUE(file_stream.is_open())
+      << "Failed to open image file: " << image_path;
+  std::stringstream buffer;
+  buffer << file_stream.rdbuf();
+  const InputImage input_image(buffer.str());
+
+  ImagePreprocessParameter parameter;
+  parameter.SetTargetDimensions({1, 224, 224, 3});
+  EXPECT_FALSE(parameter.IsFastDownscaleEnabled());
+  ASSERT_OK_AND_ASSIGN(auto exact_image,
+                       preprocessor.Preprocess(input_image, parameter));
+  // The 1024x1024 image is first reduced to 256x256.
+  parameter.SetFastDownscale(true);
+  ASSERT_OK_AND_ASSIGN(auto fast_image,
+                       preprocessor.Preprocess(input_image, parameter));
+
+  ASSERT_OK_AND_ASSIGN(auto fast_tensor,
+                       fast_image.GetPreprocessedImageTensor());
+  ASSERT_OK_AND_ASSIGN(auto exact_tensor,
+                       exact_image.GetPreprocessedImageTensor());
+  auto fast_lock = ::litert::TensorBufferScopedLock::Create(
+      *fast_tensor, TensorBuffer::LockMode::kRead);
+  ASSERT_TRUE(fast_lock.HasValue());
+  auto exact_lock = ::litert::TensorBufferScopedLock::Create(
+      *exact_tensor, TensorBuffer::LockMode::kRead);
+  ASSERT_TRUE(exact_lock.HasValue());
+  const float* fast_data = static_cast<const float*>(fast_lock->second);
+  const float* exact_data = static_cast<const float*>(exact_lock->second);
+
+  constexpr size_t kNumElements = 224 * 224 * 3;
+  double total_difference = 0;
+  for (size_t i = 0; i < kNumElements; ++i) {
+    total_difference += std::abs(fast_data[i] - exact_data[i]);
+  }
+  EXPECT_LT(total_difference / kNumElements, 0.01);
+}
+
 TEST(StbImagePreprocessorTest, PreprocessFailedWithInvalidDimensions) {
   StbImagePreprocessor preprocessor;
   std::string dummy_bytes = "dummy";
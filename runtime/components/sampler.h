@@ -16,7 +16,9 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_SAMPLER_H_
 
 #include <memory>
+#include <optional>
 #include <random>
+#include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -24,6 +26,20 @@
 
 namespace litert::lm {
 
+// The log-probabilities computed by a sampler for the last sampling step.
+struct SampledLogProbs {
+  // The number of most likely alternatives reported for each batch.
+  int num_top_logprobs = 0;
+  // The log-probabilities of the sampled ids. Shape: [batch_size].
+  std::vector<float> sampled_logprobs;
+  // The most likely token ids in descending order of probability.
+  // Shape: [batch_size, num_top_logprobs].
+  std::vector<int> top_token_ids;
+  // The log-probabilities of `top_token_ids`.
+  // Shape: [batch_size, num_top_logprobs].
+  std::vector<float> top_logprobs;
+};
+
 // A sampler that samples token ids from logits.
 // Optionally, it may be able to handle input tensors. If so, the sampler can
 // fill input tensors by itself, e.g. input tokens from output tokens, input
@@ -90,6 +106,24 @@ class Sampler {
       int (*run_inference_func)(void* arg), void* arg) {
     return absl::UnimplementedError("SetInputTensors is not implemented.");
   }
+
+  // Sets the number of most likely alternatives for which the
+  // log-probabilities are reported in each `SampleToIdAndScoreBuffer()` call.
+  // When set, the sampler also computes the log-probability of the sampled
+  // ids, and the result of the last call is available from
+  // `GetLastLogProbs()`. 0 only reports the sampled ids, without ranking the
+  // vocabulary. std::nullopt disables the computation, which is the default.
+  //
+  // It returns `UnimplementedError` for a set value if the sampler does not
+  // support log-probabilities.
+  virtual absl::Status SetNumTopLogProbs(std::optional<int> num_top_logprobs) {
+    if (!num_top_logprobs.has_value()) return absl::OkStatus();
+    return absl::UnimplementedError("SetNumTopLogProbs is not implemented.");
+  }
+
+  // Returns the log-probabilities computed by the last
+  // `SampleToIdAndScoreBuffer()` call, or nullptr if they were not computed.
+  virtual const SampledLogProbs* GetLastLogProbs() const { return nullptr; }
 };
 
 }  // namespace litert::lm
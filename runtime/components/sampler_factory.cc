@@ -468,6 +468,10 @@ absl::StatusOr<std::unique_ptr<Sampler>> CreateCpuSampler(
       return TopPSampler::Create(sampler_params.k(), sampler_params.p(),
                                  sampler_params.temperature(), batch_size,
                                  sampler_params.seed());
+    case proto::SamplerParameters::MIN_P:
+    case proto::SamplerParameters::TYPICAL:
+    case proto::SamplerParameters::MIROSTAT:
+      return TopPSampler::Create(sampler_params, batch_size);
     default:
       return absl::UnimplementedError(absl::StrCat(
           "Sampler type: ", sampler_params.type(), " not implemented yet."));
@@ -536,6 +540,16 @@ absl::StatusOr<std::unique_ptr<Sampler>> CreateSampler(
     std::optional<ActivationDataType> activation_data_type) {
   switch (backend) {
     case Backend::GPU: {
+      // The GPU samplers only implement top-k / top-p sampling, so the other
+      // strategies always sample on CPU rather than silently running top-p.
+      if (sampler_params.type() == proto::SamplerParameters::MIN_P ||
+          sampler_params.type() == proto::SamplerParameters::TYPICAL ||
+          sampler_params.type() == proto::SamplerParameters::MIROSTAT) {
+        ABSL_LOG(INFO) << "Sampler type " << sampler_params.type()
+                       << " is not supported by the GPU samplers. Sampling "
+                          "on CPU.";
+        return CreateCpuSampler(batch_size, sampler_params);
+      }
       RET_CHECK(env != nullptr)
           << "LiteRT environment is needed for GPU sampling.";
       RET_CHECK(vocab_size.has_value())
@@ -32,6 +32,8 @@ namespace litert::lm {
 //   batch_size: The batch size for the input logits.
 //   sampler_params: The parameters for the sampler.
 //   The following parameters are optional and only used for GPU backend.
+//   MIN_P, TYPICAL and MIROSTAT sampling always run on CPU, as the GPU
+//   samplers only implement top-k / top-p sampling.
 //   env: The litert environment to use for the sampler.
 //   vocab_size: The vocabulary size for the sampler.
 //   activation_data_type: The activation data type for the sampler.
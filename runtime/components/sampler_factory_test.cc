@@ -75,5 +75,27 @@ TEST(SamplerFactoryTest,
   EXPECT_EQ(sampler, nullptr);
 }
 
+TEST(SamplerFactoryTest, CreateSamplerForGpuWithCpuOnlyTypeUsesCpu) {
+  for (auto type : {proto::SamplerParameters::MIN_P,
+                    proto::SamplerParameters::TYPICAL,
+                    proto::SamplerParameters::MIROSTAT}) {
+    proto::SamplerParameters sampler_params;
+    sampler_params.set_k(40);
+    sampler_params.set_p(1.0);
+    sampler_params.set_min_p(0.1);
+    sampler_params.set_typical_p(0.9);
+    sampler_params.set_mirostat_tau(5.0);
+    sampler_params.set_mirostat_eta(0.1);
+    sampler_params.set_temperature(1.0);
+    sampler_params.set_seed(12345);
+    sampler_params.set_type(type);
+    // No LiteRT environment is needed, as the GPU samplers are never tried.
+    ASSERT_OK_AND_ASSIGN(auto sampler,
+                         CreateSampler(Backend::GPU, /*batch_size=*/1,
+                                       std::move(sampler_params)));
+    EXPECT_NE(dynamic_cast<TopPSampler*>(sampler.get()), nullptr);
+  }
+}
+
 }  // namespace
 }  // namespace litert::lm
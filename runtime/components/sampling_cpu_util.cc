@@ -259,4 +259,308 @@ absl::StatusOr<std::vector<int>> TopKTopPSampling(
   return sampled_ids;
 }
 
+namespace {
+
+// Validates the arguments shared by the top-k based sampling functions.
+absl::Status ValidateTopKSamplingArgs(
+    absl::Span<const float> logits, int k,
+    const std::shared_ptr<std::default_random_engine>& rng, int batch_size) {
+  if (logits.empty()) {
+    return absl::InvalidArgumentError("Logits vector cannot be empty.");
+  }
+  if (batch_size <= 0 || logits.size() % batch_size != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Logits vector size must be a multiple of batch "
+                        "size. But got %d and %d.",
+                        logits.size(), batch_size));
+  }
+  if (k <= 0) {
+    return absl::InvalidArgumentError("k must be greater than 0.");
+  }
+  if (rng == nullptr) {
+    return absl::InvalidArgumentError("rng cannot be nullptr.");
+  }
+  return absl::OkStatus();
+}
+
+// Samples one of the first `num_candidates` offsets of `candidates`, which are
+// offsets within the top k of batch `b`, with a probability proportional to
+// their probabilities. Returns the sampled offset.
+int SampleCandidate(absl::Span<const float> probabilities, int b, int k,
+                    absl::Span<const int> candidates, int num_candidates,
+                    std::default_random_engine& rng) {
+  double mass = 0.0;
+  for (int i = 0; i < num_candidates; ++i) {
+    mass += probabilities[b * k + candidates[i]];
+  }
+  if (mass <= std::numeric_limits<double>::epsilon()) {
+    return candidates[0];
+  }
+  std::uniform_real_distribution<double> dist(0.0, mass);
+  const double random_sample = dist(rng);
+  double cumulative = 0.0;
+  for (int i = 0; i < num_candidates; ++i) {
+    cumulative += probabilities[b * k + candidates[i]];
+    if (random_sample <= cumulative) {
+      return candidates[i];
+    }
+  }
+  // Only reached on rounding errors of the cumulative sum.
+  return candidates[num_candidates - 1];
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<int>> TopKMinPSampling(
+    absl::Span<const float> logits, int k, float min_p, float temperature,
+    std::shared_ptr<std::default_random_engine> rng, int batch_size,
+    std::vector<float>& sampled_scores) {
+  absl::Status status = ValidateTopKSamplingArgs(logits, k, rng, batch_size);
+  if (!status.ok()) return status;
+  if (min_p < 0.0 || min_p > 1.0) {
+    return absl::InvalidArgumentError(
+        "min_p must be in the range [0.0, 1.0].");
+  }
+  const int vocab_size = logits.size() / batch_size;
+  k = std::min(k, vocab_size);
+
+  auto topk_token_ids = TopKTokenIds(logits, k, batch_size);
+  if (!topk_token_ids.ok()) return topk_token_ids.status();
+
+  std::vector<float> max_logit_values;
+  auto probabilities = Softmax(logits, *topk_token_ids, temperature, batch_size,
+                               max_logit_values);
+  if (!probabilities.ok()) return probabilities.status();
+
+  std::vector<int> sampled_ids(batch_size);
+  sampled_scores.resize(batch_size);
+  // The threshold only depends on the most likely token, so the top k does
+  // not need to be sorted.
+  // O(k) time complexity.
+  std::vector<int> candidates(k);
+  for (int b = 0; b < batch_size; ++b) {
+    const float* batch_probabilities = probabilities->data() + b * k;
+    const float threshold =
+        min_p * *std::max_element(batch_probabilities, batch_probabilities + k);
+    int num_candidates = 0;
+    for (int i = 0; i < k; ++i) {
+      if (batch_probabilities[i] >= threshold) {
+        candidates[num_candidates++] = i;
+      }
+    }
+    const int sampled =
+        SampleCandidate(*probabilities, b, k, candidates, num_candidates, *rng);
+    sampled_ids[b] = (*topk_token_ids)[b * k + sampled];
+    sampled_scores[b] = batch_probabilities[sampled];
+  }
+  return sampled_ids;
+}
+
+absl::StatusOr<std::vector<int>> TopKTypicalSampling(
+    absl::Span<const float> logits, int k, float typical_p, float temperature,
+    std::shared_ptr<std::default_random_engine> rng, int batch_size,
+    std::vector<float>& sampled_scores) {
+  absl::Status status = ValidateTopKSamplingArgs(logits, k, rng, batch_size);
+  if (!status.ok()) return status;
+  if (typical_p < 0.0 || typical_p > 1.0) {
+    return absl::InvalidArgumentError(
+        "typical_p must be in the range [0.0, 1.0].");
+  }
+  const int vocab_size = logits.size() / batch_size;
+  k = std::min(k, vocab_size);
+
+  auto topk_token_ids = TopKTokenIds(logits, k, batch_size);
+  if (!topk_token_ids.ok()) return topk_token_ids.status();
+
+  std::vector<float> max_logit_values;
+  auto probabilities = Softmax(logits, *topk_token_ids, temperature, batch_size,
+                               max_logit_values);
+  if (!probabilities.ok()) return probabilities.status();
+
+  std::vector<int> sampled_ids(batch_size);
+  sampled_scores.resize(batch_size);
+  std::vector<int> index_of_topk(k);
+  std::vector<float> deviations(k);
+  for (int b = 0; b < batch_size; ++b) {
+    const float* batch_probabilities = probabilities->data() + b * k;
+    // O(k) time complexity.
+    double entropy = 0.0;
+    for (int i = 0; i < k; ++i) {
+      if (batch_probabilities[i] > 0.0f) {
+        entropy -= batch_probabilities[i] * std::log(batch_probabilities[i]);
+      }
+    }
+    for (int i = 0; i < k; ++i) {
+      deviations[i] = batch_probabilities[i] > 0.0f
+                          ? std::abs(-std::log(batch_probabilities[i]) -
+                                     static_cast<float>(entropy))
+                          : std::numeric_limits<float>::infinity();
+    }
+
+    // Sorts the top k by ascending deviation from the entropy, i.e. the most
+    // typical tokens first.
+    // O(k log k) time complexity, the same as the top-p sort.
+    std::iota(index_of_topk.begin(), index_of_topk.end(), 0);
+    std::sort(index_of_topk.begin(), index_of_topk.end(),
+              [&deviations](int i1, int i2) {
+                return deviations[i1] < deviations[i2];
+              });
+
+    double cumulative_prob = 0.0;
+    int num_candidates = 0;
+    for (int i = 0; i < k; ++i) {
+      cumulative_prob += batch_probabilities[index_of_topk[i]];
+      num_candidates = i + 1;
+      if (cumulative_prob >= typical_p) {
+        break;
+      }
+    }
+    const int sampled = SampleCandidate(*probabilities, b, k, index_of_topk,
+                                        num_candidates, *rng);
+    sampled_ids[b] = (*topk_token_ids)[b * k + sampled];
+    sampled_scores[b] = batch_probabilities[sampled];
+  }
+  return sampled_ids;
+}
+
+absl::StatusOr<std::vector<int>> TopKMirostatSampling(
+    absl::Span<const float> logits, int k, float tau, float eta,
+    float temperature, std::shared_ptr<std::default_random_engine> rng,
+    int batch_size, std::vector<float>& mu,
+    std::vector<float>& sampled_scores) {
+  absl::Status status = ValidateTopKSamplingArgs(logits, k, rng, batch_size);
+  if (!status.ok()) return status;
+  if (tau < 0.0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("tau must be >= 0, but got ", tau));
+  }
+  if (eta < 0.0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("eta must be >= 0, but got ", eta));
+  }
+  const int vocab_size = logits.size() / batch_size;
+  k = std::min(k, vocab_size);
+  if (mu.size() != batch_size) {
+    mu.assign(batch_size, 2.0f * tau);
+  }
+
+  auto topk_token_ids = TopKTokenIds(logits, k, batch_size);
+  if (!topk_token_ids.ok()) return topk_token_ids.status();
+
+  std::vector<float> max_logit_values;
+  auto probabilities = Softmax(logits, *topk_token_ids, temperature, batch_size,
+                               max_logit_values);
+  if (!probabilities.ok()) return probabilities.status();
+
+  std::vector<int> sampled_ids(batch_size);
+  sampled_scores.resize(batch_size);
+  // The truncation is a probability threshold, so the top k does not need to
+  // be sorted.
+  // O(k) time complexity.
+  std::vector<int> candidates(k);
+  for (int b = 0; b < batch_size; ++b) {
+    const float* batch_probabilities = probabilities->data() + b * k;
+    // A surprise of at most mu is a probability of at least 2^-mu.
+    const float min_probability = std::exp2(-mu[b]);
+    int num_candidates = 0;
+    double kept_mass = 0.0;
+    for (int i = 0; i < k; ++i) {
+      if (batch_probabilities[i] >= min_probability) {
+        candidates[num_candidates++] = i;
+        kept_mass += batch_probabilities[i];
+      }
+    }
+    if (num_candidates == 0) {
+      // Keep at least the most likely token.
+      candidates[0] = std::distance(
+          batch_probabilities,
+          std::max_element(batch_probabilities, batch_probabilities + k));
+      num_candidates = 1;
+      kept_mass = batch_probabilities[candidates[0]];
+    }
+    const int sampled =
+        SampleCandidate(*probabilities, b, k, candidates, num_candidates, *rng);
+    sampled_ids[b] = (*topk_token_ids)[b * k + sampled];
+    sampled_scores[b] = batch_probabilities[sampled];
+
+    // The observed surprise is measured on the truncated distribution.
+    if (kept_mass > 0.0 && batch_probabilities[sampled] > 0.0f) {
+      const double surprise =
+          -std::log2(batch_probabilities[sampled] / kept_mass);
+      mu[b] -= eta * (surprise - tau);
+    }
+  }
+  return sampled_ids;
+}
+
+absl::Status ComputeLogProbs(absl::Span<const float> logits,
+                             absl::Span<const int> sampled_ids,
+                             int num_top_logprobs, int batch_size,
+                             std::vector<float>& sampled_logprobs,
+                             std::vector<int>& top_token_ids,
+                             std::vector<float>& top_logprobs) {
+  if (logits.empty()) {
+    return absl::InvalidArgumentError("Logits vector cannot be empty.");
+  }
+  if (batch_size <= 0 || logits.size() % batch_size != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Logits vector size must be a multiple of batch "
+                        "size. But got %d and %d.",
+                        logits.size(), batch_size));
+  }
+  if (sampled_ids.size() != batch_size) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Sampled ids size must be equal to batch size. But got %d and %d.",
+        sampled_ids.size(), batch_size));
+  }
+  if (num_top_logprobs < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "num_top_logprobs must be >= 0, but got ", num_top_logprobs));
+  }
+  const int vocab_size = logits.size() / batch_size;
+  const int n = std::min(num_top_logprobs, vocab_size);
+
+  // The top n ids are selected in O(vocab_size) with the same partitioning as
+  // TopKTopPSampling; only those n ids are sorted afterwards.
+  if (n > 0) {
+    auto top_ids = TopKTokenIds(logits, n, batch_size);
+    if (!top_ids.ok()) return top_ids.status();
+    top_token_ids = *std::move(top_ids);
+  } else {
+    top_token_ids.clear();
+  }
+  sampled_logprobs.resize(batch_size);
+  top_logprobs.resize(batch_size * n);
+
+  for (int b = 0; b < batch_size; ++b) {
+    const float* batch_logits = logits.data() + b * vocab_size;
+    if (sampled_ids[b] < 0 || sampled_ids[b] >= vocab_size) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Sampled id %d is out of range [0, %d).",
+                          sampled_ids[b], vocab_size));
+    }
+    // log_softmax(x_i) = x_i - max - log(sum_j exp(x_j - max)).
+    const float max_logit =
+        *std::max_element(batch_logits, batch_logits + vocab_size);
+    double sum_of_exps = 0.0;
+    for (int i = 0; i < vocab_size; ++i) {
+      sum_of_exps += std::exp(batch_logits[i] - max_logit);
+    }
+    const float log_normalizer =
+        max_logit + static_cast<float>(std::log(sum_of_exps));
+    sampled_logprobs[b] = batch_logits[sampled_ids[b]] - log_normalizer;
+
+    if (n == 0) continue;
+    auto batch_top_ids = top_token_ids.begin() + b * n;
+    std::sort(batch_top_ids, batch_top_ids + n,
+              [batch_logits](int i1, int i2) {
+                return batch_logits[i1] > batch_logits[i2];
+              });
+    for (int i = 0; i < n; ++i) {
+      top_logprobs[b * n + i] = batch_logits[batch_top_ids[i]] - log_normalizer;
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace litert::lm
@@ -19,6 +19,7 @@
 #include <random>
 #include <vector>
 
+#include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 
@@ -66,6 +67,66 @@ absl::StatusOr<std::vector<int>> TopKTopPSampling(
     std::shared_ptr<std::default_random_engine> rng, int batch_size,
     std::vector<float>& sampled_scores);
 
+// Samples a batch of token ids among the top k tokens whose probability is at
+// least `min_p` times the probability of the most likely token.
+//   - min_p: the relative probability threshold, in the range [0.0, 1.0].
+// The other arguments and the sampled_scores are the same as in
+// TopKTopPSampling.
+absl::StatusOr<std::vector<int>> TopKMinPSampling(
+    absl::Span<const float> logits, int k, float min_p, float temperature,
+    std::shared_ptr<std::default_random_engine> rng, int batch_size,
+    std::vector<float>& sampled_scores);
+
+// Samples a batch of token ids with locally typical sampling: the top k tokens
+// are ordered by how close their surprise (-log(prob)) is to the entropy of
+// the top k distribution, and the sampling is done among the smallest set of
+// the most typical tokens whose sum is greater than or equal to `typical_p`.
+//   - typical_p: the probability mass to keep, in the range [0.0, 1.0].
+// The other arguments and the sampled_scores are the same as in
+// TopKTopPSampling.
+absl::StatusOr<std::vector<int>> TopKTypicalSampling(
+    absl::Span<const float> logits, int k, float typical_p, float temperature,
+    std::shared_ptr<std::default_random_engine> rng, int batch_size,
+    std::vector<float>& sampled_scores);
+
+// Samples a batch of token ids with Mirostat (v2) sampling: the sampling is
+// done among the top k tokens whose surprise (-log2(prob)) is at most `mu`,
+// then `mu` is moved by `eta` times the difference between the surprise of the
+// sampled token and the target surprise `tau`.
+//   - tau: the target surprise in bits, must be >= 0.
+//   - eta: the learning rate of `mu`, must be >= 0.
+//   - mu: an input and output parameter of shape [batch_size] holding the
+//     running maximum surprise of each batch. It is initialized to 2 * tau if
+//     its size does not match the batch size, e.g. when it is empty.
+// The other arguments and the sampled_scores are the same as in
+// TopKTopPSampling.
+absl::StatusOr<std::vector<int>> TopKMirostatSampling(
+    absl::Span<const float> logits, int k, float tau, float eta,
+    float temperature, std::shared_ptr<std::default_random_engine> rng,
+    int batch_size, std::vector<float>& mu, std::vector<float>& sampled_scores);
+
+// Computes the log-probabilities of the sampled token ids and of the
+// `num_top_logprobs` most likely token ids under the full-vocab softmax of the
+// given logits (i.e. without temperature, top-k or top-p applied).
+//   - logits: a 2D tensor (in a flattened buffer) of shape
+//     [batch_size, vocab_size].
+//   - sampled_ids: the sampled token ids of shape [batch_size].
+//   - num_top_logprobs: the number of most likely alternatives to report. Must
+//     be >= 0 and is capped at vocab_size.
+//   - batch_size: the batch size of the logits.
+//   - sampled_logprobs: output parameter of shape [batch_size] holding the
+//     log-probabilities of the sampled ids.
+//   - top_token_ids: output parameter of shape [batch_size, num_top_logprobs]
+//     holding the most likely token ids of each batch in descending order.
+//   - top_logprobs: output parameter of the same shape as `top_token_ids`
+//     holding the log-probabilities of the `top_token_ids`.
+absl::Status ComputeLogProbs(absl::Span<const float> logits,
+                             absl::Span<const int> sampled_ids,
+                             int num_top_logprobs, int batch_size,
+                             std::vector<float>& sampled_logprobs,
+                             std::vector<int>& top_token_ids,
+                             std::vector<float>& top_logprobs);
+
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_SAMPLING_CPU_UTIL_H_
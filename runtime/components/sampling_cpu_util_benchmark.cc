@@ -0,0 +1,128 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the CPU sampling kernels.
+//
+// bazel run -c opt //runtime/components:sampling_cpu_util_benchmark
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/sampling_cpu_util.h"
+
+namespace litert::lm {
+namespace {
+
+// Returns `batch_size * vocab_size` logits drawn from a normal distribution,
+// which is close enough to real model outputs for partitioning and softmax.
+std::vector<float> RandomLogits(int batch_size, int vocab_size) {
+  std::default_random_engine rng(/*seed=*/0);
+  std::normal_distribution<float> dist(0.0f, 4.0f);
+  std::vector<float> logits(batch_size * vocab_size);
+  for (float& logit : logits) {
+    logit = dist(rng);
+  }
+  return logits;
+}
+
+// Args: vocab_size, k, batch_size.
+void BM_TopKTokenIds(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int k = state.range(1);
+  const int batch_size = state.range(2);
+  const std::vector<float> logits = RandomLogits(batch_size, vocab_size);
+  for (auto _ : state) {
+    auto ids = TopKTokenIds(absl::MakeConstSpan(logits), k, batch_size);
+    benchmark::DoNotOptimize(ids);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * vocab_size);
+}
+BENCHMARK(BM_TopKTokenIds)
+    ->ArgNames({"vocab", "k", "batch"})
+    ->ArgsProduct({{32000, 128000, 262144}, {1, 40, 64}, {1, 4}});
+
+// Args: vocab_size, k, batch_size.
+void BM_Softmax(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int k = state.range(1);
+  const int batch_size = state.range(2);
+  const std::vector<float> logits = RandomLogits(batch_size, vocab_size);
+  auto ids = TopKTokenIds(absl::MakeConstSpan(logits), k, batch_size);
+  if (!ids.ok()) {
+    state.SkipWithError("TopKTokenIds failed.");
+    return;
+  }
+  std::vector<float> max_logit_values;
+  for (auto _ : state) {
+    auto probabilities =
+        Softmax(absl::MakeConstSpan(logits), *ids, /*temperature=*/0.8f,
+                batch_size, max_logit_values);
+    benchmark::DoNotOptimize(probabilities);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * k);
+}
+BENCHMARK(BM_Softmax)
+    ->ArgNames({"vocab", "k", "batch"})
+    ->ArgsProduct({{32000, 262144}, {40, 64, 1024}, {1, 4}});
+
+// Args: vocab_size, k, batch_size.
+void BM_TopKTopPSampling(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int k = state.range(1);
+  const int batch_size = state.range(2);
+  const std::vector<float> logits = RandomLogits(batch_size, vocab_size);
+  auto rng = std::make_shared<std::default_random_engine>(/*seed=*/0);
+  std::vector<float> sampled_scores;
+  for (auto _ : state) {
+    auto ids = TopKTopPSampling(absl::MakeConstSpan(logits), k, /*p=*/0.95f,
+                                /*temperature=*/0.8f, rng, batch_size,
+                                sampled_scores);
+    benchmark::DoNotOptimize(ids);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * vocab_size);
+}
+BENCHMARK(BM_TopKTopPSampling)
+    ->ArgNames({"vocab", "k", "batch"})
+    ->ArgsProduct({{32000, 128000, 262144}, {1, 40, 64}, {1, 4}});
+
+// Args: vocab_size, num_top_logprobs, batch_size.
+void BM_ComputeLogProbs(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int num_top_logprobs = state.range(1);
+  const int batch_size = state.range(2);
+  const std::vector<float> logits = RandomLogits(batch_size, vocab_size);
+  const std::vector<int> sampled_ids(batch_size, 0);
+  std::vector<float> sampled_logprobs;
+  std::vector<int> top_token_ids;
+  std::vector<float> top_logprobs;
+  for (auto _ : state) {
+    auto status = ComputeLogProbs(
+        absl::MakeConstSpan(logits), absl::MakeConstSpan(sampled_ids),
+        num_top_logprobs, batch_size, sampled_logprobs, top_token_ids,
+        top_logprobs);
+    benchmark::DoNotOptimize(status);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size * vocab_size);
+}
+BENCHMARK(BM_ComputeLogProbs)
+    ->ArgNames({"vocab", "top_n", "batch"})
+    ->ArgsProduct({{32000, 262144}, {0, 5, 20}, {1, 4}});
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
@@ -14,6 +14,7 @@
 
 #include "runtime/components/sampling_cpu_util.h"
 
+#include <cmath>
 #include <memory>
 #include <random>
 #include <vector>
@@ -25,7 +26,11 @@
 namespace litert::lm {
 namespace {
 
+using ::testing::AnyOf;
 using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+using ::testing::SizeIs;
 using ::testing::UnorderedElementsAre;
 
 TEST(SamplingCpuUtilTest, TopKTokenIds_BatchSize1) {
@@ -204,5 +209,193 @@ TEST(SamplingCpuUtilTest, TopKTopPSampling_LargeVocabIndices) {
   EXPECT_THAT(sampled_scores, ElementsAre(0.99827528f));
 }
 
+TEST(SamplingCpuUtilTest, TopKMinPSampling_InvalidInputs) {
+  const std::vector<float> logits = {0.0, 0.0, 0.3};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> sampled_scores;
+  auto sampled_ids = TopKMinPSampling(
+      absl::MakeConstSpan(logits), /*k=*/3, /*min_p=*/1.5,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, sampled_scores);
+  EXPECT_FALSE(sampled_ids.ok());
+  sampled_ids = TopKMinPSampling(absl::MakeConstSpan(logits), /*k=*/3,
+                                 /*min_p=*/0.5, /*temperature=*/1.0f,
+                                 /*rng=*/nullptr, /*batch_size=*/1,
+                                 sampled_scores);
+  EXPECT_FALSE(sampled_ids.ok());
+}
+
+TEST(SamplingCpuUtilTest, TopKMinPSampling_KeepsOnlyLikelyTokens) {
+  // Tokens 0 and 3 are more than 50x less likely than the most likely token.
+  const std::vector<float> logits = {0.0, 5.0, 5.1, 1.0};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> sampled_scores;
+  for (int i = 0; i < 50; ++i) {
+    auto sampled_ids = TopKMinPSampling(
+        absl::MakeConstSpan(logits), /*k=*/4, /*min_p=*/0.5,
+        /*temperature=*/1.0f, rng, /*batch_size=*/1, sampled_scores);
+    ASSERT_TRUE(sampled_ids.ok());
+    EXPECT_THAT(*sampled_ids, ElementsAre(AnyOf(1, 2)));
+  }
+}
+
+TEST(SamplingCpuUtilTest, TopKMinPSampling_BatchSize2_Greedy) {
+  // With min_p = 1, only the most likely token of each batch is kept.
+  const std::vector<float> logits = {0.0, 0.0, 10.0, 0.0,
+                                     11.0, 12.0, 1.0, 2.0};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> sampled_scores;
+  auto sampled_ids = TopKMinPSampling(
+      absl::MakeConstSpan(logits), /*k=*/4, /*min_p=*/1.0,
+      /*temperature=*/1.0f, rng, /*batch_size=*/2, sampled_scores);
+  ASSERT_TRUE(sampled_ids.ok());
+  EXPECT_THAT(*sampled_ids, ElementsAre(2, 1));
+  EXPECT_THAT(sampled_scores, SizeIs(2));
+}
+
+TEST(SamplingCpuUtilTest, TopKTypicalSampling_InvalidInputs) {
+  const std::vector<float> logits = {0.0, 0.0, 0.3};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> sampled_scores;
+  auto sampled_ids = TopKTypicalSampling(
+      absl::MakeConstSpan(logits), /*k=*/3, /*typical_p=*/-0.1,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, sampled_scores);
+  EXPECT_FALSE(sampled_ids.ok());
+}
+
+TEST(SamplingCpuUtilTest, TopKTypicalSampling_SkipsAtypicalTokens) {
+  // Token 0 has probability 0.4 and the 10 others 0.06 each. The entropy is
+  // ~2.06 nats, so the surprise of the other tokens (~2.81) is closer to it
+  // than the one of token 0 (~0.92), and they alone cover typical_p = 0.5.
+  std::vector<float> logits(11, std::log(0.06f));
+  logits[0] = std::log(0.4f);
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> sampled_scores;
+  for (int i = 0; i < 50; ++i) {
+    auto sampled_ids = TopKTypicalSampling(
+        absl::MakeConstSpan(logits), /*k=*/11, /*typical_p=*/0.5,
+        /*temperature=*/1.0f, rng, /*batch_size=*/1, sampled_scores);
+    ASSERT_TRUE(sampled_ids.ok());
+    EXPECT_NE((*sampled_ids)[0], 0);
+    EXPECT_THAT(sampled_scores, ElementsAre(FloatNear(0.06f, 1e-5f)));
+  }
+}
+
+TEST(SamplingCpuUtilTest, TopKMirostatSampling_InvalidInputs) {
+  const std::vector<float> logits = {0.0, 0.0, 0.3};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> mu;
+  std::vector<float> sampled_scores;
+  auto sampled_ids = TopKMirostatSampling(
+      absl::MakeConstSpan(logits), /*k=*/3, /*tau=*/-1.0, /*eta=*/0.1,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, mu, sampled_scores);
+  EXPECT_FALSE(sampled_ids.ok());
+  sampled_ids = TopKMirostatSampling(
+      absl::MakeConstSpan(logits), /*k=*/3, /*tau=*/1.0, /*eta=*/-0.1,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, mu, sampled_scores);
+  EXPECT_FALSE(sampled_ids.ok());
+}
+
+TEST(SamplingCpuUtilTest, TopKMirostatSampling_ZeroTauIsGreedy) {
+  const std::vector<float> logits = {0.0, 0.0, 10.0, 0.0,
+                                     11.0, 12.0, 1.0, 2.0};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> mu;
+  std::vector<float> sampled_scores;
+  auto sampled_ids = TopKMirostatSampling(
+      absl::MakeConstSpan(logits), /*k=*/4, /*tau=*/0.0, /*eta=*/0.1,
+      /*temperature=*/1.0f, rng, /*batch_size=*/2, mu, sampled_scores);
+  ASSERT_TRUE(sampled_ids.ok());
+  EXPECT_THAT(*sampled_ids, ElementsAre(2, 1));
+  EXPECT_THAT(mu, ElementsAre(0.0f, 0.0f));
+}
+
+TEST(SamplingCpuUtilTest, TopKMirostatSampling_UpdatesMu) {
+  // 4 equally likely tokens, i.e. a surprise of 2 bits each.
+  const std::vector<float> logits = {1.0, 1.0, 1.0, 1.0};
+  auto rng = std::make_shared<std::default_random_engine>(0);
+  std::vector<float> mu;
+  std::vector<float> sampled_scores;
+  // mu starts at 2 * tau = 2, so all the tokens are kept and mu moves by
+  // eta * (2 - tau) towards the target.
+  auto sampled_ids = TopKMirostatSampling(
+      absl::MakeConstSpan(logits), /*k=*/4, /*tau=*/1.0, /*eta=*/0.5,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, mu, sampled_scores);
+  ASSERT_TRUE(sampled_ids.ok());
+  EXPECT_THAT(mu, ElementsAre(FloatNear(1.5f, 1e-5f)));
+  EXPECT_THAT(sampled_scores, ElementsAre(FloatNear(0.25f, 1e-5f)));
+
+  // A maximum surprise of 1.5 bits truncates all the tokens but the first
+  // one, whose surprise on the truncated distribution is 0.
+  sampled_ids = TopKMirostatSampling(
+      absl::MakeConstSpan(logits), /*k=*/4, /*tau=*/1.0, /*eta=*/0.5,
+      /*temperature=*/1.0f, rng, /*batch_size=*/1, mu, sampled_scores);
+  ASSERT_TRUE(sampled_ids.ok());
+  EXPECT_THAT(mu, ElementsAre(FloatNear(2.0f, 1e-5f)));
+}
+
+TEST(SamplingCpuUtilTest, ComputeLogProbs_BatchSize2) {
+  // Probabilities of batch 0: {1/8, 2/8, 4/8, 1/8}.
+  // Probabilities of batch 1: {1/4, 1/4, 1/4, 1/4}.
+  const std::vector<float> logits = {std::log(1.0f), std::log(2.0f),
+                                     std::log(4.0f), std::log(1.0f),
+                                     3.0f,           3.0f,
+                                     3.0f,           3.0f};
+  const std::vector<int> sampled_ids = {1, 3};
+  std::vector<float> sampled_logprobs;
+  std::vector<int> top_token_ids;
+  std::vector<float> top_logprobs;
+  EXPECT_TRUE(ComputeLogProbs(absl::MakeConstSpan(logits),
+                              absl::MakeConstSpan(sampled_ids),
+                              /*num_top_logprobs=*/2, /*batch_size=*/2,
+                              sampled_logprobs, top_token_ids, top_logprobs)
+                  .ok());
+  EXPECT_THAT(sampled_logprobs,
+              Pointwise(FloatNear(1e-5), {std::log(0.25f), std::log(0.25f)}));
+  ASSERT_EQ(top_token_ids.size(), 4);
+  EXPECT_THAT(absl::MakeConstSpan(top_token_ids).subspan(0, 2),
+              ElementsAre(2, 1));
+  EXPECT_THAT(top_logprobs,
+              Pointwise(FloatNear(1e-5), {std::log(0.5f), std::log(0.25f),
+                                          std::log(0.25f), std::log(0.25f)}));
+}
+
+TEST(SamplingCpuUtilTest, ComputeLogProbs_NoTopLogProbs) {
+  const std::vector<float> logits = {0.0f, 0.0f};
+  const std::vector<int> sampled_ids = {0};
+  std::vector<float> sampled_logprobs;
+  std::vector<int> top_token_ids = {7};
+  std::vector<float> top_logprobs = {-1.0f};
+  EXPECT_TRUE(ComputeLogProbs(absl::MakeConstSpan(logits),
+                              absl::MakeConstSpan(sampled_ids),
+                              /*num_top_logprobs=*/0, /*batch_size=*/1,
+                              sampled_logprobs, top_token_ids, top_logprobs)
+                  .ok());
+  EXPECT_THAT(sampled_logprobs,
+              Pointwise(FloatNear(1e-5), {std::log(0.5f)}));
+  EXPECT_TRUE(top_token_ids.empty());
+  EXPECT_TRUE(top_logprobs.empty());
+}
+
+TEST(SamplingCpuUtilTest, ComputeLogProbs_InvalidInputs) {
+  const std::vector<float> logits = {0.0f, 0.0f, 0.0f};
+  std::vector<float> sampled_logprobs;
+  std::vector<int> top_token_ids;
+  std::vector<float> top_logprobs;
+  // Sampled id out of range.
+  const std::vector<int> out_of_range_ids = {3};
+  EXPECT_FALSE(ComputeLogProbs(absl::MakeConstSpan(logits),
+                               absl::MakeConstSpan(out_of_range_ids),
+                               /*num_top_logprobs=*/1, /*batch_size=*/1,
+                               sampled_logprobs, top_token_ids, top_logprobs)
+                   .ok());
+  // Negative num_top_logprobs.
+  const std::vector<int> sampled_ids = {0};
+  EXPECT_FALSE(ComputeLogProbs(absl::MakeConstSpan(logits),
+                               absl::MakeConstSpan(sampled_ids),
+                               /*num_top_logprobs=*/-1, /*batch_size=*/1,
+                               sampled_logprobs, top_token_ids, top_logprobs)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace litert::lm
@@ -63,7 +63,7 @@ SentencePieceTokenizer::CreateFromProto(
 
 // Encodes the given text into a TensorBuffer of token ids.
 absl::StatusOr<std::vector<int>> SentencePieceTokenizer::TextToTokenIds(
-    absl::string_view text) {
+    absl::string_view text) const {
   std::vector<int> ids;
   auto status = processor_->Encode(text, &ids);
   if (!status.ok()) {
@@ -72,7 +72,8 @@ absl::StatusOr<std::vector<int>> SentencePieceTokenizer::TextToTokenIds(
   return ids;
 }
 
-absl::StatusOr<int> SentencePieceTokenizer::TokenToId(absl::string_view token) {
+absl::StatusOr<int> SentencePieceTokenizer::TokenToId(
+    absl::string_view token) const {
   int id = processor_->PieceToId(token);
   if (id == processor_->unk_id()) {
     return absl::NotFoundError(absl::StrCat("Unknown token: ", token));
@@ -82,7 +83,7 @@ absl::StatusOr<int> SentencePieceTokenizer::TokenToId(absl::string_view token) {
 
 // Decodes the given TensorBuffer of token ids into a string.
 absl::StatusOr<std::string> SentencePieceTokenizer::TokenIdsToText(
-    const std::vector<int>& token_ids) {
+    const std::vector<int>& token_ids) const {
   std::string text = "";
   std::vector<int> chunk_byte_token_ids;
   for (const auto& token_id : token_ids) {
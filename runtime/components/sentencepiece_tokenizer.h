@@ -50,15 +50,15 @@ class SentencePieceTokenizer : public Tokenizer {
 
   // Encodes the given text into a sequence of token ids.
   absl::StatusOr<std::vector<int>> TextToTokenIds(
-      absl::string_view text) override;
+      absl::string_view text) const override;
 
   // Converts a token string to its token id. Uses SentencePiece's
   // PieceToId method.
-  absl::StatusOr<int> TokenToId(absl::string_view token) override;
+  absl::StatusOr<int> TokenToId(absl::string_view token) const override;
 
   // Decodes the given sequence of token ids into a string.
   absl::StatusOr<std::string> TokenIdsToText(
-      const std::vector<int>& token_ids) override;
+      const std::vector<int>& token_ids) const override;
 
   // Returns the tokens in the SentencePiece model.
   std::vector<std::string> GetTokens() const override;
@@ -25,6 +25,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 
 namespace litert::lm {
@@ -76,6 +77,21 @@ absl::Status StopTokenDetector::AddStopTokenSequence(
   return absl::OkStatus();
 }
 
+absl::Status StopTokenDetector::AddStopString(absl::string_view stop_string) {
+  if (stop_string.empty()) {
+    return absl::InvalidArgumentError("Cannot add an empty stop string.");
+  }
+  if (std::find(stop_strings_.begin(), stop_strings_.end(), stop_string) !=
+      stop_strings_.end()) {
+    ABSL_LOG(INFO) << absl::StrFormat(
+        "Stop string \"%s\" already exists. Skipping adding the stop string.",
+        stop_string);
+    return absl::OkStatus();
+  }
+  stop_strings_.push_back(std::string(stop_string));
+  return absl::OkStatus();
+}
+
 void StopTokenDetector::ResetBatch(size_t batch_size) {
   int new_batch_size = batch_size == 0 ? stop_token_found_.size() : batch_size;
   stop_token_found_.assign(new_batch_size, false);
@@ -85,6 +101,8 @@ void StopTokenDetector::ResetBatch(size_t batch_size) {
   batch_item_match_progress_.assign(
       new_batch_size, std::vector<int>(stop_sequences_storage_.size(), 0));
   matched_stop_sequence_length_.assign(new_batch_size, 0);
+  pending_text_.assign(new_batch_size, "");
+  stop_string_found_.assign(new_batch_size, false);
 }
 
 // Processes the latest incoming token for each sequence in the batch.
@@ -143,6 +161,54 @@ int StopTokenDetector::MaxPartialStopTokenLength(int index) const {
   return max_batch_item_match_progress_[index];
 }
 
+std::string StopTokenDetector::ProcessText(int index, absl::string_view text) {
+  if (stop_string_found_[index]) {
+    return "";
+  }
+  std::string& pending = pending_text_[index];
+  absl::StrAppend(&pending, text);
+  if (stop_token_found_[index]) {
+    return FlushText(index);
+  }
+
+  // Only the held back text and the new text can contain a match, as the held
+  // back text is always shorter than the longest stop string.
+  size_t match_pos = std::string::npos;
+  for (const auto& stop_string : stop_strings_) {
+    match_pos = std::min(match_pos, pending.find(stop_string));
+  }
+  if (match_pos != std::string::npos) {
+    std::string emitted = pending.substr(0, match_pos);
+    pending.clear();
+    stop_string_found_[index] = true;
+    stop_token_found_[index] = true;
+    return emitted;
+  }
+
+  // Hold back the longest suffix of the text that a later step could complete
+  // into a stop string.
+  size_t held_back = 0;
+  for (const auto& stop_string : stop_strings_) {
+    const size_t max_length = std::min(stop_string.size() - 1, pending.size());
+    for (size_t length = max_length; length > held_back; --length) {
+      if (absl::string_view(pending).substr(pending.size() - length) ==
+          absl::string_view(stop_string).substr(0, length)) {
+        held_back = length;
+        break;
+      }
+    }
+  }
+  std::string emitted = pending.substr(0, pending.size() - held_back);
+  pending.erase(0, pending.size() - held_back);
+  return emitted;
+}
+
+std::string StopTokenDetector::FlushText(int index) {
+  std::string emitted;
+  emitted.swap(pending_text_[index]);
+  return emitted;
+}
+
 const std::vector<int>& StopTokenDetector::GetStepsBeforeStopTokens() const {
   return matched_stop_sequence_length_;
 }
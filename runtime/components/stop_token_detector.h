@@ -16,10 +16,12 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_STOP_TOKEN_DETECTOR_H_
 
 #include <cstddef>
+#include <string>
 #include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 
 namespace litert::lm {
@@ -42,6 +44,15 @@ namespace litert::lm {
 //     // Stop token found...
 //   }
 //
+// Stop strings are matched on the detokenized text instead, so they are found
+// regardless of how the model happened to tokenize them. The text of each
+// step is passed through ProcessText(), which holds back the text that could
+// still be the beginning of a stop string and cuts the text at a match:
+//
+//   RETURN_IF_ERROR(detector.AddStopString("\nObservation:"));
+//   // ... for each decode step and batch item i ...
+//   std::string text_to_emit = detector.ProcessText(i, step_text);
+//
 class StopTokenDetector {
  public:
   // Constructs the detector for a given batch size.
@@ -54,6 +65,15 @@ class StopTokenDetector {
   //   - InvalidArgumentError if sequence is empty or added before.
   absl::Status AddStopTokenSequence(const std::vector<int>& stop_sequence);
 
+  // Adds a new stop string, matched on the decoded text across token
+  // boundaries.
+  //   - stop_string: The text to stop at. Must not be empty.
+  //   - InvalidArgumentError if the string is empty.
+  absl::Status AddStopString(absl::string_view stop_string);
+
+  // Returns true if any stop string was added.
+  bool HasStopStrings() const { return !stop_strings_.empty(); }
+
   // Resets detector state for a new batch size or clears existing state. Note
   // that this does not clear the stop sequences themselves.
   //   - batch_size: The new number of sequences in the batch. If zeros is
@@ -88,6 +108,21 @@ class StopTokenDetector {
   // the stop token is already found.
   int MaxPartialStopTokenLength(int index) const;
 
+  // Processes the decoded text of the latest step for the given batch item
+  // and returns the text that is safe to emit:
+  //   - If a stop string completes, the item is marked as stopped and the text
+  //     before the match is returned. The stop string itself and anything
+  //     after it are dropped.
+  //   - Otherwise, the longest suffix which is a prefix of a stop string is
+  //     held back until later text confirms or rules out the match.
+  //   - If the item was stopped by a stop token sequence, the held back text
+  //     is released together with `text`.
+  std::string ProcessText(int index, absl::string_view text);
+
+  // Returns and clears the text held back for the given batch item. Used when
+  // decoding ends for a reason other than a stop string or token.
+  std::string FlushText(int index);
+
  private:
   // Stores all added stop sequences.
   std::vector<std::vector<int>> stop_sequences_storage_;
@@ -108,6 +143,16 @@ class StopTokenDetector {
   // (if batch_size > 1) the additional length until the other batch items
   // also match the stop sequence.
   std::vector<int> matched_stop_sequence_length_;
+
+  // Stores all added stop strings.
+  std::vector<std::string> stop_strings_;
+
+  // pending_text_[i]: decoded text of batch item 'i' held back because it may
+  // be the beginning of a stop string.
+  std::vector<std::string> pending_text_;
+
+  // stop_string_found_[i]: true if batch item 'i' has matched a stop string.
+  std::vector<bool> stop_string_found_;
 };
 
 }  // namespace litert::lm
@@ -0,0 +1,64 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for StopTokenDetector::ProcessTokens, which runs once per
+// decode step.
+//
+// bazel run -c opt //runtime/components:stop_token_detector_benchmark
+
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/stop_token_detector.h"
+
+namespace litert::lm {
+namespace {
+
+// Args: batch_size, number of stop sequences, stop sequence length.
+void BM_StopTokenDetector_ProcessTokens(benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const int num_sequences = state.range(1);
+  const int sequence_length = state.range(2);
+  StopTokenDetector detector(batch_size);
+  for (int i = 0; i < num_sequences; ++i) {
+    std::vector<int> sequence(sequence_length);
+    for (int j = 0; j < sequence_length; ++j) {
+      sequence[j] = 1000 + i * sequence_length + j;
+    }
+    if (!detector.AddStopTokenSequence(sequence).ok()) {
+      state.SkipWithError("AddStopTokenSequence failed.");
+      return;
+    }
+  }
+  // Feed the first token of a stop sequence followed by a non-matching token
+  // so that the partial match bookkeeping is exercised without ever stopping.
+  const std::vector<int> prefix_tokens(batch_size, 1000);
+  const std::vector<int> other_tokens(batch_size, 7);
+  for (auto _ : state) {
+    auto status = detector.ProcessTokens(absl::MakeConstSpan(prefix_tokens));
+    benchmark::DoNotOptimize(status);
+    status = detector.ProcessTokens(absl::MakeConstSpan(other_tokens));
+    benchmark::DoNotOptimize(status);
+  }
+  state.SetItemsProcessed(state.iterations() * 2 * batch_size);
+}
+BENCHMARK(BM_StopTokenDetector_ProcessTokens)
+    ->ArgNames({"batch", "num_seqs", "seq_len"})
+    ->ArgsProduct({{1, 8}, {1, 4, 16}, {1, 4}});
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
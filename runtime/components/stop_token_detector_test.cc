@@ -15,6 +15,7 @@
 #include "runtime/components/stop_token_detector.h"
 
 #include <cstddef>
+#include <string>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -134,5 +135,78 @@ TEST(StopTokenDetectorTest, ResetBatch) {
   EXPECT_EQ(0, detector.GetStepsBeforeStopTokens()[0]);
 }
 
+TEST(StopTokenDetectorTest, AddStopString) {
+  StopTokenDetector detector(1);
+  EXPECT_FALSE(detector.HasStopStrings());
+  EXPECT_OK(detector.AddStopString("\nObservation:"));
+  EXPECT_TRUE(detector.HasStopStrings());
+
+  // Adding an empty string should fail.
+  EXPECT_EQ(absl::StatusCode::kInvalidArgument,
+            detector.AddStopString("").code());
+
+  // Adding a repeated string should be a no-op.
+  EXPECT_OK(detector.AddStopString("\nObservation:"));
+}
+
+TEST(StopTokenDetectorTest, ProcessTextAcrossTokenBoundaries) {
+  StopTokenDetector detector(1);
+  EXPECT_OK(detector.AddStopTokenSequence({1}));
+  EXPECT_OK(detector.AddStopString("\nObservation:"));
+
+  std::string result;
+  // "\n" may start the stop string, so it is held back.
+  result += detector.ProcessText(0, "Thought: done");
+  EXPECT_EQ(result, "Thought: done");
+  result += detector.ProcessText(0, "\n");
+  EXPECT_EQ(result, "Thought: done");
+  result += detector.ProcessText(0, "Obs");
+  EXPECT_EQ(result, "Thought: done");
+  EXPECT_FALSE(detector.AllDone().value());
+  // The match completes in the middle of the token.
+  result += detector.ProcessText(0, "ervation: 42");
+  EXPECT_EQ(result, "Thought: done");
+  EXPECT_TRUE(detector.AllDone().value());
+
+  // Nothing is emitted after the stop string.
+  EXPECT_EQ(detector.ProcessText(0, "more"), "");
+}
+
+TEST(StopTokenDetectorTest, ProcessTextReleasesBrokenPartialMatch) {
+  StopTokenDetector detector(1);
+  EXPECT_OK(detector.AddStopTokenSequence({1}));
+  EXPECT_OK(detector.AddStopString("STOP"));
+
+  EXPECT_EQ(detector.ProcessText(0, "a ST"), "a ");
+  // "STO" is still a partial match.
+  EXPECT_EQ(detector.ProcessText(0, "O"), "");
+  // "STOS" is not, but its suffix "S" is.
+  EXPECT_EQ(detector.ProcessText(0, "S"), "STO");
+  EXPECT_EQ(detector.FlushText(0), "S");
+  EXPECT_FALSE(detector.AllDone().value());
+}
+
+TEST(StopTokenDetectorTest, ProcessTextWithBatchAndStopTokens) {
+  StopTokenDetector detector(2);
+  EXPECT_OK(detector.AddStopTokenSequence({1}));
+  EXPECT_OK(detector.AddStopString("##"));
+
+  EXPECT_EQ(detector.ProcessText(0, "x#"), "x");
+  EXPECT_EQ(detector.ProcessText(1, "y#"), "y");
+
+  // Item 0 stops on the stop string.
+  EXPECT_EQ(detector.ProcessText(0, "#z"), "");
+  // Item 1 stops on a stop token; the held back text is released.
+  std::vector<int> tokens = {2, 1};
+  EXPECT_OK(detector.ProcessTokens(absl::MakeSpan(tokens)));
+  EXPECT_EQ(detector.ProcessText(1, ""), "#");
+  EXPECT_TRUE(detector.AllDone().value());
+
+  detector.ResetBatch();
+  EXPECT_FALSE(detector.AllDone().value());
+  EXPECT_EQ(detector.ProcessText(0, "a#"), "a");
+  EXPECT_EQ(detector.FlushText(0), "#");
+}
+
 }  // namespace
 }  // namespace litert::lm
@@ -47,12 +47,13 @@ class Tokenizer {
 
   // Encodes the given input text to token ids. Includes tokenizer pre/post
   // processing.
-  virtual absl::StatusOr<TokenIds> TextToTokenIds(absl::string_view text) = 0;
+  virtual absl::StatusOr<TokenIds> TextToTokenIds(
+      absl::string_view text) const = 0;
 
   // Converts a token string to its token id. This is a raw token look up,
   // without any tokenizer pre/post processing. The implementation is expected
   // to return absl::NotFoundError if the token is not found.
-  virtual absl::StatusOr<int> TokenToId(absl::string_view token) = 0;
+  virtual absl::StatusOr<int> TokenToId(absl::string_view token) const = 0;
 
   // Helper function to convert a vector of token ids into a 1D
   // litert::TensorBuffer of shape [batch_size(==1), num_tokens].
@@ -69,7 +70,7 @@ class Tokenizer {
   // Returns absl::DataLossError if any of the tokens are part of an incomplete
   // BPE sequence.
   virtual absl::StatusOr<std::string> TokenIdsToText(
-      const TokenIds& token_ids) = 0;
+      const TokenIds& token_ids) const = 0;
 
   // Returns the list of tokens in the tokenizer.
   virtual std::vector<std::string> GetTokens() const = 0;
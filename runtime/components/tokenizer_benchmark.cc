@@ -0,0 +1,129 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for the SentencePiece and HuggingFace tokenizers on the
+// encode and decode paths.
+//
+// bazel run -c opt //runtime/components:tokenizer_benchmark
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "runtime/components/huggingface_tokenizer.h"
+#include "runtime/components/sentencepiece_tokenizer.h"
+#include "runtime/components/tokenizer.h"
+
+namespace litert::lm {
+namespace {
+
+// Relative to the runfiles directory `bazel run` starts the binary in.
+constexpr char kTestdataDir[] = "runtime/components/testdata/";
+
+constexpr char kSentence[] =
+    "The quick brown fox jumps over the lazy dog while the model streams its "
+    "answer token by token. ";
+
+enum TokenizerKind { kSentencePiece = 0, kHuggingFace = 1 };
+
+absl::StatusOr<std::unique_ptr<Tokenizer>> CreateTokenizer(int kind) {
+  if (kind == kSentencePiece) {
+    return SentencePieceTokenizer::CreateFromFile(
+        absl::StrCat(kTestdataDir, "sentencepiece.model"));
+  }
+  return HuggingFaceTokenizer::CreateFromFile(
+      absl::StrCat(kTestdataDir, "tokenizer.json"));
+}
+
+std::string MakeText(int num_sentences) {
+  std::string text;
+  for (int i = 0; i < num_sentences; ++i) {
+    absl::StrAppend(&text, kSentence);
+  }
+  return text;
+}
+
+// Args: tokenizer kind, number of sentences.
+void BM_Tokenizer_TextToTokenIds(benchmark::State& state) {
+  auto tokenizer = CreateTokenizer(state.range(0));
+  if (!tokenizer.ok()) {
+    state.SkipWithError(tokenizer.status().ToString());
+    return;
+  }
+  const std::string text = MakeText(state.range(1));
+  for (auto _ : state) {
+    auto ids = (*tokenizer)->TextToTokenIds(text);
+    benchmark::DoNotOptimize(ids);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK(BM_Tokenizer_TextToTokenIds)
+    ->ArgNames({"hf", "sentences"})
+    ->ArgsProduct({{kSentencePiece, kHuggingFace}, {1, 16, 256}});
+
+// Args: tokenizer kind, number of sentences.
+void BM_Tokenizer_TokenIdsToText(benchmark::State& state) {
+  auto tokenizer = CreateTokenizer(state.range(0));
+  if (!tokenizer.ok()) {
+    state.SkipWithError(tokenizer.status().ToString());
+    return;
+  }
+  auto ids = (*tokenizer)->TextToTokenIds(MakeText(state.range(1)));
+  if (!ids.ok()) {
+    state.SkipWithError(ids.status().ToString());
+    return;
+  }
+  for (auto _ : state) {
+    auto text = (*tokenizer)->TokenIdsToText(*ids);
+    benchmark::DoNotOptimize(text);
+  }
+  state.SetItemsProcessed(state.iterations() * ids->size());
+}
+BENCHMARK(BM_Tokenizer_TokenIdsToText)
+    ->ArgNames({"hf", "sentences"})
+    ->ArgsProduct({{kSentencePiece, kHuggingFace}, {1, 16, 256}});
+
+// Decodes one token at a time, as the streaming decode loop does.
+// Args: tokenizer kind.
+void BM_Tokenizer_TokenIdsToText_Streaming(benchmark::State& state) {
+  auto tokenizer = CreateTokenizer(state.range(0));
+  if (!tokenizer.ok()) {
+    state.SkipWithError(tokenizer.status().ToString());
+    return;
+  }
+  auto ids = (*tokenizer)->TextToTokenIds(MakeText(16));
+  if (!ids.ok()) {
+    state.SkipWithError(ids.status().ToString());
+    return;
+  }
+  for (auto _ : state) {
+    for (int id : *ids) {
+      auto text = (*tokenizer)->TokenIdsToText({id});
+      benchmark::DoNotOptimize(text);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * ids->size());
+}
+BENCHMARK(BM_Tokenizer_TokenIdsToText_Streaming)
+    ->ArgNames({"hf"})
+    ->Arg(kSentencePiece)
+    ->Arg(kHuggingFace);
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
@@ -37,11 +37,11 @@ namespace {
 class MockTokenizer : public Tokenizer {
  public:
   MOCK_METHOD(absl::StatusOr<std::vector<int>>, TextToTokenIds,
-              (absl::string_view text), (override));
+              (absl::string_view text), (const, override));
   MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view token),
-              (override));
+              (const, override));
   MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText,
-              (const std::vector<int>& token_ids), (override));
+              (const std::vector<int>& token_ids), (const, override));
   MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
   MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
 };
@@ -14,37 +14,282 @@
 
 #include "runtime/components/tool_use/fc_parser_utils.h"
 
+#include <cstddef>
 #include <string>
 #include <utility>
 
 #include "absl/log/absl_log.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/ascii.h"  // from @com_google_absl
+#include "absl/strings/match.h"  // from @com_google_absl
 #include "absl/strings/numbers.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/strings/strip.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
-#include "runtime/components/tool_use/parser_common.h"
-#include "runtime/components/tool_use/rust/parsers.rs.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
 
 namespace litert::lm {
 
-absl::StatusOr<nlohmann::ordered_json> ParseFcExpression(
-    absl::string_view text) {
-  auto tool_calls = parse_fc_expression(text.data());
-  if (!tool_calls.is_ok) {
-    absl::string_view error_message =
-        absl::string_view(tool_calls.error.data(), tool_calls.error.size());
+namespace {
+
+// The tokens delimiting a string value.
+constexpr absl::string_view kEscapeTokens[] = {"<escape>", "<ctrl46>",
+                                               "<|\"|>"};
+
+bool IsIdStart(char c) { return absl::ascii_isalpha(c) || c == '_'; }
+
+bool IsIdChar(char c) { return absl::ascii_isalnum(c) || c == '_'; }
+
+// Single-pass recursive-descent parser for FC tool calls:
+//
+//   start: 'call' ':' ID object EOF
+//   object: '{' (ID ':' value (',' ID ':' value)*)? '}'
+//   array: '[' (value (',' value)*)? ']'
+//   value: ESCAPED_STRING | NUMBER | true | false | null | object | array
+//
+// where an ESCAPED_STRING is any text between two escape tokens. Numbers and
+// words are split the way the original lexer did: a word is not an ID if it is
+// a keyword or if it reads entirely as an exponent such as `e5`.
+class FcExpressionParser {
+ public:
+  explicit FcExpressionParser(absl::string_view text) : text_(text) {}
+
+  absl::StatusOr<nlohmann::ordered_json> Parse() {
+    if (ScanWord() != "call") {
+      return Error("Expected 'call'");
+    }
+    RETURN_IF_ERROR(Expect(':'));
+    ASSIGN_OR_RETURN(absl::string_view name, ParseId());
+    if (!Peek('{')) {
+      return Error("Expected '{'");
+    }
+    ASSIGN_OR_RETURN(nlohmann::ordered_json arguments, ParseObject());
+    SkipWhitespace();
+    if (pos_ < text_.size()) {
+      return Error("Unexpected trailing input");
+    }
+    nlohmann::ordered_json tool_call = nlohmann::ordered_json::object();
+    tool_call["name"] = std::string(name);
+    tool_call["arguments"] = std::move(arguments);
+    nlohmann::ordered_json tool_calls = nlohmann::ordered_json::array();
+    tool_calls.push_back(std::move(tool_call));
+    return tool_calls;
+  }
+
+ private:
+  absl::Status Error(absl::string_view message) const {
     return absl::InvalidArgumentError(
-        absl::StrCat("Failed to parse FC tool calls: ", error_message));
+        absl::StrCat(message, " at offset ", pos_));
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() && absl::ascii_isspace(text_[pos_])) ++pos_;
+  }
+
+  bool Peek(char c) {
+    SkipWhitespace();
+    return pos_ < text_.size() && text_[pos_] == c;
+  }
+
+  bool Consume(char c) {
+    if (!Peek(c)) return false;
+    ++pos_;
+    return true;
+  }
+
+  absl::Status Expect(char c) {
+    if (!Consume(c)) {
+      return Error(absl::StrCat("Expected '", absl::string_view(&c, 1), "'"));
+    }
+    return absl::OkStatus();
+  }
+
+  // Scans [a-zA-Z_][a-zA-Z_0-9]*, returns an empty view if there is none.
+  absl::string_view ScanWord() {
+    SkipWhitespace();
+    const size_t start = pos_;
+    if (pos_ < text_.size() && IsIdStart(text_[pos_])) {
+      while (pos_ < text_.size() && IsIdChar(text_[pos_])) ++pos_;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+  // Returns the length of the exponent ([eE] [+-]? [0-9]+) starting at `pos`,
+  // or 0 if there is none.
+  size_t ExponentLength(size_t pos) const {
+    size_t end = pos;
+    if (end >= text_.size() || (text_[end] != 'e' && text_[end] != 'E')) {
+      return 0;
+    }
+    ++end;
+    if (end < text_.size() && (text_[end] == '+' || text_[end] == '-')) ++end;
+    const size_t digits_start = end;
+    while (end < text_.size() && absl::ascii_isdigit(text_[end])) ++end;
+    return end > digits_start ? end - pos : 0;
+  }
+
+  absl::StatusOr<absl::string_view> ParseId() {
+    SkipWhitespace();
+    const size_t start = pos_;
+    absl::string_view id = ScanWord();
+    if (id.empty() || ExponentLength(start) >= id.size() || id == "true" ||
+        id == "false" || id == "null" || id == "call") {
+      pos_ = start;
+      return Error("Expected an identifier");
+    }
+    return id;
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseValue() {
+    SkipWhitespace();
+    if (pos_ >= text_.size()) {
+      return Error("Expected a value");
+    }
+    const char c = text_[pos_];
+    if (c == '<') {
+      return ParseEscapedString();
+    }
+    if (c == '{') {
+      return ParseObject();
+    }
+    if (c == '[') {
+      return ParseArray();
+    }
+    const size_t start = pos_;
+    const size_t exponent_length = ExponentLength(pos_);
+    absl::string_view word = ScanWord();
+    if (!word.empty() && exponent_length < word.size()) {
+      if (word == "true") return nlohmann::ordered_json(true);
+      if (word == "false") return nlohmann::ordered_json(false);
+      if (word == "null") return nlohmann::ordered_json(nullptr);
+      pos_ = start;
+      return Error(absl::StrCat("Unexpected value: ", word));
+    }
+    pos_ = start;
+    return ParseNumber();
+  }
+
+  // ESCAPED_STRING: ESCAPE .*? ESCAPE
+  absl::StatusOr<nlohmann::ordered_json> ParseEscapedString() {
+    const size_t start = pos_;
+    size_t content_start = absl::string_view::npos;
+    for (absl::string_view token : kEscapeTokens) {
+      if (absl::StartsWith(text_.substr(pos_), token)) {
+        content_start = pos_ + token.size();
+        break;
+      }
+    }
+    if (content_start == absl::string_view::npos) {
+      return Error("Expected a value");
+    }
+    size_t end = absl::string_view::npos;
+    for (absl::string_view token : kEscapeTokens) {
+      size_t found = text_.find(token, content_start);
+      if (found != absl::string_view::npos &&
+          (end == absl::string_view::npos || found + token.size() < end)) {
+        end = found + token.size();
+      }
+    }
+    if (end == absl::string_view::npos) {
+      return Error("Unterminated string");
+    }
+    pos_ = end;
+    // Only the <escape> token is stripped from the value.
+    absl::string_view value = text_.substr(start, end - start);
+    absl::ConsumePrefix(&value, "<escape>");
+    absl::ConsumeSuffix(&value, "<escape>");
+    return nlohmann::ordered_json(std::string(value));
+  }
+
+  // NUMBER: '-'? INT (FRAC | EXP)? | '-'? FRAC | '-'? EXP
+  // INT: '0' | [1-9] [0-9]*
+  // FRAC: '.' [0-9]+
+  absl::StatusOr<nlohmann::ordered_json> ParseNumber() {
+    const size_t start = pos_;
+    if (pos_ < text_.size() && text_[pos_] == '-') ++pos_;
+    bool has_int = false;
+    if (pos_ < text_.size() && text_[pos_] == '0') {
+      ++pos_;
+      has_int = true;
+    } else if (pos_ < text_.size() && absl::ascii_isdigit(text_[pos_])) {
+      while (pos_ < text_.size() && absl::ascii_isdigit(text_[pos_])) ++pos_;
+      has_int = true;
+    }
+    bool has_suffix = false;
+    if (pos_ + 1 < text_.size() && text_[pos_] == '.' &&
+        absl::ascii_isdigit(text_[pos_ + 1])) {
+      ++pos_;
+      while (pos_ < text_.size() && absl::ascii_isdigit(text_[pos_])) ++pos_;
+      has_suffix = true;
+    } else if (size_t length = ExponentLength(pos_); length > 0) {
+      pos_ += length;
+      has_suffix = true;
+    }
+    absl::string_view number = text_.substr(start, pos_ - start);
+    double value;
+    if ((!has_int && !has_suffix) || !absl::SimpleAtod(number, &value)) {
+      pos_ = start;
+      return Error(absl::StrCat("Failed to parse number: ", number));
+    }
+    return nlohmann::ordered_json(value);
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseArray() {
+    ++pos_;
+    nlohmann::ordered_json array = nlohmann::ordered_json::array();
+    if (Consume(']')) return array;
+    while (true) {
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      array.push_back(std::move(value));
+      if (Consume(']')) return array;
+      RETURN_IF_ERROR(Expect(','));
+    }
+  }
+
+  // Duplicate keys are ignored, the first value wins.
+  absl::StatusOr<nlohmann::ordered_json> ParseObject() {
+    ++pos_;
+    nlohmann::ordered_json object = nlohmann::ordered_json::object();
+    if (Consume('}')) return object;
+    while (true) {
+      ASSIGN_OR_RETURN(absl::string_view id, ParseId());
+      RETURN_IF_ERROR(Expect(':'));
+      auto value = ParseValue();
+      if (!value.ok()) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Error parsing value for key '", id,
+                         "': ", value.status().message()));
+      }
+      std::string key(id);
+      if (object.contains(key)) {
+        ABSL_LOG(WARNING) << "Ignoring duplicate key: " << key;
+      } else {
+        object[std::move(key)] = *std::move(value);
+      }
+      if (Consume('}')) return object;
+      RETURN_IF_ERROR(Expect(','));
+    }
   }
 
-  nlohmann::ordered_json tool_calls_json = nlohmann::ordered_json::array();
-  for (const auto& tool_call : tool_calls.tool_calls) {
-    tool_calls_json.push_back(ConvertJsonValue(tool_call));
+  const absl::string_view text_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<nlohmann::ordered_json> ParseFcExpression(
+    absl::string_view text) {
+  if (text.empty()) {
+    return nlohmann::ordered_json::array();
+  }
+  auto tool_calls = FcExpressionParser(text).Parse();
+  if (!tool_calls.ok()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Failed to parse FC tool calls: ", tool_calls.status().message()));
   }
-  return tool_calls_json;
+  return tool_calls;
 }
 
 }  // namespace litert::lm
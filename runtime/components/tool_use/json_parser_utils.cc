@@ -14,32 +14,359 @@
 
 #include "runtime/components/tool_use/json_parser_utils.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <utility>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/ascii.h"  // from @com_google_absl
+#include "absl/strings/numbers.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
-#include "runtime/components/tool_use/parser_common.h"
-#include "runtime/components/tool_use/rust/parsers.rs.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
 
 namespace litert::lm {
 
+namespace {
+
+void AppendUtf8(uint32_t code_point, std::string& out) {
+  if (code_point < 0x80) {
+    out.push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else if (code_point < 0x10000) {
+    out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  } else {
+    out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+  }
+}
+
+// Single-pass recursive-descent parser for a strict (RFC 8259) JSON document.
+// The values are built directly while scanning the text, without an
+// intermediate token stream or parse tree.
+class JsonDocumentParser {
+ public:
+  explicit JsonDocumentParser(absl::string_view text) : text_(text) {}
+
+  absl::StatusOr<nlohmann::ordered_json> Parse() {
+    ASSIGN_OR_RETURN(nlohmann::ordered_json root, ParseValue());
+    SkipWhitespace();
+    if (pos_ < text_.size()) {
+      return Error("Trailing characters");
+    }
+    return root;
+  }
+
+ private:
+  absl::Status Error(absl::string_view message) const {
+    return absl::InvalidArgumentError(
+        absl::StrCat(message, " at offset ", pos_));
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' ||
+            text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ >= text_.size() || text_[pos_] != c) return false;
+    ++pos_;
+    return true;
+  }
+
+  absl::Status Expect(char c) {
+    if (!Consume(c)) {
+      return Error(absl::StrCat("Expected '", absl::string_view(&c, 1), "'"));
+    }
+    return absl::OkStatus();
+  }
+
+  bool ConsumeLiteral(absl::string_view literal) {
+    if (text_.substr(pos_, literal.size()) != literal) return false;
+    pos_ += literal.size();
+    return true;
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseValue() {
+    SkipWhitespace();
+    if (pos_ >= text_.size()) {
+      return Error("Expected a value");
+    }
+    switch (text_[pos_]) {
+      case '{':
+        return ParseObject();
+      case '[':
+        return ParseArray();
+      case '"': {
+        std::string value;
+        RETURN_IF_ERROR(ParseString(value));
+        return nlohmann::ordered_json(std::move(value));
+      }
+      case 't':
+        if (ConsumeLiteral("true")) return nlohmann::ordered_json(true);
+        break;
+      case 'f':
+        if (ConsumeLiteral("false")) return nlohmann::ordered_json(false);
+        break;
+      case 'n':
+        if (ConsumeLiteral("null")) return nlohmann::ordered_json(nullptr);
+        break;
+      default:
+        if (text_[pos_] == '-' || absl::ascii_isdigit(text_[pos_])) {
+          return ParseNumber();
+        }
+    }
+    return Error("Expected a value");
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseObject() {
+    ++pos_;
+    nlohmann::ordered_json object = nlohmann::ordered_json::object();
+    if (Consume('}')) return object;
+    while (true) {
+      SkipWhitespace();
+      if (pos_ >= text_.size() || text_[pos_] != '"') {
+        return Error("Expected a string key");
+      }
+      std::string key;
+      RETURN_IF_ERROR(ParseString(key));
+      RETURN_IF_ERROR(Expect(':'));
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      object[std::move(key)] = std::move(value);
+      if (Consume('}')) return object;
+      RETURN_IF_ERROR(Expect(','));
+    }
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseArray() {
+    ++pos_;
+    nlohmann::ordered_json array = nlohmann::ordered_json::array();
+    if (Consume(']')) return array;
+    while (true) {
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      array.push_back(std::move(value));
+      if (Consume(']')) return array;
+      RETURN_IF_ERROR(Expect(','));
+    }
+  }
+
+  absl::StatusOr<uint32_t> ParseHex4() {
+    if (pos_ + 4 > text_.size()) {
+      return Error("Invalid unicode escape");
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = text_[pos_++];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return Error("Invalid unicode escape");
+      }
+    }
+    return value;
+  }
+
+  // Appends the unescaped content of the string at the current position to
+  // `out`. Runs without escape sequences are appended in one go.
+  absl::Status ParseString(std::string& out) {
+    ++pos_;
+    while (true) {
+      const size_t run_start = pos_;
+      while (pos_ < text_.size() && text_[pos_] != '"' &&
+             text_[pos_] != '\\' &&
+             static_cast<unsigned char>(text_[pos_]) >= 0x20) {
+        ++pos_;
+      }
+      out.append(text_.data() + run_start, pos_ - run_start);
+      if (pos_ >= text_.size()) {
+        return Error("Unterminated string");
+      }
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return absl::OkStatus();
+      }
+      if (c != '\\') {
+        return Error("Control character in string");
+      }
+      if (pos_ >= text_.size()) {
+        return Error("Unterminated string");
+      }
+      switch (text_[pos_++]) {
+        case '"':
+          out.push_back('"');
+          break;
+        case '\\':
+          out.push_back('\\');
+          break;
+        case '/':
+          out.push_back('/');
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u': {
+          ASSIGN_OR_RETURN(uint32_t code_point, ParseHex4());
+          if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+            return Error("Lone trailing surrogate");
+          }
+          if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+            if (!ConsumeLiteral("\\u")) {
+              return Error("Lone leading surrogate");
+            }
+            ASSIGN_OR_RETURN(uint32_t low, ParseHex4());
+            if (low < 0xDC00 || low > 0xDFFF) {
+              return Error("Invalid surrogate pair");
+            }
+            code_point =
+                0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          }
+          AppendUtf8(code_point, out);
+          break;
+        }
+        default:
+          --pos_;
+          return Error("Invalid escape");
+      }
+    }
+  }
+
+  // number: '-'? ('0' | [1-9][0-9]*) ('.' [0-9]+)? ([eE] [+-]? [0-9]+)?
+  // Integers are kept as integers when they fit in 64 bits.
+  absl::StatusOr<nlohmann::ordered_json> ParseNumber() {
+    const size_t start = pos_;
+    bool is_float = false;
+    if (text_[pos_] == '-') ++pos_;
+    if (pos_ < text_.size() && text_[pos_] == '0') {
+      ++pos_;
+    } else if (ScanDigits() == 0) {
+      return Error("Invalid number");
+    }
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+      ++pos_;
+      if (ScanDigits() == 0) return Error("Invalid number");
+      is_float = true;
+    }
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      ++pos_;
+      if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+        ++pos_;
+      }
+      if (ScanDigits() == 0) return Error("Invalid number");
+      is_float = true;
+    }
+    absl::string_view number = text_.substr(start, pos_ - start);
+    if (!is_float) {
+      if (int64_t value; absl::SimpleAtoi(number, &value)) {
+        return nlohmann::ordered_json(value);
+      }
+      if (uint64_t value; absl::SimpleAtoi(number, &value)) {
+        return nlohmann::ordered_json(value);
+      }
+    }
+    double value;
+    if (!absl::SimpleAtod(number, &value)) {
+      return Error("Invalid number");
+    }
+    return nlohmann::ordered_json(value);
+  }
+
+  size_t ScanDigits() {
+    const size_t start = pos_;
+    while (pos_ < text_.size() && absl::ascii_isdigit(text_[pos_])) ++pos_;
+    return pos_ - start;
+  }
+
+  const absl::string_view text_;
+  size_t pos_ = 0;
+};
+
+// Converts a JSON object into a tool call with a name and an arguments object.
+// The arguments are read from "arguments", or from "args" if there is none.
+absl::StatusOr<nlohmann::ordered_json> ToToolCall(
+    nlohmann::ordered_json& object) {
+  auto name = object.find("name");
+  if (name == object.end() || !name->is_string() ||
+      name->get_ref<const std::string&>().empty()) {
+    return absl::InvalidArgumentError("Tool call missing name.");
+  }
+  auto arguments = object.find("arguments");
+  if (arguments == object.end()) {
+    arguments = object.find("args");
+  }
+  nlohmann::ordered_json tool_call = nlohmann::ordered_json::object();
+  tool_call["name"] = std::move(*name);
+  if (arguments == object.end()) {
+    tool_call["arguments"] = nlohmann::ordered_json::object();
+  } else if (arguments->is_object()) {
+    tool_call["arguments"] = std::move(*arguments);
+  } else {
+    return absl::InvalidArgumentError(
+        "Tool call arguments are not an object.");
+  }
+  return tool_call;
+}
+
+}  // namespace
+
 absl::StatusOr<nlohmann::ordered_json> ParseJsonExpression(
     absl::string_view text) {
-  auto tool_calls = parse_json_expression(text.data());
-  if (!tool_calls.is_ok) {
-    absl::string_view error_message =
-        absl::string_view(tool_calls.error.data(), tool_calls.error.size());
-    return absl::InvalidArgumentError(
-        absl::StrCat("Failed to parse JSON tool calls: ", error_message));
+  auto root = JsonDocumentParser(text).Parse();
+  if (!root.ok()) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Failed to parse JSON tool calls: ", root.status().message()));
   }
-  nlohmann::ordered_json tool_calls_json = nlohmann::ordered_json::array();
-  for (const auto& tool_call : tool_calls.tool_calls) {
-    tool_calls_json.push_back(ConvertJsonValue(tool_call));
+
+  // The document is either a single tool call or a list of them. Items that
+  // are not objects are skipped.
+  nlohmann::ordered_json tool_calls = nlohmann::ordered_json::array();
+  auto add_tool_call = [&](nlohmann::ordered_json& item) -> absl::Status {
+    if (!item.is_object()) return absl::OkStatus();
+    auto tool_call = ToToolCall(item);
+    if (!tool_call.ok()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Failed to parse JSON tool calls: ", tool_call.status().message()));
+    }
+    tool_calls.push_back(*std::move(tool_call));
+    return absl::OkStatus();
+  };
+  if (root->is_array()) {
+    for (auto& item : *root) {
+      RETURN_IF_ERROR(add_tool_call(item));
+    }
+  } else {
+    RETURN_IF_ERROR(add_tool_call(*root));
   }
-  return tool_calls_json;
+  return tool_calls;
 }
 
 }  // namespace litert::lm
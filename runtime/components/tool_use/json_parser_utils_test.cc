@@ -163,4 +163,27 @@ TEST(JsonParserUtilsTest, EmptyJsonArray) {
               IsOkAndHolds(nlohmann::ordered_json::parse("[]")));
 }
 
+TEST(JsonParserUtilsTest, ParseEscapedStrings) {
+  ASSERT_OK_AND_ASSIGN(auto tool_calls, ParseJsonExpression(R"json({
+                "name": "tool",
+                "arguments": {"text": "a\"b\\c\n\u00e9\ud83d\ude00"}
+              })json"));
+  EXPECT_EQ(tool_calls[0]["arguments"]["text"],
+            "a\"b\\c\n\xc3\xa9\xf0\x9f\x98\x80");
+}
+
+TEST(JsonParserUtilsTest, ParseArgsKey) {
+  EXPECT_THAT(
+      ParseJsonExpression(R"json({"name": "tool", "args": {"x": 1}})json"),
+      IsOkAndHolds(nlohmann::ordered_json::parse(R"json([{
+                "name": "tool",
+                "arguments": {"x": 1}
+              }])json")));
+}
+
+TEST(JsonParserUtilsTest, TrailingCharacters) {
+  EXPECT_THAT(ParseJsonExpression(R"json({"name": "tool"} x)json"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
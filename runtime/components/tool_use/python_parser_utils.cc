@@ -14,31 +14,287 @@
 
 #include "runtime/components/tool_use/python_parser_utils.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/ascii.h"  // from @com_google_absl
+#include "absl/strings/numbers.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
-#include "runtime/components/tool_use/parser_common.h"
-#include "runtime/components/tool_use/rust/parsers.rs.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
 
 namespace litert::lm {
 
-absl::StatusOr<nlohmann::ordered_json> ParsePythonExpression(
-    absl::string_view text) {
-  auto tool_calls = parse_python_expression(text.data());
-  if (!tool_calls.is_ok) {
-    absl::string_view error_message =
-        absl::string_view(tool_calls.error.data(), tool_calls.error.size());
+namespace {
+
+bool IsNameStart(char c) { return absl::ascii_isalpha(c) || c == '_'; }
+
+bool IsNameChar(char c) { return absl::ascii_isalnum(c) || c == '_'; }
+
+// Single-pass recursive-descent parser for Python-style tool calls:
+//
+//   main: (functionCall+ | functionCallList) EOF
+//   functionCallList: '[' (functionCall (',' functionCall)* ','?)? ']'
+//   functionCall: NAME '(' (argVal (',' argVal)* ','?)? ')'
+//   argVal: NAME '=' value
+//   value: INT | FLOAT | True | False | None | STRING | list | dict | object
+//   list: '[' (value (',' value)* ','?)? ']'
+//   dict: '{' (STRING ':' value (',' STRING ':' value)* ','?)? '}'
+//   object: NAME '(' (argVal (',' argVal)* ','?)? ')'
+//
+// The JSON values are built directly while scanning the text, without an
+// intermediate token stream or parse tree.
+class PythonExpressionParser {
+ public:
+  explicit PythonExpressionParser(absl::string_view text) : text_(text) {}
+
+  absl::StatusOr<nlohmann::ordered_json> Parse() {
+    nlohmann::ordered_json tool_calls = nlohmann::ordered_json::array();
+    if (Consume('[')) {
+      if (!Consume(']')) {
+        while (true) {
+          RETURN_IF_ERROR(ParseFunctionCall(tool_calls));
+          if (Consume(']')) break;
+          RETURN_IF_ERROR(Expect(','));
+          if (Consume(']')) break;
+        }
+      }
+    } else {
+      do {
+        RETURN_IF_ERROR(ParseFunctionCall(tool_calls));
+      } while (!AtEnd());
+    }
+    if (!AtEnd()) {
+      return Error("Unexpected trailing input");
+    }
+    return tool_calls;
+  }
+
+ private:
+  absl::Status Error(absl::string_view message) const {
     return absl::InvalidArgumentError(
-        absl::StrCat("Failed to parse Python tool calls: ", error_message));
+        absl::StrCat(message, " at offset ", pos_));
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() && absl::ascii_isspace(text_[pos_])) ++pos_;
+  }
+
+  bool AtEnd() {
+    SkipWhitespace();
+    return pos_ >= text_.size();
+  }
+
+  bool Peek(char c) {
+    SkipWhitespace();
+    return pos_ < text_.size() && text_[pos_] == c;
+  }
+
+  bool Consume(char c) {
+    if (!Peek(c)) return false;
+    ++pos_;
+    return true;
+  }
+
+  absl::Status Expect(char c) {
+    if (!Consume(c)) {
+      return Error(absl::StrCat("Expected '", absl::string_view(&c, 1), "'"));
+    }
+    return absl::OkStatus();
   }
 
-  nlohmann::ordered_json tool_calls_json = nlohmann::ordered_json::array();
-  for (const auto& tool_call : tool_calls.tool_calls) {
-    tool_calls_json.push_back(ConvertJsonValue(tool_call));
+  // Scans [a-zA-Z_][a-zA-Z0-9_]*, returns an empty view if there is none.
+  absl::string_view ScanWord() {
+    SkipWhitespace();
+    const size_t start = pos_;
+    if (pos_ < text_.size() && IsNameStart(text_[pos_])) {
+      while (pos_ < text_.size() && IsNameChar(text_[pos_])) ++pos_;
+    }
+    return text_.substr(start, pos_ - start);
+  }
+
+  absl::StatusOr<absl::string_view> ParseName() {
+    absl::string_view name = ScanWord();
+    if (name.empty() || name == "True" || name == "False" || name == "None") {
+      return Error("Expected a name");
+    }
+    return name;
+  }
+
+  absl::Status ParseFunctionCall(nlohmann::ordered_json& tool_calls) {
+    ASSIGN_OR_RETURN(absl::string_view name, ParseName());
+    RETURN_IF_ERROR(Expect('('));
+    nlohmann::ordered_json tool_call = nlohmann::ordered_json::object();
+    tool_call["name"] = std::string(name);
+    nlohmann::ordered_json arguments = nlohmann::ordered_json::object();
+    RETURN_IF_ERROR(ParseArguments(arguments));
+    tool_call["arguments"] = std::move(arguments);
+    tool_calls.push_back(std::move(tool_call));
+    return absl::OkStatus();
+  }
+
+  // Parses the keyword arguments following an opening parenthesis, up to and
+  // including the closing one, into `arguments`.
+  absl::Status ParseArguments(nlohmann::ordered_json& arguments) {
+    if (Consume(')')) return absl::OkStatus();
+    while (true) {
+      ASSIGN_OR_RETURN(absl::string_view name, ParseName());
+      std::string key(name);
+      if (arguments.contains(key)) {
+        return Error(absl::StrCat("Duplicate key: ", key));
+      }
+      RETURN_IF_ERROR(Expect('='));
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      arguments[std::move(key)] = std::move(value);
+      if (Consume(')')) return absl::OkStatus();
+      RETURN_IF_ERROR(Expect(','));
+      if (Consume(')')) return absl::OkStatus();
+    }
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseValue() {
+    SkipWhitespace();
+    if (pos_ >= text_.size()) {
+      return Error("Expected a value");
+    }
+    const char c = text_[pos_];
+    if (c == '"' || c == '\'') {
+      ASSIGN_OR_RETURN(absl::string_view value, ParseString());
+      return nlohmann::ordered_json(std::string(value));
+    }
+    if (c == '-' || c == '.' || absl::ascii_isdigit(c)) {
+      return ParseNumber();
+    }
+    if (c == '[') {
+      return ParseList();
+    }
+    if (c == '{') {
+      return ParseDict();
+    }
+    absl::string_view word = ScanWord();
+    if (word.empty()) {
+      return Error("Expected a value");
+    }
+    if (word == "True") return nlohmann::ordered_json(true);
+    if (word == "False") return nlohmann::ordered_json(false);
+    if (word == "None") return nlohmann::ordered_json(nullptr);
+    RETURN_IF_ERROR(Expect('('));
+    nlohmann::ordered_json object = nlohmann::ordered_json::object();
+    object["__type__"] = std::string(word);
+    RETURN_IF_ERROR(ParseArguments(object));
+    return object;
+  }
+
+  // Returns the content of a quoted string. Escape sequences are kept as is.
+  absl::StatusOr<absl::string_view> ParseString() {
+    const char quote = text_[pos_++];
+    const size_t start = pos_;
+    while (pos_ < text_.size()) {
+      if (text_[pos_] == '\\') {
+        pos_ += 2;
+      } else if (text_[pos_] == quote) {
+        return text_.substr(start, pos_++ - start);
+      } else {
+        ++pos_;
+      }
+    }
+    pos_ = start - 1;
+    return Error("Unterminated string");
+  }
+
+  // INT: '-'? [0-9]+
+  // FLOAT: '-'? [0-9]+ '.' [0-9]* | '-'? [0-9]* '.' [0-9]+
+  absl::StatusOr<nlohmann::ordered_json> ParseNumber() {
+    const size_t start = pos_;
+    if (text_[pos_] == '-') ++pos_;
+    const size_t int_digits = ScanDigits();
+    bool is_float = false;
+    if (pos_ < text_.size() && text_[pos_] == '.' &&
+        (int_digits > 0 ||
+         (pos_ + 1 < text_.size() && absl::ascii_isdigit(text_[pos_ + 1])))) {
+      ++pos_;
+      ScanDigits();
+      is_float = true;
+    }
+    absl::string_view number = text_.substr(start, pos_ - start);
+    if (is_float) {
+      double value;
+      if (!absl::SimpleAtod(number, &value)) {
+        return Error(absl::StrCat("Invalid float: ", number));
+      }
+      return nlohmann::ordered_json(value);
+    }
+    int64_t value;
+    if (int_digits == 0 || !absl::SimpleAtoi(number, &value)) {
+      return Error(absl::StrCat("Invalid int: ", number));
+    }
+    return nlohmann::ordered_json(value);
+  }
+
+  size_t ScanDigits() {
+    const size_t start = pos_;
+    while (pos_ < text_.size() && absl::ascii_isdigit(text_[pos_])) ++pos_;
+    return pos_ - start;
+  }
+
+  absl::StatusOr<nlohmann::ordered_json> ParseList() {
+    ++pos_;
+    nlohmann::ordered_json list = nlohmann::ordered_json::array();
+    if (Consume(']')) return list;
+    while (true) {
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      list.push_back(std::move(value));
+      if (Consume(']')) return list;
+      RETURN_IF_ERROR(Expect(','));
+      if (Consume(']')) return list;
+    }
+  }
+
+  // Duplicate keys are ignored, the first value wins.
+  absl::StatusOr<nlohmann::ordered_json> ParseDict() {
+    ++pos_;
+    nlohmann::ordered_json dict = nlohmann::ordered_json::object();
+    if (Consume('}')) return dict;
+    while (true) {
+      if (!Peek('"') && !Peek('\'')) {
+        return Error("Expected a string key");
+      }
+      ASSIGN_OR_RETURN(absl::string_view key, ParseString());
+      RETURN_IF_ERROR(Expect(':'));
+      ASSIGN_OR_RETURN(nlohmann::ordered_json value, ParseValue());
+      std::string key_str(key);
+      if (!dict.contains(key_str)) {
+        dict[std::move(key_str)] = std::move(value);
+      }
+      if (Consume('}')) return dict;
+      RETURN_IF_ERROR(Expect(','));
+      if (Consume('}')) return dict;
+    }
+  }
+
+  const absl::string_view text_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+absl::StatusOr<nlohmann::ordered_json> ParsePythonExpression(
+    absl::string_view text) {
+  if (text.empty()) {
+    return nlohmann::ordered_json::array();
+  }
+  auto tool_calls = PythonExpressionParser(text).Parse();
+  if (!tool_calls.ok()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Failed to parse Python tool calls: ",
+                     tool_calls.status().message()));
   }
-  return tool_calls_json;
+  return tool_calls;
 }
 
 }  // namespace litert::lm
@@ -353,4 +353,19 @@ TEST(PythonParserUtilsTest, InvalidArgExpression) {
               StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST(PythonParserUtilsTest, EscapedQuotesAreKeptInStrings) {
+  EXPECT_THAT(ParsePythonExpression(R"(function_name(x='it\'s'))"),
+              IsOkAndHolds(nlohmann::ordered_json::parse(R"json([{
+                "name": "function_name",
+                "arguments": {
+                  "x": "it\\'s"
+                }
+              }])json")));
+}
+
+TEST(PythonParserUtilsTest, DuplicateArgumentsAreInvalid) {
+  EXPECT_THAT(ParsePythonExpression("function_name(x=1, x=2)"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 }  // namespace
@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <cstring>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -33,6 +34,7 @@
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/sampling_cpu_util.h"
 #include "runtime/util/convert_tensor_buffer.h"
+#include "runtime/util/status_macros.h"  //NOLINT
 #include "runtime/util/tensor_buffer_util.h"
 
 namespace litert::lm {
@@ -88,6 +90,61 @@ absl::StatusOr<std::unique_ptr<TopPSampler>> TopPSampler::Create(
   return absl::WrapUnique(new TopPSampler(k, p, temperature, batch_size, seed));
 }
 
+absl::StatusOr<std::unique_ptr<TopPSampler>> TopPSampler::Create(
+    const proto::SamplerParameters& sampler_params, int batch_size) {
+  switch (sampler_params.type()) {
+    case proto::SamplerParameters::TOP_P:
+      break;
+    case proto::SamplerParameters::MIN_P:
+      if (sampler_params.min_p() < 0.0f || sampler_params.min_p() > 1.0f) {
+        return absl::InvalidArgumentError("min_p must be in [0, 1].");
+      }
+      break;
+    case proto::SamplerParameters::TYPICAL:
+      if (sampler_params.typical_p() < 0.0f ||
+          sampler_params.typical_p() > 1.0f) {
+        return absl::InvalidArgumentError("typical_p must be in [0, 1].");
+      }
+      break;
+    case proto::SamplerParameters::MIROSTAT:
+      if (sampler_params.mirostat_tau() < 0.0f ||
+          sampler_params.mirostat_eta() < 0.0f) {
+        return absl::InvalidArgumentError(
+            "mirostat_tau and mirostat_eta must be >= 0.");
+      }
+      break;
+    default:
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Unsupported sampler type for TopPSampler: ", sampler_params.type()));
+  }
+  ASSIGN_OR_RETURN(
+      auto sampler,
+      Create(sampler_params.k(), sampler_params.p(),
+             sampler_params.temperature(), batch_size, sampler_params.seed()));
+  RETURN_IF_ERROR(sampler->UpdateConfig(sampler_params, batch_size,
+                                        /*rand_gen=*/nullptr));
+  return sampler;
+}
+
+absl::StatusOr<std::vector<int>> TopPSampler::Sample(
+    absl::Span<const float> logits) {
+  switch (type_) {
+    case proto::SamplerParameters::MIN_P:
+      return TopKMinPSampling(logits, k_, min_p_, temperature_, generator_,
+                              batch_size_, sampled_scores_);
+    case proto::SamplerParameters::TYPICAL:
+      return TopKTypicalSampling(logits, k_, typical_p_, temperature_,
+                                 generator_, batch_size_, sampled_scores_);
+    case proto::SamplerParameters::MIROSTAT:
+      return TopKMirostatSampling(logits, k_, mirostat_tau_, mirostat_eta_,
+                                  temperature_, generator_, batch_size_,
+                                  mirostat_mu_, sampled_scores_);
+    default:
+      return TopKTopPSampling(logits, k_, p_, temperature_, generator_,
+                              batch_size_, sampled_scores_);
+  }
+}
+
 absl::Status TopPSampler::SampleToIdAndScoreBuffer(
     const TensorBuffer& logits_tensor, TensorBuffer& ids_tensor,
     TensorBuffer* scores_tensor) {
@@ -127,12 +184,20 @@ absl::Status TopPSampler::SampleToIdAndScoreBuffer(
         "Unsupported logits data type for sampler.");
   }
 
-  std::vector<float> sampled_scores;
-  auto sampled_ids = TopKTopPSampling(logits_data_span, k_, p_, temperature_,
-                                      generator_, batch_size_, sampled_scores);
+  auto sampled_ids = Sample(logits_data_span);
   if (!sampled_ids.ok()) {
     return sampled_ids.status();
   }
+  if (num_top_logprobs_.has_value()) {
+    // Computed before handling the inputs below, as the next decode step may
+    // overwrite the logits.
+    RETURN_IF_ERROR(ComputeLogProbs(
+        logits_data_span, *sampled_ids, *num_top_logprobs_, batch_size_,
+        last_logprobs_.sampled_logprobs, last_logprobs_.top_token_ids,
+        last_logprobs_.top_logprobs));
+    last_logprobs_.num_top_logprobs =
+        last_logprobs_.top_token_ids.size() / batch_size_;
+  }
   ids_tensor.Write(absl::MakeConstSpan(*sampled_ids));
   if (scores_tensor != nullptr) {
     status = ValidateTensor(*scores_tensor, /*max_num_dims=*/1, batch_size_,
@@ -143,10 +208,15 @@ absl::Status TopPSampler::SampleToIdAndScoreBuffer(
     std::vector<float> scores(batch_size_);
     for (int i = 0; i < batch_size_; ++i) {
       // The scores are the log of the probability of the sampled token.
-      scores[i] = std::log(sampled_scores[i]);
+      scores[i] = std::log(sampled_scores_[i]);
     }
     scores_tensor->Write(absl::MakeConstSpan(scores));
   }
+  if (HandlesInput()) {
+    // The logits of the current step are no longer needed, so the next decode
+    // step can overwrite them.
+    return HandleInputsAndRunInference(*sampled_ids);
+  }
   return absl::OkStatus();
 }
 
@@ -157,10 +227,185 @@ absl::Status TopPSampler::UpdateConfig(
   p_ = sampler_params.p();
   temperature_ = sampler_params.temperature();
   batch_size_ = batch_size;
+  switch (sampler_params.type()) {
+    case proto::SamplerParameters::MIN_P:
+    case proto::SamplerParameters::TYPICAL:
+    case proto::SamplerParameters::MIROSTAT:
+      type_ = sampler_params.type();
+      break;
+    default:
+      type_ = proto::SamplerParameters::TOP_P;
+      break;
+  }
+  min_p_ = sampler_params.min_p();
+  typical_p_ = sampler_params.typical_p();
+  mirostat_tau_ = sampler_params.mirostat_tau();
+  mirostat_eta_ = sampler_params.mirostat_eta();
+  mirostat_mu_.clear();
   if (rand_gen != nullptr) {
     generator_ = rand_gen;
   }
   return absl::OkStatus();
 }
 
+absl::Status TopPSampler::SetNumTopLogProbs(
+    std::optional<int> num_top_logprobs) {
+  if (num_top_logprobs.has_value() && *num_top_logprobs < 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "num_top_logprobs must be >= 0, but got ", *num_top_logprobs));
+  }
+  num_top_logprobs_ = num_top_logprobs;
+  last_logprobs_ = SampledLogProbs();
+  return absl::OkStatus();
+}
+
+absl::Status TopPSampler::SetInputTensorsAndInferenceFunc(
+    const TensorBuffer* ids_tensor,
+    const TensorBuffer* prev_input_positions_tensor,
+    const TensorBuffer* input_positions_tensor,
+    const TensorBuffer* prev_mask_tensor, const TensorBuffer* mask_tensor,
+    int (*run_inference_func)(void* arg), void* arg) {
+  if (run_inference_func == nullptr) {
+    input_ids_tensor_ = nullptr;
+    prev_input_positions_tensor_ = nullptr;
+    input_positions_tensor_ = nullptr;
+    prev_mask_tensor_ = nullptr;
+    mask_tensor_ = nullptr;
+    run_inference_func_ = nullptr;
+    run_inference_arg_ = nullptr;
+    return absl::OkStatus();
+  }
+
+  if (ids_tensor == nullptr || prev_input_positions_tensor == nullptr ||
+      input_positions_tensor == nullptr) {
+    return absl::InvalidArgumentError(
+        "Input ids and input positions tensors must be provided to handle "
+        "inputs.");
+  }
+  if ((prev_mask_tensor == nullptr) != (mask_tensor == nullptr)) {
+    return absl::InvalidArgumentError(
+        "Previous and current mask tensors must be provided together.");
+  }
+  if (mask_tensor != nullptr) {
+    LITERT_ASSIGN_OR_RETURN(auto mask_type, mask_tensor->TensorType());
+    if (mask_type.Layout().Rank() != 4) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Attention mask must be 4D, but got ", mask_type.Layout().Rank()));
+    }
+  }
+
+  // The caller owns the tensors and expects the sampler to fill them.
+  input_ids_tensor_ = const_cast<TensorBuffer*>(ids_tensor);
+  prev_input_positions_tensor_ =
+      const_cast<TensorBuffer*>(prev_input_positions_tensor);
+  input_positions_tensor_ = const_cast<TensorBuffer*>(input_positions_tensor);
+  prev_mask_tensor_ = const_cast<TensorBuffer*>(prev_mask_tensor);
+  mask_tensor_ = const_cast<TensorBuffer*>(mask_tensor);
+  run_inference_func_ = run_inference_func;
+  run_inference_arg_ = arg;
+  return absl::OkStatus();
+}
+
+absl::Status TopPSampler::HandleInputsAndRunInference(
+    absl::Span<const int> sampled_ids) {
+  // The input positions of the next step are one-incremented from the previous
+  // ones. The positions tensor has either a single position shared by all
+  // batches or one position per batch at a fixed stride.
+  LITERT_ASSIGN_OR_RETURN(auto pos_size,
+                          prev_input_positions_tensor_->PackedSize());
+  const int num_positions = pos_size / sizeof(int32_t);
+  const int stride = num_positions >= batch_size_
+                         ? num_positions / batch_size_
+                         : 0;  // A single position shared by all batches.
+  std::vector<int32_t> positions(num_positions);
+  {
+    LITERT_ASSIGN_OR_RETURN(
+        auto prev_pos_lock_and_addr,
+        TensorBufferScopedLock::Create(*prev_input_positions_tensor_,
+                                       TensorBuffer::LockMode::kRead));
+    std::memcpy(positions.data(), prev_pos_lock_and_addr.second, pos_size);
+  }
+  std::vector<int32_t> next_positions(batch_size_);
+  for (int i = 0; i < batch_size_; ++i) {
+    next_positions[i] = positions[i * stride] + 1;
+  }
+
+  // At the end of the context there is no next step to run ahead. The input
+  // handling is dropped instead, so that the executor fills the inputs of the
+  // next decode, and rejects it, by itself.
+  if (mask_tensor_ != nullptr) {
+    LITERT_ASSIGN_OR_RETURN(auto mask_type, mask_tensor_->TensorType());
+    const int mask_batch_size = mask_type.Layout().Dimensions()[0];
+    const int channel_size = mask_type.Layout().Dimensions()[3];
+    for (int b = 0; b < mask_batch_size; ++b) {
+      const int position = next_positions[b < batch_size_ ? b : 0];
+      if (position < 0 || position >= channel_size) {
+        return SetInputTensorsAndInferenceFunc(nullptr, nullptr, nullptr,
+                                               nullptr, nullptr, nullptr,
+                                               nullptr);
+      }
+    }
+  }
+
+  // The sampled ids are the input tokens of the next step.
+  LITERT_RETURN_IF_ERROR(input_ids_tensor_->Write(sampled_ids));
+
+  for (int i = 0; i < batch_size_; ++i) {
+    positions[i * stride] = next_positions[i];
+  }
+  LITERT_RETURN_IF_ERROR(
+      input_positions_tensor_->Write(absl::MakeConstSpan(positions)));
+
+  // The attention mask of the next step is the previous one plus the newly
+  // visible position of each batch.
+  if (mask_tensor_ != nullptr) {
+    LITERT_ASSIGN_OR_RETURN(auto mask_type, mask_tensor_->TensorType());
+    LITERT_ASSIGN_OR_RETURN(auto mask_size, mask_tensor_->PackedSize());
+    const int mask_batch_size = mask_type.Layout().Dimensions()[0];
+    size_t element_size;
+    switch (mask_type.ElementType()) {
+      case ElementType::Bool:
+        element_size = sizeof(bool);
+        break;
+      case ElementType::Float32:
+        element_size = sizeof(float);
+        break;
+      case ElementType::Float16:
+        element_size = sizeof(uint16_t);
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            "Unsupported attention mask data type.");
+    }
+    LITERT_ASSIGN_OR_RETURN(
+        auto prev_mask_lock_and_addr,
+        TensorBufferScopedLock::Create(*prev_mask_tensor_,
+                                       TensorBuffer::LockMode::kRead));
+    LITERT_ASSIGN_OR_RETURN(
+        auto mask_lock_and_addr,
+        TensorBufferScopedLock::Create(*mask_tensor_,
+                                       TensorBuffer::LockMode::kWrite));
+    auto* mask_ptr = static_cast<char*>(mask_lock_and_addr.second);
+    std::memcpy(mask_ptr, prev_mask_lock_and_addr.second, mask_size);
+    const size_t batch_offset = mask_size / mask_batch_size;
+    for (int b = 0; b < mask_batch_size; ++b) {
+      const int position = next_positions[b < batch_size_ ? b : 0];
+      char* visible = mask_ptr + b * batch_offset + position * element_size;
+      if (mask_type.ElementType() == ElementType::Bool) {
+        *reinterpret_cast<bool*>(visible) = true;
+      } else {
+        // 0.0 is all-zero bits in both float32 and float16.
+        std::memset(visible, 0, element_size);
+      }
+    }
+  }
+
+  int error_code = run_inference_func_(run_inference_arg_);
+  if (error_code != 0) {
+    return absl::Status(static_cast<absl::StatusCode>(error_code),
+                        "Failed to run inference for the next decode step.");
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace litert::lm
@@ -16,11 +16,13 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_COMPONENTS_TOP_P_CPU_SAMPLER_H_
 
 #include <memory>
+#include <optional>
 #include <random>
 #include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/sampler.h"
 #include "runtime/proto/sampler_params.pb.h"
@@ -39,6 +41,12 @@ class TopPSampler : public Sampler {
                                                              int batch_size,
                                                              int seed);
 
+  // Creates a sampler of the type given in `sampler_params`, which must be one
+  // of TOP_P, MIN_P, TYPICAL or MIROSTAT. All of them run on the same top-k
+  // candidates and differ only in how the candidates are truncated.
+  static absl::StatusOr<std::unique_ptr<TopPSampler>> Create(
+      const proto::SamplerParameters& sampler_params, int batch_size);
+
   // Given a batch of logits, samples a batch of token ids.
   // The expected shape of the logits is [batch_size, vocab_size].
   // The output ids_tensor is a 1D litert::TensorBuffer of shape [batch_size].
@@ -49,11 +57,35 @@ class TopPSampler : public Sampler {
                                         TensorBuffer& ids_tensor,
                                         TensorBuffer* scores_tensor) override;
 
-  // Updates the configs of the sampler.
+  // Updates the configs of the sampler. Sampler types other than MIN_P,
+  // TYPICAL and MIROSTAT fall back to TOP_P. The Mirostat state is reset.
   absl::Status UpdateConfig(
       const proto::SamplerParameters& sampler_params, int batch_size,
       std::shared_ptr<std::default_random_engine> rand_gen) override;
 
+  // The CPU sampler can prepare the decode inputs of the next step in place,
+  // i.e. write the sampled ids as the next input tokens, increment the input
+  // positions and extend the attention mask by one position, then run the
+  // next decode step before returning the sampled ids of the current step.
+  bool CanHandleInput() const override { return true; }
+
+  bool HandlesInput() const override { return run_inference_func_ != nullptr; }
+
+  absl::Status SetInputTensorsAndInferenceFunc(
+      const TensorBuffer* ids_tensor,
+      const TensorBuffer* prev_input_positions_tensor,
+      const TensorBuffer* input_positions_tensor,
+      const TensorBuffer* prev_mask_tensor, const TensorBuffer* mask_tensor,
+      int (*run_inference_func)(void* arg), void* arg) override;
+
+  // The log-probabilities are computed over the full vocab from the same
+  // logits used for sampling, i.e. before temperature, top-k and top-p.
+  absl::Status SetNumTopLogProbs(std::optional<int> num_top_logprobs) override;
+
+  const SampledLogProbs* GetLastLogProbs() const override {
+    return num_top_logprobs_.has_value() ? &last_logprobs_ : nullptr;
+  }
+
  private:
   explicit TopPSampler(int k, float p, float temperature, int batch_size,
                        int seed)
@@ -61,6 +93,9 @@ class TopPSampler : public Sampler {
     generator_ = std::make_shared<std::default_random_engine>(seed);
   }
 
+  // Samples a batch of ids from the logits with the configured sampling type.
+  absl::StatusOr<std::vector<int>> Sample(absl::Span<const float> logits);
+
   // The parameters for the sampler.
   int k_;
   float p_;
@@ -68,9 +103,43 @@ class TopPSampler : public Sampler {
   int batch_size_;
   std::shared_ptr<std::default_random_engine> generator_;
 
+  // The sampling type and its specific parameters. See SamplerParameters.
+  proto::SamplerParameters::Type type_ = proto::SamplerParameters::TOP_P;
+  float min_p_ = 0.0f;
+  float typical_p_ = 1.0f;
+  float mirostat_tau_ = 0.0f;
+  float mirostat_eta_ = 0.0f;
+
+  // The running maximum surprise of each batch for MIROSTAT sampling. Empty
+  // until the first sampling call.
+  std::vector<float> mirostat_mu_;
+
+  // Fills the decode input tensors for the next step from the sampled ids and
+  // the previous input tensors, then runs inference for the next step.
+  absl::Status HandleInputsAndRunInference(absl::Span<const int> sampled_ids);
+
   // The logits data to be used for sampling. Having it as a member to avoid
   // re-allocating the vector for each sampling call.
   std::vector<float> logits_data_;
+
+  // The scores of the sampled ids. Having it as a member to avoid re-allocating
+  // the vector for each sampling call.
+  std::vector<float> sampled_scores_;
+
+  // The number of top alternatives to report log-probabilities for. Unset
+  // disables the log-probability computation.
+  std::optional<int> num_top_logprobs_;
+  SampledLogProbs last_logprobs_;
+
+  // Decode input tensors set by SetInputTensorsAndInferenceFunc(). They are
+  // owned by the caller and valid only while run_inference_func_ is not null.
+  TensorBuffer* input_ids_tensor_ = nullptr;
+  TensorBuffer* prev_input_positions_tensor_ = nullptr;
+  TensorBuffer* input_positions_tensor_ = nullptr;
+  TensorBuffer* prev_mask_tensor_ = nullptr;
+  TensorBuffer* mask_tensor_ = nullptr;
+  int (*run_inference_func_)(void* arg) = nullptr;
+  void* run_inference_arg_ = nullptr;
 };
 
 }  // namespace litert::lm
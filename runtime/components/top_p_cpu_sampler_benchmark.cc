@@ -0,0 +1,81 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmarks for TopPSampler, including the tensor buffer round trip
+// around the sampling kernels.
+//
+// bazel run -c opt //runtime/components:top_p_cpu_sampler_benchmark
+
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/top_p_cpu_sampler.h"
+#include "runtime/util/convert_tensor_buffer.h"
+
+namespace litert::lm {
+namespace {
+
+// Args: vocab_size, k, batch_size, num_top_logprobs. A negative
+// num_top_logprobs disables the log-probabilities.
+void BM_TopPSampler_SampleToIdAndScoreBuffer(benchmark::State& state) {
+  const int vocab_size = state.range(0);
+  const int k = state.range(1);
+  const int batch_size = state.range(2);
+  const std::optional<int> num_top_logprobs =
+      state.range(3) >= 0 ? std::make_optional<int>(state.range(3))
+                          : std::nullopt;
+
+  auto sampler = TopPSampler::Create(k, /*p=*/0.95f, /*temperature=*/0.8f,
+                                     batch_size, /*seed=*/0);
+  if (!sampler.ok() || !(*sampler)->SetNumTopLogProbs(num_top_logprobs).ok()) {
+    state.SkipWithError("Failed to create the sampler.");
+    return;
+  }
+
+  std::default_random_engine rng(/*seed=*/0);
+  std::normal_distribution<float> dist(0.0f, 4.0f);
+  std::vector<float> logits(batch_size * vocab_size);
+  for (float& logit : logits) {
+    logit = dist(rng);
+  }
+  auto logits_tensor =
+      CopyToTensorBuffer<float>(logits, {batch_size, vocab_size});
+  auto ids_tensor = CreateTensorBuffer<int>({batch_size});
+  auto scores_tensor = CreateTensorBuffer<float>({batch_size});
+  if (!logits_tensor || !ids_tensor || !scores_tensor) {
+    state.SkipWithError("Failed to create the tensor buffers.");
+    return;
+  }
+
+  for (auto _ : state) {
+    auto status = (*sampler)->SampleToIdAndScoreBuffer(
+        *logits_tensor, *ids_tensor, &(*scores_tensor));
+    benchmark::DoNotOptimize(status);
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+BENCHMARK(BM_TopPSampler_SampleToIdAndScoreBuffer)
+    ->ArgNames({"vocab", "k", "batch", "top_n"})
+    ->ArgsProduct({{32000, 128000, 262144}, {1, 40}, {1, 4}, {-1}})
+    ->Args({262144, 40, 1, 0})
+    ->Args({262144, 40, 1, 5});
+
+}  // namespace
+}  // namespace litert::lm
+
+BENCHMARK_MAIN();
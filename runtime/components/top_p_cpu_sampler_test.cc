@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <cstring>
 #include <limits>
+#include <optional>
 #include <utility>
 #include <vector>
 
@@ -33,12 +34,16 @@
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/proto/sampler_params.pb.h"
 #include "runtime/util/convert_tensor_buffer.h"  // IWYU pragma: keep
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
 #include "tflite/types/half.h"  // from @litert
 
 namespace litert::lm {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+using ::testing::SizeIs;
 
 Expected<TensorBuffer> CopyFp16ToTensorBuffer(absl::Span<const float> data,
                                               absl::Span<const int> dims) {
@@ -82,6 +87,31 @@ TEST(TopPSamplerTest, CreateWithNegativeTemp) {
               testing::HasSubstr("Temperature must be >= 0"));
 }
 
+TEST(TopPSamplerTest, CreateFromSamplerParams) {
+  proto::SamplerParameters sampler_params;
+  sampler_params.set_type(proto::SamplerParameters::MIROSTAT);
+  sampler_params.set_k(40);
+  sampler_params.set_temperature(1.0);
+  sampler_params.set_mirostat_tau(5.0);
+  sampler_params.set_mirostat_eta(0.1);
+  EXPECT_TRUE(TopPSampler::Create(sampler_params, /*batch_size=*/1).ok());
+}
+
+TEST(TopPSamplerTest, CreateFromSamplerParamsWithInvalidParams) {
+  proto::SamplerParameters sampler_params;
+  sampler_params.set_type(proto::SamplerParameters::MIN_P);
+  sampler_params.set_k(40);
+  sampler_params.set_temperature(1.0);
+  sampler_params.set_min_p(2.0);
+  auto sampler_or = TopPSampler::Create(sampler_params, /*batch_size=*/1);
+  EXPECT_FALSE(sampler_or.ok());
+  EXPECT_THAT(sampler_or.status().message(),
+              testing::HasSubstr("min_p must be in [0, 1]"));
+
+  sampler_params.set_type(proto::SamplerParameters::GREEDY);
+  EXPECT_FALSE(TopPSampler::Create(sampler_params, /*batch_size=*/1).ok());
+}
+
 TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_IdsOnly_BatchSize2) {
   auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
                                         /*batch_size=*/2, /*seed=*/1);
@@ -201,6 +231,82 @@ TEST(TopPSamplerTest, SampleToIdAndScoreBufferFp16_BatchSize2) {
   EXPECT_THAT(*scores, ElementsAre(std::log(1.0f), std::log(1.0f)));
 }
 
+TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_LogProbs_BatchSize2) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/2, /*seed=*/1);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+  // Log-probabilities are not computed by default.
+  EXPECT_EQ(sampler->GetLastLogProbs(), nullptr);
+  EXPECT_FALSE(sampler->SetNumTopLogProbs(-1).ok());
+  ASSERT_TRUE(sampler->SetNumTopLogProbs(2).ok());
+
+  // Probabilities of batch 0: {1/8, 1/8, 4/8, 2/8}.
+  // Probabilities of batch 1: e/(3+e) for id 1 and 1/(3+e) for the others.
+  const std::vector<float> logits = {std::log(1.0f), std::log(1.0f),
+                                     std::log(4.0f), std::log(2.0f),
+                                     0.0f,           1.0f,
+                                     0.0f,           0.0f};
+  auto logits_tensor = CopyToTensorBuffer<float>(logits, {2, 4});
+  ASSERT_TRUE(logits_tensor.HasValue());
+  std::vector<int> ids_vector(2);
+  auto ids_tensor =
+      CopyToTensorBuffer<int>(absl::MakeConstSpan(ids_vector), {2});
+  ASSERT_TRUE(ids_tensor.HasValue());
+  EXPECT_OK(sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                              /*scores_tensor=*/nullptr));
+  auto ids = CopyFromTensorBuffer<int>(*ids_tensor);
+  ASSERT_TRUE(ids.HasValue());
+  EXPECT_THAT(*ids, ElementsAre(2, 1));
+
+  const SampledLogProbs* logprobs = sampler->GetLastLogProbs();
+  ASSERT_NE(logprobs, nullptr);
+  EXPECT_EQ(logprobs->num_top_logprobs, 2);
+  const float batch1_logprob = 1.0f - std::log(3.0f + std::exp(1.0f));
+  EXPECT_THAT(logprobs->sampled_logprobs,
+              Pointwise(FloatNear(1e-5), {std::log(0.5f), batch1_logprob}));
+  ASSERT_THAT(logprobs->top_token_ids, SizeIs(4));
+  EXPECT_EQ(logprobs->top_token_ids[0], 2);
+  EXPECT_EQ(logprobs->top_token_ids[1], 3);
+  EXPECT_EQ(logprobs->top_token_ids[2], 1);
+  EXPECT_NEAR(logprobs->top_logprobs[0], std::log(0.5f), 1e-5);
+  EXPECT_NEAR(logprobs->top_logprobs[1], std::log(0.25f), 1e-5);
+  EXPECT_NEAR(logprobs->top_logprobs[2], batch1_logprob, 1e-5);
+
+  // Unsetting disables the computation again.
+  ASSERT_TRUE(sampler->SetNumTopLogProbs(std::nullopt).ok());
+  EXPECT_EQ(sampler->GetLastLogProbs(), nullptr);
+}
+
+TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_SampledLogProbsOnly) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/1, /*seed=*/1);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+  ASSERT_TRUE(sampler->SetNumTopLogProbs(0).ok());
+
+  // Probabilities: {1/8, 1/8, 4/8, 2/8}.
+  const std::vector<float> logits = {std::log(1.0f), std::log(1.0f),
+                                     std::log(4.0f), std::log(2.0f)};
+  auto logits_tensor = CopyToTensorBuffer<float>(logits, {1, 4});
+  ASSERT_TRUE(logits_tensor.HasValue());
+  std::vector<int> ids_vector(1);
+  auto ids_tensor =
+      CopyToTensorBuffer<int>(absl::MakeConstSpan(ids_vector), {1});
+  ASSERT_TRUE(ids_tensor.HasValue());
+  EXPECT_OK(sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                              /*scores_tensor=*/nullptr));
+
+  // Only the log-probability of the sampled id is reported.
+  const SampledLogProbs* logprobs = sampler->GetLastLogProbs();
+  ASSERT_NE(logprobs, nullptr);
+  EXPECT_EQ(logprobs->num_top_logprobs, 0);
+  EXPECT_THAT(logprobs->sampled_logprobs,
+              Pointwise(FloatNear(1e-5), {std::log(0.5f)}));
+  EXPECT_THAT(logprobs->top_token_ids, SizeIs(0));
+  EXPECT_THAT(logprobs->top_logprobs, SizeIs(0));
+}
+
 TEST(TopPSamplerTest, UpdateConfig) {
   auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
                                         /*batch_size=*/1, /*seed=*/2);
@@ -252,5 +358,151 @@ TEST(TopPSamplerTest, UpdateConfig) {
   EXPECT_NE(ids.Value()[0], 4);
 }
 
+TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_MinP_BatchSize2) {
+  proto::SamplerParameters sampler_params;
+  sampler_params.set_type(proto::SamplerParameters::MIN_P);
+  sampler_params.set_k(4);
+  sampler_params.set_temperature(1.0);
+  // Only the most likely token of each batch is kept.
+  sampler_params.set_min_p(1.0);
+  sampler_params.set_seed(1);
+  auto sampler_or = TopPSampler::Create(sampler_params, /*batch_size=*/2);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+
+  const std::vector<float> logits = {0.0, 0.0, 10.0, 0.0, 11.0, 12.0, 1.0, 2.0};
+  auto logits_tensor = CopyToTensorBuffer<float>(logits, {2, 4});
+
+  std::vector<int> ids_vector(2);
+  auto ids_tensor =
+      CopyToTensorBuffer<int>(absl::MakeConstSpan(ids_vector), {2});
+  auto status = sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                                  /*scores_tensor=*/nullptr);
+  EXPECT_TRUE(status.ok());
+
+  auto ids = CopyFromTensorBuffer<int>(*ids_tensor);
+  ASSERT_TRUE(ids.HasValue());
+  EXPECT_THAT(*ids, ElementsAre(2, 1));
+}
+
+TEST(TopPSamplerTest, UpdateConfig_SamplerType) {
+  auto sampler_or = TopPSampler::Create(/*k=*/8, /*p=*/1.0,
+                                        /*temperature=*/100.0,
+                                        /*batch_size=*/1, /*seed=*/2);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+
+  // With a target surprise of 0, Mirostat only keeps the most likely token.
+  proto::SamplerParameters sampler_params;
+  sampler_params.set_type(proto::SamplerParameters::MIROSTAT);
+  sampler_params.set_k(8);
+  sampler_params.set_temperature(100.0);
+  sampler_params.set_mirostat_tau(0.0);
+  sampler_params.set_mirostat_eta(0.1);
+  auto status = sampler->UpdateConfig(sampler_params,
+                                      /*batch_size=*/1, nullptr);
+  ASSERT_TRUE(status.ok());
+
+  const std::vector<float> logits = {0.0, 0.0, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0};
+  auto logits_tensor = CopyToTensorBuffer<float>(logits, {1, 8});
+  std::vector<int> ids_vector(1);
+  auto ids_tensor =
+      CopyToTensorBuffer<int>(absl::MakeConstSpan(ids_vector), {1});
+  ASSERT_TRUE(ids_tensor.HasValue());
+
+  status = sampler->SampleToIdAndScoreBuffer(*logits_tensor,
+                                              ids_tensor.Value(),
+                                              /*scores_tensor=*/nullptr);
+  ASSERT_TRUE(status.ok());
+  auto ids = CopyFromTensorBuffer<int>(ids_tensor.Value());
+  ASSERT_TRUE(ids.HasValue());
+  EXPECT_EQ(ids.Value()[0], 4);
+}
+
+TEST(TopPSamplerTest, CanHandleInput) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/1, /*seed=*/1);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+  EXPECT_TRUE(sampler->CanHandleInput());
+  EXPECT_FALSE(sampler->HandlesInput());
+}
+
+int CountInferenceCalls(void* arg) {
+  ++*static_cast<int*>(arg);
+  return 0;
+}
+
+TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_HandlesInput_BatchSize2) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/2, /*seed=*/1);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+
+  auto input_ids = CopyToTensorBuffer<int>({0, 0}, {2, 1});
+  auto prev_input_pos = CopyToTensorBuffer<int>({3, 3}, {2});
+  auto input_pos = CopyToTensorBuffer<int>({0, 0}, {2});
+  // Mask of step 3 with a context length of 6, i.e. positions 0-3 visible.
+  auto prev_mask = CopyToTensorBuffer<float>(
+      {0, 0, 0, 0, -1, -1, 0, 0, 0, 0, -1, -1}, {2, 1, 1, 6});
+  auto mask = CopyToTensorBuffer<float>(
+      {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1}, {2, 1, 1, 6});
+  int num_inference_calls = 0;
+  ASSERT_OK(sampler->SetInputTensorsAndInferenceFunc(
+      &*input_ids, &*prev_input_pos, &*input_pos, &*prev_mask, &*mask,
+      CountInferenceCalls, &num_inference_calls));
+  EXPECT_TRUE(sampler->HandlesInput());
+
+  const std::vector<float> logits = {0.0, 0.0, 10.0, 0.0, 11.0, 12.0, 1.0, 2.0};
+  auto logits_tensor = CopyToTensorBuffer<float>(logits, {2, 4});
+  auto ids_tensor = CopyToTensorBuffer<int>({0, 0}, {2});
+  ASSERT_OK(sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                              /*scores_tensor=*/nullptr));
+
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*ids_tensor), ElementsAre(2, 1));
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*input_ids), ElementsAre(2, 1));
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*input_pos), ElementsAre(4, 4));
+  EXPECT_THAT(*CopyFromTensorBuffer<float>(*mask),
+              ElementsAre(0, 0, 0, 0, 0, -1, 0, 0, 0, 0, 0, -1));
+  EXPECT_EQ(num_inference_calls, 1);
+
+  // Resetting the input handling stops running inference.
+  ASSERT_OK(sampler->SetInputTensorsAndInferenceFunc(
+      nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr));
+  EXPECT_FALSE(sampler->HandlesInput());
+  ASSERT_OK(sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                              /*scores_tensor=*/nullptr));
+  EXPECT_EQ(num_inference_calls, 1);
+}
+
+TEST(TopPSamplerTest, SampleToIdAndScoreBuffer_HandlesInput_EndOfContext) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/1, /*seed=*/1);
+  ASSERT_TRUE(sampler_or.ok());
+  auto sampler = *std::move(sampler_or);
+
+  auto input_ids = CopyToTensorBuffer<int>({0}, {1, 1});
+  auto prev_input_pos = CopyToTensorBuffer<int>({3}, {1});
+  auto input_pos = CopyToTensorBuffer<int>({0}, {1});
+  auto prev_mask = CopyToTensorBuffer<float>({0, 0, 0, 0}, {1, 1, 1, 4});
+  auto mask = CopyToTensorBuffer<float>({0, 0, 0, 0}, {1, 1, 1, 4});
+  int num_inference_calls = 0;
+  ASSERT_OK(sampler->SetInputTensorsAndInferenceFunc(
+      &*input_ids, &*prev_input_pos, &*input_pos, &*prev_mask, &*mask,
+      CountInferenceCalls, &num_inference_calls));
+
+  // The sampled token is valid even though there is no room for the next
+  // step, which is then left to the executor.
+  auto logits_tensor = CopyToTensorBuffer<float>({0.0, 1.0}, {1, 2});
+  auto ids_tensor = CopyToTensorBuffer<int>({0}, {1});
+  ASSERT_OK(sampler->SampleToIdAndScoreBuffer(*logits_tensor, *ids_tensor,
+                                              /*scores_tensor=*/nullptr));
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*ids_tensor), ElementsAre(1));
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*input_ids), ElementsAre(0));
+  EXPECT_THAT(*CopyFromTensorBuffer<int>(*input_pos), ElementsAre(0));
+  EXPECT_EQ(num_inference_calls, 0);
+  EXPECT_FALSE(sampler->HandlesInput());
+}
+
 }  // namespace
 }  // namespace litert::lm
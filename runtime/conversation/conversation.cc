@@ -35,6 +35,7 @@
 #include "runtime/components/constrained_decoding/constraint_provider.h"
 #include "runtime/components/constrained_decoding/constraint_provider_config.h"
 #include "runtime/components/constrained_decoding/constraint_provider_factory.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/components/prompt_template.h"
 #include "runtime/conversation/internal_callback_util.h"
 #include "runtime/conversation/io_types.h"
@@ -43,6 +44,7 @@
 #include "runtime/conversation/model_data_processor/model_data_processor_factory.h"
 #include "runtime/conversation/prompt_utils.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/proto/llm_model_type.pb.h"
@@ -271,15 +273,26 @@ absl::StatusOr<std::unique_ptr<Conversation>> Conversation::Create(
   if (!std::holds_alternative<JsonPreface>(config.GetPreface())) {
     return absl::InvalidArgumentError("Only JsonPreface is supported for now.");
   }
-  ASSIGN_OR_RETURN(std::unique_ptr<Engine::Session> session,
-                   engine.CreateSession(config.GetSessionConfig()));
   ASSIGN_OR_RETURN(
       std::unique_ptr<ModelDataProcessor> model_data_processor,
       CreateModelDataProcessor(config.GetProcessorConfig(), config.GetPreface(),
                                &engine.GetTokenizer(),
-                               session->GetSessionConfig().GetStopTokenIds(),
+                               config.GetSessionConfig().GetStopTokenIds(),
                                config.constrained_decoding_enabled(),
                                config.GetPromptTemplate().GetCapabilities()));
+  // Streamed chunks are cut at the tool call boundaries, so that the text
+  // before a tool call and the tool call itself are not held back.
+  SessionConfig session_config = config.GetSessionConfig();
+  std::vector<std::string>& flush_strings =
+      session_config.GetMutableStreamingChunkPolicy().flush_strings;
+  for (absl::string_view code_fence : {model_data_processor->CodeFenceStart(),
+                                       model_data_processor->CodeFenceEnd()}) {
+    if (!code_fence.empty()) {
+      flush_strings.emplace_back(code_fence);
+    }
+  }
+  ASSIGN_OR_RETURN(std::unique_ptr<Engine::Session> session,
+                   engine.CreateSession(session_config));
   std::unique_ptr<ConstraintProvider> constraint_provider;
   if (config.constraint_provider_config().has_value()) {
     ASSIGN_OR_RETURN(
@@ -368,7 +381,8 @@ absl::StatusOr<Message> Conversation::SendMessage(const Message& message,
       const auto session_inputs,
       model_data_processor_->ToInputDataVector(
           single_turn_text, nlohmann::ordered_json::array({json_message}),
-          optional_args.args.value_or(std::monostate())));
+          optional_args.args.value_or(std::monostate()),
+          optional_args.attachments));
   RETURN_IF_ERROR(IgnoreEmptyInputError(session_->RunPrefill(session_inputs)));
   if (is_appending_message_) {
     return JsonMessage();
@@ -413,7 +427,8 @@ absl::Status Conversation::SendMessageAsync(
       const auto session_inputs,
       model_data_processor_->ToInputDataVector(
           single_turn_text, nlohmann::ordered_json::array({json_message}),
-          optional_args.args.value_or(std::monostate())));
+          optional_args.args.value_or(std::monostate()),
+          optional_args.attachments));
 
   absl::AnyInvocable<void(Message)> complete_message_callback =
       [this](const Message& complete_message) {
@@ -528,6 +543,30 @@ absl::StatusOr<BenchmarkInfo*> Conversation::GetMutableBenchmarkInfo() {
   return session_->GetMutableBenchmarkInfo();
 }
 
+absl::StatusOr<MetricsSnapshot> Conversation::GetMetricsSnapshot() const {
+  std::vector<MetricSnapshot> metrics;
+  absl::StatusOr<MetricsSnapshot> engine_snapshot =
+      engine_.GetMetricsSnapshot();
+  if (engine_snapshot.ok()) {
+    metrics = engine_snapshot->metrics();
+  } else if (!absl::IsUnimplemented(engine_snapshot.status())) {
+    return engine_snapshot.status();
+  }
+  const SilenceTrimmingStats silence_trimming_stats =
+      model_data_processor_->GetAudioSilenceTrimmingStats();
+  metrics.push_back(
+      {.name = "litert_lm_audio_samples_total",
+       .help = "Audio samples passed to the silence trimming.",
+       .type = MetricType::kCounter,
+       .value = silence_trimming_stats.num_input_samples});
+  metrics.push_back(
+      {.name = "litert_lm_audio_silence_removed_samples_total",
+       .help = "Audio samples removed as silence.",
+       .type = MetricType::kCounter,
+       .value = silence_trimming_stats.num_removed_samples});
+  return MetricsSnapshot(std::move(metrics));
+}
+
 void Conversation::CancelProcess() { session_->CancelProcess(); }
 
 void Conversation::CancelGroup(absl::string_view task_group_id) {
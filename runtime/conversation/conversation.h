@@ -37,6 +37,7 @@
 #include "runtime/conversation/model_data_processor/config_registry.h"
 #include "runtime/conversation/model_data_processor/model_data_processor.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/util/status_macros.h"
@@ -306,6 +307,13 @@ struct OptionalArgs {
   // context only applies to a single message and is merged with the extra
   // context provided in the Preface, overwriting existing keys.
   std::optional<nlohmann::ordered_json> extra_context = std::nullopt;
+
+  // The binary media referenced by the content items of the message, e.g.
+  // {"type": "image", "attachment": 0}. The attachments are only read while
+  // the message is converted into the model inputs, i.e. before SendMessage or
+  // SendMessageAsync returns, and are passed to the preprocessors without being
+  // copied or base64 encoded.
+  std::vector<MediaAttachment> attachments;
 };
 
 // A multi-turn centric stateful Conversation API for high-level user
@@ -467,6 +475,14 @@ class Conversation {
   // - The mutable benchmark info for the conversation.
   absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo();
 
+  // Returns a snapshot of the metrics of the engine, if it collects any,
+  // followed by the metrics of the preprocessing of the conversation:
+  // - litert_lm_audio_samples_total: The audio samples passed to the silence
+  //   trimming.
+  // - litert_lm_audio_silence_removed_samples_total: The audio samples
+  //   removed as silence.
+  absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const;
+
   // Cancels the ongoing inference process, for asynchronous inference.
   // Note: the underlying Session is not rollbacked, so the message
   // from the user is actually sent to the LLM and processed for prefill.
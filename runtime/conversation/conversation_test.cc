@@ -47,6 +47,7 @@
 #include "runtime/conversation/io_types.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -1223,6 +1224,33 @@ TEST_P(ConversationTest, GetBenchmarkInfo) {
             prefill_preface_on_init_ ? 3 : 2);
 }
 
+TEST_P(ConversationTest, GetMetricsSnapshot) {
+  auto mock_engine = CreateMockEngine(CreateMockSession());
+  ASSERT_OK_AND_ASSIGN(
+      auto conversation_config,
+      ConversationConfig::Builder()
+          .SetSessionConfig(session_config_)
+          .SetOverwritePromptTemplate(PromptTemplate(kTestJinjaPromptTemplate))
+          .Build(*mock_engine));
+  ASSERT_OK_AND_ASSIGN(auto conversation,
+                       Conversation::Create(*mock_engine, conversation_config));
+
+  // The mock engine does not collect metrics, so only the metrics of the
+  // conversation are reported.
+  ASSERT_OK_AND_ASSIGN(const MetricsSnapshot snapshot,
+                       conversation->GetMetricsSnapshot());
+  EXPECT_EQ(snapshot.metrics().size(), 2);
+  const MetricSnapshot* input_samples =
+      snapshot.Find("litert_lm_audio_samples_total");
+  ASSERT_NE(input_samples, nullptr);
+  EXPECT_EQ(input_samples->type, MetricType::kCounter);
+  EXPECT_EQ(input_samples->value, 0);
+  const MetricSnapshot* removed_samples =
+      snapshot.Find("litert_lm_audio_silence_removed_samples_total");
+  ASSERT_NE(removed_samples, nullptr);
+  EXPECT_EQ(removed_samples->value, 0);
+}
+
 TEST_P(ConversationTest, CancelGroupWithSendMessageAsync) {
   // Set up mock Session.
   auto mock_session = CreateMockSession();
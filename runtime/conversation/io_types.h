@@ -19,6 +19,7 @@
 #include <variant>
 
 #include "nlohmann/json.hpp"  // from @nlohmann_json
+#include "runtime/engine/io_types.h"
 
 namespace litert::lm {
 
@@ -47,6 +48,18 @@ struct JsonPreface {
 // conversation.
 using Preface = std::variant<JsonPreface>;
 
+// MediaAttachment is a binary image or audio buffer passed alongside a message
+// instead of being embedded into the message as a base64 "blob". A content item
+// refers to an attachment by its index in the list of attachments sent with
+// the message:
+//
+//   {"type": "image", "attachment": 0}
+//
+// An image attachment holds the encoded image bytes or an already preprocessed
+// image tensor. An audio attachment holds the encoded audio bytes, the mono PCM
+// frames, or an already preprocessed audio tensor.
+using MediaAttachment = std::variant<InputImage, InputAudio>;
+
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CONVERSATION_IO_TYPES_H_
@@ -14,19 +14,48 @@
 
 #include "runtime/conversation/model_data_processor/data_utils.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <variant>
+#include <vector>
 
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/escaping.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
+#include "runtime/conversation/io_types.h"
+#include "runtime/engine/io_types.h"
 #include "runtime/util/memory_mapped_file.h"
+#include "runtime/util/status_macros.h"
 
 namespace litert::lm {
 
 using ::nlohmann::ordered_json;
 
+namespace {
+
+// Returns the attachment index referenced by the item, if any.
+absl::StatusOr<std::optional<size_t>> GetAttachmentIndex(
+    const ordered_json& item) {
+  if (!item.is_object() || !item.contains("attachment")) {
+    return std::nullopt;
+  }
+  const ordered_json& index = item["attachment"];
+  if (!index.is_number_integer() || index.get<int64_t>() < 0) {
+    return absl::InvalidArgumentError(
+        "Attachment must be a non-negative integer index.");
+  }
+  return index.get<size_t>();
+}
+
+}  // namespace
+
 absl::StatusOr<std::unique_ptr<MemoryMappedFile>> LoadItemData(
     const ordered_json& item) {
   if (!item.contains("type")) {
@@ -55,4 +84,84 @@ absl::StatusOr<std::unique_ptr<MemoryMappedFile>> LoadItemData(
                                   item["type"].get<std::string>());
 }
 
+absl::StatusOr<const MediaAttachment*> GetItemAttachment(
+    const ordered_json& item, absl::Span<const MediaAttachment> attachments) {
+  ASSIGN_OR_RETURN(std::optional<size_t> index, GetAttachmentIndex(item));
+  if (!index.has_value()) {
+    return nullptr;
+  }
+  if (*index >= attachments.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Attachment index ", *index, " is out of range, only ",
+                     attachments.size(), " attachments are provided."));
+  }
+  const MediaAttachment& attachment = attachments[*index];
+  const std::string type = item.value("type", "");
+  if (type == "image" && !std::holds_alternative<InputImage>(attachment)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Attachment ", *index, " is not an image."));
+  }
+  if (type == "audio" && !std::holds_alternative<InputAudio>(attachment)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Attachment ", *index, " is not an audio."));
+  }
+  return &attachment;
+}
+
+absl::StatusOr<std::vector<MediaAttachment>> CreateMediaAttachments(
+    const ordered_json& messages, std::vector<std::string> buffers) {
+  // The item type referencing each buffer, if any.
+  std::vector<std::optional<std::string>> types(buffers.size());
+  auto visit_message = [&](const ordered_json& message) -> absl::Status {
+    if (!message.is_object() || !message.contains("content") ||
+        !message["content"].is_array()) {
+      return absl::OkStatus();
+    }
+    for (const auto& item : message["content"]) {
+      ASSIGN_OR_RETURN(std::optional<size_t> index, GetAttachmentIndex(item));
+      if (!index.has_value()) {
+        continue;
+      }
+      if (*index >= buffers.size()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Attachment index ", *index, " is out of range, only ",
+            buffers.size(), " attachments are provided."));
+      }
+      const std::string type = item.value("type", "");
+      if (type != "image" && type != "audio") {
+        return absl::InvalidArgumentError(
+            "Only image and audio items can reference an attachment.");
+      }
+      if (types[*index].has_value() && *types[*index] != type) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Attachment ", *index, " is referenced as both image and audio."));
+      }
+      types[*index] = type;
+    }
+    return absl::OkStatus();
+  };
+  if (messages.is_array()) {
+    for (const auto& message : messages) {
+      RETURN_IF_ERROR(visit_message(message));
+    }
+  } else {
+    RETURN_IF_ERROR(visit_message(messages));
+  }
+
+  std::vector<MediaAttachment> attachments;
+  attachments.reserve(buffers.size());
+  for (size_t i = 0; i < buffers.size(); ++i) {
+    if (!types[i].has_value()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Attachment ", i, " is not referenced by any item."));
+    }
+    if (*types[i] == "image") {
+      attachments.emplace_back(InputImage(std::move(buffers[i])));
+    } else {
+      attachments.emplace_back(InputAudio(std::move(buffers[i])));
+    }
+  }
+  return attachments;
+}
+
 }  // namespace litert::lm
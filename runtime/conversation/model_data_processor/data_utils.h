@@ -16,9 +16,13 @@
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CONVERSATION_MODEL_DATA_PROCESSOR_DATA_UTILS_H_
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json_fwd.hpp"  // from @nlohmann_json
+#include "runtime/conversation/io_types.h"
 #include "runtime/util/memory_mapped_file.h"
 
 namespace litert::lm {
@@ -56,6 +60,27 @@ namespace litert::lm {
 absl::StatusOr<std::unique_ptr<MemoryMappedFile>> LoadItemData(
     const nlohmann::ordered_json& item);
 
+// Returns the media attachment referenced by the given image or audio item,
+// or nullptr if the item does not reference an attachment. The expected item
+// content is:
+//  {
+//    "type": "image",
+//    "attachment": 0,
+//  }
+// where "attachment" is the index of the attachment in `attachments`. Returns
+// an error if the index is out of range, or if the attachment type does not
+// match the item type.
+absl::StatusOr<const MediaAttachment*> GetItemAttachment(
+    const nlohmann::ordered_json& item,
+    absl::Span<const MediaAttachment> attachments);
+
+// Wraps the raw encoded media buffers into media attachments, typed after the
+// items of `messages` referencing them. This is used by the language bindings
+// which only pass byte buffers. Returns an error if a buffer is not referenced
+// by any image or audio item.
+absl::StatusOr<std::vector<MediaAttachment>> CreateMediaAttachments(
+    const nlohmann::ordered_json& messages, std::vector<std::string> buffers);
+
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CONVERSATION_MODEL_DATA_PROCESSOR_DATA_UTILS_H_
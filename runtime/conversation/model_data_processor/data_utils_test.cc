@@ -19,12 +19,16 @@
 #include <ios>
 #include <memory>
 #include <string>
+#include <variant>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
+#include "runtime/conversation/io_types.h"
+#include "runtime/engine/io_types.h"
 #include "runtime/util/memory_mapped_file.h"
 #include "runtime/util/test_utils.h"  // NOLINT
 
@@ -138,5 +142,81 @@ TEST(DataUtilsTest, LoadItemData_ToolResponseItem) {
   EXPECT_EQ(memory_mapped_file, nullptr);
 }
 
+TEST(DataUtilsTest, GetItemAttachment_NoAttachment) {
+  std::vector<MediaAttachment> attachments;
+  attachments.emplace_back(InputImage("image bytes"));
+  ASSERT_OK_AND_ASSIGN(
+      const MediaAttachment* attachment,
+      GetItemAttachment({{"type", "image"}, {"path", "/path/to/image"}},
+                        attachments));
+  EXPECT_EQ(attachment, nullptr);
+}
+
+TEST(DataUtilsTest, GetItemAttachment_ImageAndAudio) {
+  std::vector<MediaAttachment> attachments;
+  attachments.emplace_back(InputImage("image bytes"));
+  attachments.emplace_back(InputAudio(std::vector<float>{0.1f, 0.2f}));
+
+  ASSERT_OK_AND_ASSIGN(
+      const MediaAttachment* image,
+      GetItemAttachment({{"type", "image"}, {"attachment", 0}}, attachments));
+  EXPECT_EQ(image, &attachments[0]);
+  ASSERT_OK_AND_ASSIGN(
+      const MediaAttachment* audio,
+      GetItemAttachment({{"type", "audio"}, {"attachment", 1}}, attachments));
+  EXPECT_EQ(audio, &attachments[1]);
+}
+
+TEST(DataUtilsTest, GetItemAttachment_InvalidReference) {
+  std::vector<MediaAttachment> attachments;
+  attachments.emplace_back(InputImage("image bytes"));
+
+  EXPECT_THAT(
+      GetItemAttachment({{"type", "image"}, {"attachment", 1}}, attachments)
+          .status(),
+      testing::status::StatusIs(absl::StatusCode::kInvalidArgument,
+                                testing::HasSubstr("out of range")));
+  EXPECT_THAT(
+      GetItemAttachment({{"type", "image"}, {"attachment", -1}}, attachments)
+          .status(),
+      testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      GetItemAttachment({{"type", "audio"}, {"attachment", 0}}, attachments)
+          .status(),
+      testing::status::StatusIs(absl::StatusCode::kInvalidArgument,
+                                testing::HasSubstr("is not an audio")));
+}
+
+TEST(DataUtilsTest, CreateMediaAttachments) {
+  const ordered_json message = {
+      {"role", "user"},
+      {"content",
+       {{{"type", "audio"}, {"attachment", 1}},
+        {{"type", "text"}, {"text", "Describe."}},
+        {{"type", "image"}, {"attachment", 0}}}}};
+  ASSERT_OK_AND_ASSIGN(
+      std::vector<MediaAttachment> attachments,
+      CreateMediaAttachments(message, {"image bytes", "audio bytes"}));
+  ASSERT_EQ(attachments.size(), 2);
+  ASSERT_TRUE(std::holds_alternative<InputImage>(attachments[0]));
+  ASSERT_OK_AND_ASSIGN(absl::string_view image_bytes,
+                       std::get<InputImage>(attachments[0]).GetRawImageBytes());
+  EXPECT_EQ(image_bytes, "image bytes");
+  ASSERT_TRUE(std::holds_alternative<InputAudio>(attachments[1]));
+  ASSERT_OK_AND_ASSIGN(absl::string_view audio_bytes,
+                       std::get<InputAudio>(attachments[1]).GetRawAudioBytes());
+  EXPECT_EQ(audio_bytes, "audio bytes");
+}
+
+TEST(DataUtilsTest, CreateMediaAttachments_UnreferencedBuffer) {
+  const ordered_json message = {
+      {"role", "user"},
+      {"content", {{{"type", "image"}, {"attachment", 0}}}}};
+  EXPECT_THAT(
+      CreateMediaAttachments(message, {"image bytes", "extra bytes"}).status(),
+      testing::status::StatusIs(absl::StatusCode::kInvalidArgument,
+                                testing::HasSubstr("not referenced")));
+}
+
 }  // namespace
 }  // namespace litert::lm
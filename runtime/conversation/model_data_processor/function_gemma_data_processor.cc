@@ -27,6 +27,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint.h"
 #if !defined(LITERT_LM_FST_CONSTRAINTS_DISABLED)
@@ -296,7 +297,8 @@ absl::StatusOr<std::vector<InputData>>
 FunctionGemmaDataProcessor::ToInputDataVectorImpl(
     const std::string& rendered_template_prompt,
     const nlohmann::ordered_json& messages,
-    const FunctionGemmaDataProcessorArguments& args) const {
+    const FunctionGemmaDataProcessorArguments& args,
+    absl::Span<const MediaAttachment> attachments) const {
   std::vector<InputData> input_data;
   input_data.push_back(InputText(rendered_template_prompt));
   return input_data;
@@ -25,6 +25,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint.h"
 #if !defined(LITERT_LM_FST_CONSTRAINTS_DISABLED)
@@ -98,7 +99,8 @@ class FunctionGemmaDataProcessor
   absl::StatusOr<std::vector<InputData>> ToInputDataVectorImpl(
       const std::string& rendered_template_prompt,
       const nlohmann::ordered_json& messages,
-      const FunctionGemmaDataProcessorArguments& args) const override;
+      const FunctionGemmaDataProcessorArguments& args,
+      absl::Span<const MediaAttachment> attachments) const override;
 
   absl::StatusOr<Message> ToMessageImpl(
       const Responses& responses,
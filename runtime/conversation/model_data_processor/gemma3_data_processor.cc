@@ -28,6 +28,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "nlohmann/json_fwd.hpp"  // from @nlohmann_json
 #include "litert/cc/litert_layout.h"  // from @litert
@@ -68,6 +69,13 @@ bool IsAudio(absl::string_view part) {
   return part == "<start_of_audio>" || part == "<audio_soft_token>";
 }
 
+// An image or audio item of the messages. The data is either loaded from the
+// item path or blob, or read in place from a caller-provided attachment.
+struct MediaItem {
+  std::unique_ptr<MemoryMappedFile> file;
+  const MediaAttachment* attachment = nullptr;
+};
+
 bool HasToolCalls(const ordered_json& message) {
   return message.contains("tool_calls") && message["tool_calls"].is_array();
 }
@@ -114,6 +122,14 @@ absl::StatusOr<std::string> FormatToolResponse(
   return FormatValueAsPython(tool_response[tool_response_key]);
 }
 
+absl::StatusOr<std::unique_ptr<AudioPreprocessorMiniAudio>>
+CreateAudioPreprocessor(const Gemma3DataProcessorConfig& config) {
+  AudioPreprocessorConfig audio_preprocessor_config =
+      AudioPreprocessorConfig::CreateDefaultUsmConfig();
+  audio_preprocessor_config.SetSilenceTrimming(config.audio_silence_trimming);
+  return AudioPreprocessorMiniAudio::Create(audio_preprocessor_config);
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<Gemma3DataProcessor>>
@@ -127,9 +143,7 @@ Gemma3DataProcessor::Create(Gemma3DataProcessorConfig config,
     return absl::FailedPreconditionError(
         "Constrained decoding was disabled at build time.");
   }
-  ASSIGN_OR_RETURN(auto audio_preprocessor,
-                   AudioPreprocessorMiniAudio::Create(
-                       AudioPreprocessorConfig::CreateDefaultUsmConfig()));
+  ASSIGN_OR_RETURN(auto audio_preprocessor, CreateAudioPreprocessor(config));
   return absl::WrapUnique(new Gemma3DataProcessor(
       config, preface, std::make_unique<StbImagePreprocessor>(),
       std::move(audio_preprocessor)));
@@ -167,9 +181,7 @@ Gemma3DataProcessor::Create(Gemma3DataProcessorConfig config,
     }
     constraint_provider.reset(provider);
   }
-  ASSIGN_OR_RETURN(auto audio_preprocessor,
-                   AudioPreprocessorMiniAudio::Create(
-                       AudioPreprocessorConfig::CreateDefaultUsmConfig()));
+  ASSIGN_OR_RETURN(auto audio_preprocessor, CreateAudioPreprocessor(config));
   return absl::WrapUnique(new Gemma3DataProcessor(
       std::move(constraint_provider), config, preface,
       std::make_unique<StbImagePreprocessor>(), std::move(audio_preprocessor)));
@@ -253,10 +265,11 @@ absl::StatusOr<ordered_json> Gemma3DataProcessor::MessageToTemplateInput(
 absl::StatusOr<std::vector<InputData>>
 Gemma3DataProcessor::ToInputDataVectorImpl(
     const std::string& rendered_template_prompt, const ordered_json& messages,
-    const Gemma3DataProcessorArguments& args) const {
+    const Gemma3DataProcessorArguments& args,
+    absl::Span<const MediaAttachment> attachments) const {
   std::vector<InputData> input_data;
-  std::deque<std::unique_ptr<MemoryMappedFile>> image_files;
-  std::deque<std::unique_ptr<MemoryMappedFile>> audio_files;
+  std::deque<MediaItem> image_files;
+  std::deque<MediaItem> audio_files;
   // Find all images and audio contained in the messages.
   for (const auto& message : messages) {
     if (message.contains("content") && message["content"].is_array()) {
@@ -264,12 +277,16 @@ Gemma3DataProcessor::ToInputDataVectorImpl(
         if (item.is_string()) {
           continue;
         }
-        ASSIGN_OR_RETURN(std::unique_ptr<MemoryMappedFile> mmap_file,
-                         LoadItemData(item));
+        MediaItem media_item;
+        ASSIGN_OR_RETURN(media_item.attachment,
+                         GetItemAttachment(item, attachments));
+        if (media_item.attachment == nullptr) {
+          ASSIGN_OR_RETURN(media_item.file, LoadItemData(item));
+        }
         if (item["type"] == "image") {
-          image_files.push_back(std::move(mmap_file));
+          image_files.push_back(std::move(media_item));
         } else if (item["type"] == "audio") {
-          audio_files.push_back(std::move(mmap_file));
+          audio_files.push_back(std::move(media_item));
         }
       }
     }
@@ -300,13 +317,28 @@ Gemma3DataProcessor::ToInputDataVectorImpl(
       }
       auto image_file = std::move(image_files.front());
       image_files.pop_front();
-      ASSIGN_OR_RETURN(auto preprocessed_image,
-                       image_preprocessor_->Preprocess(
-                           InputImage(std::string(
-                               static_cast<const char*>(image_file->data()),
-                               image_file->length())),
-                           image_params));
-      input_data.emplace_back(InputImage(std::move(preprocessed_image)));
+      if (image_file.attachment != nullptr) {
+        // Attachments are read in place, and passed through as is if already
+        // preprocessed.
+        const auto& image = std::get<InputImage>(*image_file.attachment);
+        if (image.IsTensorBuffer() || image.IsTensorBufferMap()) {
+          ASSIGN_OR_RETURN(auto image_copy, image.CreateCopy());
+          input_data.emplace_back(std::move(image_copy));
+        } else {
+          ASSIGN_OR_RETURN(auto preprocessed_image,
+                           image_preprocessor_->Preprocess(image, image_params));
+          input_data.emplace_back(InputImage(std::move(preprocessed_image)));
+        }
+      } else {
+        ASSIGN_OR_RETURN(auto preprocessed_image,
+                         image_preprocessor_->Preprocess(
+                             InputImage(std::string(
+                                 static_cast<const char*>(
+                                     image_file.file->data()),
+                                 image_file.file->length())),
+                             image_params));
+        input_data.emplace_back(InputImage(std::move(preprocessed_image)));
+      }
       input_data.emplace_back(InputText("\n\n"));
     } else if (IsAudio(part)) {
       input_data.emplace_back(
@@ -317,12 +349,26 @@ Gemma3DataProcessor::ToInputDataVectorImpl(
       }
       auto audio_file = std::move(audio_files.front());
       audio_files.pop_front();
-      ASSIGN_OR_RETURN(auto preprocessed_audio,
-                       audio_preprocessor_->Preprocess(InputAudio(std::string(
-                           static_cast<const char*>(audio_file->data()),
-                           audio_file->length()))));
-      audio_preprocessor_->Reset();
-      input_data.emplace_back(InputAudio(std::move(preprocessed_audio)));
+      if (audio_file.attachment != nullptr) {
+        const auto& audio = std::get<InputAudio>(*audio_file.attachment);
+        if (audio.IsTensorBuffer()) {
+          ASSIGN_OR_RETURN(auto audio_copy, audio.CreateCopy());
+          input_data.emplace_back(std::move(audio_copy));
+        } else {
+          ASSIGN_OR_RETURN(auto preprocessed_audio,
+                           audio_preprocessor_->Preprocess(audio));
+          audio_preprocessor_->Reset();
+          input_data.emplace_back(InputAudio(std::move(preprocessed_audio)));
+        }
+      } else {
+        ASSIGN_OR_RETURN(auto preprocessed_audio,
+                         audio_preprocessor_->Preprocess(InputAudio(
+                             std::string(static_cast<const char*>(
+                                             audio_file.file->data()),
+                                         audio_file.file->length()))));
+        audio_preprocessor_->Reset();
+        input_data.emplace_back(InputAudio(std::move(preprocessed_audio)));
+      }
       input_data.emplace_back(InputAudioEnd());
       input_data.emplace_back(InputText("\n\n"));
     }
@@ -532,9 +578,7 @@ absl::Status Gemma3DataProcessor::CloneStateImpl(
       static_cast<const Gemma3DataProcessor&>(other);
   if (other_gemma3_data_processor.audio_preprocessor_ != nullptr) {
     if (audio_preprocessor_ == nullptr) {
-      ASSIGN_OR_RETURN(audio_preprocessor_,
-                       AudioPreprocessorMiniAudio::Create(
-                           AudioPreprocessorConfig::CreateDefaultUsmConfig()));
+      ASSIGN_OR_RETURN(audio_preprocessor_, CreateAudioPreprocessor(config_));
     }
     *static_cast<AudioPreprocessorMiniAudio*>(audio_preprocessor_.get()) =
         *static_cast<AudioPreprocessorMiniAudio*>(
@@ -24,6 +24,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint.h"
 #if !defined(LITERT_LM_FST_CONSTRAINTS_DISABLED)
@@ -31,6 +32,7 @@
 #endif
 #include "runtime/components/preprocessor/audio_preprocessor.h"
 #include "runtime/components/preprocessor/image_preprocessor.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/components/prompt_template.h"
 #include "runtime/components/tokenizer.h"
 #include "runtime/conversation/io_types.h"
@@ -75,6 +77,12 @@ class Gemma3DataProcessor
   // Returns the end of tool call blocks.
   absl::string_view CodeFenceEnd() const override;
 
+  SilenceTrimmingStats GetAudioSilenceTrimmingStats() const override {
+    return audio_preprocessor_ != nullptr
+               ? audio_preprocessor_->GetSilenceTrimmingStats()
+               : SilenceTrimmingStats();
+  }
+
  private:
 #if defined(LITERT_LM_FST_CONSTRAINTS_DISABLED)
   explicit Gemma3DataProcessor(
@@ -105,7 +113,8 @@ class Gemma3DataProcessor
   absl::StatusOr<std::vector<InputData>> ToInputDataVectorImpl(
       const std::string& rendered_template_prompt,
       const nlohmann::ordered_json& messages,
-      const Gemma3DataProcessorArguments& args) const override;
+      const Gemma3DataProcessorArguments& args,
+      absl::Span<const MediaAttachment> attachments) const override;
 
   absl::StatusOr<Message> ToMessageImpl(
       const Responses& responses,
@@ -15,8 +15,11 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CONVERSATION_MODEL_DATA_PROCESSOR_GEMMA3_ARGUMENTS_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CONVERSATION_MODEL_DATA_PROCESSOR_GEMMA3_ARGUMENTS_H_
 
+#include <optional>
 #include <string>
 
+#include "runtime/components/preprocessor/silence_trimmer.h"
+
 namespace litert::lm {
 
 // Config for Gemma3DataProcessor.
@@ -33,6 +36,9 @@ struct Gemma3DataProcessorConfig {
   std::string boa_token = "<start_of_audio>";
   // The string for end of audio token.
   std::string eoa_token = "<end_of_audio>";
+  // The silence trimming applied to the audio before it is preprocessed. The
+  // audio is kept as is if not set.
+  std::optional<SilenceTrimmingConfig> audio_silence_trimming;
 
   // Tool call parsing configuration.
   std::string code_fence_start = "```tool_code\n";
@@ -1045,6 +1045,78 @@ TEST_F(Gemma3DataProcessorTest, ToInputDataVectorTextAndAudio) {
                   HasInputText(&expected_text3)));
 }
 
+TEST_F(Gemma3DataProcessorTest, ToInputDataVectorWithAttachments) {
+  ASSERT_OK_AND_ASSIGN(auto processor, Gemma3DataProcessor::Create(
+                                           /*Gemma3DataProcessorConfig=*/
+                                           {.image_tensor_height = 224,
+                                            .image_tensor_width = 128}));
+  const std::string rendered_template_prompt =
+      "<start_of_turn>user\nHere is an image "
+      "<start_of_image> and an audio <start_of_audio><end_of_turn>";
+
+  std::string image_path = (std::filesystem::path(::testing::SrcDir()) /
+                            kImageTestdataDir / "apple.png")
+                               .string();
+  std::string audio_path = (std::filesystem::path(::testing::SrcDir()) /
+                            kTestdataDir / "audio_sample.wav")
+                               .string();
+  std::vector<MediaAttachment> attachments;
+  attachments.emplace_back(InputAudio(ReadFile(audio_path)));
+  attachments.emplace_back(InputImage(ReadFile(image_path)));
+  const nlohmann::ordered_json message = {
+      {"role", "user"},
+      {"content",
+       {{{"type", "text"}, {"text", "Here is an image "}},
+        {{"type", "image"}, {"attachment", 1}},
+        {{"type", "text"}, {"text", " and an audio "}},
+        {{"type", "audio"}, {"attachment", 0}}}}};
+  ASSERT_OK_AND_ASSIGN(
+      const std::vector<InputData> input_data,
+      processor->ToInputDataVector(rendered_template_prompt,
+                                   json::array({message}), {}, attachments));
+
+  InputText expected_text1(
+      "<start_of_turn>user\nHere is an image \n\n<start_of_image>");
+  StbImagePreprocessor image_preprocessor;
+  ImagePreprocessParameter image_params;
+  image_params.SetTargetDimensions(Dimensions({1, 224, 128, 3}));
+  ASSERT_OK_AND_ASSIGN(InputImage expected_image,
+                       image_preprocessor.Preprocess(
+                           InputImage(ReadFile(image_path)), image_params));
+  InputText expected_text2("\n\n");
+  InputText expected_text3(" and an audio \n\n<start_of_audio>");
+  ASSERT_OK_AND_ASSIGN(auto audio_preprocessor,
+                       AudioPreprocessorMiniAudio::Create(
+                           AudioPreprocessorConfig::CreateDefaultUsmConfig()));
+  ASSERT_OK_AND_ASSIGN(
+      InputAudio expected_audio,
+      audio_preprocessor->Preprocess(InputAudio(ReadFile(audio_path))));
+  InputText expected_text4("<end_of_turn>");
+  EXPECT_THAT(input_data,
+              ElementsAre(HasInputText(&expected_text1),
+                          HasInputImage(&expected_image),
+                          HasInputText(&expected_text2),
+                          HasInputText(&expected_text3),
+                          HasInputAudio(&expected_audio), HasInputAudioEnd(),
+                          HasInputText(&expected_text2),
+                          HasInputText(&expected_text4)));
+}
+
+TEST_F(Gemma3DataProcessorTest, ToInputDataVectorWithMismatchedAttachment) {
+  ASSERT_OK_AND_ASSIGN(auto processor, Gemma3DataProcessor::Create());
+  const std::string rendered_template_prompt =
+      "<start_of_turn>user\n<start_of_image><end_of_turn>";
+  std::vector<MediaAttachment> attachments;
+  attachments.emplace_back(InputAudio(std::vector<float>{0.0f, 0.1f}));
+  const nlohmann::ordered_json message = {
+      {"role", "user"},
+      {"content", {{{"type", "image"}, {"attachment", 0}}}}};
+  EXPECT_THAT(processor->ToInputDataVector(rendered_template_prompt,
+                                           json::array({message}), {},
+                                           attachments),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(Gemma3DataProcessorTest, PromptTemplateToInputDataVectorTextAndAudio) {
   const std::string test_file_path =
       GetTestdataPath("google-gemma-3n-e2b-it.jinja");
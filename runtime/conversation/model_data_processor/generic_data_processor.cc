@@ -22,6 +22,7 @@
 #include "absl/memory/memory.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json_fwd.hpp"  // from @nlohmann_json
 #include "runtime/components/prompt_template.h"
 #include "runtime/conversation/io_types.h"
@@ -42,7 +43,8 @@ absl::StatusOr<std::vector<InputData>>
 GenericDataProcessor::ToInputDataVectorImpl(
     const std::string& rendered_template_prompt,
     const nlohmann::ordered_json& messages,
-    const GenericDataProcessorArguments& args) const {
+    const GenericDataProcessorArguments& args,
+    absl::Span<const MediaAttachment> attachments) const {
   std::vector<InputData> input_data;
   input_data.emplace_back(InputText(rendered_template_prompt));
   return input_data;
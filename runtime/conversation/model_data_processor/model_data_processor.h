@@ -24,8 +24,10 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json.hpp"  // from @nlohmann_json
 #include "runtime/components/constrained_decoding/constraint.h"
+#include "runtime/components/preprocessor/silence_trimmer.h"
 #include "runtime/components/prompt_template.h"
 #include "runtime/conversation/io_types.h"
 #include "runtime/conversation/model_data_processor/config_registry.h"
@@ -49,11 +51,22 @@ class ModelDataProcessor {
   virtual ~ModelDataProcessor() = default;
 
   // Converts a rendered template prompt and a list of messages to a vector of
-  // InputData, which is the input to the LLM Session.
+  // InputData, which is the input to the LLM Session. Content items of the
+  // messages may refer to the given media attachments by index.
   virtual absl::StatusOr<std::vector<InputData>> ToInputDataVector(
       const std::string& rendered_template_prompt,
       const nlohmann::ordered_json& messages,
-      const DataProcessorArguments& args) const = 0;
+      const DataProcessorArguments& args,
+      absl::Span<const MediaAttachment> attachments) const = 0;
+
+  // Same as above, for messages without media attachments.
+  absl::StatusOr<std::vector<InputData>> ToInputDataVector(
+      const std::string& rendered_template_prompt,
+      const nlohmann::ordered_json& messages,
+      const DataProcessorArguments& args) const {
+    return ToInputDataVector(rendered_template_prompt, messages, args,
+                             /*attachments=*/{});
+  }
 
   // Converts a list of responses from the LLM Session to a Message, which is
   // the output to the user.
@@ -117,6 +130,13 @@ class ModelDataProcessor {
 
   // Clones the state of the other model data processor.
   virtual absl::Status CloneState(const ModelDataProcessor& other) = 0;
+
+  // Returns the number of audio samples preprocessed and removed by the
+  // silence trimming since the creation of the model data processor. Empty if
+  // the model data processor does not trim the silence of its audio.
+  virtual SilenceTrimmingStats GetAudioSilenceTrimmingStats() const {
+    return SilenceTrimmingStats();
+  }
 };
 
 // TypeSafeModelDataProcessor is a ModelDataProcessor that expects a specific
@@ -128,18 +148,22 @@ class ModelDataProcessor {
 template <typename ExpectedConfigT, typename ExpectedArgsT>
 class TypeSafeModelDataProcessor : public ModelDataProcessor {
  public:
+  using ModelDataProcessor::ToInputDataVector;
+
   // Converts a rendered template prompt and a list of messages to a vector of
   // InputData, with arguments type validated.
   absl::StatusOr<std::vector<InputData>> ToInputDataVector(
       const std::string& rendered_template_prompt,
       const nlohmann::ordered_json& messages,
-      const DataProcessorArguments& args) const final {
+      const DataProcessorArguments& args,
+      absl::Span<const MediaAttachment> attachments) const final {
     if (std::holds_alternative<ExpectedArgsT>(args)) {
       return this->ToInputDataVectorImpl(rendered_template_prompt, messages,
-                                         std::get<ExpectedArgsT>(args));
+                                         std::get<ExpectedArgsT>(args),
+                                         attachments);
     } else if (std::holds_alternative<std::monostate>(args)) {
       return this->ToInputDataVectorImpl(rendered_template_prompt, messages,
-                                         ExpectedArgsT{});
+                                         ExpectedArgsT{}, attachments);
     }
     return absl::InvalidArgumentError(
         "DataProcessorArguments does not hold the expected type");
@@ -177,8 +201,8 @@ class TypeSafeModelDataProcessor : public ModelDataProcessor {
  private:
   virtual absl::StatusOr<std::vector<InputData>> ToInputDataVectorImpl(
       const std::string& rendered_template_prompt,
-      const nlohmann::ordered_json& messages,
-      const ExpectedArgsT& typed_args) const = 0;
+      const nlohmann::ordered_json& messages, const ExpectedArgsT& typed_args,
+      absl::Span<const MediaAttachment> attachments) const = 0;
 
   virtual absl::StatusOr<Message> ToMessageImpl(
       const Responses& responses, const ExpectedArgsT& typed_args) const = 0;
@@ -24,6 +24,7 @@
 #include "absl/memory/memory.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json_fwd.hpp"  // from @nlohmann_json
 #include "runtime/components/tool_use/parser_utils.h"
 #include "runtime/conversation/io_types.h"
@@ -58,7 +59,8 @@ absl::StatusOr<std::vector<InputData>>
 Qwen3DataProcessor::ToInputDataVectorImpl(
     const std::string& rendered_template_prompt,
     const nlohmann::ordered_json& messages,
-    const Qwen3DataProcessorArguments& args) const {
+    const Qwen3DataProcessorArguments& args,
+    absl::Span<const MediaAttachment> attachments) const {
   std::vector<InputData> input_data;
   input_data.emplace_back(InputText(rendered_template_prompt));
   return input_data;
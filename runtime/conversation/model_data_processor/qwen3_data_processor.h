@@ -25,6 +25,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
 #include "nlohmann/json_fwd.hpp"  // from @nlohmann_json
 #include "runtime/conversation/io_types.h"
 #include "runtime/conversation/model_data_processor/model_data_processor.h"
@@ -72,7 +73,8 @@ class Qwen3DataProcessor
   absl::StatusOr<std::vector<InputData>> ToInputDataVectorImpl(
       const std::string& rendered_template_prompt,
       const nlohmann::ordered_json& messages,
-      const Qwen3DataProcessorArguments& args) const override;
+      const Qwen3DataProcessorArguments& args,
+      absl::Span<const MediaAttachment> attachments) const override;
 
   absl::StatusOr<Message> ToMessageImpl(
       const Responses& responses,
@@ -0,0 +1,618 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/cascade_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/core/session_utils.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using TaskController = Engine::Session::TaskController;
+using ResponsesCallback = absl::AnyInvocable<void(absl::StatusOr<Responses>)>;
+
+bool IsSuccessfulEndState(TaskState task_state) {
+  return task_state == TaskState::kDone ||
+         task_state == TaskState::kMaxNumTokensReached;
+}
+
+// Appends the text of the first candidate of `responses` to `text`.
+void AppendText(const Responses& responses, std::string& text) {
+  if (!responses.GetTexts().empty()) {
+    text += responses.GetTexts()[0];
+  }
+}
+
+bool HasText(const Responses& responses) {
+  for (const std::string& text : responses.GetTexts()) {
+    if (!text.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+absl::Status MissingLogProbsError() {
+  return absl::FailedPreconditionError(
+      "The small engine did not report the log-probabilities of its answer, "
+      "which the cascade needs to decide whether to escalate.");
+}
+
+// The state of one decode started with RunDecodeAsync, shared between the
+// callbacks of the small and the large sessions and the task controller.
+struct CascadeDecode {
+  CascadeDecode(ResponsesCallback callback, const DecodeConfig& decode_config,
+                bool keep_logprobs)
+      : callback(std::move(callback)),
+        decode_config(decode_config),
+        keep_logprobs(keep_logprobs) {}
+
+  // Sets the controller of the task currently running for this decode.
+  void SetController(std::unique_ptr<TaskController> task_controller) {
+    absl::MutexLock lock(&mutex);
+    controller = std::move(task_controller);
+    if (cancelled && controller != nullptr) {
+      controller->Cancel().IgnoreError();
+    }
+  }
+
+  ResponsesCallback callback;
+  const DecodeConfig decode_config;
+  // Whether the caller asked for log-probabilities. If not, the ones
+  // requested from the small model are dropped before they reach the caller.
+  const bool keep_logprobs;
+
+  // The responses of the small model, held back until it is done. Only
+  // touched by the small session's callback, which is called serially.
+  std::vector<Responses> buffered;
+  // The lowest token probability of the small answer so far, or std::nullopt
+  // if no log-probability was reported yet.
+  std::optional<float> min_token_probability;
+  bool has_text = false;
+
+  absl::Notification done;
+  absl::Mutex mutex;
+  std::unique_ptr<TaskController> controller ABSL_GUARDED_BY(mutex);
+  bool cancelled ABSL_GUARDED_BY(mutex) = false;
+};
+
+class CascadeSession;
+
+class CascadeTaskController : public TaskController {
+ public:
+  CascadeTaskController(std::shared_ptr<CascadeDecode> decode,
+                        CascadeSession* session)
+      : decode_(std::move(decode)), session_(session) {}
+
+  absl::Status WaitUntilDone(absl::Duration timeout) override {
+    if (!decode_->done.WaitForNotificationWithTimeout(timeout)) {
+      return absl::DeadlineExceededError("Timed out waiting for the decode.");
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Cancel() override;
+
+ private:
+  std::shared_ptr<CascadeDecode> decode_;
+  CascadeSession* session_;
+};
+
+class CascadeSession : public Engine::Session {
+ public:
+  CascadeSession(std::unique_ptr<Session> small_session,
+                 std::unique_ptr<Session> large_session, Engine& large_engine,
+                 const SessionConfig& session_config,
+                 const CascadeConfig& config, std::vector<InputData> history)
+      : small_session_(std::move(small_session)),
+        large_engine_(large_engine),
+        session_config_(session_config),
+        config_(config),
+        large_session_(std::move(large_session)),
+        history_(std::move(history)) {}
+
+  ~CascadeSession() override {
+    absl::Status status = WaitUntilDone();
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to wait for the cascade session: "
+                        << status;
+    }
+  }
+
+  absl::StatusOr<Responses> GenerateContent(
+      const std::vector<InputData>& contents) override {
+    RETURN_IF_ERROR(RunPrefill(contents));
+    return RunDecode();
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents,
+      ResponsesCallback callback) override {
+    return GenerateContentStream(contents, std::move(callback),
+                                 DecodeConfig::CreateDefault());
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents, ResponsesCallback callback,
+      const DecodeConfig& decode_config) override {
+    auto shared_callback =
+        std::make_shared<ResponsesCallback>(std::move(callback));
+    RETURN_IF_ERROR(
+        RunPrefillAsync(
+            contents, [this, shared_callback, decode_config](
+                          absl::StatusOr<Responses> responses) {
+              if (!responses.ok()) {
+                (*shared_callback)(responses.status());
+                return;
+              }
+              if (responses->GetTaskState() != TaskState::kDone) {
+                return;
+              }
+              auto decode_task_controller = RunDecodeAsync(
+                  [shared_callback](absl::StatusOr<Responses> responses) {
+                    (*shared_callback)(std::move(responses));
+                  },
+                  decode_config);
+              if (!decode_task_controller.ok()) {
+                (*shared_callback)(decode_task_controller.status());
+              }
+            })
+            .status());
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Responses> RunTextScoring(
+      const std::vector<absl::string_view>& target_text,
+      bool store_token_lengths) override {
+    return Active().RunTextScoring(target_text, store_token_lengths);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunTextScoringAsync(
+      const std::vector<absl::string_view>& target_text,
+      ResponsesCallback callback, bool store_token_lengths) override {
+    return Active().RunTextScoringAsync(target_text, std::move(callback),
+                                        store_token_lengths);
+  }
+
+  absl::Status RunPrefill(const std::vector<InputData>& contents) override {
+    RETURN_IF_ERROR(RecordInputs(contents));
+    return Active().RunPrefill(contents);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunPrefillAsync(
+      const std::vector<InputData>& contents,
+      ResponsesCallback callback) override {
+    RETURN_IF_ERROR(RecordInputs(contents));
+    return Active().RunPrefillAsync(contents, std::move(callback));
+  }
+
+  absl::StatusOr<Responses> RunDecode() override {
+    return RunDecode(DecodeConfig::CreateDefault());
+  }
+
+  absl::StatusOr<Responses> RunDecode(
+      const DecodeConfig& decode_config) override {
+    if (Session* large_session = GetLargeSession()) {
+      return large_session->RunDecode(decode_config);
+    }
+    ASSIGN_OR_RETURN(Responses responses,
+                     small_session_->RunDecode(WithLogProbs(decode_config)));
+    const std::optional<float> min_token_probability =
+        GetMinTokenProbability(responses);
+    if (!min_token_probability.has_value() && HasText(responses)) {
+      return MissingLogProbsError();
+    }
+    if (min_token_probability.value_or(1.0f) >=
+        config_.min_token_probability) {
+      std::string text;
+      AppendText(responses, text);
+      RecordAnswer(std::move(text));
+      if (!KeepLogProbs(decode_config)) {
+        responses.GetMutableTokenLogProbs() = std::nullopt;
+      }
+      return responses;
+    }
+
+    ASSIGN_OR_RETURN(auto escalation, Escalate());
+    auto& [large_session, history] = escalation;
+    if (!history.empty()) {
+      RETURN_IF_ERROR(large_session->RunPrefill(history));
+    }
+    return large_session->RunDecode(decode_config);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      ResponsesCallback callback) override {
+    return RunDecodeAsync(std::move(callback), DecodeConfig::CreateDefault());
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      ResponsesCallback callback, const DecodeConfig& decode_config) override {
+    if (Session* large_session = GetLargeSession()) {
+      return large_session->RunDecodeAsync(std::move(callback), decode_config);
+    }
+    auto decode = std::make_shared<CascadeDecode>(
+        std::move(callback), decode_config, KeepLogProbs(decode_config));
+    {
+      absl::MutexLock lock(&mutex_);
+      ++pending_decodes_;
+    }
+    auto task_controller = small_session_->RunDecodeAsync(
+        [this, decode](absl::StatusOr<Responses> responses) {
+          OnSmallResponses(decode, std::move(responses));
+        },
+        WithLogProbs(decode_config));
+    if (!task_controller.ok()) {
+      absl::MutexLock lock(&mutex_);
+      --pending_decodes_;
+      return task_controller.status();
+    }
+    decode->SetController(std::move(*task_controller));
+    return std::make_unique<CascadeTaskController>(decode, this);
+  }
+
+  absl::StatusOr<BenchmarkInfo> GetBenchmarkInfo() override {
+    return Active().GetBenchmarkInfo();
+  }
+
+  absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo() override {
+    return Active().GetMutableBenchmarkInfo();
+  }
+
+  void CancelProcess() override { Active().CancelProcess(); }
+
+  absl::Status WaitUntilDone() override {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!mutex_.AwaitWithTimeout(
+              absl::Condition(this, &CascadeSession::NoPendingDecodes),
+              Engine::kDefaultTimeout)) {
+        return absl::DeadlineExceededError(
+            "Timed out waiting for the cascade decodes.");
+      }
+    }
+    if (small_session_ != nullptr) {
+      RETURN_IF_ERROR(small_session_->WaitUntilDone());
+    }
+    if (Session* large_session = GetLargeSession()) {
+      RETURN_IF_ERROR(large_session->WaitUntilDone());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<std::unique_ptr<Session>> Clone() override {
+    if (Session* large_session = GetLargeSession()) {
+      ASSIGN_OR_RETURN(auto large_clone, large_session->Clone());
+      return std::make_unique<CascadeSession>(
+          nullptr, std::move(large_clone), large_engine_, session_config_,
+          config_, std::vector<InputData>());
+    }
+    ASSIGN_OR_RETURN(auto small_clone, small_session_->Clone());
+    ASSIGN_OR_RETURN(auto history, CopyHistory());
+    return std::make_unique<CascadeSession>(
+        std::move(small_clone), nullptr, large_engine_, session_config_,
+        config_, std::move(history));
+  }
+
+  absl::StatusOr<std::unique_ptr<Session>> CloneAsync(
+      ResponsesCallback callback) override {
+    if (Session* large_session = GetLargeSession()) {
+      ASSIGN_OR_RETURN(auto large_clone,
+                       large_session->CloneAsync(std::move(callback)));
+      return std::make_unique<CascadeSession>(
+          nullptr, std::move(large_clone), large_engine_, session_config_,
+          config_, std::vector<InputData>());
+    }
+    ASSIGN_OR_RETURN(auto small_clone,
+                     small_session_->CloneAsync(std::move(callback)));
+    ASSIGN_OR_RETURN(auto history, CopyHistory());
+    return std::make_unique<CascadeSession>(
+        std::move(small_clone), nullptr, large_engine_, session_config_,
+        config_, std::move(history));
+  }
+
+  const SessionConfig& GetSessionConfig() const override {
+    return session_config_;
+  }
+
+ private:
+  // Returns the large session, or nullptr if the session has not escalated.
+  // The large session is never replaced once set.
+  Session* GetLargeSession() {
+    absl::MutexLock lock(&mutex_);
+    return large_session_.get();
+  }
+
+  bool NoPendingDecodes() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return pending_decodes_ == 0;
+  }
+
+  Session& Active() {
+    Session* large_session = GetLargeSession();
+    return large_session != nullptr ? *large_session : *small_session_;
+  }
+
+  bool KeepLogProbs(const DecodeConfig& decode_config) const {
+    return GetNumTopLogProbs(decode_config, session_config_).has_value();
+  }
+
+  // Asks the small session for the log-probabilities of the sampled tokens.
+  // Unless the caller asked for top alternatives, none are ranked or decoded.
+  static DecodeConfig WithLogProbs(const DecodeConfig& decode_config) {
+    DecodeConfig config = decode_config;
+    config.SetReturnTokenLogProbs(true);
+    return config;
+  }
+
+  // Keeps a copy of `contents` to replay on the large model, until the
+  // session escalates.
+  absl::Status RecordInputs(const std::vector<InputData>& contents) {
+    absl::MutexLock lock(&mutex_);
+    if (large_session_ != nullptr) {
+      return absl::OkStatus();
+    }
+    ASSIGN_OR_RETURN(auto copy, CreateInputDataVectorCopy(contents));
+    for (InputData& input : copy) {
+      history_.push_back(std::move(input));
+    }
+    return absl::OkStatus();
+  }
+
+  void RecordAnswer(std::string text) {
+    absl::MutexLock lock(&mutex_);
+    if (large_session_ == nullptr && !text.empty()) {
+      history_.emplace_back(InputText(std::move(text)));
+    }
+  }
+
+  absl::StatusOr<std::vector<InputData>> CopyHistory() {
+    absl::MutexLock lock(&mutex_);
+    return CreateInputDataVectorCopy(history_);
+  }
+
+  // Moves the session to the large engine. Returns the new large session and
+  // the inputs to prefill it with.
+  absl::StatusOr<std::pair<Session*, std::vector<InputData>>> Escalate() {
+    absl::MutexLock lock(&mutex_);
+    if (large_session_ == nullptr) {
+      ASSIGN_OR_RETURN(large_session_,
+                       large_engine_.CreateSession(session_config_));
+    }
+    ABSL_LOG(INFO) << "Escalating the session to the large model, replaying "
+                   << history_.size() << " inputs.";
+    return std::make_pair(large_session_.get(), std::move(history_));
+  }
+
+  void OnSmallResponses(const std::shared_ptr<CascadeDecode>& decode,
+                        absl::StatusOr<Responses> responses) {
+    if (!responses.ok()) {
+      Finish(decode, responses.status());
+      return;
+    }
+    if (const std::optional<float> min_token_probability =
+            GetMinTokenProbability(*responses);
+        min_token_probability.has_value()) {
+      decode->min_token_probability =
+          std::min(decode->min_token_probability.value_or(1.0f),
+                   *min_token_probability);
+    }
+    decode->has_text = decode->has_text || HasText(*responses);
+    if (!IsTaskEndState(responses->GetTaskState())) {
+      decode->buffered.push_back(*std::move(responses));
+      return;
+    }
+    if (IsSuccessfulEndState(responses->GetTaskState()) &&
+        !decode->min_token_probability.has_value() && decode->has_text) {
+      decode->buffered.clear();
+      Finish(decode, MissingLogProbsError());
+      return;
+    }
+    if (!IsSuccessfulEndState(responses->GetTaskState()) ||
+        decode->min_token_probability.value_or(1.0f) >=
+            config_.min_token_probability) {
+      std::string text;
+      for (Responses& buffered : decode->buffered) {
+        AppendText(buffered, text);
+        if (!decode->keep_logprobs) {
+          buffered.GetMutableTokenLogProbs() = std::nullopt;
+        }
+        decode->callback(std::move(buffered));
+      }
+      decode->buffered.clear();
+      if (IsSuccessfulEndState(responses->GetTaskState())) {
+        AppendText(*responses, text);
+        RecordAnswer(std::move(text));
+      }
+      if (!decode->keep_logprobs) {
+        responses->GetMutableTokenLogProbs() = std::nullopt;
+      }
+      Finish(decode, std::move(responses));
+      return;
+    }
+
+    decode->buffered.clear();
+    {
+      absl::MutexLock lock(&decode->mutex);
+      if (decode->cancelled) {
+        Finish(decode, absl::CancelledError("The decode was cancelled."));
+        return;
+      }
+    }
+    auto escalation = Escalate();
+    if (!escalation.ok()) {
+      Finish(decode, escalation.status());
+      return;
+    }
+    auto& [large_session, history] = *escalation;
+    if (history.empty()) {
+      DecodeOnLargeSession(decode, *large_session);
+      return;
+    }
+    auto task_controller = large_session->RunPrefillAsync(
+        history, [this, decode, large_session = large_session](
+                     absl::StatusOr<Responses> responses) {
+          if (!responses.ok()) {
+            Finish(decode, responses.status());
+          } else if (responses->GetTaskState() == TaskState::kDone) {
+            DecodeOnLargeSession(decode, *large_session);
+          }
+        });
+    if (!task_controller.ok()) {
+      Finish(decode, task_controller.status());
+      return;
+    }
+    decode->SetController(std::move(*task_controller));
+  }
+
+  void DecodeOnLargeSession(const std::shared_ptr<CascadeDecode>& decode,
+                            Session& large_session) {
+    auto task_controller = large_session.RunDecodeAsync(
+        [this, decode](absl::StatusOr<Responses> responses) {
+          if (!responses.ok() ||
+              IsTaskEndState(responses->GetTaskState())) {
+            Finish(decode, std::move(responses));
+          } else {
+            decode->callback(std::move(responses));
+          }
+        },
+        decode->decode_config);
+    if (!task_controller.ok()) {
+      Finish(decode, task_controller.status());
+      return;
+    }
+    decode->SetController(std::move(*task_controller));
+  }
+
+  // Delivers the last callback of `decode`.
+  void Finish(const std::shared_ptr<CascadeDecode>& decode,
+              absl::StatusOr<Responses> responses) {
+    decode->callback(std::move(responses));
+    decode->done.Notify();
+    absl::MutexLock lock(&mutex_);
+    --pending_decodes_;
+  }
+
+  // Null once the session has been cloned from an escalated session.
+  const std::unique_ptr<Session> small_session_;
+  Engine& large_engine_;
+  const SessionConfig session_config_;
+  const CascadeConfig config_;
+
+  absl::Mutex mutex_;
+  std::unique_ptr<Session> large_session_ ABSL_GUARDED_BY(mutex_);
+  // The inputs of the session so far, replayed on the large session when
+  // escalating. Cleared once the session has escalated.
+  std::vector<InputData> history_ ABSL_GUARDED_BY(mutex_);
+  int pending_decodes_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+absl::Status CascadeTaskController::Cancel() {
+  {
+    absl::MutexLock lock(&decode_->mutex);
+    decode_->cancelled = true;
+    if (decode_->controller != nullptr) {
+      return decode_->controller->Cancel();
+    }
+  }
+  // Some sessions do not hand out task controllers.
+  session_->CancelProcess();
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+std::optional<float> GetMinTokenProbability(const Responses& responses) {
+  std::optional<float> min_probability;
+  if (!responses.GetTokenLogProbs().has_value()) {
+    return min_probability;
+  }
+  for (const auto& candidate : *responses.GetTokenLogProbs()) {
+    for (const TokenLogProbs& token : candidate) {
+      min_probability = std::min(min_probability.value_or(1.0f),
+                                 std::exp(token.token.logprob));
+    }
+  }
+  return min_probability;
+}
+
+absl::StatusOr<std::unique_ptr<CascadeEngine>> CascadeEngine::Create(
+    std::unique_ptr<Engine> small_engine, std::unique_ptr<Engine> large_engine,
+    const CascadeConfig& config) {
+  if (small_engine == nullptr || large_engine == nullptr) {
+    return absl::InvalidArgumentError("Both engines must be provided.");
+  }
+  if (config.min_token_probability < 0.0f ||
+      config.min_token_probability > 1.0f) {
+    return absl::InvalidArgumentError(
+        "min_token_probability must be in [0, 1].");
+  }
+  // Callers tokenize with the small engine and its stop token ids stay in the
+  // session config when a session escalates, so both must share a vocabulary.
+  if (small_engine->GetTokenizer().GetTokens() !=
+      large_engine->GetTokenizer().GetTokens()) {
+    return absl::InvalidArgumentError(
+        "The small and large engines must use the same tokenizer.");
+  }
+  return absl::WrapUnique(new CascadeEngine(std::move(small_engine),
+                                            std::move(large_engine), config));
+}
+
+absl::StatusOr<std::unique_ptr<CascadeEngine>> CascadeEngine::Create(
+    EngineSettings small_engine_settings, EngineSettings large_engine_settings,
+    const CascadeConfig& config) {
+  ASSIGN_OR_RETURN(auto small_engine, EngineFactory::CreateDefault(
+                                          std::move(small_engine_settings)));
+  ASSIGN_OR_RETURN(auto large_engine, EngineFactory::CreateDefault(
+                                          std::move(large_engine_settings)));
+  return Create(std::move(small_engine), std::move(large_engine), config);
+}
+
+absl::StatusOr<std::unique_ptr<Engine::Session>> CascadeEngine::CreateSession(
+    const SessionConfig& session_config) {
+  ASSIGN_OR_RETURN(auto small_session,
+                   small_engine_->CreateSession(session_config));
+  return std::make_unique<CascadeSession>(std::move(small_session), nullptr,
+                                          *large_engine_, session_config,
+                                          config_, std::vector<InputData>());
+}
+
+absl::Status CascadeEngine::WaitUntilDone(absl::Duration timeout) {
+  RETURN_IF_ERROR(small_engine_->WaitUntilDone(timeout));
+  return large_engine_->WaitUntilDone(timeout);
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,123 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_CASCADE_ENGINE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_CASCADE_ENGINE_H_
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/components/tokenizer.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+
+namespace litert::lm {
+
+struct CascadeConfig {
+  // A response of the small model is rejected, and the turn is served by the
+  // large model, when any of its tokens was sampled with a probability below
+  // this threshold.
+  float min_token_probability = 0.2f;
+};
+
+// An Engine serving every request with a small model first and escalating to
+// a large model when the small model is not confident about its answer.
+//
+// Each session starts on the small engine. Decoding asks the small engine for
+// the log-probability of every sampled token; if one of them falls below
+// `CascadeConfig::min_token_probability`, the small answer is discarded, the
+// inputs of the session so far (the prefilled contents and the accepted
+// answers) are prefilled into a new session of the large engine and the turn
+// is decoded again there. The session then stays on the large engine.
+//
+// Streaming decodes are buffered until the small model is done, so callers
+// never see a discarded answer. The cascade is invisible to users of
+// Engine::Session and Conversation, except for the added latency of
+// escalated turns.
+//
+// Requirements:
+//   - The small engine must use a sampler that reports log-probabilities
+//     (e.g. the CPU sampler). A decode whose small answer carries none fails
+//     with FailedPreconditionError rather than being accepted unchecked.
+//   - Both engines must use the same tokenizer, as the session keeps the
+//     token ids and stop tokens of the small engine when it escalates.
+//     Create() fails with InvalidArgumentError if their vocabularies differ.
+//   - The replayed history matches the small session's context exactly when
+//     the caller applies the prompt template, as Conversation does.
+class CascadeEngine : public Engine {
+ public:
+  static absl::StatusOr<std::unique_ptr<CascadeEngine>> Create(
+      std::unique_ptr<Engine> small_engine,
+      std::unique_ptr<Engine> large_engine, const CascadeConfig& config);
+
+  // Creates both engines with the registered default engine type.
+  static absl::StatusOr<std::unique_ptr<CascadeEngine>> Create(
+      EngineSettings small_engine_settings,
+      EngineSettings large_engine_settings, const CascadeConfig& config);
+
+  absl::StatusOr<std::unique_ptr<Session>> CreateSession(
+      const SessionConfig& session_config) override;
+
+  absl::Status WaitUntilDone(absl::Duration timeout) override;
+
+  // The settings, tokenizer, executor properties and metrics are the ones of
+  // the small engine, which serves most requests.
+  const EngineSettings& GetEngineSettings() const override {
+    return small_engine_->GetEngineSettings();
+  }
+  const Tokenizer& GetTokenizer() const override {
+    return small_engine_->GetTokenizer();
+  }
+  absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties()
+      const override {
+    return small_engine_->GetAudioExecutorProperties();
+  }
+  absl::StatusOr<VisionExecutorProperties> GetVisionExecutorProperties()
+      const override {
+    return small_engine_->GetVisionExecutorProperties();
+  }
+  absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const override {
+    return small_engine_->GetMetricsSnapshot();
+  }
+
+  Engine& small_engine() { return *small_engine_; }
+  Engine& large_engine() { return *large_engine_; }
+
+ private:
+  CascadeEngine(std::unique_ptr<Engine> small_engine,
+                std::unique_ptr<Engine> large_engine,
+                const CascadeConfig& config)
+      : small_engine_(std::move(small_engine)),
+        large_engine_(std::move(large_engine)),
+        config_(config) {}
+
+  std::unique_ptr<Engine> small_engine_;
+  std::unique_ptr<Engine> large_engine_;
+  const CascadeConfig config_;
+};
+
+// Returns the lowest probability with which a token of `responses` was
+// sampled, over all candidates, or std::nullopt if `responses` holds no
+// log-probabilities.
+std::optional<float> GetMinTokenProbability(const Responses& responses);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_CASCADE_ENGINE_H_
@@ -0,0 +1,411 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/cascade_engine.h"
+
+#include <cmath>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/components/tokenizer.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Return;
+using ::testing::ReturnRef;
+using ::testing::Truly;
+using ::testing::status::StatusIs;
+
+using ResponsesCallback = absl::AnyInvocable<void(absl::StatusOr<Responses>)>;
+
+class MockSession : public Engine::Session {
+ public:
+  MOCK_METHOD(absl::StatusOr<Responses>, GenerateContent,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback),
+              (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback,
+               const DecodeConfig& decode_config),
+              (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunTextScoring,
+              (const std::vector<absl::string_view>& target_text,
+               bool store_token_lengths),
+              (override));
+  MOCK_METHOD(absl::Status, RunPrefill,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::StatusOr<std::unique_ptr<TaskController>>,
+              RunPrefillAsync,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback),
+              (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode, (), (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode,
+              (const DecodeConfig& decode_config), (override));
+  MOCK_METHOD(absl::StatusOr<std::unique_ptr<TaskController>>,
+              RunDecodeAsync,
+              (ResponsesCallback user_callback,
+               const DecodeConfig& decode_config),
+              (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo>, GetBenchmarkInfo, (), (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo*>, GetMutableBenchmarkInfo, (),
+              (override));
+  MOCK_METHOD(void, CancelProcess, (), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (), (override));
+  MOCK_METHOD(const SessionConfig&, GetSessionConfig, (), (const, override));
+};
+
+class MockEngine : public Engine {
+ public:
+  MOCK_METHOD(const EngineSettings&, GetEngineSettings, (), (const, override));
+  MOCK_METHOD(const Tokenizer&, GetTokenizer, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<AudioExecutorProperties>,
+              GetAudioExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<VisionExecutorProperties>,
+              GetVisionExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<std::unique_ptr<Session>>, CreateSession,
+              (const SessionConfig& session_config), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (absl::Duration timeout),
+              (override));
+};
+
+class MockTokenizer : public Tokenizer {
+ public:
+  MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText,
+              (const std::vector<int>& token_ids), (const, override));
+  MOCK_METHOD(absl::StatusOr<std::vector<int>>, TextToTokenIds,
+              (absl::string_view text), (const, override));
+  MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view token),
+              (const, override));
+  MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
+  MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
+};
+
+// Returns an engine using `tokenizer`.
+std::unique_ptr<MockEngine> MakeEngine(const MockTokenizer& tokenizer) {
+  auto engine = std::make_unique<MockEngine>();
+  EXPECT_CALL(*engine, GetTokenizer())
+      .WillRepeatedly(ReturnRef(tokenizer));
+  return engine;
+}
+
+// Returns responses holding `text` whose single token was sampled with
+// `probability`.
+Responses MakeResponses(TaskState task_state, const std::string& text,
+                        float probability) {
+  Responses responses(task_state, {text});
+  responses.GetMutableTokenLogProbs() =
+      std::vector<std::vector<TokenLogProbs>>{
+          {TokenLogProbs{TokenLogProb{1, text, std::log(probability)}, {}}}};
+  return responses;
+}
+
+std::string RawText(const InputData& input) {
+  return std::string(*std::get<InputText>(input).GetRawTextString());
+}
+
+bool RequestsLogProbs(const DecodeConfig& decode_config) {
+  return decode_config.GetReturnTokenLogProbs() ||
+         decode_config.GetNumTopLogProbs().value_or(0) > 0;
+}
+
+// Whether only the log-probabilities of the sampled tokens are requested,
+// without ranking top alternatives.
+bool RequestsSampledLogProbsOnly(const DecodeConfig& decode_config) {
+  return decode_config.GetReturnTokenLogProbs() &&
+         decode_config.GetNumTopLogProbs().value_or(0) == 0;
+}
+
+class CascadeEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    EXPECT_CALL(tokenizer_, GetTokens())
+        .WillRepeatedly(Return(std::vector<std::string>{"<pad>", "a", "b"}));
+    auto small_engine = MakeEngine(tokenizer_);
+    auto large_engine = MakeEngine(tokenizer_);
+    small_engine_ = small_engine.get();
+    large_engine_ = large_engine.get();
+
+    auto small_session = std::make_unique<MockSession>();
+    small_session_ = small_session.get();
+    EXPECT_CALL(*small_session_, WaitUntilDone())
+        .WillRepeatedly(Return(absl::OkStatus()));
+    EXPECT_CALL(*small_engine_, CreateSession(_))
+        .WillOnce(Return(std::move(small_session)));
+
+    ASSERT_OK_AND_ASSIGN(
+        engine_,
+        CascadeEngine::Create(std::move(small_engine), std::move(large_engine),
+                              CascadeConfig{.min_token_probability = 0.5f}));
+    ASSERT_OK_AND_ASSIGN(session_,
+                         engine_->CreateSession(SessionConfig::CreateDefault()));
+  }
+
+  // Makes the large engine hand out a new mock session.
+  MockSession* ExpectLargeSession() {
+    auto large_session = std::make_unique<MockSession>();
+    MockSession* large_session_ptr = large_session.get();
+    EXPECT_CALL(*large_session_ptr, WaitUntilDone())
+        .WillRepeatedly(Return(absl::OkStatus()));
+    EXPECT_CALL(*large_engine_, CreateSession(_))
+        .WillOnce(Return(std::move(large_session)));
+    return large_session_ptr;
+  }
+
+  std::vector<InputData> Text(const std::string& text) {
+    std::vector<InputData> inputs;
+    inputs.emplace_back(InputText(text));
+    return inputs;
+  }
+
+  MockTokenizer tokenizer_;
+  MockEngine* small_engine_;
+  MockEngine* large_engine_;
+  MockSession* small_session_;
+  std::unique_ptr<CascadeEngine> engine_;
+  std::unique_ptr<Engine::Session> session_;
+};
+
+TEST(GetMinTokenProbabilityTest, ReturnsLowestProbability) {
+  Responses responses(TaskState::kDone, {"ab", "c"});
+  responses.GetMutableTokenLogProbs() =
+      std::vector<std::vector<TokenLogProbs>>{
+          {TokenLogProbs{TokenLogProb{1, "a", std::log(0.9f)}, {}},
+           TokenLogProbs{TokenLogProb{2, "b", std::log(0.4f)}, {}}},
+          {TokenLogProbs{TokenLogProb{3, "c", std::log(0.7f)}, {}}}};
+  ASSERT_TRUE(GetMinTokenProbability(responses).has_value());
+  EXPECT_NEAR(*GetMinTokenProbability(responses), 0.4f, 1e-6);
+  EXPECT_EQ(GetMinTokenProbability(Responses(TaskState::kDone)), std::nullopt);
+}
+
+TEST(CascadeEngineCreateTest, RejectsInvalidThreshold) {
+  EXPECT_THAT(CascadeEngine::Create(std::make_unique<MockEngine>(),
+                                    std::make_unique<MockEngine>(),
+                                    {.min_token_probability = 1.5f}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(CascadeEngine::Create(std::make_unique<MockEngine>(), nullptr,
+                                    CascadeConfig()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(CascadeEngineCreateTest, RejectsDifferentTokenizers) {
+  MockTokenizer small_tokenizer;
+  EXPECT_CALL(small_tokenizer, GetTokens())
+      .WillRepeatedly(Return(std::vector<std::string>{"<pad>", "a", "b"}));
+  MockTokenizer large_tokenizer;
+  EXPECT_CALL(large_tokenizer, GetTokens())
+      .WillRepeatedly(Return(std::vector<std::string>{"<pad>", "b", "a"}));
+  EXPECT_THAT(CascadeEngine::Create(MakeEngine(small_tokenizer),
+                                    MakeEngine(large_tokenizer),
+                                    CascadeConfig()),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       "The small and large engines must use the same "
+                       "tokenizer."));
+}
+
+TEST_F(CascadeEngineTest, ConfidentAnswerStaysOnSmallModel) {
+  EXPECT_CALL(*small_session_, RunPrefill(_))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*small_session_, RunDecode(Truly(RequestsSampledLogProbsOnly)))
+      .WillOnce(Return(MakeResponses(TaskState::kDone, "Paris", 0.9f)));
+  EXPECT_CALL(*large_engine_, CreateSession(_)).Times(0);
+
+  ASSERT_OK_AND_ASSIGN(Responses responses,
+                       session_->GenerateContent(Text("Capital of France?")));
+  EXPECT_THAT(responses.GetTexts(), ElementsAre("Paris"));
+  // The caller did not ask for log-probabilities.
+  EXPECT_FALSE(responses.GetTokenLogProbs().has_value());
+}
+
+TEST_F(CascadeEngineTest, UnconfidentAnswerEscalatesWithHistory) {
+  EXPECT_CALL(*small_session_, RunPrefill(_))
+      .Times(2)
+      .WillRepeatedly(Return(absl::OkStatus()));
+  EXPECT_CALL(*small_session_, RunDecode(_))
+      .WillOnce(Return(MakeResponses(TaskState::kDone, "Hi!", 0.9f)))
+      .WillOnce(Return(MakeResponses(TaskState::kDone, "Maybe 42", 0.1f)));
+
+  ASSERT_OK_AND_ASSIGN(Responses first, session_->GenerateContent(Text("Hi")));
+  EXPECT_THAT(first.GetTexts(), ElementsAre("Hi!"));
+
+  MockSession* large_session = ExpectLargeSession();
+  std::vector<std::string> replayed;
+  EXPECT_CALL(*large_session, RunPrefill(_))
+      .WillOnce([&replayed](const std::vector<InputData>& contents) {
+        for (const InputData& input : contents) {
+          replayed.push_back(RawText(input));
+        }
+        return absl::OkStatus();
+      })
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*large_session, RunDecode(Truly([](const DecodeConfig& config) {
+                return !RequestsLogProbs(config);
+              })))
+      .WillOnce(Return(Responses(TaskState::kDone, {"It is 6 * 7."})))
+      .WillOnce(Return(Responses(TaskState::kDone, {"You are welcome."})));
+
+  ASSERT_OK_AND_ASSIGN(Responses second,
+                       session_->GenerateContent(Text("Meaning of life?")));
+  EXPECT_THAT(second.GetTexts(), ElementsAre("It is 6 * 7."));
+  EXPECT_THAT(replayed, ElementsAre("Hi", "Hi!", "Meaning of life?"));
+
+  // The session stays on the large model.
+  ASSERT_OK_AND_ASSIGN(Responses third, session_->GenerateContent(Text("Thx")));
+  EXPECT_THAT(third.GetTexts(), ElementsAre("You are welcome."));
+}
+
+TEST_F(CascadeEngineTest, StreamingBuffersSmallAnswerUntilDone) {
+  EXPECT_CALL(*small_session_, RunPrefillAsync(_, _))
+      .WillOnce([](const std::vector<InputData>&, ResponsesCallback callback) {
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+  EXPECT_CALL(*small_session_, RunDecodeAsync(_, Truly(RequestsLogProbs)))
+      .WillOnce([](ResponsesCallback callback, const DecodeConfig&) {
+        callback(MakeResponses(TaskState::kProcessing, "Par", 0.8f));
+        callback(MakeResponses(TaskState::kProcessing, "is", 0.9f));
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+
+  std::vector<std::string> texts;
+  std::vector<TaskState> states;
+  ASSERT_OK(session_->GenerateContentStream(
+      Text("Capital of France?"),
+      [&](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        states.push_back(responses->GetTaskState());
+        if (!responses->GetTexts().empty()) {
+          texts.push_back(responses->GetTexts()[0]);
+        }
+      }));
+  ASSERT_OK(session_->WaitUntilDone());
+  EXPECT_THAT(texts, ElementsAre("Par", "is"));
+  EXPECT_THAT(states, ElementsAre(TaskState::kProcessing,
+                                  TaskState::kProcessing, TaskState::kDone));
+}
+
+TEST_F(CascadeEngineTest, StreamingEscalatesWithoutLeakingSmallAnswer) {
+  EXPECT_CALL(*small_session_, RunPrefillAsync(_, _))
+      .WillOnce([](const std::vector<InputData>&, ResponsesCallback callback) {
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+  EXPECT_CALL(*small_session_, RunDecodeAsync(_, _))
+      .WillOnce([](ResponsesCallback callback, const DecodeConfig&) {
+        callback(MakeResponses(TaskState::kProcessing, "Ly", 0.2f));
+        callback(MakeResponses(TaskState::kProcessing, "on", 0.9f));
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+
+  MockSession* large_session = ExpectLargeSession();
+  EXPECT_CALL(*large_session, RunPrefillAsync(_, _))
+      .WillOnce([](const std::vector<InputData>& contents,
+                   ResponsesCallback callback) {
+        EXPECT_EQ(contents.size(), 1);
+        EXPECT_EQ(RawText(contents[0]), "Capital of France?");
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+  EXPECT_CALL(*large_session, RunDecodeAsync(_, _))
+      .WillOnce([](ResponsesCallback callback, const DecodeConfig&) {
+        callback(Responses(TaskState::kProcessing, {"Paris"}));
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+
+  std::vector<std::string> texts;
+  ASSERT_OK(session_->GenerateContentStream(
+      Text("Capital of France?"), [&](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        if (!responses->GetTexts().empty()) {
+          texts.push_back(responses->GetTexts()[0]);
+        }
+      }));
+  ASSERT_OK(session_->WaitUntilDone());
+  EXPECT_THAT(texts, ElementsAre("Paris"));
+}
+
+TEST_F(CascadeEngineTest, AnswerWithoutLogProbsFails) {
+  EXPECT_CALL(*small_session_, RunPrefill(_))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*small_session_, RunDecode(_))
+      .WillOnce(Return(Responses(TaskState::kDone, {"Paris"})));
+  EXPECT_CALL(*large_engine_, CreateSession(_)).Times(0);
+
+  EXPECT_THAT(session_->GenerateContent(Text("Capital of France?")),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+TEST_F(CascadeEngineTest, StreamingAnswerWithoutLogProbsFails) {
+  EXPECT_CALL(*small_session_, RunPrefillAsync(_, _))
+      .WillOnce([](const std::vector<InputData>&, ResponsesCallback callback) {
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+  EXPECT_CALL(*small_session_, RunDecodeAsync(_, _))
+      .WillOnce([](ResponsesCallback callback, const DecodeConfig&) {
+        callback(Responses(TaskState::kProcessing, {"Paris"}));
+        callback(Responses(TaskState::kDone));
+        return nullptr;
+      });
+  EXPECT_CALL(*large_engine_, CreateSession(_)).Times(0);
+
+  std::vector<std::string> texts;
+  absl::Status status;
+  ASSERT_OK(session_->GenerateContentStream(
+      Text("Capital of France?"), [&](absl::StatusOr<Responses> responses) {
+        if (!responses.ok()) {
+          status = responses.status();
+        } else if (!responses->GetTexts().empty()) {
+          texts.push_back(responses->GetTexts()[0]);
+        }
+      }));
+  ASSERT_OK(session_->WaitUntilDone());
+  EXPECT_THAT(status, StatusIs(absl::StatusCode::kFailedPrecondition));
+  // The unchecked answer is not passed on.
+  EXPECT_THAT(texts, testing::IsEmpty());
+}
+
+TEST_F(CascadeEngineTest, ScoringUsesActiveSession) {
+  EXPECT_CALL(*small_session_, RunTextScoring(_, true))
+      .WillOnce(Return(Responses(TaskState::kDone, {}, {-1.5f})));
+  ASSERT_OK_AND_ASSIGN(Responses responses,
+                       session_->RunTextScoring({"yes"}, true));
+  EXPECT_THAT(responses.GetScores(), ElementsAre(-1.5f));
+}
+
+}  // namespace
+}  // namespace litert::lm
@@ -0,0 +1,833 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/coalescing_engine.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT: Required for the model identity.
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT: Required for std::filesystem errors.
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_join.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/synchronization/notification.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/core/response_cache.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/framework/threadpool.h"
+#include "runtime/proto/sampler_params.pb.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using TaskController = Engine::Session::TaskController;
+using ResponsesCallback = absl::AnyInvocable<void(absl::StatusOr<Responses>)>;
+
+// Maximum number of cached streams replayed concurrently.
+constexpr int kMaxReplayThreads = 4;
+
+bool IsSuccessfulEndState(TaskState task_state) {
+  return task_state == TaskState::kDone ||
+         task_state == TaskState::kMaxNumTokensReached;
+}
+
+// Appends `value` to `key` with its length, so that the concatenation of the
+// values can be split back unambiguously.
+void AppendKeyField(std::string& key, absl::string_view value) {
+  absl::StrAppend(&key, value.size(), ":", value, ";");
+}
+
+bool IsDeterministic(const proto::SamplerParameters& sampler_params) {
+  return sampler_params.type() == proto::SamplerParameters::GREEDY ||
+         sampler_params.k() == 1 || sampler_params.has_seed();
+}
+
+// Whether the responses of a request can be cached. The coalescing key only
+// identifies constraints and LoRA weights by address, which is not stable
+// over time, and the cache does not keep log-probabilities.
+bool IsCacheable(const SessionConfig& session_config,
+                 const DecodeConfig* decode_config) {
+  if (session_config.GetScopedLoraFile() != nullptr ||
+      session_config.GetNumTopLogProbs() > 0) {
+    return false;
+  }
+  return decode_config == nullptr ||
+         (decode_config->GetConstraint() == nullptr &&
+          decode_config->GetNumTopLogProbs().value_or(0) == 0 &&
+          !decode_config->GetReturnTokenLogProbs());
+}
+
+// Identifies the model file by its path, size and modification time.
+absl::StatusOr<std::string> GetModelId(const EngineSettings& engine_settings) {
+  ASSIGN_OR_RETURN(
+      absl::string_view path,
+      engine_settings.GetMainExecutorSettings().GetModelAssets().GetPath());
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(path, error);
+  if (error) {
+    return absl::NotFoundError(
+        absl::StrCat("Failed to read the size of ", path, ": ",
+                     error.message()));
+  }
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  if (error) {
+    return absl::NotFoundError(
+        absl::StrCat("Failed to read the modification time of ", path, ": ",
+                     error.message()));
+  }
+  return absl::StrCat(
+      path, ";", size, ";",
+      static_cast<int64_t>(mtime.time_since_epoch().count()));
+}
+
+}  // namespace
+
+class CoalescingRegistry {
+ public:
+  explicit CoalescingRegistry(std::unique_ptr<ResponseCache> cache)
+      : cache_(std::move(cache)) {
+    if (cache_ != nullptr) {
+      replay_pool_ =
+          std::make_unique<ThreadPool>("response_replay", kMaxReplayThreads);
+    }
+  }
+
+  // One caller waiting for the responses of an in-flight request.
+  struct Subscription {
+    explicit Subscription(ResponsesCallback callback)
+        : callback(std::move(callback)) {}
+
+    // Serializes the calls to `callback`, which are made without holding the
+    // registry mutex.
+    absl::Mutex delivery_mutex;
+    ResponsesCallback callback ABSL_GUARDED_BY(delivery_mutex);
+    // The text of the first candidate received so far.
+    std::string text ABSL_GUARDED_BY(delivery_mutex);
+    // Whether `callback` received its last call, and whether that call ended
+    // the generation successfully.
+    bool ended ABSL_GUARDED_BY(delivery_mutex) = false;
+    bool succeeded ABSL_GUARDED_BY(delivery_mutex) = false;
+    // Set when the subscriber cancels. The CANCELLED error is delivered right
+    // away if `callback` is not running, or in place of the next responses
+    // otherwise.
+    std::atomic<bool> cancelled{false};
+    absl::Notification done;
+  };
+
+  // A generation shared by all the requests with the same key. Guarded by
+  // `mutex_`.
+  struct Request {
+    std::string key;
+    // The key the responses are cached under once the request succeeds, empty
+    // if they are not cached.
+    std::string cache_key;
+    // The session running the generation, released once it is done.
+    std::shared_ptr<Engine::Session> session;
+    // The responses streamed so far, replayed to late subscribers.
+    std::vector<Responses> streamed;
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    int num_live_subscriptions = 0;
+    bool finished = false;
+    // Notified once the request no longer references `session`.
+    absl::Notification released;
+  };
+
+  struct JoinResult {
+    std::shared_ptr<Request> request;
+    std::shared_ptr<Subscription> subscription;
+    // Whether the caller must run the generation on `session`, or replay
+    // `cached` if set.
+    bool is_owner = false;
+    std::optional<std::vector<Responses>> cached;
+  };
+
+  // Returns the key of the response cache for a request with the coalescing
+  // key `key`, or an empty string if its responses are not cached.
+  std::string GetCacheKey(const std::string& key,
+                          const SessionConfig& session_config,
+                          const DecodeConfig* decode_config) const {
+    if (cache_ == nullptr || !IsCacheable(session_config, decode_config)) {
+      return "";
+    }
+    std::string cache_key;
+    AppendKeyField(cache_key, cache_->config().model_id);
+    absl::StrAppend(&cache_key, key);
+    return cache_key;
+  }
+
+  // Subscribes `callback` to the in-flight request for `key`, or starts a new
+  // request if there is none: answered from the cache if `cache_key` is found
+  // there, or run on `session` otherwise.
+  JoinResult Join(const std::string& key, const std::string& cache_key,
+                  std::shared_ptr<Engine::Session> session,
+                  ResponsesCallback callback) {
+    JoinResult result;
+    result.subscription = std::make_shared<Subscription>(std::move(callback));
+    std::vector<Responses> backlog;
+    {
+      absl::MutexLock lock(mutex_);
+      auto it = requests_.find(key);
+      if (it == requests_.end()) {
+        result.request = std::make_shared<Request>();
+        result.request->key = key;
+        if (!cache_key.empty()) {
+          result.cached = cache_->Lookup(cache_key);
+        }
+        if (result.cached.has_value()) {
+          ++num_cache_hits_;
+        } else {
+          result.request->cache_key = cache_key;
+          result.request->session = std::move(session);
+        }
+        result.request->subscriptions.push_back(result.subscription);
+        result.request->num_live_subscriptions = 1;
+        result.is_owner = true;
+        requests_[key] = result.request;
+        return result;
+      }
+      result.request = it->second;
+      result.request->subscriptions.push_back(result.subscription);
+      ++result.request->num_live_subscriptions;
+      ++num_coalesced_;
+      backlog = result.request->streamed;
+      // Taken before releasing the registry mutex, so that responses
+      // published from now on are delivered after the backlog.
+      result.subscription->delivery_mutex.Lock();
+    }
+    for (Responses& responses : backlog) {
+      DeliverLocked(*result.subscription, std::move(responses),
+                    /*last=*/false);
+    }
+    result.subscription->delivery_mutex.Unlock();
+    return result;
+  }
+
+  // Fans `responses` out to the subscribers of `request`. `last` ends the
+  // request.
+  void Publish(const std::shared_ptr<Request>& request,
+               absl::StatusOr<Responses> responses, bool last) {
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    std::shared_ptr<Engine::Session> session;
+    std::optional<std::vector<Responses>> to_cache;
+    {
+      absl::MutexLock lock(mutex_);
+      if (request->finished) {
+        return;
+      }
+      if (last) {
+        request->finished = true;
+        EraseLocked(*request);
+        session = std::move(request->session);
+        if (!request->cache_key.empty() && responses.ok() &&
+            (!IsTaskEndState(responses->GetTaskState()) ||
+             IsSuccessfulEndState(responses->GetTaskState()))) {
+          to_cache = std::move(request->streamed);
+          to_cache->push_back(*responses);
+        }
+        request->streamed.clear();
+      } else if (responses.ok()) {
+        request->streamed.push_back(*responses);
+      }
+      subscriptions = request->subscriptions;
+    }
+    for (const auto& subscription : subscriptions) {
+      absl::MutexLock lock(subscription->delivery_mutex);
+      DeliverLocked(*subscription, responses, last);
+    }
+    session.reset();
+    if (to_cache.has_value()) {
+      absl::Status status =
+          cache_->Insert(request->cache_key, *std::move(to_cache));
+      if (!status.ok()) {
+        ABSL_LOG(WARNING) << "Failed to cache the responses: " << status;
+      }
+    }
+    if (last) {
+      request->released.Notify();
+    }
+  }
+
+  // Publishes the cached `responses` of `request`: right away for a blocking
+  // call, or from the replay pool for a stream, paced by the replay interval.
+  // The replay stops once all the subscribers have cancelled.
+  void Replay(const std::shared_ptr<Request>& request,
+              std::vector<Responses> responses, bool stream) {
+    if (responses.empty()) {
+      Publish(request, absl::DataLossError("Empty cached responses."),
+              /*last=*/true);
+      return;
+    }
+    if (!stream) {
+      Publish(request, std::move(responses.back()), /*last=*/true);
+      return;
+    }
+    absl::Status status = replay_pool_->Schedule(
+        [this, request, responses = std::move(responses)]() mutable {
+          const absl::Duration interval = cache_->config().replay_interval;
+          for (size_t i = 0; i < responses.size(); ++i) {
+            if (i > 0 && interval > absl::ZeroDuration()) {
+              absl::SleepFor(interval);
+            }
+            if (!HasLiveSubscriptions(*request)) {
+              Publish(request,
+                      absl::CancelledError("The request was cancelled."),
+                      /*last=*/true);
+              return;
+            }
+            Publish(request, std::move(responses[i]),
+                    /*last=*/i + 1 == responses.size());
+          }
+        });
+    if (!status.ok()) {
+      Publish(request, status, /*last=*/true);
+    }
+  }
+
+  // Ends the stream of `subscription` with a CANCELLED error, and cancels the
+  // generation if no other subscriber is left.
+  void Cancel(const std::shared_ptr<Request>& request,
+              const std::shared_ptr<Subscription>& subscription) {
+    std::shared_ptr<Engine::Session> session;
+    {
+      absl::MutexLock lock(mutex_);
+      if (request->finished || subscription->cancelled.exchange(true)) {
+        return;
+      }
+      if (--request->num_live_subscriptions == 0) {
+        // New requests must not join a generation that is being cancelled.
+        EraseLocked(*request);
+        session = request->session;
+      }
+    }
+    // The callback may be the one cancelling, in which case the error is
+    // delivered with the next responses.
+    if (subscription->delivery_mutex.TryLock()) {
+      DeliverLocked(*subscription,
+                    absl::CancelledError("The request was cancelled."),
+                    /*last=*/true);
+      subscription->delivery_mutex.Unlock();
+    }
+    if (session != nullptr) {
+      session->CancelProcess();
+    }
+  }
+
+  int64_t GetNumCoalesced() const {
+    absl::MutexLock lock(mutex_);
+    return num_coalesced_;
+  }
+
+  int64_t GetNumCacheHits() const {
+    absl::MutexLock lock(mutex_);
+    return num_cache_hits_;
+  }
+
+ private:
+  static void DeliverLocked(Subscription& subscription,
+                            absl::StatusOr<Responses> responses, bool last)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(subscription.delivery_mutex) {
+    if (subscription.ended) {
+      return;
+    }
+    if (subscription.cancelled) {
+      responses = absl::CancelledError("The request was cancelled.");
+      last = true;
+    }
+    if (responses.ok() && !responses->GetTexts().empty()) {
+      subscription.text += responses->GetTexts()[0];
+    }
+    if (last) {
+      subscription.ended = true;
+      subscription.succeeded =
+          responses.ok() && (!IsTaskEndState(responses->GetTaskState()) ||
+                             IsSuccessfulEndState(responses->GetTaskState()));
+    }
+    subscription.callback(std::move(responses));
+    if (last) {
+      subscription.done.Notify();
+    }
+  }
+
+  bool HasLiveSubscriptions(const Request& request) const {
+    absl::MutexLock lock(mutex_);
+    return request.num_live_subscriptions > 0;
+  }
+
+  void EraseLocked(const Request& request)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    auto it = requests_.find(request.key);
+    if (it != requests_.end() && it->second.get() == &request) {
+      requests_.erase(it);
+    }
+  }
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Request>> requests_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t num_coalesced_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t num_cache_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+  const std::unique_ptr<ResponseCache> cache_;
+  // Declared last, so that the replays in flight are done before the other
+  // members are destroyed.
+  std::unique_ptr<ThreadPool> replay_pool_;
+};
+
+namespace {
+
+class CoalescingSession : public Engine::Session {
+ public:
+  CoalescingSession(std::shared_ptr<Session> session,
+                    std::shared_ptr<CoalescingRegistry> registry)
+      : session_(std::move(session)), registry_(std::move(registry)) {}
+
+  ~CoalescingSession() override {
+    CancelSubscription();
+    absl::Status status = WaitUntilDone();
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to wait for the coalescing session: "
+                        << status;
+    }
+  }
+
+  absl::StatusOr<Responses> GenerateContent(
+      const std::vector<InputData>& contents) override {
+    std::optional<std::string> key = TakeCoalescingKey(contents, nullptr);
+    if (!key.has_value()) {
+      ASSIGN_OR_RETURN(Session * session, Prepare());
+      return session->GenerateContent(contents);
+    }
+    auto result = std::make_shared<std::optional<absl::StatusOr<Responses>>>();
+    ASSIGN_OR_RETURN(
+        auto joined,
+        Join(*key, contents, nullptr,
+             [result](absl::StatusOr<Responses> responses) {
+               *result = std::move(responses);
+             }));
+    if (joined.cached.has_value()) {
+      registry_->Replay(joined.request, *std::move(joined.cached),
+                        /*stream=*/false);
+    } else if (joined.is_owner) {
+      registry_->Publish(joined.request, session_->GenerateContent(contents),
+                         /*last=*/true);
+    }
+    joined.subscription->done.WaitForNotification();
+    return std::move(**result);
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents,
+      ResponsesCallback callback) override {
+    return GenerateContentStream(contents, std::move(callback),
+                                 DecodeConfig::CreateDefault());
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents, ResponsesCallback callback,
+      const DecodeConfig& decode_config) override {
+    std::optional<std::string> key =
+        TakeCoalescingKey(contents, &decode_config);
+    if (!key.has_value()) {
+      ASSIGN_OR_RETURN(Session * session, Prepare());
+      return session->GenerateContentStream(contents, std::move(callback),
+                                            decode_config);
+    }
+    ASSIGN_OR_RETURN(auto joined, Join(*key, contents, &decode_config,
+                                       std::move(callback)));
+    if (joined.cached.has_value()) {
+      registry_->Replay(joined.request, *std::move(joined.cached),
+                        /*stream=*/true);
+      return absl::OkStatus();
+    }
+    if (!joined.is_owner) {
+      return absl::OkStatus();
+    }
+    absl::Status status = session_->GenerateContentStream(
+        contents,
+        [registry = registry_, request = joined.request](
+            absl::StatusOr<Responses> responses) {
+          const bool last =
+              !responses.ok() || IsTaskEndState(responses->GetTaskState());
+          registry->Publish(request, std::move(responses), last);
+        },
+        decode_config);
+    if (!status.ok()) {
+      // Subscribers may have joined already, they all get the error.
+      registry_->Publish(joined.request, status, /*last=*/true);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Responses> RunTextScoring(
+      const std::vector<absl::string_view>& target_text,
+      bool store_token_lengths) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunTextScoring(target_text, store_token_lengths);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunTextScoringAsync(
+      const std::vector<absl::string_view>& target_text,
+      ResponsesCallback callback, bool store_token_lengths) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunTextScoringAsync(target_text, std::move(callback),
+                                        store_token_lengths);
+  }
+
+  absl::StatusOr<Responses> RunTextClassification(
+      const std::vector<absl::string_view>& choices) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunTextClassification(choices);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunTextClassificationAsync(
+      const std::vector<absl::string_view>& choices,
+      ResponsesCallback callback) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunTextClassificationAsync(choices, std::move(callback));
+  }
+
+  absl::Status RunPrefill(const std::vector<InputData>& contents) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunPrefill(contents);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunPrefillAsync(
+      const std::vector<InputData>& contents,
+      ResponsesCallback callback) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunPrefillAsync(contents, std::move(callback));
+  }
+
+  absl::StatusOr<Responses> RunDecode() override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunDecode();
+  }
+
+  absl::StatusOr<Responses> RunDecode(
+      const DecodeConfig& decode_config) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunDecode(decode_config);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      ResponsesCallback callback) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunDecodeAsync(std::move(callback));
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      ResponsesCallback callback, const DecodeConfig& decode_config) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    return session->RunDecodeAsync(std::move(callback), decode_config);
+  }
+
+  absl::StatusOr<BenchmarkInfo> GetBenchmarkInfo() override {
+    return session_->GetBenchmarkInfo();
+  }
+
+  absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo() override {
+    return session_->GetMutableBenchmarkInfo();
+  }
+
+  void CancelProcess() override {
+    if (!CancelSubscription()) {
+      session_->CancelProcess();
+    }
+  }
+
+  absl::Status WaitUntilDone() override {
+    std::shared_ptr<CoalescingRegistry::Request> request;
+    std::shared_ptr<CoalescingRegistry::Subscription> subscription;
+    bool is_owner;
+    {
+      absl::MutexLock lock(mutex_);
+      request = request_;
+      subscription = subscription_;
+      is_owner = is_owner_;
+    }
+    if (subscription != nullptr &&
+        !subscription->done.WaitForNotificationWithTimeout(
+            Engine::kDefaultTimeout)) {
+      return absl::DeadlineExceededError(
+          "Timed out waiting for the coalesced request.");
+    }
+    // The other subscribers may still be served by this session.
+    if (is_owner && !request->released.WaitForNotificationWithTimeout(
+                        Engine::kDefaultTimeout)) {
+      return absl::DeadlineExceededError(
+          "Timed out waiting for the coalesced request.");
+    }
+    return session_->WaitUntilDone();
+  }
+
+  absl::StatusOr<std::unique_ptr<Session>> Clone() override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    ASSIGN_OR_RETURN(std::unique_ptr<Session> clone, session->Clone());
+    return Wrap(std::move(clone));
+  }
+
+  absl::StatusOr<std::unique_ptr<Session>> CloneAsync(
+      ResponsesCallback callback) override {
+    ASSIGN_OR_RETURN(Session * session, Prepare());
+    ASSIGN_OR_RETURN(std::unique_ptr<Session> clone,
+                     session->CloneAsync(std::move(callback)));
+    return Wrap(std::move(clone));
+  }
+
+  const SessionConfig& GetSessionConfig() const override {
+    return session_->GetSessionConfig();
+  }
+
+ private:
+  // Clones have a context, so they are never coalesced.
+  std::unique_ptr<Session> Wrap(std::unique_ptr<Session> clone) {
+    auto session = std::make_unique<CoalescingSession>(std::move(clone),
+                                                       registry_);
+    absl::MutexLock lock(session->mutex_);
+    session->has_context_ = true;
+    return session;
+  }
+
+  // Returns the coalescing key of a generation request, or std::nullopt if
+  // the request cannot be coalesced. Only the first call on a session is
+  // coalesced, as the others depend on the context of the session.
+  std::optional<std::string> TakeCoalescingKey(
+      const std::vector<InputData>& contents,
+      const DecodeConfig* decode_config) {
+    {
+      absl::MutexLock lock(mutex_);
+      if (has_context_) {
+        return std::nullopt;
+      }
+      has_context_ = true;
+    }
+    return GetCoalescingKey(session_->GetSessionConfig(), contents,
+                            decode_config);
+  }
+
+  absl::StatusOr<CoalescingRegistry::JoinResult> Join(
+      const std::string& key, const std::vector<InputData>& contents,
+      const DecodeConfig* decode_config, ResponsesCallback callback) {
+    ASSIGN_OR_RETURN(std::vector<InputData> inputs,
+                     CreateInputDataVectorCopy(contents));
+    CoalescingRegistry::JoinResult joined = registry_->Join(
+        key,
+        registry_->GetCacheKey(key, session_->GetSessionConfig(),
+                               decode_config),
+        session_, std::move(callback));
+    absl::MutexLock lock(mutex_);
+    request_ = joined.request;
+    subscription_ = joined.subscription;
+    is_owner_ = joined.is_owner;
+    // A cached answer was not generated on this session either.
+    if (!joined.is_owner || joined.cached.has_value()) {
+      replay_inputs_ = std::move(inputs);
+      needs_replay_ = true;
+    }
+    return joined;
+  }
+
+  // Returns the underlying session, after prefilling the coalesced turn into
+  // it if it was served by another session.
+  absl::StatusOr<Session*> Prepare() {
+    std::shared_ptr<CoalescingRegistry::Subscription> subscription;
+    std::vector<InputData> inputs;
+    {
+      absl::MutexLock lock(mutex_);
+      has_context_ = true;
+      if (!needs_replay_) {
+        return session_.get();
+      }
+      needs_replay_ = false;
+      subscription = subscription_;
+      inputs = std::move(replay_inputs_);
+    }
+    if (!subscription->done.WaitForNotificationWithTimeout(
+            Engine::kDefaultTimeout)) {
+      return absl::DeadlineExceededError(
+          "Timed out waiting for the coalesced request.");
+    }
+    {
+      absl::MutexLock lock(subscription->delivery_mutex);
+      if (subscription->succeeded && !subscription->text.empty()) {
+        inputs.emplace_back(InputText(subscription->text));
+      }
+    }
+    RETURN_IF_ERROR(session_->RunPrefill(inputs));
+    return session_.get();
+  }
+
+  // Cancels the coalesced request of the session, if one is in flight.
+  // Returns false if there is none.
+  bool CancelSubscription() {
+    std::shared_ptr<CoalescingRegistry::Request> request;
+    std::shared_ptr<CoalescingRegistry::Subscription> subscription;
+    {
+      absl::MutexLock lock(mutex_);
+      request = request_;
+      subscription = subscription_;
+    }
+    if (subscription == nullptr || subscription->done.HasBeenNotified()) {
+      return false;
+    }
+    registry_->Cancel(request, subscription);
+    return true;
+  }
+
+  // Shared with the in-flight request this session runs, if any.
+  const std::shared_ptr<Session> session_;
+  const std::shared_ptr<CoalescingRegistry> registry_;
+
+  absl::Mutex mutex_;
+  // Whether any call was made on the session (or its source, for clones).
+  bool has_context_ ABSL_GUARDED_BY(mutex_) = false;
+  // The coalesced request of the first call, if any.
+  std::shared_ptr<CoalescingRegistry::Request> request_ ABSL_GUARDED_BY(mutex_);
+  std::shared_ptr<CoalescingRegistry::Subscription> subscription_
+      ABSL_GUARDED_BY(mutex_);
+  bool is_owner_ ABSL_GUARDED_BY(mutex_) = false;
+  // The inputs of the coalesced request, prefilled with its answer before the
+  // next call when the request was run by another session.
+  std::vector<InputData> replay_inputs_ ABSL_GUARDED_BY(mutex_);
+  bool needs_replay_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace
+
+std::optional<std::string> GetCoalescingKey(
+    const SessionConfig& session_config, const std::vector<InputData>& contents,
+    const DecodeConfig* decode_config) {
+  const proto::SamplerParameters& sampler_params =
+      session_config.GetSamplerParams();
+  if (!IsDeterministic(sampler_params) || contents.empty()) {
+    return std::nullopt;
+  }
+  std::string key = decode_config == nullptr ? "blocking;" : "stream;";
+  for (const InputData& input : contents) {
+    const auto* input_text = std::get_if<InputText>(&input);
+    if (input_text == nullptr || input_text->IsTensorBuffer()) {
+      return std::nullopt;
+    }
+    absl::StatusOr<absl::string_view> text = input_text->GetRawTextString();
+    if (!text.ok()) {
+      return std::nullopt;
+    }
+    AppendKeyField(key, *text);
+  }
+  AppendKeyField(key, sampler_params.SerializeAsString());
+  absl::StrAppend(&key, "stop_token_ids;");
+  for (const std::vector<int>& stop_token_ids :
+       session_config.GetStopTokenIds()) {
+    absl::StrAppend(&key, absl::StrJoin(stop_token_ids, ","), ";");
+  }
+  absl::StrAppend(&key, "stop_strings;");
+  for (const std::string& stop_string : session_config.GetStopStrings()) {
+    AppendKeyField(key, stop_string);
+  }
+  AppendKeyField(key, session_config.GetPromptTemplates().SerializeAsString());
+  AppendKeyField(key, session_config.GetLlmModelType().SerializeAsString());
+  absl::StrAppend(
+      &key, session_config.GetStartTokenId(), ";",
+      session_config.GetNumOutputCandidates(), ";",
+      static_cast<int>(session_config.GetSamplerBackend()), ";",
+      session_config.GetApplyPromptTemplateInSession(), ";",
+      session_config.UseExternalSampler(), ";",
+      session_config.GetMaxOutputTokens(), ";",
+      session_config.GetNumTopLogProbs(), ";",
+      // The LoRA weights are identified by their file.
+      reinterpret_cast<uintptr_t>(session_config.GetScopedLoraFile().get()),
+      ";");
+  if (decode_config != nullptr) {
+    absl::StrAppend(
+        &key, decode_config->GetMaxOutputTokens().value_or(-1), ";",
+        decode_config->GetNumTopLogProbs().value_or(-1), ";",
+        decode_config->GetReturnTokenLogProbs(), ";",
+        // Constraints are stateful objects, only the same one is known to
+        // accept the same tokens.
+        reinterpret_cast<uintptr_t>(decode_config->GetConstraint()), ";");
+    // Subscribers receive the chunks of the owner's stream, so only requests
+    // chunked the same way can share it.
+    const StreamingChunkPolicy& policy =
+        session_config.GetStreamingChunkPolicy();
+    absl::StrAppend(&key, "chunks;", policy.max_tokens, ";", policy.max_bytes,
+                    ";", absl::FormatDuration(policy.max_delay), ";");
+    for (const std::string& flush_string : policy.flush_strings) {
+      AppendKeyField(key, flush_string);
+    }
+  }
+  return key;
+}
+
+absl::StatusOr<std::unique_ptr<CoalescingEngine>> CoalescingEngine::Create(
+    std::unique_ptr<Engine> engine,
+    std::optional<ResponseCacheConfig> cache_config) {
+  if (engine == nullptr) {
+    return absl::InvalidArgumentError("The engine must be provided.");
+  }
+  std::unique_ptr<ResponseCache> cache;
+  if (cache_config.has_value()) {
+    if (cache_config->model_id.empty()) {
+      absl::StatusOr<std::string> model_id =
+          GetModelId(engine->GetEngineSettings());
+      if (model_id.ok()) {
+        cache_config->model_id = *std::move(model_id);
+      } else if (cache_config->directory.has_value()) {
+        // Persisted entries must not be served for another model.
+        return absl::InvalidArgumentError(absl::StrCat(
+            "The model id must be set to persist the response cache: ",
+            model_id.status().message()));
+      }
+    }
+    ASSIGN_OR_RETURN(cache, ResponseCache::Create(*cache_config));
+  }
+  return absl::WrapUnique(new CoalescingEngine(
+      std::move(engine),
+      std::make_shared<CoalescingRegistry>(std::move(cache))));
+}
+
+absl::StatusOr<std::unique_ptr<Engine::Session>>
+CoalescingEngine::CreateSession(const SessionConfig& session_config) {
+  ASSIGN_OR_RETURN(std::unique_ptr<Session> session,
+                   engine_->CreateSession(session_config));
+  return std::make_unique<CoalescingSession>(std::move(session), registry_);
+}
+
+int64_t CoalescingEngine::GetNumCoalescedRequests() const {
+  return registry_->GetNumCoalesced();
+}
+
+int64_t CoalescingEngine::GetNumCacheHits() const {
+  return registry_->GetNumCacheHits();
+}
+
+}  // namespace litert::lm
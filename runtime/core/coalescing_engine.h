@@ -0,0 +1,125 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_COALESCING_ENGINE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_COALESCING_ENGINE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/components/tokenizer.h"
+#include "runtime/core/response_cache.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+
+namespace litert::lm {
+
+class CoalescingRegistry;
+
+// An Engine running identical concurrent generation requests only once.
+//
+// A GenerateContent or GenerateContentStream call can be coalesced when it is
+// the first call on its session, its inputs are raw text only, and the
+// sampling of the session is deterministic: greedy, top-k with k == 1, or
+// seeded. While such a request is in flight, an identical request (see
+// GetCoalescingKey) subscribes to it instead of running its own prefill and
+// decode: it receives the responses streamed so far, then the rest of the
+// stream.
+//
+// Cancelling a subscriber with Session::CancelProcess only ends its own
+// stream with a CANCELLED error; the generation itself is cancelled once all
+// of its subscribers have cancelled. A session that was served by another
+// session's generation has an empty context, so the inputs and the answer of
+// the coalesced turn are prefilled into it before its next call.
+//
+// With a response cache, the responses of the requests that completed
+// successfully are kept, and an identical request made later is answered from
+// the cache without running the model: a stream is replayed through its
+// callback, paced by ResponseCacheConfig::replay_interval. Requests with a
+// constraint, LoRA weights or log-probabilities are not cached, as these are
+// only identified by the address of their objects.
+class CoalescingEngine : public Engine {
+ public:
+  // Creates the engine, with a response cache if `cache_config` is set.
+  static absl::StatusOr<std::unique_ptr<CoalescingEngine>> Create(
+      std::unique_ptr<Engine> engine,
+      std::optional<ResponseCacheConfig> cache_config = std::nullopt);
+
+  absl::StatusOr<std::unique_ptr<Session>> CreateSession(
+      const SessionConfig& session_config) override;
+
+  absl::Status WaitUntilDone(absl::Duration timeout) override {
+    return engine_->WaitUntilDone(timeout);
+  }
+
+  const EngineSettings& GetEngineSettings() const override {
+    return engine_->GetEngineSettings();
+  }
+  const Tokenizer& GetTokenizer() const override {
+    return engine_->GetTokenizer();
+  }
+  absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties()
+      const override {
+    return engine_->GetAudioExecutorProperties();
+  }
+  absl::StatusOr<VisionExecutorProperties> GetVisionExecutorProperties()
+      const override {
+    return engine_->GetVisionExecutorProperties();
+  }
+  absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const override {
+    return engine_->GetMetricsSnapshot();
+  }
+
+  // Returns the number of requests served by subscribing to the generation
+  // of an identical in-flight request.
+  int64_t GetNumCoalescedRequests() const;
+
+  // Returns the number of requests answered from the response cache.
+  int64_t GetNumCacheHits() const;
+
+  Engine& engine() { return *engine_; }
+
+ private:
+  CoalescingEngine(std::unique_ptr<Engine> engine,
+                   std::shared_ptr<CoalescingRegistry> registry)
+      : engine_(std::move(engine)), registry_(std::move(registry)) {}
+
+  std::unique_ptr<Engine> engine_;
+  std::shared_ptr<CoalescingRegistry> registry_;
+};
+
+// Returns the key identifying a generation request on a new session, or
+// std::nullopt if the request cannot be coalesced. Two requests with the same
+// key produce the same responses: the key covers the raw text of the inputs
+// (which determines their tokens), the sampler parameters, the stop tokens and
+// strings, the output limits, the prompt template settings, the constraint and
+// the LoRA weights, and for streaming calls the streaming chunk policy.
+// `decode_config` is null for blocking calls, which are only coalesced with
+// other blocking calls.
+std::optional<std::string> GetCoalescingKey(
+    const SessionConfig& session_config, const std::vector<InputData>& contents,
+    const DecodeConfig* decode_config);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_COALESCING_ENGINE_H_
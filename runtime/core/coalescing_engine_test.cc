@@ -0,0 +1,392 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/coalescing_engine.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/components/tokenizer.h"
+#include "runtime/core/response_cache.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/proto/sampler_params.pb.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Return;
+using ::testing::ReturnRef;
+using ::testing::status::StatusIs;
+
+using ResponsesCallback = absl::AnyInvocable<void(absl::StatusOr<Responses>)>;
+
+class MockSession : public Engine::Session {
+ public:
+  MOCK_METHOD(absl::StatusOr<Responses>, GenerateContent,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback),
+              (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback,
+               const DecodeConfig& decode_config),
+              (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunTextScoring,
+              (const std::vector<absl::string_view>& target_text,
+               bool store_token_lengths),
+              (override));
+  MOCK_METHOD(absl::Status, RunPrefill,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode, (), (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode,
+              (const DecodeConfig& decode_config), (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo>, GetBenchmarkInfo, (), (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo*>, GetMutableBenchmarkInfo, (),
+              (override));
+  MOCK_METHOD(void, CancelProcess, (), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (), (override));
+  MOCK_METHOD(const SessionConfig&, GetSessionConfig, (), (const, override));
+};
+
+class MockEngine : public Engine {
+ public:
+  MOCK_METHOD(const EngineSettings&, GetEngineSettings, (), (const, override));
+  MOCK_METHOD(const Tokenizer&, GetTokenizer, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<AudioExecutorProperties>,
+              GetAudioExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<VisionExecutorProperties>,
+              GetVisionExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<std::unique_ptr<Session>>, CreateSession,
+              (const SessionConfig& session_config), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (absl::Duration timeout),
+              (override));
+};
+
+SessionConfig GreedyConfig() {
+  SessionConfig config = SessionConfig::CreateDefault();
+  config.GetMutableSamplerParams().set_type(proto::SamplerParameters::GREEDY);
+  return config;
+}
+
+std::vector<InputData> Text(const std::string& text) {
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText(text));
+  return inputs;
+}
+
+std::string RawText(const InputData& input) {
+  return std::string(*std::get<InputText>(input).GetRawTextString());
+}
+
+// Records the streamed texts and the final status of a request.
+struct StreamRecorder {
+  ResponsesCallback Callback() {
+    return [this](absl::StatusOr<Responses> responses) {
+      if (!responses.ok()) {
+        status = responses.status();
+        return;
+      }
+      if (!responses->GetTexts().empty()) {
+        texts.push_back(responses->GetTexts()[0]);
+      }
+      if (IsTaskEndState(responses->GetTaskState())) {
+        done = true;
+      }
+    };
+  }
+
+  std::vector<std::string> texts;
+  absl::Status status;
+  bool done = false;
+};
+
+class CoalescingEngineTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto engine = std::make_unique<MockEngine>();
+    engine_ = engine.get();
+    ASSERT_OK_AND_ASSIGN(
+        coalescing_engine_,
+        CoalescingEngine::Create(std::move(engine), GetCacheConfig()));
+  }
+
+  virtual std::optional<ResponseCacheConfig> GetCacheConfig() {
+    return std::nullopt;
+  }
+
+  // Makes the engine hand out a new mock session.
+  MockSession* ExpectSession() {
+    auto session = std::make_unique<MockSession>();
+    MockSession* session_ptr = session.get();
+    EXPECT_CALL(*session_ptr, GetSessionConfig())
+        .WillRepeatedly(ReturnRef(config_));
+    EXPECT_CALL(*session_ptr, WaitUntilDone())
+        .WillRepeatedly(Return(absl::OkStatus()));
+    EXPECT_CALL(*engine_, CreateSession(_))
+        .WillOnce(Return(std::move(session)));
+    return session_ptr;
+  }
+
+  SessionConfig config_ = GreedyConfig();
+  MockEngine* engine_;
+  std::unique_ptr<CoalescingEngine> coalescing_engine_;
+};
+
+TEST(GetCoalescingKeyTest, IdentifiesDeterministicTextRequests) {
+  const SessionConfig config = GreedyConfig();
+  const DecodeConfig decode_config = DecodeConfig::CreateDefault();
+  auto key = GetCoalescingKey(config, Text("Hi"), &decode_config);
+  ASSERT_TRUE(key.has_value());
+  EXPECT_EQ(GetCoalescingKey(config, Text("Hi"), &decode_config), key);
+  EXPECT_NE(GetCoalescingKey(config, Text("Hello"), &decode_config), key);
+  // Blocking calls are not coalesced with streaming ones.
+  EXPECT_NE(GetCoalescingKey(config, Text("Hi"), nullptr), key);
+
+  SessionConfig seeded = SessionConfig::CreateDefault();
+  seeded.GetMutableSamplerParams().set_type(proto::SamplerParameters::TOP_P);
+  seeded.GetMutableSamplerParams().set_k(40);
+  EXPECT_FALSE(
+      GetCoalescingKey(seeded, Text("Hi"), &decode_config).has_value());
+  seeded.GetMutableSamplerParams().set_seed(7);
+  EXPECT_TRUE(GetCoalescingKey(seeded, Text("Hi"), &decode_config).has_value());
+  EXPECT_NE(GetCoalescingKey(seeded, Text("Hi"), &decode_config), key);
+}
+
+TEST(GetCoalescingKeyTest, StreamsWithDifferentChunkingAreNotCoalesced) {
+  const SessionConfig config = GreedyConfig();
+  const DecodeConfig decode_config = DecodeConfig::CreateDefault();
+  const auto key = GetCoalescingKey(config, Text("Hi"), &decode_config);
+  const auto blocking_key = GetCoalescingKey(config, Text("Hi"), nullptr);
+
+  SessionConfig chunked = GreedyConfig();
+  chunked.GetMutableStreamingChunkPolicy().max_tokens = 8;
+  EXPECT_NE(GetCoalescingKey(chunked, Text("Hi"), &decode_config), key);
+  // Blocking calls are not streamed, so their chunking does not matter.
+  EXPECT_EQ(GetCoalescingKey(chunked, Text("Hi"), nullptr), blocking_key);
+
+  chunked = GreedyConfig();
+  chunked.GetMutableStreamingChunkPolicy().max_bytes = 64;
+  EXPECT_NE(GetCoalescingKey(chunked, Text("Hi"), &decode_config), key);
+
+  chunked = GreedyConfig();
+  chunked.GetMutableStreamingChunkPolicy().max_delay = absl::Milliseconds(20);
+  EXPECT_NE(GetCoalescingKey(chunked, Text("Hi"), &decode_config), key);
+
+  chunked = GreedyConfig();
+  chunked.GetMutableStreamingChunkPolicy().flush_strings.push_back("```");
+  EXPECT_NE(GetCoalescingKey(chunked, Text("Hi"), &decode_config), key);
+}
+
+TEST(CoalescingEngineCreateTest, RejectsNullEngine) {
+  EXPECT_THAT(CoalescingEngine::Create(nullptr),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(CoalescingEngineTest, IdenticalStreamsShareOneGeneration) {
+  MockSession* first_session = ExpectSession();
+  ResponsesCallback generation;
+  EXPECT_CALL(*first_session, GenerateContentStream(_, _, _))
+      .WillOnce([&](const std::vector<InputData>&, ResponsesCallback callback,
+                    const DecodeConfig&) {
+        generation = std::move(callback);
+        return absl::OkStatus();
+      });
+  ASSERT_OK_AND_ASSIGN(auto first, coalescing_engine_->CreateSession(config_));
+  StreamRecorder first_recorder;
+  ASSERT_OK(
+      first->GenerateContentStream(Text("Hi"), first_recorder.Callback()));
+  generation(Responses(TaskState::kProcessing, {"Hel"}));
+
+  MockSession* second_session = ExpectSession();
+  EXPECT_CALL(*second_session, GenerateContentStream(_, _, _)).Times(0);
+  ASSERT_OK_AND_ASSIGN(auto second, coalescing_engine_->CreateSession(config_));
+  StreamRecorder second_recorder;
+  ASSERT_OK(
+      second->GenerateContentStream(Text("Hi"), second_recorder.Callback()));
+  // The late subscriber gets the responses streamed so far.
+  EXPECT_THAT(second_recorder.texts, ElementsAre("Hel"));
+
+  generation(Responses(TaskState::kProcessing, {"lo"}));
+  generation(Responses(TaskState::kDone));
+  EXPECT_THAT(first_recorder.texts, ElementsAre("Hel", "lo"));
+  EXPECT_THAT(second_recorder.texts, ElementsAre("Hel", "lo"));
+  EXPECT_TRUE(first_recorder.done);
+  EXPECT_TRUE(second_recorder.done);
+  EXPECT_EQ(coalescing_engine_->GetNumCoalescedRequests(), 1);
+
+  // The second session did not run the turn, so it is prefilled before the
+  // next call.
+  std::vector<std::string> replayed;
+  EXPECT_CALL(*second_session, RunPrefill(_))
+      .WillOnce([&replayed](const std::vector<InputData>& contents) {
+        for (const InputData& input : contents) {
+          replayed.push_back(RawText(input));
+        }
+        return absl::OkStatus();
+      })
+      .WillOnce(Return(absl::OkStatus()));
+  ASSERT_OK(second->RunPrefill(Text("Thanks")));
+  EXPECT_THAT(replayed, ElementsAre("Hi", "Hello"));
+}
+
+TEST_F(CoalescingEngineTest, CancellingOneSubscriberKeepsTheGeneration) {
+  MockSession* first_session = ExpectSession();
+  ResponsesCallback generation;
+  EXPECT_CALL(*first_session, GenerateContentStream(_, _, _))
+      .WillOnce([&](const std::vector<InputData>&, ResponsesCallback callback,
+                    const DecodeConfig&) {
+        generation = std::move(callback);
+        return absl::OkStatus();
+      });
+  ASSERT_OK_AND_ASSIGN(auto first, coalescing_engine_->CreateSession(config_));
+  StreamRecorder first_recorder;
+  ASSERT_OK(
+      first->GenerateContentStream(Text("Hi"), first_recorder.Callback()));
+
+  ExpectSession();
+  ASSERT_OK_AND_ASSIGN(auto second, coalescing_engine_->CreateSession(config_));
+  StreamRecorder second_recorder;
+  ASSERT_OK(
+      second->GenerateContentStream(Text("Hi"), second_recorder.Callback()));
+
+  // The generation goes on for the first session.
+  EXPECT_CALL(*first_session, CancelProcess()).Times(0);
+  second->CancelProcess();
+  EXPECT_THAT(second_recorder.status, StatusIs(absl::StatusCode::kCancelled));
+  generation(Responses(TaskState::kProcessing, {"Hello"}));
+  EXPECT_THAT(first_recorder.texts, ElementsAre("Hello"));
+  EXPECT_TRUE(second_recorder.texts.empty());
+
+  // Cancelling the last subscriber cancels the generation.
+  ::testing::Mock::VerifyAndClearExpectations(first_session);
+  EXPECT_CALL(*first_session, CancelProcess()).WillOnce([&generation]() {
+    generation(absl::CancelledError("Cancelled."));
+  });
+  EXPECT_CALL(*first_session, WaitUntilDone())
+      .WillRepeatedly(Return(absl::OkStatus()));
+  first->CancelProcess();
+  EXPECT_THAT(first_recorder.status, StatusIs(absl::StatusCode::kCancelled));
+}
+
+TEST_F(CoalescingEngineTest, FollowUpTurnsAreNotCoalesced) {
+  MockSession* session = ExpectSession();
+  EXPECT_CALL(*session, RunPrefill(_)).WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(*session, GenerateContent(_))
+      .WillOnce(Return(Responses(TaskState::kDone, {"Hello"})));
+  ASSERT_OK_AND_ASSIGN(auto coalescing_session,
+                       coalescing_engine_->CreateSession(config_));
+  ASSERT_OK(coalescing_session->RunPrefill(Text("You are helpful.")));
+  ASSERT_OK_AND_ASSIGN(Responses responses,
+                       coalescing_session->GenerateContent(Text("Hi")));
+  EXPECT_THAT(responses.GetTexts(), ElementsAre("Hello"));
+  EXPECT_EQ(coalescing_engine_->GetNumCoalescedRequests(), 0);
+}
+
+class CoalescingEngineCacheTest : public CoalescingEngineTest {
+ protected:
+  std::optional<ResponseCacheConfig> GetCacheConfig() override {
+    ResponseCacheConfig cache_config;
+    cache_config.model_id = "model";
+    return cache_config;
+  }
+};
+
+TEST_F(CoalescingEngineCacheTest, AnswersRepeatedRequestsFromTheCache) {
+  MockSession* first_session = ExpectSession();
+  EXPECT_CALL(*first_session, GenerateContent(_))
+      .WillOnce(Return(Responses(TaskState::kDone, {"Hello"})));
+  ASSERT_OK_AND_ASSIGN(auto first, coalescing_engine_->CreateSession(config_));
+  ASSERT_OK(first->GenerateContent(Text("Hi")));
+
+  MockSession* second_session = ExpectSession();
+  EXPECT_CALL(*second_session, GenerateContent(_)).Times(0);
+  ASSERT_OK_AND_ASSIGN(auto second, coalescing_engine_->CreateSession(config_));
+  ASSERT_OK_AND_ASSIGN(Responses responses,
+                       second->GenerateContent(Text("Hi")));
+  EXPECT_THAT(responses.GetTexts(), ElementsAre("Hello"));
+  EXPECT_EQ(coalescing_engine_->GetNumCacheHits(), 1);
+
+  // The cached turn is prefilled before the next call.
+  std::vector<std::string> replayed;
+  EXPECT_CALL(*second_session, RunPrefill(_))
+      .WillOnce([&replayed](const std::vector<InputData>& contents) {
+        for (const InputData& input : contents) {
+          replayed.push_back(RawText(input));
+        }
+        return absl::OkStatus();
+      })
+      .WillOnce(Return(absl::OkStatus()));
+  ASSERT_OK(second->RunPrefill(Text("Thanks")));
+  EXPECT_THAT(replayed, ElementsAre("Hi", "Hello"));
+}
+
+TEST_F(CoalescingEngineCacheTest, ReplaysCachedStreams) {
+  MockSession* first_session = ExpectSession();
+  EXPECT_CALL(*first_session, GenerateContentStream(_, _, _))
+      .WillOnce([](const std::vector<InputData>&, ResponsesCallback callback,
+                   const DecodeConfig&) {
+        callback(Responses(TaskState::kProcessing, {"Hel"}));
+        callback(Responses(TaskState::kProcessing, {"lo"}));
+        callback(Responses(TaskState::kDone));
+        return absl::OkStatus();
+      });
+  ASSERT_OK_AND_ASSIGN(auto first, coalescing_engine_->CreateSession(config_));
+  StreamRecorder first_recorder;
+  ASSERT_OK(
+      first->GenerateContentStream(Text("Hi"), first_recorder.Callback()));
+
+  MockSession* second_session = ExpectSession();
+  EXPECT_CALL(*second_session, GenerateContentStream(_, _, _)).Times(0);
+  ASSERT_OK_AND_ASSIGN(auto second, coalescing_engine_->CreateSession(config_));
+  StreamRecorder second_recorder;
+  ASSERT_OK(
+      second->GenerateContentStream(Text("Hi"), second_recorder.Callback()));
+  ASSERT_OK(second->WaitUntilDone());
+  EXPECT_THAT(second_recorder.texts, ElementsAre("Hel", "lo"));
+  EXPECT_TRUE(second_recorder.done);
+  EXPECT_EQ(coalescing_engine_->GetNumCacheHits(), 1);
+}
+
+TEST_F(CoalescingEngineCacheTest, DoesNotCacheRequestsWithLogProbs) {
+  config_.SetNumTopLogProbs(1);
+  for (int i = 0; i < 2; ++i) {
+    MockSession* session = ExpectSession();
+    EXPECT_CALL(*session, GenerateContent(_))
+        .WillOnce(Return(Responses(TaskState::kDone, {"Hello"})));
+    ASSERT_OK_AND_ASSIGN(auto coalescing_session,
+                         coalescing_engine_->CreateSession(config_));
+    ASSERT_OK(coalescing_session->GenerateContent(Text("Hi")));
+  }
+  EXPECT_EQ(coalescing_engine_->GetNumCacheHits(), 0);
+}
+
+}  // namespace
+}  // namespace litert::lm
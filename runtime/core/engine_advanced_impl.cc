@@ -14,6 +14,9 @@
 
 // TODO(b/417209286): Remove this once the model assets are stored in the
 // litertlm file format.
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>  // NOLINT: Required for path manipulation.
 #include <memory>
 #include <optional>
@@ -27,15 +30,19 @@
 #include "absl/log/check.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "runtime/components/model_resources.h"
 #include "runtime/components/tokenizer.h"
+#include "runtime/core/engine_utils.h"
 #include "runtime/core/session_factory.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
@@ -134,15 +141,16 @@ class EngineAdvancedImpl : public Engine {
   static absl::StatusOr<std::unique_ptr<Engine>> Create(
       EngineSettings engine_settings, absl::string_view input_prompt_as_hint);
 
-  EngineAdvancedImpl(EngineSettings engine_settings,
-                     std::unique_ptr<ModelResources> litert_model_resources,
-                     std::unique_ptr<Tokenizer> tokenizer,
-                     std::unique_ptr<ExecutionManager> execution_manager,
-                     std::optional<BenchmarkInfo> benchmark_info)
+  EngineAdvancedImpl(
+      EngineSettings engine_settings,
+      std::unique_ptr<ModelResources> litert_model_resources,
+      std::unique_ptr<Tokenizer> tokenizer,
+      std::vector<std::shared_ptr<ExecutionManager>> execution_managers,
+      std::optional<BenchmarkInfo> benchmark_info)
       : engine_settings_(std::move(engine_settings)),
         litert_model_resources_(std::move(litert_model_resources)),
         tokenizer_(std::move(tokenizer)),
-        execution_manager_(std::move(execution_manager)),
+        execution_managers_(std::move(execution_managers)),
         benchmark_info_(std::move(benchmark_info)) {}
 
   // Method to create the Session.
@@ -166,8 +174,8 @@ class EngineAdvancedImpl : public Engine {
 
     ASSIGN_OR_RETURN(
         auto session,
-        InitializeSessionAdvanced(execution_manager_, tokenizer_.get(), config,
-                                  std::move(session_benchmark_info)));
+        InitializeSessionAdvanced(PickExecutionManager(), tokenizer_.get(),
+                                  config, std::move(session_benchmark_info)));
 
     if (benchmark_info_.has_value()) {
       auto session_benchmark_info_or = session->GetMutableBenchmarkInfo();
@@ -179,7 +187,12 @@ class EngineAdvancedImpl : public Engine {
     return session;
   }
   absl::Status WaitUntilDone(absl::Duration timeout) override {
-    return execution_manager_->WaitUntilAllDone(timeout);
+    const absl::Time deadline = absl::Now() + timeout;
+    for (const auto& execution_manager : execution_managers_) {
+      RETURN_IF_ERROR(execution_manager->WaitUntilAllDone(
+          std::max(deadline - absl::Now(), absl::ZeroDuration())));
+    }
+    return absl::OkStatus();
   }
 
   const EngineSettings& GetEngineSettings() const override {
@@ -200,7 +213,32 @@ class EngineAdvancedImpl : public Engine {
         *litert_model_resources_);
   }
 
+  absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const override {
+    if (execution_managers_.size() == 1) {
+      return execution_managers_[0]->GetMetrics().Snapshot();
+    }
+    std::vector<MetricsSnapshot> snapshots;
+    snapshots.reserve(execution_managers_.size());
+    for (const auto& execution_manager : execution_managers_) {
+      snapshots.push_back(execution_manager->GetMetrics().Snapshot());
+    }
+    return MetricsSnapshot::Merge(snapshots);
+  }
+
  private:
+  // Returns the replica a new session is placed on: the one with the fewest
+  // resident contexts, then the shortest queue. A session and its clones stay
+  // on the replica that holds their context.
+  std::shared_ptr<ExecutionManager> PickExecutionManager() {
+    absl::MutexLock lock(placement_mutex_);
+    std::vector<const EngineMetrics*> replica_metrics;
+    replica_metrics.reserve(execution_managers_.size());
+    for (const auto& execution_manager : execution_managers_) {
+      replica_metrics.push_back(&execution_manager->GetMetrics());
+    }
+    return execution_managers_[PickLeastLoadedReplica(replica_metrics)];
+  }
+
   // Stored engine settings.
   EngineSettings engine_settings_;
 
@@ -210,8 +248,13 @@ class EngineAdvancedImpl : public Engine {
   // Tokenizer shared by all sessions.
   std::unique_ptr<Tokenizer> tokenizer_;
 
-  // Execution manager for the engine.
-  std::shared_ptr<ExecutionManager> execution_manager_;
+  // One execution manager per executor replica. They share the model
+  // resources but each owns its executor.
+  std::vector<std::shared_ptr<ExecutionManager>> execution_managers_;
+
+  // Serializes session placement so that concurrent CreateSession calls see
+  // each other's resident contexts.
+  absl::Mutex placement_mutex_;
 
   // Benchmark info for the engine.
   std::optional<BenchmarkInfo> benchmark_info_;
@@ -271,6 +314,14 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineAdvancedImpl::Create(
     RETURN_IF_ERROR(benchmark_info->TimeInitPhaseEnd(
         BenchmarkInfo::InitPhase::kLlmMetadata));
   }
+  const int num_replicas = engine_settings.GetNumExecutorReplicas();
+  if (num_replicas < 1) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "The number of executor replicas must be at least 1, got ",
+        num_replicas));
+  }
+  RETURN_IF_ERROR(MaybeApplyMemoryBudget(engine_settings, *model_resources,
+                                         num_replicas));
 
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(benchmark_info->TimeInitPhaseStart(
@@ -280,40 +331,71 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineAdvancedImpl::Create(
   ASSIGN_OR_RETURN(auto& litert_env,
                    GetEnvironment(engine_settings, *model_resources));
 
-  std::unique_ptr<LlmExecutor> executor;
   const auto& main_executor_settings =
       engine_settings.GetMainExecutorSettings();
+  if (engine_settings.GetVisionExecutorSettings().has_value() &&
+      engine_settings.GetVisionExecutorSettings()->GetAdapterBackend() !=
+          Backend::CPU) {
+    ABSL_LOG(WARNING) << "Vision adapter backend is not CPU, which may cause "
+                         "precision loss.";
+  }
 
-  switch (main_executor_settings.GetBackend()) {
-    default: {
-      ASSIGN_OR_RETURN(
-          executor, CreateLlmLiteRtCompiledModelExecutor(
-                        main_executor_settings, litert_env, *model_resources));
+  // Every replica loads its executor from the same model resources and with
+  // the same weight cache settings, so the memory-mapped weights and the
+  // packed weight cache are shared while the KV cache and the thread pools
+  // are per replica.
+  std::vector<std::unique_ptr<LlmExecutor>> executors(num_replicas);
+  for (auto& executor : executors) {
+    switch (main_executor_settings.GetBackend()) {
+      default: {
+        ASSIGN_OR_RETURN(executor, CreateLlmLiteRtCompiledModelExecutor(
+                                       main_executor_settings, litert_env,
+                                       *model_resources));
+      }
+    };
+  }
+
+  // The vision and audio executors are created lazily by the execution
+  // manager, so only the main executors are warmed up here. The warmup phase
+  // is nested in the executor phase.
+  if (engine_settings.GetWarmupOnInit()) {
+    if (benchmark_info.has_value()) {
+      RETURN_IF_ERROR(benchmark_info->TimeInitPhaseStart(
+          BenchmarkInfo::InitPhase::kWarmup));
     }
-  };
-
-  std::unique_ptr<VisionExecutorSettings> vision_executor_settings_ptr;
-  if (engine_settings.GetVisionExecutorSettings().has_value()) {
-    vision_executor_settings_ptr = std::make_unique<VisionExecutorSettings>(
-        std::move(engine_settings.GetVisionExecutorSettings().value()));
-    if (vision_executor_settings_ptr->GetAdapterBackend() != Backend::CPU) {
-      ABSL_LOG(WARNING) << "Vision adapter backend is not CPU, which may cause "
-                           "precision loss.";
+    for (auto& executor : executors) {
+      RETURN_IF_ERROR(WarmupExecutor(executor->Warmup(), "LLM"));
+    }
+    if (benchmark_info.has_value()) {
+      RETURN_IF_ERROR(benchmark_info->TimeInitPhaseEnd(
+          BenchmarkInfo::InitPhase::kWarmup));
     }
   }
 
-  std::unique_ptr<AudioExecutorSettings> audio_executor_settings_ptr;
-  if (engine_settings.GetAudioExecutorSettings().has_value()) {
-    audio_executor_settings_ptr = std::make_unique<AudioExecutorSettings>(
-        std::move(engine_settings.GetAudioExecutorSettings().value()));
-  }
+  std::vector<std::shared_ptr<ExecutionManager>> execution_managers;
+  execution_managers.reserve(num_replicas);
+  for (auto& executor : executors) {
+    std::unique_ptr<VisionExecutorSettings> vision_executor_settings_ptr;
+    if (engine_settings.GetVisionExecutorSettings().has_value()) {
+      vision_executor_settings_ptr = std::make_unique<VisionExecutorSettings>(
+          *engine_settings.GetVisionExecutorSettings());
+    }
+
+    std::unique_ptr<AudioExecutorSettings> audio_executor_settings_ptr;
+    if (engine_settings.GetAudioExecutorSettings().has_value()) {
+      audio_executor_settings_ptr = std::make_unique<AudioExecutorSettings>(
+          *engine_settings.GetAudioExecutorSettings());
+    }
 
-  ASSIGN_OR_RETURN(
-      auto execution_manager,
-      ExecutionManager::Create(
-          tokenizer.get(), model_resources.get(), std::move(executor),
-          std::move(vision_executor_settings_ptr),
-          std::move(audio_executor_settings_ptr), &litert_env));
+    ASSIGN_OR_RETURN(
+        auto execution_manager,
+        ExecutionManager::Create(
+            tokenizer.get(), model_resources.get(), std::move(executor),
+            std::move(vision_executor_settings_ptr),
+            std::move(audio_executor_settings_ptr), &litert_env,
+            engine_settings.GetMaxResidentContexts()));
+    execution_managers.push_back(std::move(execution_manager));
+  }
 
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(
@@ -327,7 +409,7 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineAdvancedImpl::Create(
 
   auto llm_impl = std::make_unique<EngineAdvancedImpl>(
       std::move(engine_settings), std::move(model_resources),
-      std::move(tokenizer), std::move(execution_manager),
+      std::move(tokenizer), std::move(execution_managers),
       std::move(benchmark_info));
 
   return llm_impl;
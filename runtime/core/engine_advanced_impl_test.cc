@@ -29,6 +29,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -295,6 +296,48 @@ TEST(EngineTest, CreateEngine_FailsNoAudioModel) {
                   "TF_LITE_AUDIO_ENCODER_HW not found in the model."));
 }
 
+TEST(EngineTest, CreateEngine_SpreadsSessionsAcrossReplicas) {
+  auto task_path =
+      std::filesystem::path(::testing::SrcDir()) /
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task";
+  auto model_assets = ModelAssets::Create(task_path.string());
+  ASSERT_OK(model_assets);
+  auto engine_settings =
+      EngineSettings::CreateDefault(*model_assets, Backend::CPU);
+  ASSERT_OK(engine_settings);
+  engine_settings->GetMutableMainExecutorSettings().SetMaxNumTokens(
+      kMaxNumTokens);
+  engine_settings->GetMutableMainExecutorSettings().SetCacheDir(":nocache");
+  engine_settings->SetNumExecutorReplicas(2);
+  // Each replica only keeps one context, so the second session only fits if
+  // it is placed on the replica without one.
+  engine_settings->SetMaxResidentContexts(1);
+  ASSERT_OK_AND_ASSIGN(auto llm, CreateEngine(*engine_settings));
+
+  ASSERT_OK_AND_ASSIGN(auto session1,
+                       llm->CreateSession(SessionConfig::CreateDefault()));
+  ASSERT_OK_AND_ASSIGN(auto session2,
+                       llm->CreateSession(SessionConfig::CreateDefault()));
+  EXPECT_THAT(llm->CreateSession(SessionConfig::CreateDefault()),
+              testing::status::StatusIs(absl::StatusCode::kResourceExhausted));
+
+  ASSERT_OK_AND_ASSIGN(auto snapshot, llm->GetMetricsSnapshot());
+  const MetricSnapshot* resident_contexts =
+      snapshot.Find("litert_lm_resident_contexts");
+  ASSERT_NE(resident_contexts, nullptr);
+  EXPECT_EQ(resident_contexts->value, 2);
+
+  // Both sessions run on their own replica.
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText("Hello world!"));
+  EXPECT_OK(session1->RunPrefill(inputs));
+  EXPECT_OK(session2->RunPrefill(inputs));
+
+  // Deleting a session frees its replica for the next one.
+  session1.reset();
+  EXPECT_OK(llm->CreateSession(SessionConfig::CreateDefault()));
+}
+
 // TODO (b/397975034): Add more tests for Engine.
 
 }  // namespace
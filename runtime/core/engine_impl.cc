@@ -33,9 +33,11 @@
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "runtime/components/model_resources.h"
 #include "runtime/components/tokenizer.h"
+#include "runtime/core/engine_utils.h"
 #include "runtime/core/session_factory.h"
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -140,7 +142,8 @@ class EngineImpl : public Engine {
              std::unique_ptr<VisionExecutor> vision_executor,
              std::unique_ptr<AudioExecutor> audio_executor,
              std::optional<BenchmarkInfo> benchmark_info,
-             std::unique_ptr<ThreadPool> worker_thread_pool)
+             std::unique_ptr<ThreadPool> worker_thread_pool,
+             std::unique_ptr<EngineMetrics> metrics)
       : engine_settings_(std::move(engine_settings)),
         litert_model_resources_(std::move(litert_model_resources)),
         tokenizer_(std::move(tokenizer)),
@@ -150,6 +153,7 @@ class EngineImpl : public Engine {
         stop_token_ids_(),
         sampler_params_(),
         benchmark_info_(std::move(benchmark_info)),
+        metrics_(std::move(metrics)),
         worker_thread_pool_(std::move(worker_thread_pool)) {}
   // Method to create the Session.
   absl::StatusOr<std::unique_ptr<Session>> CreateSession(
@@ -175,7 +179,8 @@ class EngineImpl : public Engine {
                                /*vision_executor=*/vision_executor_.get(),
                                /*audio_executor=*/audio_executor_.get(), config,
                                std::move(session_benchmark_info),
-                               worker_thread_pool_.get()));
+                               worker_thread_pool_.get(), metrics_.get()));
+    metrics_->sessions_created->Increment();
     if (benchmark_info_.has_value()) {
       auto session_benchmark_info_or = session->GetMutableBenchmarkInfo();
       if (session_benchmark_info_or.ok()) {
@@ -211,6 +216,10 @@ class EngineImpl : public Engine {
     return vision_executor_->GetVisionExecutorProperties();
   }
 
+  absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const override {
+    return metrics_->Snapshot();
+  }
+
  private:
   // Stored engine settings.
   EngineSettings engine_settings_;
@@ -231,6 +240,10 @@ class EngineImpl : public Engine {
   // Benchmark info for the engine.
   std::optional<BenchmarkInfo> benchmark_info_;
 
+  // Live metrics recorded by the sessions of the engine. Declared before
+  // `worker_thread_pool_` so that it outlives any scheduled work.
+  std::unique_ptr<EngineMetrics> metrics_;
+
   // Thread pool for the engine to execute the works.
   std::unique_ptr<ThreadPool> worker_thread_pool_;
 };
@@ -289,6 +302,7 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineImpl::Create(
     RETURN_IF_ERROR(benchmark_info->TimeInitPhaseEnd(
         BenchmarkInfo::InitPhase::kLlmMetadata));
   }
+  RETURN_IF_ERROR(MaybeApplyMemoryBudget(engine_settings, *model_resources));
 
   if (benchmark_info.has_value()) {
     RETURN_IF_ERROR(benchmark_info->TimeInitPhaseStart(
@@ -331,6 +345,24 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineImpl::Create(
         benchmark_info->TimeInitPhaseEnd(BenchmarkInfo::InitPhase::kExecutor));
   }
 
+  if (engine_settings.GetWarmupOnInit()) {
+    if (benchmark_info.has_value()) {
+      RETURN_IF_ERROR(benchmark_info->TimeInitPhaseStart(
+          BenchmarkInfo::InitPhase::kWarmup));
+    }
+    RETURN_IF_ERROR(WarmupExecutor(executor->Warmup(), "LLM"));
+    if (vision_executor != nullptr) {
+      RETURN_IF_ERROR(WarmupExecutor(vision_executor->Warmup(), "Vision"));
+    }
+    if (audio_executor != nullptr) {
+      RETURN_IF_ERROR(WarmupExecutor(audio_executor->Warmup(), "Audio"));
+    }
+    if (benchmark_info.has_value()) {
+      RETURN_IF_ERROR(benchmark_info->TimeInitPhaseEnd(
+          BenchmarkInfo::InitPhase::kWarmup));
+    }
+  }
+
   // Creating the thread pool of a single thread to execute the works.
   auto worker_thread_pool =
       std::make_unique<ThreadPool>(/*name_prefix=*/"engine",
@@ -341,11 +373,12 @@ absl::StatusOr<std::unique_ptr<Engine>> EngineImpl::Create(
         benchmark_info->TimeInitPhaseEnd(BenchmarkInfo::InitPhase::kTotal));
   }
 
+  ASSIGN_OR_RETURN(auto metrics, EngineMetrics::Create());
   auto llm_impl = std::make_unique<EngineImpl>(
       std::move(engine_settings), std::move(model_resources),
       std::move(tokenizer), std::move(executor), std::move(vision_executor),
       std::move(audio_executor), std::move(benchmark_info),
-      std::move(worker_thread_pool));
+      std::move(worker_thread_pool), std::move(metrics));
 
   return llm_impl;
 };
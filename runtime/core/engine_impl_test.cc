@@ -29,6 +29,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "runtime/engine/engine.h"
 #include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -243,6 +244,82 @@ TEST(EngineTest, CreateEngine_WithBenchmark) {
       BenchmarkInfo::InitPhaseToString(BenchmarkInfo::InitPhase::kTotal))));
 }
 
+TEST(EngineTest, CreateEngine_WithWarmup) {
+  auto task_path =
+      std::filesystem::path(::testing::SrcDir()) /
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task";
+  auto model_assets = ModelAssets::Create(task_path.string());
+  ASSERT_OK(model_assets);
+  auto engine_settings =
+      EngineSettings::CreateDefault(*model_assets, Backend::CPU);
+  ASSERT_OK(engine_settings);
+  engine_settings->GetMutableBenchmarkParams();
+  engine_settings->SetWarmupOnInit(true);
+
+  absl::StatusOr<std::unique_ptr<Engine>> llm =
+      EngineFactory::CreateAny(*engine_settings);
+  ABSL_CHECK_OK(llm);
+
+  absl::StatusOr<std::unique_ptr<Engine::Session>> session =
+      (*llm)->CreateSession(SessionConfig::CreateDefault());
+  ABSL_CHECK_OK(session);
+
+  auto benchmark_info = (*session)->GetMutableBenchmarkInfo();
+  ASSERT_OK(benchmark_info);
+  EXPECT_TRUE((*benchmark_info)
+                  ->GetInitPhases()
+                  .contains(std::string(BenchmarkInfo::InitPhaseToString(
+                      BenchmarkInfo::InitPhase::kWarmup))));
+
+  // The warmup leaves no state behind: the session still decodes normally.
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText("Hello world!"));
+  ABSL_CHECK_OK((*session)->RunPrefill(inputs));
+  auto responses = (*session)->RunDecode();
+  EXPECT_OK(responses);
+  EXPECT_EQ(responses->GetTexts().size(), 1);
+}
+
+TEST(EngineTest, GetMetricsSnapshot) {
+  auto task_path =
+      std::filesystem::path(::testing::SrcDir()) /
+      "litert_lm/runtime/testdata/test_lm_new_metadata.task";
+  auto model_assets = ModelAssets::Create(task_path.string());
+  ASSERT_OK(model_assets);
+  auto engine_settings =
+      EngineSettings::CreateDefault(*model_assets, Backend::CPU);
+  ASSERT_OK(engine_settings);
+
+  absl::StatusOr<std::unique_ptr<Engine>> llm =
+      EngineFactory::CreateAny(*engine_settings);
+  ABSL_CHECK_OK(llm);
+
+  absl::StatusOr<std::unique_ptr<Engine::Session>> session =
+      (*llm)->CreateSession(SessionConfig::CreateDefault());
+  ABSL_CHECK_OK(session);
+  std::vector<InputData> inputs;
+  inputs.emplace_back(InputText("Hello world!"));
+  ABSL_CHECK_OK((*session)->RunPrefill(inputs));
+  ABSL_CHECK_OK((*session)->RunDecode());
+
+  auto snapshot = (*llm)->GetMetricsSnapshot();
+  ASSERT_OK(snapshot);
+  const MetricSnapshot* sessions_created =
+      snapshot->Find("litert_lm_sessions_created_total");
+  ASSERT_NE(sessions_created, nullptr);
+  EXPECT_EQ(sessions_created->value, 1);
+  const MetricSnapshot* prefill_tokens =
+      snapshot->Find("litert_lm_prefill_tokens_total");
+  ASSERT_NE(prefill_tokens, nullptr);
+  EXPECT_GT(prefill_tokens->value, 0);
+  const MetricSnapshot* decode_latency =
+      snapshot->Find("litert_lm_decode_seconds");
+  ASSERT_NE(decode_latency, nullptr);
+  EXPECT_EQ(decode_latency->histogram.count, 1);
+  EXPECT_THAT(snapshot->ToPrometheusText(),
+              ::testing::HasSubstr("# TYPE litert_lm_prefill_seconds histogram\n"));
+}
+
 TEST(EngineTest, CreateEngine_FailsNoVisionModel) {
   auto task_path =
       std::filesystem::path(::testing::SrcDir()) /
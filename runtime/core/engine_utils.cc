@@ -0,0 +1,106 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/engine_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/log/absl_check.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/model_resources.h"
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_executor_settings.h"
+#include "runtime/executor/memory_budget.h"
+#include "runtime/util/status_macros.h"  // NOLINT
+
+namespace litert::lm {
+
+absl::Status WarmupExecutor(absl::Status warmup_status,
+                            absl::string_view executor_name) {
+  if (absl::IsUnimplemented(warmup_status)) {
+    ABSL_LOG(INFO) << executor_name
+                   << " executor does not support warmup: " << warmup_status;
+    return absl::OkStatus();
+  }
+  return warmup_status;
+}
+
+absl::Status MaybeApplyMemoryBudget(EngineSettings& engine_settings,
+                                    ModelResources& model_resources,
+                                    int num_executor_replicas) {
+  if (!engine_settings.GetMemoryBudgetBytes().has_value()) {
+    return absl::OkStatus();
+  }
+  int64_t budget_bytes = *engine_settings.GetMemoryBudgetBytes();
+  ASSIGN_OR_RETURN(ModelMemoryProfile profile,
+                   GetModelMemoryProfile(model_resources));
+  auto& executor_settings = engine_settings.GetMutableMainExecutorSettings();
+  // Statically shaped models may be compiled a second time for decode, which
+  // allocates activations of its own.
+  if (profile.fixed_context_length > 0 &&
+      UsesSeparateDecodeCompiledModel(executor_settings)) {
+    profile.num_compiled_models = 2;
+  }
+  if (num_executor_replicas > 1) {
+    // Replicas only share the packed weights through the XNNPack weight cache.
+    const bool shares_weights =
+        executor_settings.GetBackend() == Backend::CPU &&
+        executor_settings.GetWeightCacheFile(".xnnpack_cache").ok();
+    if (!shares_weights) {
+      budget_bytes /= num_executor_replicas;
+    } else if (budget_bytes > profile.weight_bytes) {
+      const int64_t non_weight_bytes = budget_bytes - profile.weight_bytes;
+      budget_bytes =
+          profile.weight_bytes + non_weight_bytes / num_executor_replicas;
+    }
+  }
+  ASSIGN_OR_RETURN(MemoryBudgetPlan plan,
+                   PlanMemoryBudget(budget_bytes, profile,
+                                    executor_settings.GetMaxNumTokens()));
+  ABSL_LOG(INFO) << "Memory budget of " << budget_bytes << " bytes for model ("
+                 << profile << "): " << plan;
+  RETURN_IF_ERROR(ApplyMemoryBudgetPlan(plan, executor_settings));
+  const auto& max_resident_contexts = engine_settings.GetMaxResidentContexts();
+  if (!max_resident_contexts.has_value() ||
+      *max_resident_contexts > plan.max_resident_contexts) {
+    engine_settings.SetMaxResidentContexts(plan.max_resident_contexts);
+  }
+  return absl::OkStatus();
+}
+
+size_t PickLeastLoadedReplica(
+    absl::Span<const EngineMetrics* const> replica_metrics) {
+  ABSL_CHECK(!replica_metrics.empty());
+  size_t best = 0;
+  for (size_t i = 1; i < replica_metrics.size(); ++i) {
+    const EngineMetrics& metrics = *replica_metrics[i];
+    const EngineMetrics& best_metrics = *replica_metrics[best];
+    const int64_t contexts = metrics.resident_contexts->Value();
+    const int64_t best_contexts = best_metrics.resident_contexts->Value();
+    if (contexts < best_contexts ||
+        (contexts == best_contexts &&
+         metrics.queue_depth->Value() < best_metrics.queue_depth->Value())) {
+      best = i;
+    }
+  }
+  return best;
+}
+
+}  // namespace litert::lm
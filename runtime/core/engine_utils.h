@@ -0,0 +1,57 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_ENGINE_UTILS_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_ENGINE_UTILS_H_
+
+#include <cstddef>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/components/model_resources.h"
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/engine/engine_settings.h"
+
+namespace litert::lm {
+
+// Returns the result of an executor's warmup pass. Backends without a warmup
+// pass report Unimplemented, which is logged and skipped so that enabling
+// warmup never fails engine creation.
+absl::Status WarmupExecutor(absl::Status warmup_status,
+                            absl::string_view executor_name);
+
+// Sizes the main executor to fit the memory budget of the engine, if one is
+// set, and lowers the engine's max resident contexts to what fits. The budget
+// is split between the `num_executor_replicas` executors. On CPU with an
+// XNNPack weight cache they share the packed weights, so each of them is sized
+// for the weights plus its share of the rest of the budget. Otherwise every
+// replica holds its own copy of the weights and gets an even share of the
+// whole budget. The share of a replica also holds the activations of the
+// separate decode compiled model, if any.
+// Must run before the LiteRT environment is created, as the magic numbers are
+// configured from max_num_tokens.
+absl::Status MaybeApplyMemoryBudget(EngineSettings& engine_settings,
+                                    ModelResources& model_resources,
+                                    int num_executor_replicas = 1);
+
+// Returns the index of the replica a new session is placed on: the one with the
+// fewest resident contexts, then the one with the fewest queued tasks, then the
+// first one. `replica_metrics` must not be empty.
+size_t PickLeastLoadedReplica(
+    absl::Span<const EngineMetrics* const> replica_metrics);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_ENGINE_UTILS_H_
@@ -0,0 +1,78 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/engine_utils.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "runtime/engine/engine_metrics.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+class PickLeastLoadedReplicaTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (int i = 0; i < 3; ++i) {
+      ASSERT_OK_AND_ASSIGN(std::unique_ptr<EngineMetrics> metrics,
+                           EngineMetrics::Create());
+      replica_metrics_.push_back(metrics.get());
+      owned_metrics_.push_back(std::move(metrics));
+    }
+  }
+
+  std::vector<std::unique_ptr<EngineMetrics>> owned_metrics_;
+  std::vector<const EngineMetrics*> replica_metrics_;
+};
+
+TEST_F(PickLeastLoadedReplicaTest, PicksFirstReplicaWhenAllAreIdle) {
+  EXPECT_EQ(PickLeastLoadedReplica(replica_metrics_), 0);
+}
+
+TEST_F(PickLeastLoadedReplicaTest, PrefersFewerResidentContexts) {
+  owned_metrics_[0]->resident_contexts->Set(2);
+  owned_metrics_[1]->resident_contexts->Set(1);
+  owned_metrics_[2]->resident_contexts->Set(2);
+  // A longer queue does not outweigh fewer resident contexts.
+  owned_metrics_[1]->queue_depth->Set(5);
+  EXPECT_EQ(PickLeastLoadedReplica(replica_metrics_), 1);
+}
+
+TEST_F(PickLeastLoadedReplicaTest, BreaksTiesOnQueueDepth) {
+  for (const auto& metrics : owned_metrics_) {
+    metrics->resident_contexts->Set(1);
+  }
+  owned_metrics_[0]->queue_depth->Set(3);
+  owned_metrics_[1]->queue_depth->Set(2);
+  owned_metrics_[2]->queue_depth->Set(1);
+  EXPECT_EQ(PickLeastLoadedReplica(replica_metrics_), 2);
+}
+
+TEST_F(PickLeastLoadedReplicaTest, SpreadsSessionsAcrossReplicas) {
+  std::vector<int> placed(replica_metrics_.size(), 0);
+  for (int i = 0; i < 6; ++i) {
+    const size_t replica = PickLeastLoadedReplica(replica_metrics_);
+    owned_metrics_[replica]->resident_contexts->Add(1);
+    ++placed[replica];
+  }
+  EXPECT_EQ(placed, std::vector<int>({2, 2, 2}));
+}
+
+}  // namespace
+}  // namespace litert::lm
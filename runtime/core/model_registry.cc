@@ -0,0 +1,462 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/model_registry.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT: Required for the model file size.
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT: Required for the model file size.
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_factory.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+
+struct ModelRegistry::Model {
+  Model(absl::string_view id, EngineSettings engine_settings,
+        int64_t memory_bytes)
+      : id(id),
+        engine_settings(std::move(engine_settings)),
+        memory_bytes(memory_bytes) {}
+
+  const std::string id;
+  const EngineSettings engine_settings;
+  const int64_t memory_bytes;
+
+  // Serializes the loading of the engine.
+  absl::Mutex load_mutex;
+
+  // The fields below are guarded by the mutex of the registry.
+  // The engine, or null if the model is not loaded.
+  std::unique_ptr<Engine> engine;
+  // Whether the model is loaded or being loaded, and counted in the loaded
+  // bytes of the registry.
+  bool resident = false;
+  // The position of the model in the loaded models, if resident.
+  std::list<Model*>::iterator lru_position;
+  // The number of open sessions and of sessions being created.
+  int num_sessions = 0;
+};
+
+// A session of a registered model, which keeps the model loaded while it is
+// open.
+class ModelRegistry::ModelSession : public Engine::Session {
+ public:
+  ModelSession(std::unique_ptr<Session> session, ModelRegistry* registry,
+               std::shared_ptr<Model> model)
+      : session_(std::move(session)),
+        registry_(registry),
+        model_(std::move(model)) {}
+
+  ~ModelSession() override {
+    // The session is closed before the model may be unloaded.
+    session_.reset();
+    registry_->Release(*model_);
+  }
+
+  absl::StatusOr<Responses> GenerateContent(
+      const std::vector<InputData>& contents) override {
+    return session_->GenerateContent(contents);
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override {
+    return session_->GenerateContentStream(contents, std::move(callback));
+  }
+
+  absl::Status GenerateContentStream(
+      const std::vector<InputData>& contents,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
+      const DecodeConfig& decode_config) override {
+    return session_->GenerateContentStream(contents, std::move(callback),
+                                           decode_config);
+  }
+
+  absl::StatusOr<Responses> RunTextScoring(
+      const std::vector<absl::string_view>& target_text,
+      bool store_token_lengths) override {
+    return session_->RunTextScoring(target_text, store_token_lengths);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunTextScoringAsync(
+      const std::vector<absl::string_view>& target_text,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
+      bool store_token_lengths) override {
+    return session_->RunTextScoringAsync(target_text, std::move(callback),
+                                         store_token_lengths);
+  }
+
+  absl::StatusOr<Responses> RunTextClassification(
+      const std::vector<absl::string_view>& choices) override {
+    return session_->RunTextClassification(choices);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunTextClassificationAsync(
+      const std::vector<absl::string_view>& choices,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override {
+    return session_->RunTextClassificationAsync(choices, std::move(callback));
+  }
+
+  absl::Status RunPrefill(const std::vector<InputData>& contents) override {
+    return session_->RunPrefill(contents);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunPrefillAsync(
+      const std::vector<InputData>& contents,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override {
+    return session_->RunPrefillAsync(contents, std::move(callback));
+  }
+
+  absl::StatusOr<Responses> RunDecode() override {
+    return session_->RunDecode();
+  }
+
+  absl::StatusOr<Responses> RunDecode(
+      const DecodeConfig& decode_config) override {
+    return session_->RunDecode(decode_config);
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override {
+    return session_->RunDecodeAsync(std::move(callback));
+  }
+
+  absl::StatusOr<std::unique_ptr<TaskController>> RunDecodeAsync(
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
+      const DecodeConfig& decode_config) override {
+    return session_->RunDecodeAsync(std::move(callback), decode_config);
+  }
+
+  absl::StatusOr<BenchmarkInfo> GetBenchmarkInfo() override {
+    return session_->GetBenchmarkInfo();
+  }
+
+  absl::StatusOr<BenchmarkInfo*> GetMutableBenchmarkInfo() override {
+    return session_->GetMutableBenchmarkInfo();
+  }
+
+  void CancelProcess() override { session_->CancelProcess(); }
+
+  absl::Status WaitUntilDone() override { return session_->WaitUntilDone(); }
+
+  absl::StatusOr<std::unique_ptr<Session>> Clone() override {
+    ASSIGN_OR_RETURN(std::unique_ptr<Session> clone, session_->Clone());
+    return Wrap(std::move(clone));
+  }
+
+  absl::StatusOr<std::unique_ptr<Session>> CloneAsync(
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override {
+    ASSIGN_OR_RETURN(std::unique_ptr<Session> clone,
+                     session_->CloneAsync(std::move(callback)));
+    return Wrap(std::move(clone));
+  }
+
+  const SessionConfig& GetSessionConfig() const override {
+    return session_->GetSessionConfig();
+  }
+
+ private:
+  std::unique_ptr<Session> Wrap(std::unique_ptr<Session> clone) {
+    registry_->Pin(*model_);
+    return std::make_unique<ModelSession>(std::move(clone), registry_, model_);
+  }
+
+  std::unique_ptr<Session> session_;
+  ModelRegistry* registry_;
+  std::shared_ptr<Model> model_;
+};
+
+absl::StatusOr<std::unique_ptr<ModelRegistry>> ModelRegistry::Create(
+    const ModelRegistryConfig& config) {
+  return Create(config, [](const EngineSettings& engine_settings) {
+    return EngineFactory::CreateDefault(engine_settings);
+  });
+}
+
+absl::StatusOr<std::unique_ptr<ModelRegistry>> ModelRegistry::Create(
+    const ModelRegistryConfig& config, EngineCreator engine_creator) {
+  if (config.memory_budget_bytes.has_value() &&
+      *config.memory_budget_bytes <= 0) {
+    return absl::InvalidArgumentError("The memory budget must be positive.");
+  }
+  if (engine_creator == nullptr) {
+    return absl::InvalidArgumentError("The engine creator must be set.");
+  }
+  return absl::WrapUnique(new ModelRegistry(config, std::move(engine_creator)));
+}
+
+ModelRegistry::~ModelRegistry() {
+  absl::MutexLock lock(mutex_);
+  for (const auto& [model_id, model] : models_) {
+    if (model->num_sessions > 0) {
+      ABSL_LOG(ERROR) << "Model " << model_id << " still has "
+                      << model->num_sessions << " open sessions.";
+    }
+  }
+}
+
+absl::Status ModelRegistry::AddModel(absl::string_view model_id,
+                                     EngineSettings engine_settings,
+                                     std::optional<int64_t> memory_bytes) {
+  if (!memory_bytes.has_value() &&
+      engine_settings.GetMemoryBudgetBytes().has_value()) {
+    // The engine sizes its executor to fit the budget, or fails to load.
+    memory_bytes = *engine_settings.GetMemoryBudgetBytes();
+  }
+  if (!memory_bytes.has_value()) {
+    ASSIGN_OR_RETURN(
+        absl::string_view path,
+        engine_settings.GetMainExecutorSettings().GetModelAssets().GetPath());
+    std::error_code error;
+    const uintmax_t size = std::filesystem::file_size(path, error);
+    if (error) {
+      return absl::NotFoundError(absl::StrCat(
+          "Failed to read the size of ", path, ": ", error.message()));
+    }
+    memory_bytes = static_cast<int64_t>(size);
+  }
+  if (*memory_bytes < 0) {
+    return absl::InvalidArgumentError("The memory size must not be negative.");
+  }
+  if (config_.memory_budget_bytes.has_value() &&
+      *memory_bytes > *config_.memory_budget_bytes) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Model ", model_id, " needs ", *memory_bytes,
+                     " bytes, more than the memory budget of ",
+                     *config_.memory_budget_bytes, " bytes."));
+  }
+
+  absl::MutexLock lock(mutex_);
+  if (models_.contains(model_id)) {
+    return absl::AlreadyExistsError(
+        absl::StrCat("Model ", model_id, " is already registered."));
+  }
+  models_.emplace(model_id,
+                  std::make_shared<Model>(model_id, std::move(engine_settings),
+                                          *memory_bytes));
+  return absl::OkStatus();
+}
+
+absl::Status ModelRegistry::RemoveModel(absl::string_view model_id) {
+  std::shared_ptr<Model> model;
+  {
+    absl::MutexLock lock(mutex_);
+    auto it = models_.find(model_id);
+    if (it == models_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Model ", model_id, " is not registered."));
+    }
+    model = it->second;
+    if (model->num_sessions > 0) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Model ", model_id, " has open sessions."));
+    }
+    if (model->resident) {
+      loaded_models_.erase(model->lru_position);
+      loaded_bytes_ -= model->memory_bytes;
+      model->resident = false;
+    }
+    models_.erase(it);
+  }
+  // The engine is destroyed outside of the lock.
+  model.reset();
+  return absl::OkStatus();
+}
+
+absl::Status ModelRegistry::UnloadModel(absl::string_view model_id) {
+  std::unique_ptr<Engine> engine;
+  {
+    absl::MutexLock lock(mutex_);
+    auto it = models_.find(model_id);
+    if (it == models_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Model ", model_id, " is not registered."));
+    }
+    Model& model = *it->second;
+    if (model.num_sessions > 0) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Model ", model_id, " has open sessions."));
+    }
+    if (model.resident) {
+      loaded_models_.erase(model.lru_position);
+      loaded_bytes_ -= model.memory_bytes;
+      model.resident = false;
+      engine = std::move(model.engine);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<Engine::Session>> ModelRegistry::CreateSession(
+    absl::string_view model_id, const SessionConfig& session_config) {
+  std::shared_ptr<Model> model;
+  std::vector<std::unique_ptr<Engine>> unloaded;
+  {
+    absl::MutexLock lock(mutex_);
+    auto it = models_.find(model_id);
+    if (it == models_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Model ", model_id, " is not registered."));
+    }
+    model = it->second;
+    if (model->resident) {
+      TouchLocked(*model);
+    } else {
+      RETURN_IF_ERROR(MakeRoomLocked(model->memory_bytes, unloaded));
+      loaded_models_.push_front(model.get());
+      model->lru_position = loaded_models_.begin();
+      loaded_bytes_ += model->memory_bytes;
+      model->resident = true;
+    }
+    ++model->num_sessions;
+  }
+  // The unloaded engines are destroyed outside of the lock.
+  unloaded.clear();
+
+  absl::StatusOr<Engine*> engine = GetOrLoadEngine(*model);
+  if (!engine.ok()) {
+    Release(*model);
+    return engine.status();
+  }
+  absl::StatusOr<std::unique_ptr<Engine::Session>> session =
+      (*engine)->CreateSession(session_config);
+  if (!session.ok()) {
+    Release(*model);
+    return session.status();
+  }
+  return std::make_unique<ModelSession>(*std::move(session), this,
+                                        std::move(model));
+}
+
+bool ModelRegistry::IsLoaded(absl::string_view model_id) const {
+  absl::MutexLock lock(mutex_);
+  auto it = models_.find(model_id);
+  return it != models_.end() && it->second->engine != nullptr;
+}
+
+std::vector<std::string> ModelRegistry::GetLoadedModels() const {
+  absl::MutexLock lock(mutex_);
+  std::vector<std::string> model_ids;
+  for (const Model* model : loaded_models_) {
+    if (model->engine != nullptr) {
+      model_ids.push_back(model->id);
+    }
+  }
+  return model_ids;
+}
+
+int64_t ModelRegistry::GetLoadedBytes() const {
+  absl::MutexLock lock(mutex_);
+  return loaded_bytes_;
+}
+
+int ModelRegistry::GetNumLoads() const {
+  absl::MutexLock lock(mutex_);
+  return num_loads_;
+}
+
+absl::StatusOr<Engine*> ModelRegistry::GetOrLoadEngine(Model& model) {
+  absl::MutexLock load_lock(model.load_mutex);
+  {
+    absl::MutexLock lock(mutex_);
+    if (model.engine != nullptr) {
+      return model.engine.get();
+    }
+  }
+  ABSL_LOG(INFO) << "Loading model " << model.id << ".";
+  ASSIGN_OR_RETURN(std::unique_ptr<Engine> engine,
+                   engine_creator_(model.engine_settings));
+  absl::MutexLock lock(mutex_);
+  model.engine = std::move(engine);
+  ++num_loads_;
+  return model.engine.get();
+}
+
+absl::Status ModelRegistry::MakeRoomLocked(
+    int64_t bytes, std::vector<std::unique_ptr<Engine>>& unloaded) {
+  if (!config_.memory_budget_bytes.has_value()) {
+    return absl::OkStatus();
+  }
+  const int64_t budget = *config_.memory_budget_bytes;
+  // Nothing is unloaded unless enough idle models can be unloaded.
+  int64_t idle_bytes = 0;
+  for (const Model* model : loaded_models_) {
+    if (model->num_sessions == 0) {
+      idle_bytes += model->memory_bytes;
+    }
+  }
+  if (loaded_bytes_ - idle_bytes + bytes > budget) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "The models with open sessions leave ",
+        budget - loaded_bytes_ + idle_bytes, " bytes of the memory budget, ",
+        bytes, " are needed."));
+  }
+  for (auto it = loaded_models_.end();
+       loaded_bytes_ + bytes > budget && it != loaded_models_.begin();) {
+    Model* model = *--it;
+    if (model->num_sessions > 0) {
+      continue;
+    }
+    ABSL_LOG(INFO) << "Unloading model " << model->id
+                   << " to fit the memory budget.";
+    unloaded.push_back(std::move(model->engine));
+    loaded_bytes_ -= model->memory_bytes;
+    model->resident = false;
+    it = loaded_models_.erase(it);
+  }
+  return absl::OkStatus();
+}
+
+void ModelRegistry::TouchLocked(Model& model) {
+  loaded_models_.splice(loaded_models_.begin(), loaded_models_,
+                        model.lru_position);
+}
+
+void ModelRegistry::Pin(Model& model) {
+  absl::MutexLock lock(mutex_);
+  ++model.num_sessions;
+  TouchLocked(model);
+}
+
+void ModelRegistry::Release(Model& model) {
+  absl::MutexLock lock(mutex_);
+  --model.num_sessions;
+  // A model whose loading failed gives its memory back once it is not
+  // pinned anymore.
+  if (model.num_sessions == 0 && model.resident && model.engine == nullptr) {
+    loaded_models_.erase(model.lru_position);
+    loaded_bytes_ -= model.memory_bytes;
+    model.resident = false;
+  }
+}
+
+}  // namespace litert::lm
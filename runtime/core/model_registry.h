@@ -0,0 +1,164 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_MODEL_REGISTRY_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_MODEL_REGISTRY_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_settings.h"
+
+namespace litert::lm {
+
+struct ModelRegistryConfig {
+  // The memory the loaded models may use together, in bytes. Unlimited if not
+  // set. Each model counts with the memory given to AddModel. When none is
+  // given, a model with an engine memory budget counts with that budget, which
+  // its engine is sized to fit, and any other model counts with the size of
+  // its model file: its weights only, without the KV caches, activations and
+  // threads of its engine.
+  std::optional<int64_t> memory_budget_bytes;
+};
+
+// Hosts several models in one process and keeps the loaded ones within a
+// memory budget.
+//
+// A model is registered with its EngineSettings and loaded, i.e. its Engine is
+// created, when the first session is created for it. When loading a model
+// would exceed the budget, the least recently used models without open
+// sessions are unloaded first. An unloaded model keeps its settings only: its
+// weights are mapped from the model file again on the next session, which is
+// cheap while the file is still in the page cache. A model with open sessions
+// is never unloaded, so loading fails with RESOURCE_EXHAUSTED when the busy
+// models leave no room for it.
+//
+// Each loaded engine keeps its own execution threads, on which the work of its
+// executors is serialized. As the idle models are unloaded, the threads of the
+// process follow the models in use rather than the models registered.
+//
+// The registry must outlive the sessions it created. Loading a model does not
+// block the sessions of the other models.
+class ModelRegistry {
+ public:
+  // Creates the engine of a model.
+  using EngineCreator = absl::AnyInvocable<absl::StatusOr<std::unique_ptr<
+      Engine>>(const EngineSettings& engine_settings)>;
+
+  // Creates a registry loading the models with the registered default engine
+  // type.
+  static absl::StatusOr<std::unique_ptr<ModelRegistry>> Create(
+      const ModelRegistryConfig& config);
+
+  // Creates a registry loading the models with `engine_creator`, e.g. to wrap
+  // the engines or to use another engine type.
+  static absl::StatusOr<std::unique_ptr<ModelRegistry>> Create(
+      const ModelRegistryConfig& config, EngineCreator engine_creator);
+
+  ~ModelRegistry();
+
+  // Registers a model without loading it.
+  // - model_id: The name the sessions of the model are created with.
+  // - engine_settings: The settings the engine of the model is created with.
+  // - memory_bytes: The memory used by the loaded model. If not set, the
+  //   memory budget of `engine_settings` is used if set, and the size of the
+  //   model file otherwise, which requires the model assets to have a path.
+  //   Set a memory budget on the engine, or pass the measured footprint, for
+  //   the registry budget to cover more than the weights.
+  absl::Status AddModel(absl::string_view model_id,
+                        EngineSettings engine_settings,
+                        std::optional<int64_t> memory_bytes = std::nullopt);
+
+  // Unloads and unregisters a model. Fails with FAILED_PRECONDITION if the
+  // model has open sessions.
+  absl::Status RemoveModel(absl::string_view model_id);
+
+  // Creates a session of a model, loading the model first if needed.
+  absl::StatusOr<std::unique_ptr<Engine::Session>> CreateSession(
+      absl::string_view model_id, const SessionConfig& session_config);
+
+  // Unloads a model now. Fails with FAILED_PRECONDITION if the model has open
+  // sessions.
+  absl::Status UnloadModel(absl::string_view model_id);
+
+  // Returns whether the model is loaded.
+  bool IsLoaded(absl::string_view model_id) const;
+
+  // Returns the identifiers of the loaded models, from the most to the least
+  // recently used.
+  std::vector<std::string> GetLoadedModels() const;
+
+  // Returns the memory used by the loaded models, in bytes.
+  int64_t GetLoadedBytes() const;
+
+  // Returns the number of times a model was loaded.
+  int GetNumLoads() const;
+
+ private:
+  struct Model;
+  class ModelSession;
+
+  ModelRegistry(const ModelRegistryConfig& config,
+                EngineCreator engine_creator)
+      : config_(config), engine_creator_(std::move(engine_creator)) {}
+
+  // Returns the engine of the model, loading it if needed. The model must be
+  // pinned by an open or pending session.
+  absl::StatusOr<Engine*> GetOrLoadEngine(Model& model);
+
+  // Unloads the least recently used idle models until `bytes` more fit in the
+  // budget, moving their engines to `unloaded` so that they are destroyed
+  // outside of the lock.
+  absl::Status MakeRoomLocked(int64_t bytes,
+                              std::vector<std::unique_ptr<Engine>>& unloaded)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Marks the model as most recently used.
+  void TouchLocked(Model& model) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Pins the loaded model for a cloned session.
+  void Pin(Model& model);
+
+  // Unpins the model when one of its sessions is closed, or when its session
+  // could not be created.
+  void Release(Model& model);
+
+  const ModelRegistryConfig config_;
+  EngineCreator engine_creator_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Model>> models_
+      ABSL_GUARDED_BY(mutex_);
+  // The loaded models, from the most to the least recently used.
+  std::list<Model*> loaded_models_ ABSL_GUARDED_BY(mutex_);
+  int64_t loaded_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  int num_loads_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_MODEL_REGISTRY_H_
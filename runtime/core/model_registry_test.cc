@@ -0,0 +1,269 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/model_registry.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/functional/any_invocable.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/components/tokenizer.h"
+#include "runtime/engine/engine.h"
+#include "runtime/engine/engine_settings.h"
+#include "runtime/engine/io_types.h"
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/util/status_macros.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Return;
+using ::testing::status::StatusIs;
+
+using ResponsesCallback = absl::AnyInvocable<void(absl::StatusOr<Responses>)>;
+
+class MockSession : public Engine::Session {
+ public:
+  MOCK_METHOD(absl::StatusOr<Responses>, GenerateContent,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback),
+              (override));
+  MOCK_METHOD(absl::Status, GenerateContentStream,
+              (const std::vector<InputData>& contents,
+               ResponsesCallback user_callback,
+               const DecodeConfig& decode_config),
+              (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunTextScoring,
+              (const std::vector<absl::string_view>& target_text,
+               bool store_token_lengths),
+              (override));
+  MOCK_METHOD(absl::Status, RunPrefill,
+              (const std::vector<InputData>& contents), (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode, (), (override));
+  MOCK_METHOD(absl::StatusOr<Responses>, RunDecode,
+              (const DecodeConfig& decode_config), (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo>, GetBenchmarkInfo, (), (override));
+  MOCK_METHOD(absl::StatusOr<BenchmarkInfo*>, GetMutableBenchmarkInfo, (),
+              (override));
+  MOCK_METHOD(void, CancelProcess, (), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (), (override));
+  MOCK_METHOD(const SessionConfig&, GetSessionConfig, (), (const, override));
+};
+
+class MockEngine : public Engine {
+ public:
+  MOCK_METHOD(const EngineSettings&, GetEngineSettings, (), (const, override));
+  MOCK_METHOD(const Tokenizer&, GetTokenizer, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<AudioExecutorProperties>,
+              GetAudioExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<VisionExecutorProperties>,
+              GetVisionExecutorProperties, (), (const, override));
+  MOCK_METHOD(absl::StatusOr<std::unique_ptr<Session>>, CreateSession,
+              (const SessionConfig& session_config), (override));
+  MOCK_METHOD(absl::Status, WaitUntilDone, (absl::Duration timeout),
+              (override));
+};
+
+constexpr int64_t kModelBytes = 100;
+
+absl::StatusOr<EngineSettings> Settings(absl::string_view model_path) {
+  ASSIGN_OR_RETURN(ModelAssets model_assets, ModelAssets::Create(model_path));
+  return EngineSettings::CreateDefault(model_assets, Backend::CPU);
+}
+
+class ModelRegistryTest : public ::testing::Test {
+ protected:
+  // Creates a registry whose engines answer with the path of their model.
+  void CreateRegistry(ModelRegistryConfig config) {
+    ASSERT_OK_AND_ASSIGN(
+        registry_,
+        ModelRegistry::Create(
+            config,
+            [this](const EngineSettings& engine_settings)
+                -> absl::StatusOr<std::unique_ptr<Engine>> {
+              if (!load_status_.ok()) {
+                return load_status_;
+              }
+              ASSIGN_OR_RETURN(absl::string_view path,
+                               engine_settings.GetMainExecutorSettings()
+                                   .GetModelAssets()
+                                   .GetPath());
+              auto engine = std::make_unique<MockEngine>();
+              EXPECT_CALL(*engine, CreateSession(_))
+                  .WillRepeatedly([path = std::string(path)](
+                                      const SessionConfig&)
+                                      -> absl::StatusOr<
+                                          std::unique_ptr<Engine::Session>> {
+                    auto session = std::make_unique<MockSession>();
+                    EXPECT_CALL(*session, GenerateContent(_))
+                        .WillRepeatedly(Return(Responses(
+                            TaskState::kDone, {path})));
+                    return session;
+                  });
+              return engine;
+            }));
+  }
+
+  void AddModels(const std::vector<std::string>& model_ids) {
+    for (const std::string& model_id : model_ids) {
+      ASSERT_OK_AND_ASSIGN(EngineSettings settings, Settings(model_id));
+      ASSERT_OK(registry_->AddModel(model_id, settings, kModelBytes));
+    }
+  }
+
+  absl::Status Use(absl::string_view model_id) {
+    ASSIGN_OR_RETURN(auto session, registry_->CreateSession(
+                                       model_id, SessionConfig::CreateDefault()));
+    return session->GenerateContent({}).status();
+  }
+
+  std::unique_ptr<ModelRegistry> registry_;
+  absl::Status load_status_;
+};
+
+TEST_F(ModelRegistryTest, LoadsModelsOnFirstSession) {
+  CreateRegistry(ModelRegistryConfig());
+  AddModels({"a", "b"});
+  EXPECT_FALSE(registry_->IsLoaded("a"));
+  EXPECT_EQ(registry_->GetNumLoads(), 0);
+
+  ASSERT_OK_AND_ASSIGN(
+      auto session,
+      registry_->CreateSession("a", SessionConfig::CreateDefault()));
+  ASSERT_OK_AND_ASSIGN(Responses responses, session->GenerateContent({}));
+  EXPECT_THAT(responses.GetTexts(), ElementsAre("a"));
+  EXPECT_TRUE(registry_->IsLoaded("a"));
+  EXPECT_FALSE(registry_->IsLoaded("b"));
+  EXPECT_EQ(registry_->GetLoadedBytes(), kModelBytes);
+
+  ASSERT_OK(Use("a"));
+  EXPECT_EQ(registry_->GetNumLoads(), 1);
+}
+
+TEST_F(ModelRegistryTest, UnloadsLeastRecentlyUsedModels) {
+  CreateRegistry({.memory_budget_bytes = 2 * kModelBytes});
+  AddModels({"a", "b", "c"});
+  ASSERT_OK(Use("a"));
+  ASSERT_OK(Use("b"));
+  ASSERT_OK(Use("a"));
+  EXPECT_THAT(registry_->GetLoadedModels(), ElementsAre("a", "b"));
+
+  ASSERT_OK(Use("c"));
+  EXPECT_THAT(registry_->GetLoadedModels(), ElementsAre("c", "a"));
+  EXPECT_EQ(registry_->GetLoadedBytes(), 2 * kModelBytes);
+
+  // An unloaded model is loaded again.
+  ASSERT_OK(Use("b"));
+  EXPECT_THAT(registry_->GetLoadedModels(), ElementsAre("b", "c"));
+  EXPECT_EQ(registry_->GetNumLoads(), 4);
+}
+
+TEST_F(ModelRegistryTest, KeepsModelsWithOpenSessions) {
+  CreateRegistry({.memory_budget_bytes = 2 * kModelBytes});
+  AddModels({"a", "b", "c"});
+  ASSERT_OK_AND_ASSIGN(
+      auto session_a,
+      registry_->CreateSession("a", SessionConfig::CreateDefault()));
+  ASSERT_OK_AND_ASSIGN(
+      auto session_b,
+      registry_->CreateSession("b", SessionConfig::CreateDefault()));
+
+  EXPECT_THAT(registry_->CreateSession("c", SessionConfig::CreateDefault()),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_THAT(registry_->GetLoadedModels(), ElementsAre("b", "a"));
+
+  // Closing a session lets its model be unloaded, even if it was used last.
+  session_b.reset();
+  ASSERT_OK(Use("c"));
+  EXPECT_THAT(registry_->GetLoadedModels(), ElementsAre("c", "a"));
+  ASSERT_OK_AND_ASSIGN(Responses responses, session_a->GenerateContent({}));
+  EXPECT_THAT(responses.GetTexts(), ElementsAre("a"));
+}
+
+TEST_F(ModelRegistryTest, ReleasesMemoryWhenLoadingFails) {
+  CreateRegistry({.memory_budget_bytes = kModelBytes});
+  AddModels({"a"});
+  load_status_ = absl::InternalError("Failed to load.");
+  EXPECT_THAT(Use("a"), StatusIs(absl::StatusCode::kInternal));
+  EXPECT_THAT(registry_->GetLoadedModels(), IsEmpty());
+  EXPECT_EQ(registry_->GetLoadedBytes(), 0);
+
+  load_status_ = absl::OkStatus();
+  ASSERT_OK(Use("a"));
+  EXPECT_TRUE(registry_->IsLoaded("a"));
+}
+
+TEST_F(ModelRegistryTest, UnloadsAndRemovesIdleModelsOnly) {
+  CreateRegistry(ModelRegistryConfig());
+  AddModels({"a"});
+  ASSERT_OK_AND_ASSIGN(
+      auto session,
+      registry_->CreateSession("a", SessionConfig::CreateDefault()));
+  EXPECT_THAT(registry_->UnloadModel("a"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(registry_->RemoveModel("a"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+
+  session.reset();
+  ASSERT_OK(registry_->UnloadModel("a"));
+  EXPECT_FALSE(registry_->IsLoaded("a"));
+  EXPECT_EQ(registry_->GetLoadedBytes(), 0);
+  ASSERT_OK(registry_->RemoveModel("a"));
+  EXPECT_THAT(Use("a"), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(ModelRegistryTest, RejectsInvalidModels) {
+  CreateRegistry({.memory_budget_bytes = kModelBytes});
+  AddModels({"a"});
+  ASSERT_OK_AND_ASSIGN(EngineSettings settings, Settings("b"));
+  EXPECT_THAT(registry_->AddModel("a", settings, kModelBytes),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+  EXPECT_THAT(registry_->AddModel("b", settings, 2 * kModelBytes),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(registry_->AddModel("b", settings, -1),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(Use("c"), StatusIs(absl::StatusCode::kNotFound));
+}
+
+TEST_F(ModelRegistryTest, CountsModelsWithTheirEngineMemoryBudget) {
+  CreateRegistry({.memory_budget_bytes = 2 * kModelBytes});
+  ASSERT_OK_AND_ASSIGN(EngineSettings settings, Settings("a"));
+  settings.SetMemoryBudgetBytes(kModelBytes + 1);
+  // No model file is read, as the engine budget is used.
+  ASSERT_OK(registry_->AddModel("a", settings));
+  ASSERT_OK(Use("a"));
+  EXPECT_EQ(registry_->GetLoadedBytes(), kModelBytes + 1);
+
+  settings.SetMemoryBudgetBytes(2 * kModelBytes + 1);
+  EXPECT_THAT(registry_->AddModel("b", settings),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace litert::lm
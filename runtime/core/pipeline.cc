@@ -34,6 +34,7 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/framework/threadpool.h"
 #include "runtime/proto/sampler_params.pb.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/status_macros.h"  //NOLINT
@@ -63,13 +64,15 @@ absl::StatusOr<Responses> Decode(LlmExecutor& executor, Tokenizer& tokenizer,
                                  Constraint* constraint,
                                  std::optional<BenchmarkInfo>& benchmark_info,
                                  std::atomic<bool>* cancelled,
-                                 int max_output_tokens) {
+                                 int max_output_tokens,
+                                 ThreadPool* constraint_thread_pool) {
   absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
   return Tasks::Decode(
       executor, tokenizer, stop_token_detector, num_output_candidates,
       benchmark_info, /*sampler=*/std::nullopt, constraint,
       /*decoded_ids=*/std::nullopt, /*callback=*/callback, cancelled,
-      max_output_tokens);
+      max_output_tokens, /*num_top_logprobs=*/std::nullopt,
+      StreamingChunkPolicy(), constraint_thread_pool);
 }
 
 absl::Status DecodeStreaming(
@@ -77,7 +80,9 @@ absl::Status DecodeStreaming(
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
     Constraint* constraint, std::optional<BenchmarkInfo>& benchmark_info,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
-    std::atomic<bool>* cancelled, int max_output_tokens) {
+    std::atomic<bool>* cancelled, int max_output_tokens,
+    const StreamingChunkPolicy& chunk_policy,
+    ThreadPool* constraint_thread_pool) {
   if (callback == nullptr) {
     return absl::InvalidArgumentError(
         "Callback must not be null for streaming.");
@@ -87,7 +92,8 @@ absl::Status DecodeStreaming(
                     num_output_candidates, benchmark_info,
                     /*sampler=*/std::nullopt, constraint,
                     /*decoded_ids=*/std::nullopt, callback, cancelled,
-                    max_output_tokens);
+                    max_output_tokens, /*num_top_logprobs=*/std::nullopt,
+                    chunk_policy, constraint_thread_pool);
 
   // Trigger the callback with the final result.
   // This can be either a error message, or a task state (e.g. kDone or
@@ -101,12 +107,15 @@ absl::StatusOr<Responses> DecodeCustomSampling(
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
     Sampler& sampler, litert::TensorBuffer decoded_ids, Constraint* constraint,
     std::optional<BenchmarkInfo>& benchmark_info,
-    std::atomic<bool>* cancelled, int max_output_tokens) {
+    std::atomic<bool>* cancelled, int max_output_tokens,
+    std::optional<int> num_top_logprobs, ThreadPool* constraint_thread_pool) {
   absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
   return Tasks::Decode(executor, tokenizer, stop_token_detector,
                        num_output_candidates, benchmark_info, &sampler,
                        constraint, std::move(decoded_ids),
-                       /*callback=*/callback, cancelled, max_output_tokens);
+                       /*callback=*/callback, cancelled, max_output_tokens,
+                       num_top_logprobs, StreamingChunkPolicy(),
+                       constraint_thread_pool);
 }
 
 absl::Status DecodeCustomSamplingStreaming(
@@ -115,7 +124,10 @@ absl::Status DecodeCustomSamplingStreaming(
     Sampler& sampler, litert::TensorBuffer decoded_ids, Constraint* constraint,
     std::optional<BenchmarkInfo>& benchmark_info,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
-    std::atomic<bool>* cancelled, int max_output_tokens) {
+    std::atomic<bool>* cancelled, int max_output_tokens,
+    std::optional<int> num_top_logprobs,
+    const StreamingChunkPolicy& chunk_policy,
+    ThreadPool* constraint_thread_pool) {
   if (callback == nullptr) {
     return absl::InvalidArgumentError(
         "Callback must not be null for streaming.");
@@ -123,7 +135,8 @@ absl::Status DecodeCustomSamplingStreaming(
   absl::StatusOr<Responses> task_respones = Tasks::Decode(
       executor, tokenizer, stop_token_detector, num_output_candidates,
       benchmark_info, &sampler, constraint, std::move(decoded_ids), callback,
-      cancelled, max_output_tokens);
+      cancelled, max_output_tokens, num_top_logprobs, chunk_policy,
+      constraint_thread_pool);
 
   // Trigger the callback with the final result.
   // This can be either a error message, or a task state (e.g. kDone or
@@ -140,4 +153,12 @@ absl::StatusOr<Responses> ScoreCustomSampling(
                       std::move(decoded_ids), store_token_lengths);
 }
 
+absl::StatusOr<Responses> ScoreChoicesCustomSampling(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& choices, const float temperature,
+    litert::TensorBuffer decoded_ids) {
+  return Tasks::ScoreChoices(executor, tokenizer, choices, temperature,
+                             std::move(decoded_ids));
+}
+
 }  // namespace litert::lm
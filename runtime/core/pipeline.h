@@ -23,6 +23,7 @@
 #include <optional>
 #include <vector>
 
+#include "absl/base/nullability.h"  // from @com_google_absl
 #include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
@@ -35,6 +36,7 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/framework/threadpool.h"
 #include "runtime/proto/sampler_params.pb.h"
 
 namespace litert::lm {
@@ -61,12 +63,15 @@ absl::StatusOr<int> Prefill(LlmExecutor& executor, ExecutorInputs& inputs,
 // - benchmark_info: The benchmark info to record the performance metrics.
 // - cancelled: A pointer to an atomic boolean. If the boolean is set to true,
 //   the decoding process will be cancelled.
+// - constraint_thread_pool: Optional caller-owned pool on which the
+//   constraint masks of the candidates are computed in parallel.
 absl::StatusOr<Responses> Decode(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
     Constraint* constraint, std::optional<BenchmarkInfo>& benchmark_info,
     std::atomic<bool>* cancelled = nullptr,
-    int max_output_tokens = std::numeric_limits<int>::max());
+    int max_output_tokens = std::numeric_limits<int>::max(),
+    ThreadPool* absl_nullable constraint_thread_pool = nullptr);
 
 // Runs the pipeline to decode the input prompt. The function is similar to
 // Decode, but it outputs the result using the callback to achieve streaming
@@ -74,13 +79,18 @@ absl::StatusOr<Responses> Decode(
 // - callback: The inference callback to receive the intermediate results.
 // - cancelled: A pointer to an atomic boolean. If the boolean is set to true,
 //   the decoding process will be cancelled.
+// - chunk_policy: How the intermediate results are coalesced into chunks.
+// - constraint_thread_pool: Optional caller-owned pool on which the
+//   constraint masks of the candidates are computed in parallel.
 absl::Status DecodeStreaming(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
     Constraint* constraint, std::optional<BenchmarkInfo>& benchmark_info,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
     std::atomic<bool>* cancelled = nullptr,
-    int max_output_tokens = std::numeric_limits<int>::max());
+    int max_output_tokens = std::numeric_limits<int>::max(),
+    const StreamingChunkPolicy& chunk_policy = StreamingChunkPolicy(),
+    ThreadPool* absl_nullable constraint_thread_pool = nullptr);
 
 // Runs the pipeline to decode the input prompt.
 // - executor: The executor that call the core LLM model.
@@ -94,13 +104,21 @@ absl::Status DecodeStreaming(
 // - benchmark_info: The benchmark info to record the performance metrics.
 // - cancelled: A pointer to an atomic boolean. If the boolean is set to true,
 //   the decoding process will be cancelled.
+// - num_top_logprobs: If set, the log-probability of each decoded token and
+//   of its num_top_logprobs most likely alternatives are returned in
+//   Responses::GetTokenLogProbs(). The tokens of a stop string are dropped
+//   along with its text.
+// - constraint_thread_pool: Optional caller-owned pool on which the
+//   constraint masks of the candidates are computed in parallel.
 absl::StatusOr<Responses> DecodeCustomSampling(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
     Sampler& sampler, litert::TensorBuffer decoded_ids, Constraint* constraint,
     std::optional<BenchmarkInfo>& benchmark_info,
     std::atomic<bool>* cancelled = nullptr,
-    int max_output_tokens = std::numeric_limits<int>::max());
+    int max_output_tokens = std::numeric_limits<int>::max(),
+    std::optional<int> num_top_logprobs = std::nullopt,
+    ThreadPool* absl_nullable constraint_thread_pool = nullptr);
 
 // Runs the pipeline to decode the input prompt. The function is similar to
 // DecodeCustomSampling, but it outputs the result using the callback to
@@ -108,6 +126,11 @@ absl::StatusOr<Responses> DecodeCustomSampling(
 // - callback: The inference callback to receive the intermediate results.
 // - cancelled: A pointer to an atomic boolean. If the boolean is set to true,
 //   the decoding process will be cancelled.
+// - num_top_logprobs: If set, each chunk carries the log-probabilities of its
+//   tokens in Responses::GetTokenLogProbs().
+// - chunk_policy: How the intermediate results are coalesced into chunks.
+// - constraint_thread_pool: Optional caller-owned pool on which the
+//   constraint masks of the candidates are computed in parallel.
 absl::Status DecodeCustomSamplingStreaming(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
@@ -115,7 +138,10 @@ absl::Status DecodeCustomSamplingStreaming(
     std::optional<BenchmarkInfo>& benchmark_info,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
     std::atomic<bool>* cancelled = nullptr,
-    int max_output_tokens = std::numeric_limits<int>::max());
+    int max_output_tokens = std::numeric_limits<int>::max(),
+    std::optional<int> num_top_logprobs = std::nullopt,
+    const StreamingChunkPolicy& chunk_policy = StreamingChunkPolicy(),
+    ThreadPool* absl_nullable constraint_thread_pool = nullptr);
 
 // Runs the pipeline to score the input prompt.
 // - executor: The executor that calls the core LLM model.
@@ -131,6 +157,22 @@ absl::StatusOr<Responses> ScoreCustomSampling(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const std::vector<absl::string_view>& target_text, float temperature,
     litert::TensorBuffer decoded_ids, bool store_token_lengths = false);
+
+// Runs the pipeline to score each of the choices as a continuation of the
+// prefilled prompt, which is prefilled only once.
+// - executor: The executor that calls the core LLM model.
+// - tokenizer: The tokenizer to encode the text into token ids.
+// - choices: The texts to score. They are scored in batches of
+//   num_output_candidates rows.
+// - temperature: The temperature to use for softmax calculations.
+// - decoded_ids: The last prefilled token id of each row.
+//   The supported shape is [num_output_candidates, 1].
+// - returns: The log probability of each choice normalized over all the
+//   choices as the scores, and the token length of each choice.
+absl::StatusOr<Responses> ScoreChoicesCustomSampling(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& choices, float temperature,
+    litert::TensorBuffer decoded_ids);
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_PIPELINE_H_
@@ -0,0 +1,383 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/response_cache.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT: Required for the cache directory.
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>  // NOLINT: Required for std::filesystem errors.
+#include <utility>
+#include <vector>
+
+#include "absl/log/absl_log.h"  // from @com_google_absl
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_format.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "runtime/engine/io_types.h"
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+constexpr absl::string_view kMagic = "LRC1";
+constexpr absl::string_view kFileExtension = ".response";
+
+// 64-bit FNV-1a. Unlike absl::Hash, it is stable across processes, so it can
+// name the persisted files.
+uint64_t StableHash(absl::string_view data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (char c : data) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+int64_t EstimateSize(absl::string_view key,
+                     const std::vector<Responses>& responses) {
+  int64_t size = key.size();
+  for (const Responses& response : responses) {
+    size += sizeof(Responses);
+    for (const std::string& text : response.GetTexts()) {
+      size += text.size();
+    }
+    size += response.GetScores().size() * sizeof(float);
+    if (response.GetTokenLengths().has_value()) {
+      size += response.GetTokenLengths()->size() * sizeof(int);
+    }
+    if (response.GetTokenScores().has_value()) {
+      for (const auto& token_scores : *response.GetTokenScores()) {
+        size += token_scores.size() * sizeof(float);
+      }
+    }
+  }
+  return size;
+}
+
+template <typename T>
+void Append(std::string& data, T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  data.append(bytes, sizeof(T));
+}
+
+void AppendString(std::string& data, absl::string_view value) {
+  Append<uint32_t>(data, value.size());
+  data.append(value.data(), value.size());
+}
+
+template <typename T>
+void AppendVector(std::string& data, const std::vector<T>& values) {
+  Append<uint32_t>(data, values.size());
+  for (const T& value : values) {
+    Append<T>(data, value);
+  }
+}
+
+// Reads the fields written by the Append functions above.
+class Reader {
+ public:
+  explicit Reader(absl::string_view data) : data_(data) {}
+
+  template <typename T>
+  absl::StatusOr<T> Read() {
+    if (data_.size() < sizeof(T)) {
+      return absl::DataLossError("Truncated cached responses.");
+    }
+    T value;
+    std::memcpy(&value, data_.data(), sizeof(T));
+    data_.remove_prefix(sizeof(T));
+    return value;
+  }
+
+  absl::StatusOr<std::string> ReadString() {
+    ASSIGN_OR_RETURN(uint32_t size, Read<uint32_t>());
+    if (data_.size() < size) {
+      return absl::DataLossError("Truncated cached responses.");
+    }
+    std::string value(data_.substr(0, size));
+    data_.remove_prefix(size);
+    return value;
+  }
+
+  template <typename T>
+  absl::StatusOr<std::vector<T>> ReadVector() {
+    ASSIGN_OR_RETURN(uint32_t size, Read<uint32_t>());
+    if (data_.size() < static_cast<size_t>(size) * sizeof(T)) {
+      return absl::DataLossError("Truncated cached responses.");
+    }
+    std::vector<T> values(size);
+    for (T& value : values) {
+      ASSIGN_OR_RETURN(value, Read<T>());
+    }
+    return values;
+  }
+
+  bool empty() const { return data_.empty(); }
+
+ private:
+  absl::string_view data_;
+};
+
+absl::Status WriteFile(const std::string& path, absl::string_view data) {
+  // Written to a temporary file first, so that a crash never leaves a
+  // truncated entry behind.
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(data.data(), data.size());
+    if (!file) {
+      return absl::InternalError(absl::StrCat("Failed to write ", temp_path));
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temp_path, path, error);
+  if (error) {
+    return absl::InternalError(
+        absl::StrCat("Failed to rename ", temp_path, ": ", error.message()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(absl::StrCat("Failed to open ", path.string()));
+  }
+  return std::string(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+}
+
+}  // namespace
+
+std::string SerializeCachedResponses(absl::string_view key,
+                                     const std::vector<Responses>& responses) {
+  std::string data(kMagic);
+  AppendString(data, key);
+  Append<uint32_t>(data, responses.size());
+  for (const Responses& response : responses) {
+    Append<int32_t>(data, static_cast<int32_t>(response.GetTaskState()));
+    Append<uint32_t>(data, response.GetTexts().size());
+    for (const std::string& text : response.GetTexts()) {
+      AppendString(data, text);
+    }
+    AppendVector(data, response.GetScores());
+    Append<uint8_t>(data, response.GetTokenLengths().has_value());
+    if (response.GetTokenLengths().has_value()) {
+      AppendVector(data, *response.GetTokenLengths());
+    }
+    Append<uint8_t>(data, response.GetTokenScores().has_value());
+    if (response.GetTokenScores().has_value()) {
+      Append<uint32_t>(data, response.GetTokenScores()->size());
+      for (const auto& token_scores : *response.GetTokenScores()) {
+        AppendVector(data, token_scores);
+      }
+    }
+  }
+  return data;
+}
+
+absl::Status ParseCachedResponses(absl::string_view data, std::string& key,
+                                  std::vector<Responses>& responses) {
+  if (data.substr(0, kMagic.size()) != kMagic) {
+    return absl::DataLossError("Not a cached response.");
+  }
+  Reader reader(data.substr(kMagic.size()));
+  ASSIGN_OR_RETURN(key, reader.ReadString());
+  ASSIGN_OR_RETURN(uint32_t num_responses, reader.Read<uint32_t>());
+  responses.clear();
+  for (uint32_t i = 0; i < num_responses; ++i) {
+    ASSIGN_OR_RETURN(int32_t task_state, reader.Read<int32_t>());
+    ASSIGN_OR_RETURN(uint32_t num_texts, reader.Read<uint32_t>());
+    std::vector<std::string> texts;
+    for (uint32_t j = 0; j < num_texts; ++j) {
+      ASSIGN_OR_RETURN(texts.emplace_back(), reader.ReadString());
+    }
+    ASSIGN_OR_RETURN(std::vector<float> scores, reader.ReadVector<float>());
+    Responses response(static_cast<TaskState>(task_state), std::move(texts),
+                       std::move(scores));
+    ASSIGN_OR_RETURN(uint8_t has_token_lengths, reader.Read<uint8_t>());
+    if (has_token_lengths) {
+      ASSIGN_OR_RETURN(response.GetMutableTokenLengths(),
+                       reader.ReadVector<int>());
+    }
+    ASSIGN_OR_RETURN(uint8_t has_token_scores, reader.Read<uint8_t>());
+    if (has_token_scores) {
+      ASSIGN_OR_RETURN(uint32_t num_token_scores, reader.Read<uint32_t>());
+      std::vector<std::vector<float>> token_scores(num_token_scores);
+      for (auto& scores : token_scores) {
+        ASSIGN_OR_RETURN(scores, reader.ReadVector<float>());
+      }
+      response.GetMutableTokenScores() = std::move(token_scores);
+    }
+    responses.push_back(std::move(response));
+  }
+  if (!reader.empty()) {
+    return absl::DataLossError("Trailing data in cached responses.");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::unique_ptr<ResponseCache>> ResponseCache::Create(
+    const ResponseCacheConfig& config) {
+  if (config.max_bytes <= 0) {
+    return absl::InvalidArgumentError("max_bytes must be positive.");
+  }
+  auto cache = absl::WrapUnique(new ResponseCache(config));
+  if (config.directory.has_value()) {
+    std::error_code error;
+    std::filesystem::create_directories(*config.directory, error);
+    if (error) {
+      return absl::InternalError(absl::StrCat("Failed to create ",
+                                              *config.directory, ": ",
+                                              error.message()));
+    }
+    RETURN_IF_ERROR(cache->Load());
+  }
+  return cache;
+}
+
+absl::Status ResponseCache::Load() {
+  std::vector<std::pair<std::filesystem::file_time_type,
+                        std::filesystem::path>>
+      files;
+  std::error_code error;
+  for (const auto& file :
+       std::filesystem::directory_iterator(*config_.directory, error)) {
+    if (file.is_regular_file() &&
+        file.path().extension() == std::string(kFileExtension)) {
+      files.emplace_back(file.last_write_time(), file.path());
+    }
+  }
+  if (error) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to list ", *config_.directory, ": ", error.message()));
+  }
+  std::sort(files.begin(), files.end());
+
+  std::vector<std::string> evicted;
+  {
+    absl::MutexLock lock(mutex_);
+    for (const auto& [time, path] : files) {
+      Entry entry;
+      absl::StatusOr<std::string> data = ReadFile(path);
+      absl::Status status =
+          data.ok() ? ParseCachedResponses(*data, entry.key, entry.responses)
+                    : data.status();
+      if (!status.ok()) {
+        ABSL_LOG(WARNING) << "Ignoring cached responses in " << path << ": "
+                          << status;
+        continue;
+      }
+      entry.size_bytes = EstimateSize(entry.key, entry.responses);
+      for (std::string& key : AddLocked(std::move(entry))) {
+        evicted.push_back(std::move(key));
+      }
+    }
+  }
+  for (const std::string& key : evicted) {
+    std::filesystem::remove(GetPath(key), error);
+  }
+  return absl::OkStatus();
+}
+
+std::optional<std::vector<Responses>> ResponseCache::Lookup(
+    absl::string_view key) {
+  absl::MutexLock lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return it->second->responses;
+}
+
+absl::Status ResponseCache::Insert(absl::string_view key,
+                                   std::vector<Responses> responses) {
+  Entry entry;
+  entry.key = std::string(key);
+  entry.size_bytes = EstimateSize(key, responses);
+  if (entry.size_bytes > config_.max_bytes) {
+    return absl::OkStatus();
+  }
+  std::string data;
+  if (config_.directory.has_value()) {
+    data = SerializeCachedResponses(key, responses);
+  }
+  entry.responses = std::move(responses);
+  std::vector<std::string> evicted;
+  {
+    absl::MutexLock lock(mutex_);
+    evicted = AddLocked(std::move(entry));
+  }
+  if (!config_.directory.has_value()) {
+    return absl::OkStatus();
+  }
+  std::error_code error;
+  for (const std::string& evicted_key : evicted) {
+    std::filesystem::remove(GetPath(evicted_key), error);
+  }
+  return WriteFile(GetPath(key), data);
+}
+
+int64_t ResponseCache::size_bytes() const {
+  absl::MutexLock lock(mutex_);
+  return size_bytes_;
+}
+
+int ResponseCache::num_entries() const {
+  absl::MutexLock lock(mutex_);
+  return entries_.size();
+}
+
+std::vector<std::string> ResponseCache::AddLocked(Entry entry) {
+  if (auto it = index_.find(entry.key); it != index_.end()) {
+    size_bytes_ -= it->second->size_bytes;
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+  size_bytes_ += entry.size_bytes;
+  entries_.push_front(std::move(entry));
+  index_[entries_.front().key] = entries_.begin();
+
+  std::vector<std::string> evicted;
+  while (size_bytes_ > config_.max_bytes && entries_.size() > 1) {
+    Entry& oldest = entries_.back();
+    size_bytes_ -= oldest.size_bytes;
+    index_.erase(oldest.key);
+    evicted.push_back(std::move(oldest.key));
+    entries_.pop_back();
+  }
+  return evicted;
+}
+
+std::string ResponseCache::GetPath(absl::string_view key) const {
+  return (std::filesystem::path(*config_.directory) /
+          absl::StrFormat("%016x%s", StableHash(key), kFileExtension))
+      .string();
+}
+
+}  // namespace litert::lm
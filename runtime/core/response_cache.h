@@ -0,0 +1,117 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_RESPONSE_CACHE_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_RESPONSE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/engine/io_types.h"
+
+namespace litert::lm {
+
+struct ResponseCacheConfig {
+  // Upper bound on the memory held by the cached responses. The least
+  // recently used entries are evicted beyond it.
+  int64_t max_bytes = int64_t{64} << 20;
+  // Directory the entries are persisted to, one file per entry, if set. The
+  // entries found there are loaded when the cache is created, and evicted
+  // entries are deleted from it.
+  std::optional<std::string> directory;
+  // Identifies the model in the cache keys, so that entries persisted for one
+  // model are never served for another. When empty, the engine derives it
+  // from the path, size and modification time of the model file.
+  std::string model_id;
+  // Delay between two responses replayed through a streaming callback. Zero
+  // replays a cached answer as fast as the callback consumes it.
+  absl::Duration replay_interval = absl::ZeroDuration();
+};
+
+// An LRU cache of the responses of deterministic generation requests, keyed
+// by an opaque string. Thread-safe.
+class ResponseCache {
+ public:
+  // Creates the cache and loads the entries persisted in
+  // `config.directory`, if set, creating the directory if needed.
+  static absl::StatusOr<std::unique_ptr<ResponseCache>> Create(
+      const ResponseCacheConfig& config);
+
+  // Returns the responses cached under `key`, in the order they were
+  // streamed, and marks them as the most recently used.
+  std::optional<std::vector<Responses>> Lookup(absl::string_view key);
+
+  // Caches `responses` under `key`, replacing any previous entry, and evicts
+  // the least recently used entries to stay within the memory budget.
+  // Responses larger than the budget are not cached. Only the task state,
+  // texts, scores, token lengths and token scores are kept.
+  absl::Status Insert(absl::string_view key, std::vector<Responses> responses);
+
+  const ResponseCacheConfig& config() const { return config_; }
+  int64_t size_bytes() const;
+  int num_entries() const;
+
+ private:
+  struct Entry {
+    std::string key;
+    std::vector<Responses> responses;
+    int64_t size_bytes = 0;
+  };
+
+  explicit ResponseCache(const ResponseCacheConfig& config)
+      : config_(config) {}
+
+  // Loads the entries persisted in the directory, oldest first.
+  absl::Status Load();
+
+  // Adds `entry` as the most recently used one and evicts the least recently
+  // used entries beyond the budget. Returns the keys of the evicted entries.
+  std::vector<std::string> AddLocked(Entry entry)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  // Returns the path of the file persisting the entry of `key`.
+  std::string GetPath(absl::string_view key) const;
+
+  const ResponseCacheConfig config_;
+
+  mutable absl::Mutex mutex_;
+  // Most recently used first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t size_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Serializes the fields of `responses` kept by the cache.
+std::string SerializeCachedResponses(absl::string_view key,
+                                     const std::vector<Responses>& responses);
+
+// Parses the output of SerializeCachedResponses into `key` and `responses`.
+absl::Status ParseCachedResponses(absl::string_view data, std::string& key,
+                                  std::vector<Responses>& responses);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_RESPONSE_CACHE_H_
@@ -0,0 +1,169 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/core/response_cache.h"
+
+#include <filesystem>  // NOLINT: Required for the cache directory.
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "runtime/engine/io_types.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Optional;
+using ::testing::status::StatusIs;
+
+std::vector<Responses> Answer(const std::string& text) {
+  std::vector<Responses> responses;
+  responses.emplace_back(TaskState::kProcessing,
+                         std::vector<std::string>{text});
+  responses.emplace_back(TaskState::kDone);
+  return responses;
+}
+
+std::optional<std::string> LookupText(ResponseCache& cache,
+                                      const std::string& key) {
+  std::optional<std::vector<Responses>> responses = cache.Lookup(key);
+  if (!responses.has_value()) {
+    return std::nullopt;
+  }
+  return (*responses)[0].GetTexts()[0];
+}
+
+std::string CreateCacheDirectory(const std::string& name) {
+  std::filesystem::path path =
+      std::filesystem::path(::testing::TempDir()) / name;
+  std::filesystem::remove_all(path);
+  return path.string();
+}
+
+TEST(ResponseCacheTest, RejectsEmptyBudget) {
+  ResponseCacheConfig config;
+  config.max_bytes = 0;
+  EXPECT_THAT(ResponseCache::Create(config),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ResponseCacheTest, EvictsLeastRecentlyUsed) {
+  ResponseCacheConfig config;
+  ASSERT_OK_AND_ASSIGN(auto probe, ResponseCache::Create(config));
+  ASSERT_OK(probe->Insert("a", Answer("1")));
+  // Room for two entries of the same size.
+  config.max_bytes = probe->size_bytes() * 2;
+  ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+
+  ASSERT_OK(cache->Insert("a", Answer("1")));
+  ASSERT_OK(cache->Insert("b", Answer("2")));
+  EXPECT_THAT(LookupText(*cache, "a"), Optional(std::string("1")));
+  ASSERT_OK(cache->Insert("c", Answer("3")));
+
+  EXPECT_EQ(cache->num_entries(), 2);
+  EXPECT_THAT(LookupText(*cache, "a"), Optional(std::string("1")));
+  EXPECT_EQ(cache->Lookup("b"), std::nullopt);
+  EXPECT_THAT(LookupText(*cache, "c"), Optional(std::string("3")));
+}
+
+TEST(ResponseCacheTest, ReplacesEntryWithSameKey) {
+  ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create({}));
+  ASSERT_OK(cache->Insert("a", Answer("1")));
+  ASSERT_OK(cache->Insert("a", Answer("2")));
+  EXPECT_EQ(cache->num_entries(), 1);
+  EXPECT_THAT(LookupText(*cache, "a"), Optional(std::string("2")));
+}
+
+TEST(ResponseCacheTest, SerializationRoundTrip) {
+  std::vector<Responses> responses = Answer("Hello");
+  responses[0].GetMutableScores() = {0.5f};
+  responses[0].GetMutableTokenLengths() = std::vector<int>{2};
+  responses[0].GetMutableTokenScores() =
+      std::vector<std::vector<float>>{{-0.1f, -0.2f}};
+
+  std::string key;
+  std::vector<Responses> parsed;
+  ASSERT_OK(ParseCachedResponses(SerializeCachedResponses("key", responses),
+                                 key, parsed));
+  EXPECT_EQ(key, "key");
+  ASSERT_EQ(parsed.size(), 2);
+  EXPECT_EQ(parsed[0].GetTaskState(), TaskState::kProcessing);
+  EXPECT_THAT(parsed[0].GetTexts(), ElementsAre("Hello"));
+  EXPECT_THAT(parsed[0].GetScores(), ElementsAre(0.5f));
+  EXPECT_THAT(parsed[0].GetTokenLengths(), Optional(ElementsAre(2)));
+  EXPECT_THAT(parsed[0].GetTokenScores(),
+              Optional(ElementsAre(ElementsAre(-0.1f, -0.2f))));
+  EXPECT_EQ(parsed[1].GetTaskState(), TaskState::kDone);
+  EXPECT_EQ(parsed[1].GetTokenLengths(), std::nullopt);
+}
+
+TEST(ResponseCacheTest, RejectsTruncatedData) {
+  std::string data = SerializeCachedResponses("key", Answer("Hello"));
+  data.pop_back();
+  std::string key;
+  std::vector<Responses> parsed;
+  EXPECT_THAT(ParseCachedResponses(data, key, parsed),
+              StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ResponseCacheTest, PersistsEntries) {
+  ResponseCacheConfig config;
+  config.directory = CreateCacheDirectory("persisted_responses");
+  {
+    ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+    ASSERT_OK(cache->Insert("a", Answer("1")));
+    ASSERT_OK(cache->Insert("b", Answer("2")));
+  }
+  ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+  EXPECT_EQ(cache->num_entries(), 2);
+  EXPECT_THAT(LookupText(*cache, "a"), Optional(std::string("1")));
+  EXPECT_THAT(LookupText(*cache, "b"), Optional(std::string("2")));
+}
+
+TEST(ResponseCacheTest, DeletesEvictedEntries) {
+  ResponseCacheConfig config;
+  config.directory = CreateCacheDirectory("evicted_responses");
+  ASSERT_OK_AND_ASSIGN(auto probe, ResponseCache::Create({}));
+  ASSERT_OK(probe->Insert("a", Answer("1")));
+  config.max_bytes = probe->size_bytes();
+  {
+    ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+    ASSERT_OK(cache->Insert("a", Answer("1")));
+    ASSERT_OK(cache->Insert("b", Answer("2")));
+  }
+  ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+  EXPECT_EQ(cache->num_entries(), 1);
+  EXPECT_EQ(cache->Lookup("a"), std::nullopt);
+  EXPECT_THAT(LookupText(*cache, "b"), Optional(std::string("2")));
+}
+
+TEST(ResponseCacheTest, IgnoresMalformedFiles) {
+  ResponseCacheConfig config;
+  config.directory = CreateCacheDirectory("malformed_responses");
+  std::filesystem::create_directories(*config.directory);
+  std::ofstream(std::filesystem::path(*config.directory) / "0.response")
+      << "garbage";
+  ASSERT_OK_AND_ASSIGN(auto cache, ResponseCache::Create(config));
+  EXPECT_EQ(cache->num_entries(), 0);
+}
+
+}  // namespace
+}  // namespace litert::lm
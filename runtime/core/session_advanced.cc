@@ -33,9 +33,11 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
 #include "runtime/core/session_utils.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/framework/resource_management/execution_manager.h"
@@ -68,6 +70,18 @@ absl::StatusOr<std::unique_ptr<SessionAdvanced>> SessionAdvanced::Create(
       /*last_task_ids=*/{}));
 }
 
+SessionAdvanced::~SessionAdvanced() {
+  WaitUntilDone().IgnoreError();
+  if (auto execution_manager_lock = execution_manager_.lock();
+      execution_manager_lock != nullptr) {
+    auto status = execution_manager_lock->ReleaseSession(session_id_);
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to release session " << session_id_ << ": "
+                        << status;
+    }
+  }
+}
+
 absl::Status SessionAdvanced::RunPrefill(
     const std::vector<InputData>& contents) {
   absl::Status status = absl::OkStatus();
@@ -92,6 +106,7 @@ SessionAdvanced::RunPrefillAsync(
     return absl::FailedPreconditionError("Execution manager is not available.");
   }
 
+  const absl::Time preprocess_start = absl::Now();
   std::vector<InputData> preprocessed_contents;
   if (session_info_->benchmark_info.has_value() &&
       session_info_->benchmark_info->GetBenchmarkParams().num_prefill_tokens() >
@@ -119,6 +134,8 @@ SessionAdvanced::RunPrefillAsync(
         PreprocessContents(templated_contents, session_info_->session_config,
                            *tokenizer_, session_info_->benchmark_info));
   }
+  execution_manager_lock->GetMetrics().preprocess_latency->ObserveDuration(
+      absl::Now() - preprocess_start);
   ASSIGN_OR_RETURN(auto task_id, execution_manager_lock->GetNewTaskId());
   RETURN_IF_ERROR(execution_manager_lock->AddPrefillTask(
       session_id_, task_id, std::move(preprocessed_contents), last_task_ids_,
@@ -252,7 +269,8 @@ absl::StatusOr<std::unique_ptr<TaskController>> SessionAdvanced::RunDecodeAsync(
       session_id_, task_id, last_task_ids_, decode_config.GetConstraint(),
       cancelled, std::move(callback),
       decode_config.GetMaxOutputTokens().value_or(
-          session_info_->session_config.GetMaxOutputTokens())));
+          session_info_->session_config.GetMaxOutputTokens()),
+      GetNumTopLogProbs(decode_config, session_info_->session_config)));
 
   last_task_ids_ = {task_id};
 
@@ -310,6 +328,48 @@ SessionAdvanced::RunTextScoringAsync(
                                                   execution_manager_);
 }
 
+absl::StatusOr<Responses> SessionAdvanced::RunTextClassification(
+    const std::vector<absl::string_view>& choices) {
+  absl::StatusOr<Responses> collected_responses;
+  auto classification_sync_callback =
+      [&collected_responses](absl::StatusOr<Responses> responses) {
+        collected_responses = std::move(responses);
+      };
+
+  ASSIGN_OR_RETURN(auto task_controller,
+                   RunTextClassificationAsync(
+                       choices, std::move(classification_sync_callback)));
+  RETURN_IF_ERROR(task_controller->WaitUntilDone(Engine::kDefaultTimeout));
+  return collected_responses;
+}
+
+absl::StatusOr<std::unique_ptr<Engine::Session::TaskController>>
+SessionAdvanced::RunTextClassificationAsync(
+    const std::vector<absl::string_view>& choices,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) {
+  absl::MutexLock lock(mutex_);
+  if (choices.empty()) {
+    return absl::InvalidArgumentError("At least one choice is required.");
+  }
+  auto execution_manager_lock = execution_manager_.lock();
+  if (execution_manager_lock == nullptr) {
+    return absl::FailedPreconditionError("Execution manager is not available.");
+  }
+
+  auto cancelled = std::make_shared<std::atomic<bool>>(false);
+  ASSIGN_OR_RETURN(auto task_id, execution_manager_lock->GetNewTaskId());
+  RETURN_IF_ERROR(execution_manager_lock->AddTextClassificationTask(
+      session_id_, task_id, last_task_ids_,
+      std::vector<std::string>(choices.begin(), choices.end()), cancelled,
+      std::move(callback)));
+  // Later tasks of the session wait for the classification, which rewinds the
+  // executor to the end of the prefilled context.
+  last_task_ids_ = {task_id};
+
+  return std::make_unique<AdvancedTaskController>(task_id, cancelled,
+                                                  execution_manager_);
+}
+
 absl::StatusOr<Responses> SessionAdvanced::GenerateContent(
     const std::vector<InputData>& contents) {
   RETURN_IF_ERROR(RunPrefill(contents));
@@ -83,9 +83,9 @@ class SessionAdvanced : public Engine::Session {
       Tokenizer* absl_nonnull tokenizer, const SessionConfig& session_config,
       std::optional<BenchmarkInfo> benchmark_info);
 
-  // TODO b/409401231 - Call execution manager's release session instead.
-  // Wait until all tasks are done before destroying the session.
-  ~SessionAdvanced() override { WaitUntilDone().IgnoreError(); };
+  // Waits until all tasks are done, then releases the session from the
+  // execution manager.
+  ~SessionAdvanced() override;
 
   absl::StatusOr<Responses> GenerateContent(
       const std::vector<InputData>& contents) override;
@@ -118,6 +118,15 @@ class SessionAdvanced : public Engine::Session {
       absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
       bool store_token_lengths) override ABSL_LOCKS_EXCLUDED(mutex_);
 
+  absl::StatusOr<Responses> RunTextClassification(
+      const std::vector<absl::string_view>& choices) override;
+
+  absl::StatusOr<std::unique_ptr<Engine::Session::TaskController>>
+  RunTextClassificationAsync(
+      const std::vector<absl::string_view>& choices,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   absl::Status RunPrefill(const std::vector<InputData>& contents) override;
 
   absl::StatusOr<std::unique_ptr<TaskController>> RunPrefillAsync(
@@ -34,6 +34,7 @@
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "litert/cc/litert_layout.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -44,6 +45,7 @@
 #include "runtime/core/pipeline.h"
 #include "runtime/core/session_utils.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -76,7 +78,7 @@ absl::StatusOr<std::unique_ptr<SessionBasic>> SessionBasic::Create(
     VisionExecutor* vision_executor, AudioExecutor* audio_executor,
     const SessionConfig& session_config,
     std::optional<BenchmarkInfo> benchmark_info,
-    ThreadPool* worker_thread_pool) {
+    ThreadPool* worker_thread_pool, EngineMetrics* metrics) {
   // Check if the session already exists.
   absl::MutexLock lock(occupied_executors_mu_);  // NOLINT
   if (occupied_executors_->contains(executor)) {
@@ -108,11 +110,15 @@ absl::StatusOr<std::unique_ptr<SessionBasic>> SessionBasic::Create(
     RETURN_IF_ERROR(
         stop_token_detector.AddStopTokenSequence(stop_token_sequence));
   }
+  for (const auto& stop_string : session_config.GetStopStrings()) {
+    RETURN_IF_ERROR(stop_token_detector.AddStopString(stop_string));
+  }
 
   occupied_executors_->insert(executor);
   return absl::WrapUnique(new SessionBasic(
       executor, tokenizer, vision_executor, audio_executor, std::move(sampler),
-      session_config, benchmark_info, worker_thread_pool, stop_token_detector));
+      session_config, benchmark_info, worker_thread_pool, stop_token_detector,
+      metrics));
 }
 
 SessionBasic::~SessionBasic() {
@@ -232,14 +238,29 @@ absl::StatusOr<ExecutorInputs> SessionBasic::ProcessAndCombineContents(
   return inputs;
 }
 
+void SessionBasic::RecordExecution(absl::Time start_time, int start_step,
+                                   Histogram* latency, Counter* tokens) {
+  latency->ObserveDuration(absl::Now() - start_time);
+  auto current_step = executor_.GetCurrentStep();
+  if (!current_step.ok()) return;
+  if (*current_step > start_step) tokens->Increment(*current_step - start_step);
+  metrics_->kv_cache_tokens->Set(*current_step);
+}
+
 absl::Status SessionBasic::PrefillInternal(
     const std::vector<InputData>& preprocessed_contents,
     bool wait_for_completion) {
   ASSIGN_OR_RETURN(ExecutorInputs inputs,
                    ProcessAndCombineContents(preprocessed_contents));
+  const int start_step = executor_.GetCurrentStep().value_or(0);
+  const absl::Time start_time = absl::Now();
   ASSIGN_OR_RETURN(
       last_prefill_token_id_,
       Prefill(executor_, inputs, wait_for_completion, benchmark_info_));
+  if (metrics_ != nullptr) {
+    RecordExecution(start_time, start_step, metrics_->prefill_latency,
+                    metrics_->prefill_tokens);
+  }
   session_state_ = SessionState::kPrefilled;
   return absl::OkStatus();
 }
@@ -257,6 +278,7 @@ absl::Status SessionBasic::RunPrefill(const std::vector<InputData>& contents) {
     // Reset the cancelled flag before processing the next turn.
     cancelled_ = false;
   }
+  const absl::Time preprocess_start = absl::Now();
   std::vector<InputData> preprocessed_contents;
   if (benchmark_info_.has_value() &&
       benchmark_info_->GetBenchmarkParams().num_prefill_tokens() > 0) {
@@ -281,6 +303,10 @@ absl::Status SessionBasic::RunPrefill(const std::vector<InputData>& contents) {
                      PreprocessContents(templated_contents, session_config_,
                                         tokenizer_, benchmark_info_));
   }
+  if (metrics_ != nullptr) {
+    metrics_->preprocess_latency->ObserveDuration(absl::Now() -
+                                                  preprocess_start);
+  }
 
   return PrefillInternal(preprocessed_contents,
                          /*wait_for_completion=*/true);
@@ -301,6 +327,7 @@ absl::StatusOr<std::unique_ptr<TaskController>> SessionBasic::RunPrefillAsync(
     // Reset the cancelled flag before processing the next turn.
     cancelled_ = false;
   }
+  const absl::Time preprocess_start = absl::Now();
   std::vector<InputData> preprocessed_contents;
   if (benchmark_info_.has_value() &&
       benchmark_info_->GetBenchmarkParams().num_prefill_tokens() > 0) {
@@ -325,6 +352,10 @@ absl::StatusOr<std::unique_ptr<TaskController>> SessionBasic::RunPrefillAsync(
                      PreprocessContents(templated_contents, session_config_,
                                         tokenizer_, benchmark_info_));
   }
+  if (metrics_ != nullptr) {
+    metrics_->preprocess_latency->ObserveDuration(absl::Now() -
+                                                  preprocess_start);
+  }
   RETURN_IF_ERROR(worker_thread_pool_.Schedule(
       [this, preprocessed_contents = std::move(preprocessed_contents),
        callback = std::move(callback)]() mutable {
@@ -370,14 +401,27 @@ absl::StatusOr<Responses> SessionBasic::DecodeInternal(
   }
   session_state_ = SessionState::kDecoded;
 
+  const std::optional<int> num_top_logprobs =
+      GetNumTopLogProbs(decode_config, session_config_);
+  const int start_step = executor_.GetCurrentStep().value_or(0);
+  const absl::Time start_time = absl::Now();
   if (sampler_ == nullptr) {
+    if (num_top_logprobs.has_value()) {
+      return absl::UnimplementedError(
+          "Log-probabilities are only supported with the CPU sampler.");
+    }
     ASSIGN_OR_RETURN(
         auto responses,
         Decode(executor_, tokenizer_, stop_token_detector_,
                session_config_.GetNumOutputCandidates(),
                decode_config.GetConstraint(), benchmark_info_, &cancelled_,
                decode_config.GetMaxOutputTokens().value_or(
-                   session_config_.GetMaxOutputTokens())));
+                   session_config_.GetMaxOutputTokens()),
+               constraint_thread_pool_.get()));
+    if (metrics_ != nullptr) {
+      RecordExecution(start_time, start_step, metrics_->decode_latency,
+                      metrics_->decode_tokens);
+    }
     return responses;
   } else {
     std::vector<int> decoded_ids(session_config_.GetNumOutputCandidates(),
@@ -394,7 +438,12 @@ absl::StatusOr<Responses> SessionBasic::DecodeInternal(
                              decode_config.GetConstraint(), benchmark_info_,
                              &cancelled_,
                              decode_config.GetMaxOutputTokens().value_or(
-                                 session_config_.GetMaxOutputTokens())));
+                                 session_config_.GetMaxOutputTokens()),
+                             num_top_logprobs, constraint_thread_pool_.get()));
+    if (metrics_ != nullptr) {
+      RecordExecution(start_time, start_step, metrics_->decode_latency,
+                      metrics_->decode_tokens);
+    }
     return responses;
   }
 }
@@ -402,13 +451,23 @@ absl::StatusOr<Responses> SessionBasic::DecodeInternal(
 absl::Status SessionBasic::DecodeInternalStreaming(
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
     const DecodeConfig& decode_config) {
+  const std::optional<int> num_top_logprobs =
+      GetNumTopLogProbs(decode_config, session_config_);
+  const int start_step = executor_.GetCurrentStep().value_or(0);
+  const absl::Time start_time = absl::Now();
   if (sampler_ == nullptr) {
+    if (num_top_logprobs.has_value()) {
+      return absl::UnimplementedError(
+          "Log-probabilities are only supported with the CPU sampler.");
+    }
     RETURN_IF_ERROR(DecodeStreaming(
         executor_, tokenizer_, stop_token_detector_,
         session_config_.GetNumOutputCandidates(), decode_config.GetConstraint(),
         benchmark_info_, std::move(callback), &cancelled_,
         decode_config.GetMaxOutputTokens().value_or(
-            session_config_.GetMaxOutputTokens())));
+            session_config_.GetMaxOutputTokens()),
+        session_config_.GetStreamingChunkPolicy(),
+        constraint_thread_pool_.get()));
   } else {
     std::vector<int> decoded_ids(session_config_.GetNumOutputCandidates(),
                                  last_prefill_token_id_);
@@ -423,7 +482,13 @@ absl::Status SessionBasic::DecodeInternalStreaming(
         std::move(decoded_ids_buffer), decode_config.GetConstraint(),
         benchmark_info_, std::move(callback), &cancelled_,
         decode_config.GetMaxOutputTokens().value_or(
-            session_config_.GetMaxOutputTokens())));
+            session_config_.GetMaxOutputTokens()),
+        num_top_logprobs, session_config_.GetStreamingChunkPolicy(),
+        constraint_thread_pool_.get()));
+  }
+  if (metrics_ != nullptr) {
+    RecordExecution(start_time, start_step, metrics_->decode_latency,
+                    metrics_->decode_tokens);
   }
   return absl::OkStatus();
 }
@@ -521,6 +586,52 @@ SessionBasic::RunTextScoringAsync(
   return nullptr;
 }
 
+absl::StatusOr<Responses> SessionBasic::RunTextClassification(
+    const std::vector<absl::string_view>& choices) {
+  absl::StatusOr<Responses> collected_responses;
+  auto classification_sync_callback =
+      [&collected_responses](absl::StatusOr<Responses> responses) {
+        collected_responses = std::move(responses);
+      };
+
+  ASSIGN_OR_RETURN(auto task_controller,
+                   RunTextClassificationAsync(
+                       choices, std::move(classification_sync_callback)));
+  RETURN_IF_ERROR(worker_thread_pool_.WaitUntilDone(Engine::kDefaultTimeout));
+  return collected_responses;
+}
+
+absl::StatusOr<std::unique_ptr<Engine::Session::TaskController>>
+SessionBasic::RunTextClassificationAsync(
+    const std::vector<absl::string_view>& choices,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) {
+  if (choices.empty()) {
+    return absl::InvalidArgumentError("At least one choice is required.");
+  }
+  // The choices are copied as the task may outlive the caller's strings.
+  std::vector<std::string> choice_texts(choices.begin(), choices.end());
+  // TODO(b/435040163): Handle the temperature the same way as scoring.
+  auto temperature = 1.0f;
+  RETURN_IF_ERROR(worker_thread_pool_.Schedule(
+      [this, callback = std::move(callback),
+       choice_texts = std::move(choice_texts), temperature]() mutable {
+        std::vector<int> decoded_ids(session_config_.GetNumOutputCandidates(),
+                                     last_prefill_token_id_);
+        auto decoded_ids_buffer = CopyToTensorBuffer<int>(
+            decoded_ids, {session_config_.GetNumOutputCandidates(), 1});
+        if (!decoded_ids_buffer.HasValue()) {
+          callback(absl::InternalError(decoded_ids_buffer.Error().Message()));
+          return;
+        }
+        std::vector<absl::string_view> choices(choice_texts.begin(),
+                                               choice_texts.end());
+        callback(ScoreChoicesCustomSampling(
+            executor_, tokenizer_, choices, temperature,
+            std::move(decoded_ids_buffer.Value())));
+      }));
+  return nullptr;
+}
+
 absl::Status SessionBasic::GenerateContentStream(
     const std::vector<InputData>& contents,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) {
@@ -30,10 +30,12 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "runtime/components/sampler.h"
 #include "runtime/components/stop_token_detector.h"
 #include "runtime/components/tokenizer.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -59,12 +61,15 @@ class SessionBasic : public Engine::Session {
   // - sampler_params: The sampler parameters used for decoding. Note that if
   //   the sampler_params.type is TYPE_UNSPECIFIED, the sampling logic will be
   //   handled by the LLM Executor.
+  // - metrics: The engine metrics to record prefill/decode work in. Can be
+  //   null; otherwise it must outlive the session.
   static absl::StatusOr<std::unique_ptr<SessionBasic>> Create(
       LlmExecutor* absl_nonnull executor, Tokenizer* absl_nonnull tokenizer,
       VisionExecutor* vision_executor, AudioExecutor* audio_executor,
       const SessionConfig& session_config,
       std::optional<BenchmarkInfo> benchmark_info,
-      ThreadPool* absl_nonnull worker_thread_pool);
+      ThreadPool* absl_nonnull worker_thread_pool,
+      EngineMetrics* absl_nullable metrics = nullptr);
 
   virtual ~SessionBasic();
 
@@ -99,6 +104,14 @@ class SessionBasic : public Engine::Session {
       absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
       bool store_token_lengths) override;
 
+  absl::StatusOr<Responses> RunTextClassification(
+      const std::vector<absl::string_view>& choices) override;
+
+  absl::StatusOr<std::unique_ptr<Engine::Session::TaskController>>
+  RunTextClassificationAsync(
+      const std::vector<absl::string_view>& choices,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) override;
+
   absl::Status RunPrefill(const std::vector<InputData>& contents) override;
 
   absl::StatusOr<std::unique_ptr<Engine::Session::TaskController>>
@@ -154,7 +167,8 @@ class SessionBasic : public Engine::Session {
                         const SessionConfig& session_config,
                         std::optional<BenchmarkInfo> benchmark_info,
                         ThreadPool* absl_nonnull worker_thread_pool,
-                        const StopTokenDetector& stop_token_detector)
+                        const StopTokenDetector& stop_token_detector,
+                        EngineMetrics* absl_nullable metrics)
       : executor_(*executor),
         tokenizer_(*tokenizer),
         vision_executor_(vision_executor),
@@ -163,7 +177,16 @@ class SessionBasic : public Engine::Session {
         session_config_(session_config),
         benchmark_info_(benchmark_info),
         worker_thread_pool_(*worker_thread_pool),
-        stop_token_detector_(stop_token_detector) {}
+        stop_token_detector_(stop_token_detector),
+        metrics_(metrics) {
+    // The constraint masks of the candidates are computed in parallel, with
+    // the first candidate on the decode thread. Worker threads are only
+    // started on first use.
+    if (session_config_.GetNumOutputCandidates() > 1) {
+      constraint_thread_pool_ = std::make_unique<ThreadPool>(
+          "constraint_pool", session_config_.GetNumOutputCandidates() - 1);
+    }
+  }
 
   // The internal function to prefill the input prompt. It is for convenience to
   // wrap it with lambda function for scheduling.
@@ -178,6 +201,12 @@ class SessionBasic : public Engine::Session {
       absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
       const DecodeConfig& decode_config);
 
+  // Records the wall time since `start_time` in `latency` and the number of
+  // tokens the executor advanced by since `start_step` in `tokens`. Must only
+  // be called if the session has metrics.
+  void RecordExecution(absl::Time start_time, int start_step,
+                       Histogram* latency, Counter* tokens);
+
   // The executor used for run the LLM for prefill/decode.
   LlmExecutor& executor_;
 
@@ -206,12 +235,19 @@ class SessionBasic : public Engine::Session {
   // The thread pool used for the session.
   ThreadPool& worker_thread_pool_;
 
+  // The thread pool the constraint masks are computed on, shared by all the
+  // decodes of the session. Null when there is a single output candidate.
+  std::unique_ptr<ThreadPool> constraint_thread_pool_;
+
   // The stop token detector used for the session.
   StopTokenDetector stop_token_detector_;
 
   // An atomic boolean to indicate whether the session is cancelled.
   std::atomic<bool> cancelled_{false};
 
+  // The engine metrics, not owned. May be null.
+  EngineMetrics* absl_nullable metrics_;
+
   // The state of the session.
   // * `kFresh` means the session is just created and
   //   hasn't been prefilled yet.
@@ -138,7 +138,7 @@ class ExtendedTokenizer : public Tokenizer {
   }
 
   absl::StatusOr<std::vector<int>> TextToTokenIds(
-      absl::string_view text) override {
+      absl::string_view text) const override {
     std::vector<int> token_ids;
     bool is_extended_token_found = false;
     do {
@@ -166,7 +166,7 @@ class ExtendedTokenizer : public Tokenizer {
   }
 
   absl::StatusOr<std::string> TokenIdsToText(
-      const std::vector<int>& token_ids) override {
+      const std::vector<int>& token_ids) const override {
     std::vector<std::string> token_strs;
     for (int token_id : token_ids) {
       if (id_to_extended_tokens_.contains(token_id)) {
@@ -178,7 +178,7 @@ class ExtendedTokenizer : public Tokenizer {
     return absl::StrJoin(token_strs, "");
   }
 
-  absl::StatusOr<int> TokenToId(absl::string_view token) override {
+  absl::StatusOr<int> TokenToId(absl::string_view token) const override {
     if (extended_tokens_to_id_.contains(token)) {
       return extended_tokens_to_id_[token];
     }
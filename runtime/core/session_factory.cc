@@ -22,6 +22,7 @@
 #include "runtime/components/tokenizer.h"
 #include "runtime/core/session_basic.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -37,10 +38,11 @@ absl::StatusOr<std::unique_ptr<Engine::Session>> InitializeSessionBasic(
     VisionExecutor* vision_executor, AudioExecutor* audio_executor,
     const SessionConfig& session_config,
     std::optional<BenchmarkInfo> benchmark_info,
-    ThreadPool* absl_nonnull worker_thread_pool) {
-  auto session =
-      SessionBasic::Create(executor, tokenizer, vision_executor, audio_executor,
-                           session_config, benchmark_info, worker_thread_pool);
+    ThreadPool* absl_nonnull worker_thread_pool,
+    EngineMetrics* absl_nullable metrics) {
+  auto session = SessionBasic::Create(
+      executor, tokenizer, vision_executor, audio_executor, session_config,
+      benchmark_info, worker_thread_pool, metrics);
   return session;
 }
 
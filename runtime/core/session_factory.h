@@ -22,6 +22,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -37,12 +38,14 @@ namespace litert::lm {
 // image_preprocessor and vision_executor are optional and can be nullptr.
 // If image input is used in the session, the vision_executor must be provided.
 // If audio input is used in the session, the audio_executor must be provided.
+// metrics is optional; if provided, it must outlive the session.
 absl::StatusOr<std::unique_ptr<Engine::Session>> InitializeSessionBasic(
     LlmExecutor* absl_nonnull executor, Tokenizer* absl_nonnull tokenizer,
     VisionExecutor* vision_executor, AudioExecutor* audio_executor,
     const SessionConfig& session_config,
     std::optional<BenchmarkInfo> benchmark_info,
-    ThreadPool* absl_nonnull worker_thread_pool);
+    ThreadPool* absl_nonnull worker_thread_pool,
+    EngineMetrics* absl_nullable metrics = nullptr);
 
 }  // namespace litert::lm
 
@@ -37,16 +37,16 @@ class FakeTokenizer : public Tokenizer {
   FakeTokenizer() = default;
 
   absl::StatusOr<std::vector<int>> TextToTokenIds(
-      absl::string_view text) override {
+      absl::string_view text) const override {
     return std::vector<int>{1, 2, 3};
   }
 
-  absl::StatusOr<int> TokenToId(absl::string_view token) override {
+  absl::StatusOr<int> TokenToId(absl::string_view token) const override {
     return token == "BOS" ? 2 : 1;
   }
 
   absl::StatusOr<std::string> TokenIdsToText(
-      const std::vector<int>& token_ids) override {
+      const std::vector<int>& token_ids) const override {
     return "fake_text";
   }
 
@@ -218,4 +218,17 @@ absl::StatusOr<std::vector<InputData>> PreprocessContents(
   return preprocessed_contents;
 }
 
+std::optional<int> GetNumTopLogProbs(const DecodeConfig& decode_config,
+                                     const SessionConfig& session_config) {
+  const int num_top_logprobs = decode_config.GetNumTopLogProbs().value_or(
+      session_config.GetNumTopLogProbs());
+  if (num_top_logprobs > 0) {
+    return num_top_logprobs;
+  }
+  if (decode_config.GetReturnTokenLogProbs()) {
+    return 0;
+  }
+  return std::nullopt;
+}
+
 }  // namespace litert::lm
@@ -61,6 +61,12 @@ absl::StatusOr<std::vector<InputData>> PreprocessContents(
     const std::vector<InputData>& contents, const SessionConfig& session_config,
     Tokenizer& tokenizer, const std::optional<BenchmarkInfo>& benchmark_info);
 
+// Returns the number of top alternatives to report with the log-probability
+// of each decoded token, or std::nullopt if no log-probabilities are
+// requested. The decode config overrides the session config.
+std::optional<int> GetNumTopLogProbs(const DecodeConfig& decode_config,
+                                     const SessionConfig& session_config);
+
 }  // namespace litert::lm
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_SESSION_UTILS_H_
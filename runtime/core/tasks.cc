@@ -16,6 +16,9 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -25,14 +28,18 @@
 #include <vector>
 
 #include "absl/base/nullability.h"  // from @com_google_absl
+#include "absl/cleanup/cleanup.h"  // from @com_google_absl
 #include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/log/absl_log.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/match.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/str_format.h"  // from @com_google_absl
 #include "absl/strings/str_replace.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/clock.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
@@ -47,6 +54,7 @@
 #include "runtime/executor/llm_executor_io_types.h"
 #include "runtime/executor/llm_executor_settings.h"
 #include "runtime/executor/llm_litert_compiled_model_executor.h"
+#include "runtime/framework/threadpool.h"
 #include "runtime/proto/sampler_params.pb.h"
 #include "runtime/util/convert_tensor_buffer.h"
 #include "runtime/util/status_macros.h"  //NOLINT
@@ -94,6 +102,21 @@ bool ShouldStop(bool hit_stop_tokens, int benchmark_decode_token_count,
   return false;
 }
 
+// Drops the log-probabilities of the trailing tokens whose text is not part of
+// `text`, e.g. the tokens of a stop string which was trimmed from the output.
+// The text of a candidate is the concatenation of the texts of its tokens, up
+// to where a stop string or stop token sequence cut it.
+void TrimLogProbsToText(absl::string_view text,
+                        std::vector<TokenLogProbs>& logprobs) {
+  size_t text_length = 0;
+  size_t num_tokens = 0;
+  while (num_tokens < logprobs.size() && text_length < text.size()) {
+    text_length += logprobs[num_tokens].token.token.size();
+    ++num_tokens;
+  }
+  logprobs.resize(num_tokens);
+}
+
 // A wrapper class to run one step of the decode process, handling both internal
 // and external sampling.
 class DecodeOneStep {
@@ -102,7 +125,8 @@ class DecodeOneStep {
                 Tokenizer* absl_nonnull tokenizer, int num_output_candidates,
                 const StopTokenDetector& stop_token_detector,
                 std::optional<BenchmarkInfo>& benchmark_info,
-                std::optional<Sampler*> sampler, Constraint* constraint)
+                std::optional<Sampler*> sampler, Constraint* constraint,
+                ThreadPool* absl_nullable constraint_thread_pool = nullptr)
       : executor_(*executor),
         tokenizer_(*tokenizer),
         num_output_candidates_(num_output_candidates),
@@ -110,8 +134,10 @@ class DecodeOneStep {
         benchmark_info_(benchmark_info),
         stop_token_detector_(stop_token_detector) {
     if (constraint != nullptr) {
+      // The constraint masks of the candidates are independent, so compute
+      // them in parallel on the caller-owned pool when one is given.
       constrained_decoder_ = std::make_unique<ConstrainedDecoder>(
-          constraint, num_output_candidates_);
+          constraint, num_output_candidates_, constraint_thread_pool);
     }
     if (!sampler_.has_value()) {  // Internal sampling setup
       auto output_tokens = CreateTensorBuffer<int>({num_output_candidates_, 1});
@@ -125,6 +151,8 @@ class DecodeOneStep {
         std::vector<std::vector<int>>(num_output_candidates_);
     pending_stop_tokens_ =
         std::vector<std::queue<std::string>>(num_output_candidates_);
+    step_logprobs_ =
+        std::vector<std::vector<TokenLogProbs>>(num_output_candidates_);
   }
 
   // Runs one step of the decode process and returns if all stops for all
@@ -149,6 +177,7 @@ class DecodeOneStep {
     LITERT_ASSIGN_OR_RETURN(auto next_tokens_span,
                             ReferTensorBufferAsSpan<int>(next_tokens_buffer));
     RETURN_IF_ERROR(stop_token_detector_.ProcessTokens(next_tokens_span));
+    RETURN_IF_ERROR(CollectLogProbs(next_tokens_span));
 
     auto decoded_result =
         tokenizer_.TokenIdsToTexts(num_output_candidates_, token_ids);
@@ -178,6 +207,12 @@ class DecodeOneStep {
           result_text_[i] += decoded_result.value()[i].value();
         }
       }
+      // Stop strings are matched on the text as the user sees it, so they are
+      // found regardless of how the model tokenized them.
+      if (stop_token_detector_.HasStopStrings()) {
+        result_text_[i] = stop_token_detector_.ProcessText(
+            i, absl::StrReplaceAll(result_text_[i], {{"▁", " "}}));
+      }
     }
 
     if (sampler_.has_value()) {
@@ -191,8 +226,25 @@ class DecodeOneStep {
 
   absl::Span<float> GetScores() { return scores_span_; }
 
+  // Returns the log-probabilities of the tokens decoded in the last step for
+  // each candidate. The vector of a candidate is empty if the sampler did not
+  // compute log-probabilities or the token was a stop token.
+  std::vector<std::vector<TokenLogProbs>>& GetMutableStepLogProbs() {
+    return step_logprobs_;
+  }
+
   const std::vector<std::string>& GetResultText() const { return result_text_; }
 
+  // Returns the text still held back as a possible stop string prefix for each
+  // candidate, e.g. when decoding ends on the token limit.
+  std::vector<std::string> FlushResultText() {
+    std::vector<std::string> texts(num_output_candidates_);
+    for (int i = 0; i < num_output_candidates_; ++i) {
+      texts[i] = stop_token_detector_.FlushText(i);
+    }
+    return texts;
+  }
+
   // This function is only supported for external sampling.
   // It computes the log likelihoods for the sampled ids corresponding to the
   // ids of a batch and returns it as a vector of floats.
@@ -235,6 +287,52 @@ class DecodeOneStep {
   }
 
  private:
+  // Converts the log-probabilities computed by the external sampler for the
+  // last step into `step_logprobs_`.
+  absl::Status CollectLogProbs(absl::Span<const int> next_tokens) {
+    for (auto& logprobs : step_logprobs_) {
+      logprobs.clear();
+    }
+    if (!sampler_.has_value()) {
+      return absl::OkStatus();
+    }
+    const SampledLogProbs* sampled_logprobs =
+        sampler_.value()->GetLastLogProbs();
+    if (sampled_logprobs == nullptr) {
+      return absl::OkStatus();
+    }
+    const int n = sampled_logprobs->num_top_logprobs;
+    for (int i = 0; i < num_output_candidates_; ++i) {
+      if (stop_token_detector_.GetStopTokensFound()[i]) {
+        continue;
+      }
+      TokenLogProbs token_logprobs;
+      ASSIGN_OR_RETURN(token_logprobs.token,
+                       ToTokenLogProb(next_tokens[i],
+                                      sampled_logprobs->sampled_logprobs[i]));
+      token_logprobs.top_logprobs.reserve(n);
+      for (int j = 0; j < n; ++j) {
+        ASSIGN_OR_RETURN(
+            auto top_logprob,
+            ToTokenLogProb(sampled_logprobs->top_token_ids[i * n + j],
+                           sampled_logprobs->top_logprobs[i * n + j]));
+        token_logprobs.top_logprobs.push_back(std::move(top_logprob));
+      }
+      step_logprobs_[i].push_back(std::move(token_logprobs));
+    }
+    return absl::OkStatus();
+  }
+
+  // Decodes the text of a single token for the log-probability output.
+  absl::StatusOr<TokenLogProb> ToTokenLogProb(int token_id, float logprob) {
+    ASSIGN_OR_RETURN(std::string token, tokenizer_.TokenIdsToText({token_id}));
+    return TokenLogProb{
+        .token_id = token_id,
+        .token = absl::StrReplaceAll(token, {{"▁", " "}}),
+        .logprob = logprob,
+    };
+  }
+
   // Runs the core decoding and sampling step, for either internal or external
   // sampling. Returns a pointer to the tensor buffer containing the next token
   // IDs.
@@ -326,10 +424,105 @@ class DecodeOneStep {
   std::vector<std::vector<int>> bpe_partial_token_ids_;
   std::vector<std::queue<std::string>> pending_stop_tokens_;
   std::vector<std::string> result_text_;
+  std::vector<std::vector<TokenLogProbs>> step_logprobs_;
 
   bool is_first_step_ = true;
 };
 
+// Coalesces the responses of the decode steps into chunks following a
+// StreamingChunkPolicy, and passes the chunks to the streaming callback.
+class StreamingChunker {
+ public:
+  StreamingChunker(
+      const StreamingChunkPolicy& policy,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback)
+      : policy_(policy), callback_(callback) {}
+
+  // Adds the responses of one decode step to the pending chunk, and sends the
+  // chunk if it reached one of the limits of the policy.
+  void Add(Responses responses) {
+    if (!pending_.has_value()) {
+      pending_ = std::move(responses);
+      if (policy_.max_delay != absl::InfiniteDuration()) {
+        first_step_time_ = absl::Now();
+      }
+    } else {
+      Merge(std::move(responses));
+    }
+    ++num_steps_;
+    if (IsFull()) {
+      Flush();
+    }
+  }
+
+  // Sends the pending chunk, if any.
+  void Flush() {
+    if (!pending_.has_value()) {
+      return;
+    }
+    callback_(*std::move(pending_));
+    pending_.reset();
+    num_steps_ = 0;
+  }
+
+ private:
+  // Appends the texts and log-probabilities of `responses` to the pending
+  // chunk. The scores of a chunk are the sums of the scores of its steps.
+  void Merge(Responses responses) {
+    std::vector<std::string>& texts = pending_->GetMutableTexts();
+    const std::vector<std::string>& new_texts = responses.GetTexts();
+    texts.resize(std::max(texts.size(), new_texts.size()));
+    for (int j = 0; j < new_texts.size(); ++j) {
+      texts[j] += new_texts[j];
+    }
+    std::vector<float>& scores = pending_->GetMutableScores();
+    const std::vector<float>& new_scores = responses.GetScores();
+    scores.resize(std::max(scores.size(), new_scores.size()));
+    for (int j = 0; j < new_scores.size(); ++j) {
+      scores[j] += new_scores[j];
+    }
+    auto& new_logprobs = responses.GetMutableTokenLogProbs();
+    if (!new_logprobs.has_value()) {
+      return;
+    }
+    auto& logprobs = pending_->GetMutableTokenLogProbs();
+    if (!logprobs.has_value()) {
+      logprobs = std::move(new_logprobs);
+      return;
+    }
+    logprobs->resize(std::max(logprobs->size(), new_logprobs->size()));
+    for (int j = 0; j < new_logprobs->size(); ++j) {
+      std::move((*new_logprobs)[j].begin(), (*new_logprobs)[j].end(),
+                std::back_inserter((*logprobs)[j]));
+    }
+  }
+
+  bool IsFull() const {
+    if (policy_.max_tokens > 0 && num_steps_ >= policy_.max_tokens) {
+      return true;
+    }
+    for (const std::string& text : pending_->GetTexts()) {
+      if (policy_.max_bytes > 0 &&
+          text.size() >= static_cast<size_t>(policy_.max_bytes)) {
+        return true;
+      }
+      for (const std::string& flush_string : policy_.flush_strings) {
+        if (!flush_string.empty() && absl::StrContains(text, flush_string)) {
+          return true;
+        }
+      }
+    }
+    return policy_.max_delay != absl::InfiniteDuration() &&
+           absl::Now() - first_step_time_ >= policy_.max_delay;
+  }
+
+  const StreamingChunkPolicy& policy_;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback_;
+  std::optional<Responses> pending_;
+  int num_steps_ = 0;
+  absl::Time first_step_time_;
+};
+
 }  // namespace
 
 absl::StatusOr<Responses> Prefill(
@@ -372,9 +565,38 @@ absl::StatusOr<Responses> Decode(
     std::optional<Sampler*> sampler, Constraint* constraint,
     std::optional<litert::TensorBuffer> decoded_ids,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
-    std::atomic<bool>* cancelled, int max_output_tokens) {
+    std::atomic<bool>* cancelled, int max_output_tokens,
+    std::optional<int> num_top_logprobs,
+    const StreamingChunkPolicy& chunk_policy,
+    ThreadPool* absl_nullable constraint_thread_pool) {
   const bool is_streaming = callback != nullptr;
   const bool is_custom_sampling = sampler.has_value();
+  const bool has_logprobs = num_top_logprobs.has_value();
+  if (has_logprobs) {
+    if (!is_custom_sampling) {
+      return absl::UnimplementedError(
+          "Log-probabilities are only supported with an external sampler.");
+    }
+    RETURN_IF_ERROR(sampler.value()->SetNumTopLogProbs(num_top_logprobs));
+  }
+  // The sampler may be shared across decodes, so the log-probabilities are
+  // only computed for this one.
+  absl::Cleanup reset_logprobs = [&sampler, has_logprobs] {
+    if (has_logprobs) {
+      sampler.value()->SetNumTopLogProbs(std::nullopt).IgnoreError();
+    }
+  };
+  std::optional<StreamingChunker> chunker;
+  if (is_streaming) {
+    chunker.emplace(chunk_policy, callback);
+  }
+  // The pending chunk is sent however the decode ends: stopped, failed or
+  // cancelled, before the caller passes the final responses to the callback.
+  absl::Cleanup flush_chunk = [&chunker] {
+    if (chunker.has_value()) {
+      chunker->Flush();
+    }
+  };
 
   int benchmark_decode_token_count = 0;
   if (benchmark_info.has_value()) {
@@ -397,12 +619,16 @@ absl::StatusOr<Responses> Decode(
   std::vector<float> accumulated_scores(num_output_candidates);
   // The number of decoded tokens for each candidate (for custom sampling).
   std::vector<int> num_decoded_tokens(num_output_candidates);
+  // The log-probabilities of the decoded tokens for each candidate, which are
+  // not yet returned (when requested).
+  std::vector<std::vector<TokenLogProbs>> pending_logprobs(
+      has_logprobs ? num_output_candidates : 0);
 
   int num_decode_steps = 0;
   const int max_num_tokens = TryGetMaxNumTokens(executor);
   DecodeOneStep run_one_step(&executor, &tokenizer, num_output_candidates,
                              stop_token_detector, benchmark_info, sampler,
-                             constraint);
+                             constraint, constraint_thread_pool);
   while (true) {
     if (cancelled != nullptr && cancelled->load()) {
       if (benchmark_info.has_value()) {
@@ -439,6 +665,13 @@ absl::StatusOr<Responses> Decode(
       return all_done.status();
     }
     num_decode_steps++;
+    if (has_logprobs) {
+      auto& step_logprobs = run_one_step.GetMutableStepLogProbs();
+      for (int j = 0; j < num_output_candidates; ++j) {
+        std::move(step_logprobs[j].begin(), step_logprobs[j].end(),
+                  std::back_inserter(pending_logprobs[j]));
+      }
+    }
     std::vector<std::string> step_texts;
     std::vector<float> step_scores;
     if (is_streaming) {
@@ -473,9 +706,18 @@ absl::StatusOr<Responses> Decode(
       }
     }
 
-    if (is_streaming && any_updates && !*all_done) {
-      callback(Responses(TaskState::kProcessing, std::move(step_texts),
-                         std::move(step_scores)));
+    // The last step may still carry the text before a stop string.
+    if (is_streaming && any_updates) {
+      Responses step_responses(TaskState::kProcessing, std::move(step_texts),
+                               std::move(step_scores));
+      if (has_logprobs) {
+        // The log-probabilities are returned with the first chunk that holds
+        // their text, as the text may be held back for BPE or stop tokens.
+        step_responses.GetMutableTokenLogProbs() = std::move(pending_logprobs);
+        pending_logprobs = std::vector<std::vector<TokenLogProbs>>(
+            num_output_candidates);
+      }
+      chunker->Add(std::move(step_responses));
     }
 
     if (ShouldStop(*all_done, benchmark_decode_token_count, num_decode_steps,
@@ -490,6 +732,26 @@ absl::StatusOr<Responses> Decode(
                                                       num_output_candidates));
   }
 
+  // Release the text held back for a stop string which never completed.
+  std::vector<std::string> flushed_texts = run_one_step.FlushResultText();
+  if (is_streaming) {
+    if (std::any_of(flushed_texts.begin(), flushed_texts.end(),
+                    [](const std::string& text) { return !text.empty(); })) {
+      Responses flushed_responses(TaskState::kProcessing,
+                                  std::move(flushed_texts),
+                                  std::vector<float>(num_output_candidates));
+      if (has_logprobs) {
+        flushed_responses.GetMutableTokenLogProbs() =
+            std::move(pending_logprobs);
+      }
+      chunker->Add(std::move(flushed_responses));
+    }
+  } else {
+    for (int j = 0; j < num_output_candidates; ++j) {
+      final_texts[j] += flushed_texts[j];
+    }
+  }
+
   if (is_custom_sampling) {
     // For external sampling, the sampled tokens are provided by the sampler. We
     // must run one prefill to add the stop token as pending token in the LLM
@@ -509,10 +771,11 @@ absl::StatusOr<Responses> Decode(
   }
 
   if (is_streaming) {
-    if (executor.GetCurrentStep().value() >= max_num_tokens) {
-      return Responses(TaskState::kMaxNumTokensReached);
-    }
-    return Responses(TaskState::kDone);
+    // The log-probabilities still pending belong to stop tokens or stop
+    // strings, whose text is never returned.
+    return Responses(executor.GetCurrentStep().value() >= max_num_tokens
+                         ? TaskState::kMaxNumTokensReached
+                         : TaskState::kDone);
   }
 
   // Finalize scores for non-streaming custom sampling.
@@ -528,8 +791,15 @@ absl::StatusOr<Responses> Decode(
   TaskState task_state = executor.GetCurrentStep().value() >= max_num_tokens
                              ? TaskState::kMaxNumTokensReached
                              : TaskState::kDone;
-  return Responses(std::move(task_state), std::move(final_texts),
-                   std::move(final_scores));
+  Responses responses(std::move(task_state), std::move(final_texts),
+                      std::move(final_scores));
+  if (has_logprobs) {
+    for (int j = 0; j < num_output_candidates; ++j) {
+      TrimLogProbsToText(responses.GetTexts()[j], pending_logprobs[j]);
+    }
+    responses.GetMutableTokenLogProbs() = std::move(pending_logprobs);
+  }
+  return responses;
 }
 
 absl::StatusOr<Responses> Score(
@@ -611,4 +881,65 @@ absl::StatusOr<Responses> Score(
   return responses;
 }
 
+absl::StatusOr<Responses> ScoreChoices(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& choices, const float temperature,
+    litert::TensorBuffer decoded_ids) {
+  if (choices.empty()) {
+    return absl::InvalidArgumentError("At least one choice is required.");
+  }
+  // Scoring overwrites the decoded ids, which hold the last prefilled token of
+  // each batch row, so they are restored before each batch.
+  LITERT_ASSIGN_OR_RETURN(std::vector<int> last_prefill_token_ids,
+                          CopyFromTensorBuffer<int>(decoded_ids));
+  const int batch_size = last_prefill_token_ids.size();
+  ASSIGN_OR_RETURN(const int prefilled_step, executor.GetCurrentStep());
+
+  std::vector<float> log_likelihoods;
+  log_likelihoods.reserve(choices.size());
+  std::vector<int> token_lengths;
+  token_lengths.reserve(choices.size());
+  for (int begin = 0; begin < choices.size(); begin += batch_size) {
+    const int end = std::min<int>(begin + batch_size, choices.size());
+    // The rows past the last choice are padded with empty targets, which are
+    // not scored.
+    std::vector<absl::string_view> batch_choices(batch_size);
+    std::copy(choices.begin() + begin, choices.begin() + end,
+              batch_choices.begin());
+    RETURN_IF_ERROR(executor.SetCurrentStep(prefilled_step));
+    LITERT_RETURN_IF_ERROR(
+        decoded_ids.Write<int>(absl::MakeConstSpan(last_prefill_token_ids)));
+    LITERT_ASSIGN_OR_RETURN(auto decoded_ids_copy, decoded_ids.Duplicate());
+    ASSIGN_OR_RETURN(Responses batch_responses,
+                     Score(executor, tokenizer, batch_choices, temperature,
+                           std::move(decoded_ids_copy),
+                           /*store_token_lengths=*/true));
+    for (int j = 0; j < end - begin; ++j) {
+      // The scores are the summed log-likelihoods of the choice tokens.
+      log_likelihoods.push_back(batch_responses.GetScores()[j]);
+      token_lengths.push_back((*batch_responses.GetTokenLengths())[j]);
+    }
+  }
+  // Leave the context as it was after the prefill.
+  RETURN_IF_ERROR(executor.SetCurrentStep(prefilled_step));
+  LITERT_RETURN_IF_ERROR(
+      decoded_ids.Write<int>(absl::MakeConstSpan(last_prefill_token_ids)));
+
+  // Normalizes the log-likelihoods with a log-softmax over the choices.
+  const float max_log_likelihood =
+      *std::max_element(log_likelihoods.begin(), log_likelihoods.end());
+  double sum_of_exps = 0.0;
+  for (float log_likelihood : log_likelihoods) {
+    sum_of_exps += std::exp(log_likelihood - max_log_likelihood);
+  }
+  const float log_normalizer = max_log_likelihood + std::log(sum_of_exps);
+  std::vector<float> scores;
+  scores.reserve(log_likelihoods.size());
+  for (float log_likelihood : log_likelihoods) {
+    scores.push_back(log_likelihood - log_normalizer);
+  }
+  return Responses(TaskState::kDone, /*response_texts=*/{}, std::move(scores),
+                   std::move(token_lengths));
+}
+
 }  // namespace litert::lm::Tasks
@@ -20,6 +20,7 @@
 #include <optional>
 #include <vector>
 
+#include "absl/base/nullability.h"  // from @com_google_absl
 #include "absl/functional/any_invocable.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
@@ -31,6 +32,7 @@
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/framework/threadpool.h"
 
 namespace litert::lm::Tasks {
 
@@ -38,6 +40,10 @@ absl::StatusOr<Responses> Prefill(LlmExecutor& executor, ExecutorInputs& inputs,
                                   bool wait_for_completion,
                                   std::optional<BenchmarkInfo>& benchmark_info);
 
+// Runs the decode loop. When `constraint` is set and there are multiple output
+// candidates, the constraint masks of the candidates are computed in parallel
+// on `constraint_thread_pool`, which is owned by the caller so that it is
+// reused across decodes. Without a pool the masks are computed serially.
 absl::StatusOr<Responses> Decode(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const StopTokenDetector& stop_token_detector, int num_output_candidates,
@@ -46,13 +52,26 @@ absl::StatusOr<Responses> Decode(
     std::optional<litert::TensorBuffer> decoded_ids,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)>& callback,
     std::atomic<bool>* cancelled,
-    int max_output_tokens = std::numeric_limits<int>::max());
+    int max_output_tokens = std::numeric_limits<int>::max(),
+    std::optional<int> num_top_logprobs = std::nullopt,
+    const StreamingChunkPolicy& chunk_policy = StreamingChunkPolicy(),
+    ThreadPool* absl_nullable constraint_thread_pool = nullptr);
 
 absl::StatusOr<Responses> Score(
     LlmExecutor& executor, Tokenizer& tokenizer,
     const std::vector<absl::string_view>& target_texts, float temperature,
     litert::TensorBuffer decoded_ids, bool store_token_lengths = false);
 
+// Scores each of the `choices` as a continuation of the prefilled context, in
+// batches of the `decoded_ids` batch size. The executor is rewound to the end
+// of the prefilled context before each batch and after the last one, so the
+// context is prefilled only once. The returned scores are the log-probability
+// of each choice normalized over all the choices.
+absl::StatusOr<Responses> ScoreChoices(
+    LlmExecutor& executor, Tokenizer& tokenizer,
+    const std::vector<absl::string_view>& choices, float temperature,
+    litert::TensorBuffer decoded_ids);
+
 }  // namespace litert::lm::Tasks
 
 #endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_CORE_TASKS_H_
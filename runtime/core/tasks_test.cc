@@ -15,6 +15,7 @@
 #include "runtime/core/tasks.h"
 
 #include <atomic>
+#include <cmath>
 #include <filesystem>  // NOLINT: Required for path manipulation.
 #include <limits>
 #include <memory>
@@ -47,6 +48,8 @@
 namespace litert::lm {
 namespace {
 
+using ::testing::ElementsAre;
+using ::testing::status::IsOkAndHolds;
 using ::testing::status::StatusIs;
 
 constexpr char kTestdataDir[] =
@@ -55,11 +58,11 @@ constexpr char kTestdataDir[] =
 class BytePairEncodingTokenizer : public Tokenizer {
  public:
   MOCK_METHOD(absl::StatusOr<std::vector<int>>, TextToTokenIds,
-              (absl::string_view text), (override));
+              (absl::string_view text), (const, override));
   MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText,
-              (const std::vector<int>& token_ids), (override));
+              (const std::vector<int>& token_ids), (const, override));
   MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view token),
-              (override));
+              (const, override));
   MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
   MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
 };
@@ -271,6 +274,41 @@ TEST_F(TasksTest, DecodeReachMaxNumTokens) {
   EXPECT_EQ(task_responses->GetTexts()[0], " How's");
 }
 
+TEST_F(TasksTest, DecodeWithStopString) {
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill first.
+  std::vector<int> prefill_token_ids = {2, 90, 547, 58, 735, 210, 466, 2294};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      *executor_, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  constexpr int kNumOutputCandidates = 1;
+  StopTokenDetector stop_token_detector(kNumOutputCandidates);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({2294}));
+  // The stop string spans several tokens.
+  EXPECT_OK(stop_token_detector.AddStopString("'s it"));
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
+
+  auto task_responses = Tasks::Decode(
+      *executor_, *tokenizer_, stop_token_detector, kNumOutputCandidates,
+      benchmark_info, /*sampler=*/std::nullopt,
+      /*constraint=*/nullptr, /*decoded_ids=*/std::nullopt,
+      /*callback=*/callback, /*cancelled=*/nullptr);
+
+  EXPECT_OK(task_responses);
+  EXPECT_EQ(task_responses->GetTaskState(), TaskState::kDone);
+  // The response is cut right before the stop string, and decoding stops
+  // without generating the rest of " How's it going?".
+  EXPECT_EQ(task_responses->GetTexts().size(), 1);
+  EXPECT_EQ(task_responses->GetTexts()[0], " How");
+  EXPECT_LT(executor_->GetCurrentStep().value(), 15);
+}
+
 TEST_F(TasksTest, DecodeWithMultipleOutputCandidates) {
   constexpr int kNumOutputCandidates = 3;
   // Rebuild the executor with multiple output candidates with the same prefill
@@ -413,6 +451,48 @@ TEST_F(TasksTest, DecodeStreaming) {
   EXPECT_OK(status);
 }
 
+TEST_F(TasksTest, DecodeStreamingCoalescesChunks) {
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill first.
+  std::vector<int> prefill_token_ids = {2, 90, 547, 58, 735, 210, 466, 2294};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      *executor_, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  constexpr int kNumOutputCandidates = 1;
+  StopTokenDetector stop_token_detector(kNumOutputCandidates);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({2294}));
+
+  std::vector<std::string> chunks;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&chunks](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        chunks.push_back(responses->GetTexts()[0]);
+      };
+  // No token limit: the chunks are only cut after the flush string, and at
+  // the end of the decode.
+  StreamingChunkPolicy chunk_policy;
+  chunk_policy.max_tokens = 0;
+  chunk_policy.flush_strings = {"'s"};
+
+  auto task_status = Tasks::Decode(
+      *executor_, *tokenizer_, stop_token_detector, kNumOutputCandidates,
+      benchmark_info,
+      /*sampler=*/std::nullopt, /*constraint=*/nullptr,
+      /*decoded_ids=*/std::nullopt, callback, /*cancelled=*/nullptr,
+      /*max_output_tokens=*/std::numeric_limits<int>::max(),
+      /*num_top_logprobs=*/std::nullopt, chunk_policy);
+
+  EXPECT_OK(task_status);
+  EXPECT_EQ(task_status->GetTaskState(), TaskState::kDone);
+  EXPECT_THAT(chunks, ElementsAre(" How's", " it going?"));
+}
+
 TEST_F(TasksTest, DecodeStreamingReachMaxNumTokens) {
   // Set the max number of tokens to 11.
   executor_->GetMutableExecutorSettings().value()->SetMaxNumTokens(11);
@@ -452,6 +532,83 @@ TEST_F(TasksTest, DecodeStreamingReachMaxNumTokens) {
   EXPECT_TRUE(done);
 }
 
+TEST_F(TasksTest, DecodeStreamingWithStopString) {
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill first.
+  std::vector<int> prefill_token_ids = {2, 90, 547, 58, 735, 210, 466, 2294};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      *executor_, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  constexpr int kNumOutputCandidates = 1;
+  StopTokenDetector stop_token_detector(kNumOutputCandidates);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({2294}));
+  EXPECT_OK(stop_token_detector.AddStopString(" going"));
+
+  std::vector<std::string> responses(kNumOutputCandidates);
+  absl::Status status;
+  bool done = false;
+  auto callback = CreateTestCallback(responses, status, done);
+
+  auto task_status = Tasks::Decode(
+      *executor_, *tokenizer_, stop_token_detector, kNumOutputCandidates,
+      benchmark_info,
+      /*sampler=*/std::nullopt, /*constraint=*/nullptr,
+      /*decoded_ids=*/std::nullopt, callback, /*cancelled=*/nullptr);
+  callback(task_status);
+
+  EXPECT_OK(task_status);
+  EXPECT_EQ(task_status->GetTaskState(), TaskState::kDone);
+  EXPECT_EQ(responses[0], " How's it");
+  EXPECT_TRUE(done);
+  EXPECT_OK(status);
+}
+
+TEST_F(TasksTest, DecodeStreamingReachMaxNumTokensReleasesPartialStopString) {
+  // Set the max number of tokens to 11.
+  executor_->GetMutableExecutorSettings().value()->SetMaxNumTokens(11);
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill first.
+  std::vector<int> prefill_token_ids = {2, 90, 547, 58, 735, 210, 466, 2294};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      *executor_, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  constexpr int kNumOutputCandidates = 1;
+  StopTokenDetector stop_token_detector(kNumOutputCandidates);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({2294}));
+  // "s" is held back as it may start the stop string.
+  EXPECT_OK(stop_token_detector.AddStopString("s it!"));
+
+  std::vector<std::string> responses(kNumOutputCandidates);
+  absl::Status status;
+  bool done = false;
+  auto callback = CreateTestCallback(responses, status, done);
+
+  auto task_status = Tasks::Decode(
+      *executor_, *tokenizer_, stop_token_detector, kNumOutputCandidates,
+      benchmark_info,
+      /*sampler=*/std::nullopt, /*constraint=*/nullptr,
+      /*decoded_ids=*/std::nullopt, callback, /*cancelled=*/nullptr);
+  callback(task_status);
+
+  EXPECT_OK(task_status);
+  EXPECT_EQ(task_status->GetTaskState(), TaskState::kMaxNumTokensReached);
+  // The held back text is released once decoding ends.
+  EXPECT_EQ(responses[0], " How's");
+  EXPECT_TRUE(done);
+}
+
 TEST_F(TasksTest, DecodeStreamingWithConstrainedDecoding) {
   // Fake constraint that expects " How's it".
   std::vector<int> expected_token_ids = {224, 24, 8, 66, 0};
@@ -936,6 +1093,164 @@ TEST_F(TasksCustomSamplingTest, DecodeCustomSampling) {
   EXPECT_EQ(task_responses->GetScores()[1], 0.0f);
 }
 
+TEST_F(TasksCustomSamplingTest, DecodeCustomSamplingWithLogProbs) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/2, /*seed=*/1);
+  EXPECT_TRUE(sampler_or.ok());
+  std::unique_ptr<TopPSampler> sampler = std::move(sampler_or.value());
+
+  auto decoded_ids = CreateTensorBuffer<int>({2, 1});
+  EXPECT_TRUE(decoded_ids.HasValue());
+  std::optional<BenchmarkInfo> benchmark_info;
+  StopTokenDetector stop_token_detector(2);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({0}));
+
+  auto executor = CreateFakeLlmExecutor(
+      /*prefill_tokens=*/{{2}, {0, 0}},
+      // " How's it going?!" and " Hello World!" followed by the stop token id
+      // (0).
+      /*decode_tokens=*/{{224, 90},
+                         {24, 547},
+                         {8, 58},
+                         {66, 735},
+                         {246, 210},
+                         {18, 466},
+                         {2295, 2294},
+                         {2294, 0},
+                         {0, 0}});
+
+  // Run Prefill with <bos> token.
+  std::vector<int> prefill_token_ids = {2};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      executor, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
+
+  auto task_responses = Tasks::Decode(
+      executor, *tokenizer_, stop_token_detector,
+      /*num_output_candidates=*/2, benchmark_info, sampler.get(),
+      /*constraint=*/nullptr, std::move(decoded_ids.Value()),
+      /*callback=*/callback,
+      /*cancelled=*/nullptr,
+      /*max_output_tokens=*/std::numeric_limits<int>::max(),
+      /*num_top_logprobs=*/2);
+  ASSERT_OK(task_responses);
+  EXPECT_EQ(task_responses->GetTexts()[0], " How's it going?!");
+  EXPECT_EQ(task_responses->GetTexts()[1], " Hello World!");
+
+  ASSERT_TRUE(task_responses->GetTokenLogProbs().has_value());
+  const auto& token_logprobs = *task_responses->GetTokenLogProbs();
+  ASSERT_EQ(token_logprobs.size(), 2);
+  // The stop tokens are not reported.
+  ASSERT_EQ(token_logprobs[0].size(), 8);
+  ASSERT_EQ(token_logprobs[1].size(), 7);
+  EXPECT_EQ(token_logprobs[0][0].token.token_id, 224);
+  EXPECT_EQ(token_logprobs[1][0].token.token_id, 90);
+  EXPECT_EQ(token_logprobs[1][6].token.token_id, 2294);
+  for (const auto& candidate_logprobs : token_logprobs) {
+    for (const auto& step_logprobs : candidate_logprobs) {
+      // The fake executor puts all the probability mass on the decoded token.
+      EXPECT_FLOAT_EQ(step_logprobs.token.logprob, 0.0f);
+      ASSERT_EQ(step_logprobs.top_logprobs.size(), 2);
+      EXPECT_EQ(step_logprobs.top_logprobs[0].token_id,
+                step_logprobs.token.token_id);
+      EXPECT_EQ(step_logprobs.top_logprobs[0].token, step_logprobs.token.token);
+    }
+  }
+  // The sampler stops computing log-probabilities after the decode.
+  EXPECT_EQ(sampler->GetLastLogProbs(), nullptr);
+}
+
+TEST_F(TasksCustomSamplingTest, DecodeLogProbsDropStopStringTokens) {
+  auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
+                                        /*batch_size=*/2, /*seed=*/1);
+  EXPECT_TRUE(sampler_or.ok());
+  std::unique_ptr<TopPSampler> sampler = std::move(sampler_or.value());
+
+  auto decoded_ids = CreateTensorBuffer<int>({2, 1});
+  EXPECT_TRUE(decoded_ids.HasValue());
+  std::optional<BenchmarkInfo> benchmark_info;
+  StopTokenDetector stop_token_detector(2);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({0}));
+  // Spans the last two tokens of the first candidate.
+  EXPECT_OK(stop_token_detector.AddStopString("?!"));
+
+  auto executor = CreateFakeLlmExecutor(
+      /*prefill_tokens=*/{{2}, {0, 0}},
+      // " How's it going?!" and " Hello World!" followed by the stop token id
+      // (0).
+      /*decode_tokens=*/{{224, 90},
+                         {24, 547},
+                         {8, 58},
+                         {66, 735},
+                         {246, 210},
+                         {18, 466},
+                         {2295, 2294},
+                         {2294, 0},
+                         {0, 0}});
+
+  std::vector<int> prefill_token_ids = {2};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  auto prefill_responses = Tasks::Prefill(
+      executor, inputs, /*wait_for_completion=*/true, benchmark_info);
+  EXPECT_OK(prefill_responses);
+
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
+
+  auto task_responses = Tasks::Decode(
+      executor, *tokenizer_, stop_token_detector,
+      /*num_output_candidates=*/2, benchmark_info, sampler.get(),
+      /*constraint=*/nullptr, std::move(decoded_ids.Value()),
+      /*callback=*/callback,
+      /*cancelled=*/nullptr,
+      /*max_output_tokens=*/std::numeric_limits<int>::max(),
+      /*num_top_logprobs=*/1);
+  ASSERT_OK(task_responses);
+  EXPECT_EQ(task_responses->GetTexts()[0], " How's it going");
+  EXPECT_EQ(task_responses->GetTexts()[1], " Hello World!");
+
+  ASSERT_TRUE(task_responses->GetTokenLogProbs().has_value());
+  const auto& token_logprobs = *task_responses->GetTokenLogProbs();
+  ASSERT_EQ(token_logprobs.size(), 2);
+  // The "?" and "!" tokens of the stop string are dropped with their text.
+  ASSERT_EQ(token_logprobs[0].size(), 6);
+  ASSERT_EQ(token_logprobs[1].size(), 7);
+  for (int j = 0; j < 2; ++j) {
+    std::string text;
+    for (const auto& step_logprobs : token_logprobs[j]) {
+      text += step_logprobs.token.token;
+    }
+    EXPECT_EQ(text, task_responses->GetTexts()[j]);
+  }
+}
+
+TEST_F(TasksCustomSamplingTest, DecodeLogProbsRequireExternalSampler) {
+  auto executor = CreateFakeLlmExecutor(
+      /*prefill_tokens=*/{{2}}, /*decode_tokens=*/{{224}, {0}},
+      /*vocab_size=*/2560, /*batch_size=*/1);
+  std::optional<BenchmarkInfo> benchmark_info;
+  StopTokenDetector stop_token_detector(1);
+  EXPECT_OK(stop_token_detector.AddStopTokenSequence({0}));
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback = nullptr;
+
+  auto task_responses = Tasks::Decode(
+      executor, *tokenizer_, stop_token_detector,
+      /*num_output_candidates=*/1, benchmark_info, /*sampler=*/std::nullopt,
+      /*constraint=*/nullptr, /*decoded_ids=*/std::nullopt,
+      /*callback=*/callback, /*cancelled=*/nullptr,
+      /*max_output_tokens=*/std::numeric_limits<int>::max(),
+      /*num_top_logprobs=*/1);
+  EXPECT_THAT(task_responses, StatusIs(absl::StatusCode::kUnimplemented));
+}
+
 TEST_F(TasksCustomSamplingTest, DecodeCustomSamplingWithConstrainedDecoding) {
   auto sampler_or = TopPSampler::Create(/*k=*/1, /*p=*/0.5, /*temperature=*/1.0,
                                         /*batch_size=*/2, /*seed=*/1);
@@ -1194,6 +1509,99 @@ TEST_F(TasksCustomSamplingTest, ScoreCustomSamplingMultiBatchWithTokenLengths) {
               testing::Each(0.0f));
 }
 
+TEST_F(TasksCustomSamplingTest, ScoreChoices) {
+  auto executor = CreateFakeLlmExecutor(
+      /*prefill_tokens=*/{{2}},
+      /*decode_tokens=*/
+      {{224, 90},
+       {24, 547},
+       {8, 58},
+       {66, 735},
+       {246, 210},
+       {18, 466},
+       {2295, 2294},
+       {0, 0}});
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  // Run prefill with <bos> token.
+  std::vector<int> prefill_token_ids = {2};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  ASSERT_OK(Tasks::Prefill(executor, inputs, /*wait_for_completion=*/true,
+                           benchmark_info));
+  ASSERT_OK_AND_ASSIGN(const int prefilled_step, executor.GetCurrentStep());
+
+  std::vector<int> last_prefill_token_ids = {2, 2};
+  auto decoded_ids = CopyToTensorBuffer<int>(last_prefill_token_ids, {2, 1});
+  ASSERT_TRUE(decoded_ids.HasValue());
+  ASSERT_OK_AND_ASSIGN(
+      auto responses,
+      Tasks::ScoreChoices(executor, *tokenizer_,
+                          /*choices=*/{"How's it going?", "Hello World!"},
+                          /*temperature=*/1.0f,
+                          std::move(decoded_ids.Value())));
+  EXPECT_EQ(responses.GetTaskState(), TaskState::kDone);
+  // Both choices are fully likely under the fake executor, so they share the
+  // probability mass evenly.
+  EXPECT_THAT(responses.GetScores(),
+              ElementsAre(testing::FloatNear(std::log(0.5f), 1e-6f),
+                          testing::FloatNear(std::log(0.5f), 1e-6f)));
+  ASSERT_TRUE(responses.GetTokenLengths().has_value());
+  EXPECT_THAT(*responses.GetTokenLengths(), ElementsAre(7, 7));
+  // The executor is rewound to the end of the prefilled context.
+  EXPECT_THAT(executor.GetCurrentStep(), IsOkAndHolds(prefilled_step));
+}
+
+TEST_F(TasksCustomSamplingTest, ScoreChoicesRanksMoreLikelyChoiceFirst) {
+  // Both batch rows decode "How's it going?", so "Hello World!" is unlikely.
+  auto executor = CreateFakeLlmExecutor(
+      /*prefill_tokens=*/{{2}},
+      /*decode_tokens=*/
+      {{224, 224},
+       {24, 24},
+       {8, 8},
+       {66, 66},
+       {246, 246},
+       {18, 18},
+       {2295, 2295},
+       {0, 0}});
+  std::optional<BenchmarkInfo> benchmark_info;
+
+  std::vector<int> prefill_token_ids = {2};
+  ASSERT_OK_AND_ASSIGN(auto token_ids_buffer,
+                       tokenizer_->TokenIdsToTensorBuffer(prefill_token_ids));
+  ExecutorTextData text_data(std::move(token_ids_buffer));
+  ExecutorInputs inputs(std::move(text_data), std::nullopt, std::nullopt);
+  ASSERT_OK(Tasks::Prefill(executor, inputs, /*wait_for_completion=*/true,
+                           benchmark_info));
+
+  std::vector<int> last_prefill_token_ids = {2, 2};
+  auto decoded_ids = CopyToTensorBuffer<int>(last_prefill_token_ids, {2, 1});
+  ASSERT_TRUE(decoded_ids.HasValue());
+  ASSERT_OK_AND_ASSIGN(
+      auto responses,
+      Tasks::ScoreChoices(executor, *tokenizer_,
+                          /*choices=*/{"Hello World!", "How's it going?"},
+                          /*temperature=*/1.0f,
+                          std::move(decoded_ids.Value())));
+  ASSERT_EQ(responses.GetScores().size(), 2);
+  // The likely choice takes all of the probability mass.
+  EXPECT_THAT(responses.GetScores()[1], testing::FloatNear(0.0f, 1e-6f));
+  EXPECT_LT(responses.GetScores()[0], responses.GetScores()[1]);
+}
+
+TEST_F(TasksCustomSamplingTest, ScoreChoicesWithoutChoices) {
+  auto executor = CreateFakeLlmExecutor();
+  auto decoded_ids = CreateTensorBuffer<int>(/*dimensions=*/{2, 1});
+  ASSERT_TRUE(decoded_ids.HasValue());
+  EXPECT_THAT(Tasks::ScoreChoices(executor, *tokenizer_, /*choices=*/{},
+                                  /*temperature=*/1.0f,
+                                  std::move(decoded_ids.Value())),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(TasksCustomSamplingTest, DecodeCustomSamplingReachMaxNumTokens) {
   auto executor = CreateFakeLlmExecutor(
       /*prefill_tokens=*/{{2}, {8, 58}},
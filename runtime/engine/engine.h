@@ -25,6 +25,7 @@
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "absl/time/time.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 
@@ -166,6 +167,32 @@ class Engine {
       return absl::UnimplementedError("Not implemented.");
     }
 
+    // Scores each of the choices as a continuation of the prefilled context,
+    // e.g. to pick one of K labels in a classification task. The context is
+    // prefilled only once: the choices are scored in batches of
+    // num_output_candidates rows, each starting from the end of the prefilled
+    // context, which is left unchanged afterwards.
+    // This function should be called after the prefill process is done.
+    // - choices: The texts to score, e.g. the label strings.
+    // - returns: The log probability of each choice normalized over all the
+    //   choices as the scores, and the token length of each choice.
+    virtual absl::StatusOr<Responses> RunTextClassification(
+        const std::vector<absl::string_view>& choices) {
+      return absl::UnimplementedError("Not implemented.");
+    }
+
+    // Similar to the above RunTextClassification function, but this is a not
+    // blocking call and the function will return right away. The processing
+    // status will be signaled through the callback.
+    // - choices: The texts to score, e.g. the label strings.
+    // - callback: Callback to receive the classification results.
+    virtual absl::StatusOr<std::unique_ptr<TaskController>>
+    RunTextClassificationAsync(
+        const std::vector<absl::string_view>& choices,
+        absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) {
+      return absl::UnimplementedError("Not implemented.");
+    }
+
     // Adds the input prompt/query to the model for starting the prefilling
     // process. Note that the user can break down their prompt/query into
     // multiple chunks and call this function multiple times.
@@ -296,6 +323,13 @@ class Engine {
   virtual absl::StatusOr<VisionExecutorProperties> GetVisionExecutorProperties()
       const = 0;
 
+  // Returns a point-in-time snapshot of the engine's live metrics (queue
+  // depth, token counts, latency histograms, ...). The metrics are always
+  // collected; this call only copies their current values.
+  virtual absl::StatusOr<MetricsSnapshot> GetMetricsSnapshot() const {
+    return absl::UnimplementedError("Not implemented.");
+  }
+
   // Default timeout duration for the engine/session processes.
   static constexpr absl::Duration kDefaultTimeout = absl::Minutes(10);
 };
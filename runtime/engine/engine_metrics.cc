@@ -0,0 +1,366 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/engine/engine_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"  // from @com_google_absl
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/str_replace.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "runtime/util/status_macros.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+// Latency buckets, in seconds, covering sub-millisecond host work up to
+// multi-second prefills.
+const std::vector<double>& LatencyBuckets() {
+  static const auto* kBuckets = new std::vector<double>{
+      0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05,
+      0.1,    0.25,  0.5,    1.0,   2.5,  5.0,   10.0};
+  return *kBuckets;
+}
+
+bool IsValidMetricName(absl::string_view name) {
+  if (name.empty()) return false;
+  for (size_t i = 0; i < name.size(); ++i) {
+    const char c = name[i];
+    const bool is_alpha =
+        (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+        c == ':';
+    const bool is_digit = c >= '0' && c <= '9';
+    if (!is_alpha && !(is_digit && i > 0)) return false;
+  }
+  return true;
+}
+
+std::string FormatDouble(double value) {
+  if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+  if (std::isnan(value)) return "NaN";
+  return absl::StrCat(value);
+}
+
+absl::string_view MetricTypeName(MetricType type) {
+  switch (type) {
+    case MetricType::kCounter:
+      return "counter";
+    case MetricType::kGauge:
+      return "gauge";
+    case MetricType::kHistogram:
+      return "histogram";
+  }
+  return "untyped";
+}
+
+std::string EscapeHelp(absl::string_view help) {
+  return absl::StrReplaceAll(help, {{"\\", "\\\\"}, {"\n", "\\n"}});
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<double> upper_bounds)
+    : upper_bounds_(std::move(upper_bounds)),
+      bucket_counts_(
+          std::make_unique<std::atomic<int64_t>[]>(upper_bounds_.size() + 1)) {
+  for (size_t i = 0; i <= upper_bounds_.size(); ++i) {
+    bucket_counts_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Histogram::Observe(double value) {
+  // Buckets are inclusive of their upper bound, as in Prometheus.
+  const size_t bucket =
+      std::lower_bound(upper_bounds_.begin(), upper_bounds_.end(), value) -
+      upper_bounds_.begin();
+  bucket_counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  double sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+HistogramSnapshot Histogram::Snapshot() const {
+  HistogramSnapshot snapshot;
+  snapshot.upper_bounds = upper_bounds_;
+  snapshot.bucket_counts.reserve(upper_bounds_.size() + 1);
+  for (size_t i = 0; i <= upper_bounds_.size(); ++i) {
+    const int64_t bucket_count =
+        bucket_counts_[i].load(std::memory_order_relaxed);
+    snapshot.bucket_counts.push_back(bucket_count);
+    // Derive the count from the buckets so that the snapshot is internally
+    // consistent even if observations race with it.
+    snapshot.count += bucket_count;
+  }
+  snapshot.sum = sum_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+std::ostream& operator<<(std::ostream& os, MetricType type) {
+  return os << MetricTypeName(type);
+}
+
+const MetricSnapshot* MetricsSnapshot::Find(absl::string_view name) const {
+  auto it = std::lower_bound(
+      metrics_.begin(), metrics_.end(), name,
+      [](const MetricSnapshot& metric, absl::string_view name) {
+        return metric.name < name;
+      });
+  if (it == metrics_.end() || it->name != name) return nullptr;
+  return &*it;
+}
+
+MetricsSnapshot MetricsSnapshot::Merge(
+    absl::Span<const MetricsSnapshot> snapshots) {
+  std::vector<MetricSnapshot> merged;
+  for (const MetricsSnapshot& snapshot : snapshots) {
+    for (const MetricSnapshot& metric : snapshot.metrics()) {
+      auto it = std::lower_bound(merged.begin(), merged.end(), metric.name,
+                                 [](const MetricSnapshot& merged_metric,
+                                    absl::string_view name) {
+                                   return merged_metric.name < name;
+                                 });
+      if (it == merged.end() || it->name != metric.name) {
+        merged.insert(it, metric);
+        continue;
+      }
+      if (it->type != metric.type) continue;
+      if (metric.type != MetricType::kHistogram) {
+        it->value += metric.value;
+        continue;
+      }
+      HistogramSnapshot& histogram = it->histogram;
+      if (histogram.upper_bounds != metric.histogram.upper_bounds) continue;
+      for (size_t i = 0; i < histogram.bucket_counts.size(); ++i) {
+        histogram.bucket_counts[i] += metric.histogram.bucket_counts[i];
+      }
+      histogram.count += metric.histogram.count;
+      histogram.sum += metric.histogram.sum;
+      it->value = histogram.count;
+    }
+  }
+  return MetricsSnapshot(std::move(merged));
+}
+
+std::string MetricsSnapshot::ToPrometheusText() const {
+  std::string text;
+  for (const MetricSnapshot& metric : metrics_) {
+    if (!metric.help.empty()) {
+      absl::StrAppend(&text, "# HELP ", metric.name, " ",
+                      EscapeHelp(metric.help), "\n");
+    }
+    absl::StrAppend(&text, "# TYPE ", metric.name, " ",
+                    MetricTypeName(metric.type), "\n");
+    if (metric.type != MetricType::kHistogram) {
+      absl::StrAppend(&text, metric.name, " ", metric.value, "\n");
+      continue;
+    }
+    const HistogramSnapshot& histogram = metric.histogram;
+    int64_t cumulative = 0;
+    for (size_t i = 0; i < histogram.bucket_counts.size(); ++i) {
+      cumulative += histogram.bucket_counts[i];
+      const double upper_bound = i < histogram.upper_bounds.size()
+                                     ? histogram.upper_bounds[i]
+                                     : std::numeric_limits<double>::infinity();
+      absl::StrAppend(&text, metric.name, "_bucket{le=\"",
+                      FormatDouble(upper_bound), "\"} ", cumulative, "\n");
+    }
+    absl::StrAppend(&text, metric.name, "_sum ", FormatDouble(histogram.sum),
+                    "\n");
+    absl::StrAppend(&text, metric.name, "_count ", histogram.count, "\n");
+  }
+  return text;
+}
+
+absl::StatusOr<MetricsRegistry::Entry*> MetricsRegistry::FindOrAdd(
+    absl::string_view name, absl::string_view help, MetricType type) {
+  if (!IsValidMetricName(name)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid metric name: \"", name, "\""));
+  }
+  auto it = entries_.find(name);
+  if (it != entries_.end()) {
+    if (it->second->type != type) {
+      return absl::AlreadyExistsError(
+          absl::StrCat("Metric \"", name, "\" is already registered as a ",
+                       MetricTypeName(it->second->type), "."));
+    }
+    return it->second.get();
+  }
+  auto entry = std::make_unique<Entry>();
+  entry->help = std::string(help);
+  entry->type = type;
+  Entry* entry_ptr = entry.get();
+  entries_.emplace(std::string(name), std::move(entry));
+  return entry_ptr;
+}
+
+absl::StatusOr<Counter*> MetricsRegistry::RegisterCounter(
+    absl::string_view name, absl::string_view help) {
+  absl::MutexLock lock(&mutex_);
+  ASSIGN_OR_RETURN(Entry * entry, FindOrAdd(name, help, MetricType::kCounter));
+  if (entry->counter == nullptr) entry->counter = std::make_unique<Counter>();
+  return entry->counter.get();
+}
+
+absl::StatusOr<Gauge*> MetricsRegistry::RegisterGauge(absl::string_view name,
+                                                      absl::string_view help) {
+  absl::MutexLock lock(&mutex_);
+  ASSIGN_OR_RETURN(Entry * entry, FindOrAdd(name, help, MetricType::kGauge));
+  if (entry->gauge == nullptr) entry->gauge = std::make_unique<Gauge>();
+  return entry->gauge.get();
+}
+
+absl::StatusOr<Histogram*> MetricsRegistry::RegisterHistogram(
+    absl::string_view name, absl::string_view help,
+    std::vector<double> upper_bounds) {
+  for (size_t i = 0; i < upper_bounds.size(); ++i) {
+    if (std::isnan(upper_bounds[i]) ||
+        (i > 0 && upper_bounds[i] <= upper_bounds[i - 1])) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Histogram bucket bounds for \"", name,
+          "\" must be strictly increasing."));
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  ASSIGN_OR_RETURN(Entry * entry,
+                   FindOrAdd(name, help, MetricType::kHistogram));
+  if (entry->histogram == nullptr) {
+    entry->histogram = std::make_unique<Histogram>(std::move(upper_bounds));
+  }
+  return entry->histogram.get();
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const {
+  std::vector<MetricSnapshot> metrics;
+  {
+    absl::MutexLock lock(&mutex_);
+    metrics.reserve(entries_.size());
+    for (const auto& [name, entry] : entries_) {
+      MetricSnapshot metric;
+      metric.name = name;
+      metric.help = entry->help;
+      metric.type = entry->type;
+      switch (entry->type) {
+        case MetricType::kCounter:
+          metric.value = entry->counter->Value();
+          break;
+        case MetricType::kGauge:
+          metric.value = entry->gauge->Value();
+          break;
+        case MetricType::kHistogram:
+          metric.histogram = entry->histogram->Snapshot();
+          metric.value = metric.histogram.count;
+          break;
+      }
+      metrics.push_back(std::move(metric));
+    }
+  }
+  std::sort(metrics.begin(), metrics.end(),
+            [](const MetricSnapshot& a, const MetricSnapshot& b) {
+              return a.name < b.name;
+            });
+  return MetricsSnapshot(std::move(metrics));
+}
+
+absl::StatusOr<std::unique_ptr<EngineMetrics>> EngineMetrics::Create() {
+  auto metrics = absl::WrapUnique(new EngineMetrics());
+  MetricsRegistry& r = metrics->registry_;
+  ASSIGN_OR_RETURN(metrics->sessions_created,
+                   r.RegisterCounter("litert_lm_sessions_created_total",
+                                     "Number of sessions created."));
+  ASSIGN_OR_RETURN(
+      metrics->resident_contexts,
+      r.RegisterGauge("litert_lm_resident_contexts",
+                      "Number of session contexts kept by the engine."));
+  ASSIGN_OR_RETURN(
+      metrics->queue_depth,
+      r.RegisterGauge("litert_lm_queue_depth",
+                      "Number of tasks queued and waiting to start."));
+  ASSIGN_OR_RETURN(metrics->tasks_completed,
+                   r.RegisterCounter("litert_lm_tasks_completed_total",
+                                     "Number of tasks that finished."));
+  ASSIGN_OR_RETURN(metrics->tasks_failed,
+                   r.RegisterCounter("litert_lm_tasks_failed_total",
+                                     "Number of tasks that failed."));
+  ASSIGN_OR_RETURN(metrics->tasks_cancelled,
+                   r.RegisterCounter("litert_lm_tasks_cancelled_total",
+                                     "Number of tasks that were cancelled."));
+  ASSIGN_OR_RETURN(metrics->prefill_tokens,
+                   r.RegisterCounter("litert_lm_prefill_tokens_total",
+                                     "Number of prompt tokens prefilled."));
+  ASSIGN_OR_RETURN(metrics->decode_tokens,
+                   r.RegisterCounter("litert_lm_decode_tokens_total",
+                                     "Number of decode steps run."));
+  ASSIGN_OR_RETURN(
+      metrics->prefill_latency,
+      r.RegisterHistogram("litert_lm_prefill_seconds",
+                          "Wall time of prefill tasks.", LatencyBuckets()));
+  ASSIGN_OR_RETURN(
+      metrics->decode_latency,
+      r.RegisterHistogram("litert_lm_decode_seconds",
+                          "Wall time of decode tasks.", LatencyBuckets()));
+  ASSIGN_OR_RETURN(
+      metrics->kv_cache_tokens,
+      r.RegisterGauge("litert_lm_kv_cache_tokens",
+                      "Number of tokens in the KV cache of the last used "
+                      "context."));
+  ASSIGN_OR_RETURN(
+      metrics->preprocess_latency,
+      r.RegisterHistogram("litert_lm_preprocess_seconds",
+                          "Time spent tokenizing and preprocessing inputs.",
+                          LatencyBuckets()));
+  ASSIGN_OR_RETURN(
+      metrics->constraint_latency,
+      r.RegisterHistogram("litert_lm_constraint_seconds",
+                          "Time spent computing constrained decoding masks.",
+                          LatencyBuckets()));
+  ASSIGN_OR_RETURN(
+      metrics->context_reuse_hits,
+      r.RegisterCounter("litert_lm_context_reuse_hits_total",
+                        "Executor acquisitions that found the requested "
+                        "context already loaded."));
+  ASSIGN_OR_RETURN(
+      metrics->context_shared_switches,
+      r.RegisterCounter("litert_lm_context_shared_switches_total",
+                        "Context switches that only swapped runtime state "
+                        "of a shared processed context."));
+  ASSIGN_OR_RETURN(
+      metrics->context_restores,
+      r.RegisterCounter("litert_lm_context_restores_total",
+                        "Context switches that restored a full context."));
+  ASSIGN_OR_RETURN(
+      metrics->context_prefetch_hits,
+      r.RegisterCounter("litert_lm_context_prefetch_hits_total",
+                        "Context restores that used a context staged ahead "
+                        "of the switch."));
+  return metrics;
+}
+
+}  // namespace litert::lm
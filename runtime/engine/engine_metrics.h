@@ -0,0 +1,221 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_ENGINE_METRICS_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_ENGINE_METRICS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"  // from @com_google_absl
+#include "absl/container/flat_hash_map.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/synchronization/mutex.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+
+namespace litert::lm {
+
+// A monotonically increasing counter. All operations are lock-free.
+class Counter {
+ public:
+  void Increment(int64_t delta = 1) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// A value that can go up and down, e.g. a queue depth. All operations are
+// lock-free.
+class Gauge {
+ public:
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t delta) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+  int64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_{0};
+};
+
+// A point-in-time copy of a histogram.
+struct HistogramSnapshot {
+  // Inclusive upper bounds of the finite buckets, in increasing order.
+  std::vector<double> upper_bounds;
+  // Per-bucket (non-cumulative) counts. Has one more entry than
+  // `upper_bounds`; the last entry is the +Inf bucket.
+  std::vector<int64_t> bucket_counts;
+  int64_t count = 0;
+  double sum = 0.0;
+};
+
+// A histogram with a fixed set of buckets chosen at registration time.
+// Observe() is lock-free: it finds the bucket with a binary search and bumps
+// a few atomics.
+class Histogram {
+ public:
+  // `upper_bounds` must be strictly increasing.
+  explicit Histogram(std::vector<double> upper_bounds);
+
+  void Observe(double value);
+  void ObserveDuration(absl::Duration duration) {
+    Observe(absl::ToDoubleSeconds(duration));
+  }
+
+  HistogramSnapshot Snapshot() const;
+
+ private:
+  const std::vector<double> upper_bounds_;
+  // One bucket per upper bound plus the +Inf bucket.
+  std::unique_ptr<std::atomic<int64_t>[]> bucket_counts_;
+  std::atomic<double> sum_{0.0};
+};
+
+enum class MetricType { kCounter, kGauge, kHistogram };
+
+std::ostream& operator<<(std::ostream& os, MetricType type);
+
+// A point-in-time copy of a single metric.
+struct MetricSnapshot {
+  std::string name;
+  std::string help;
+  MetricType type = MetricType::kCounter;
+  // The value of a counter or a gauge. For histograms this is the number of
+  // observations.
+  int64_t value = 0;
+  // Only populated for histograms.
+  HistogramSnapshot histogram;
+};
+
+// A point-in-time copy of every metric in a registry, sorted by name.
+class MetricsSnapshot {
+ public:
+  MetricsSnapshot() = default;
+  explicit MetricsSnapshot(std::vector<MetricSnapshot> metrics)
+      : metrics_(std::move(metrics)) {}
+
+  const std::vector<MetricSnapshot>& metrics() const { return metrics_; }
+
+  // Returns the metric with the given name, or nullptr if it does not exist.
+  const MetricSnapshot* Find(absl::string_view name) const;
+
+  // Renders the snapshot in the Prometheus text exposition format (version
+  // 0.0.4), so that it can be served as is from a /metrics endpoint.
+  std::string ToPrometheusText() const;
+
+  // Combines the snapshots of several registries, e.g. one per executor
+  // replica, by summing the metrics of the same name. Histograms are only
+  // summed with histograms of the same buckets; otherwise the first one wins.
+  static MetricsSnapshot Merge(absl::Span<const MetricsSnapshot> snapshots);
+
+ private:
+  std::vector<MetricSnapshot> metrics_;
+};
+
+// Owns a set of named metrics. Registration takes a lock, but the returned
+// metric objects are updated without any locking and stay valid for the
+// lifetime of the registry, so hot paths should register once and keep the
+// pointer.
+class MetricsRegistry {
+ public:
+  // Registers a metric, or returns the existing one if a metric of the same
+  // type was already registered under `name`. Returns an error if `name` is
+  // not a valid Prometheus metric name or is registered with another type.
+  absl::StatusOr<Counter*> RegisterCounter(absl::string_view name,
+                                           absl::string_view help);
+  absl::StatusOr<Gauge*> RegisterGauge(absl::string_view name,
+                                       absl::string_view help);
+  absl::StatusOr<Histogram*> RegisterHistogram(
+      absl::string_view name, absl::string_view help,
+      std::vector<double> upper_bounds);
+
+  MetricsSnapshot Snapshot() const;
+
+ private:
+  struct Entry {
+    std::string help;
+    MetricType type;
+    std::unique_ptr<Counter> counter;
+    std::unique_ptr<Gauge> gauge;
+    std::unique_ptr<Histogram> histogram;
+  };
+
+  absl::StatusOr<Entry*> FindOrAdd(absl::string_view name,
+                                   absl::string_view help, MetricType type)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+// The standard set of metrics maintained by an engine. Every member points
+// into `registry()` and is never null, so instrumented code can update it
+// directly.
+class EngineMetrics {
+ public:
+  static absl::StatusOr<std::unique_ptr<EngineMetrics>> Create();
+
+  MetricsRegistry& registry() { return registry_; }
+  MetricsSnapshot Snapshot() const { return registry_.Snapshot(); }
+
+  // Sessions.
+  Counter* sessions_created;
+  // Number of sessions whose context is kept by the engine.
+  Gauge* resident_contexts;
+
+  // Scheduling.
+  // Tasks that have been queued but not started yet.
+  Gauge* queue_depth;
+  Counter* tasks_completed;
+  Counter* tasks_failed;
+  Counter* tasks_cancelled;
+
+  // Model execution.
+  Counter* prefill_tokens;
+  Counter* decode_tokens;
+  Histogram* prefill_latency;
+  Histogram* decode_latency;
+  // Number of tokens held in the KV cache of the last used context.
+  Gauge* kv_cache_tokens;
+
+  // Host-side work.
+  Histogram* preprocess_latency;
+  Histogram* constraint_latency;
+
+  // Context switching between sessions sharing an executor.
+  Counter* context_reuse_hits;
+  Counter* context_shared_switches;
+  Counter* context_restores;
+  Counter* context_prefetch_hits;
+
+ private:
+  EngineMetrics() = default;
+
+  MetricsRegistry registry_;
+};
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_ENGINE_METRICS_H_
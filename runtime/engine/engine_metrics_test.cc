@@ -0,0 +1,195 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/engine/engine_metrics.h"
+
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::NotNull;
+using ::testing::status::StatusIs;
+
+TEST(MetricsRegistryTest, CounterAndGauge) {
+  MetricsRegistry registry;
+  ASSERT_OK_AND_ASSIGN(Counter * counter,
+                       registry.RegisterCounter("requests_total", "Requests."));
+  ASSERT_OK_AND_ASSIGN(Gauge * gauge,
+                       registry.RegisterGauge("queue_depth", "Queue depth."));
+  counter->Increment();
+  counter->Increment(4);
+  gauge->Set(3);
+  gauge->Add(-1);
+
+  MetricsSnapshot snapshot = registry.Snapshot();
+  ASSERT_EQ(snapshot.metrics().size(), 2);
+  // Sorted by name.
+  EXPECT_EQ(snapshot.metrics()[0].name, "queue_depth");
+  EXPECT_EQ(snapshot.metrics()[1].name, "requests_total");
+  ASSERT_THAT(snapshot.Find("requests_total"), NotNull());
+  EXPECT_EQ(snapshot.Find("requests_total")->value, 5);
+  EXPECT_EQ(snapshot.Find("requests_total")->type, MetricType::kCounter);
+  ASSERT_THAT(snapshot.Find("queue_depth"), NotNull());
+  EXPECT_EQ(snapshot.Find("queue_depth")->value, 2);
+  EXPECT_EQ(snapshot.Find("missing"), nullptr);
+}
+
+TEST(MetricsRegistryTest, RegisterTwiceReturnsSameMetric) {
+  MetricsRegistry registry;
+  ASSERT_OK_AND_ASSIGN(Counter * first, registry.RegisterCounter("c", ""));
+  ASSERT_OK_AND_ASSIGN(Counter * second, registry.RegisterCounter("c", ""));
+  EXPECT_EQ(first, second);
+}
+
+TEST(MetricsRegistryTest, RegisterWithDifferentTypeFails) {
+  MetricsRegistry registry;
+  ASSERT_OK(registry.RegisterCounter("metric", ""));
+  EXPECT_THAT(registry.RegisterGauge("metric", ""),
+              StatusIs(absl::StatusCode::kAlreadyExists));
+}
+
+TEST(MetricsRegistryTest, InvalidNameFails) {
+  MetricsRegistry registry;
+  EXPECT_THAT(registry.RegisterCounter("1abc", ""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(registry.RegisterCounter("with space", ""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(registry.RegisterCounter("", ""),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MetricsRegistryTest, HistogramBucketsMustIncrease) {
+  MetricsRegistry registry;
+  EXPECT_THAT(registry.RegisterHistogram("h", "", {1.0, 1.0}),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(HistogramTest, ObserveFillsInclusiveBuckets) {
+  Histogram histogram({1.0, 2.0});
+  histogram.Observe(0.5);
+  histogram.Observe(1.0);
+  histogram.Observe(1.5);
+  histogram.Observe(3.0);
+  histogram.ObserveDuration(absl::Milliseconds(500));
+
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_THAT(snapshot.bucket_counts, ElementsAre(3, 1, 1));
+  EXPECT_EQ(snapshot.count, 5);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 6.5);
+}
+
+TEST(HistogramTest, ConcurrentObserve) {
+  Histogram histogram({10.0});
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&histogram] {
+      for (int i = 0; i < 1000; ++i) histogram.Observe(1.0);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  HistogramSnapshot snapshot = histogram.Snapshot();
+  EXPECT_EQ(snapshot.count, 4000);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 4000.0);
+}
+
+TEST(MetricsSnapshotTest, ToPrometheusText) {
+  MetricsRegistry registry;
+  ASSERT_OK_AND_ASSIGN(Counter * counter,
+                       registry.RegisterCounter("tokens_total", "Tokens."));
+  ASSERT_OK_AND_ASSIGN(
+      Histogram * histogram,
+      registry.RegisterHistogram("latency_seconds", "Latency.", {0.1, 1}));
+  counter->Increment(7);
+  histogram->Observe(0.05);
+  histogram->Observe(0.5);
+  histogram->Observe(5);
+
+  EXPECT_EQ(registry.Snapshot().ToPrometheusText(),
+            "# HELP latency_seconds Latency.\n"
+            "# TYPE latency_seconds histogram\n"
+            "latency_seconds_bucket{le=\"0.1\"} 1\n"
+            "latency_seconds_bucket{le=\"1\"} 2\n"
+            "latency_seconds_bucket{le=\"+Inf\"} 3\n"
+            "latency_seconds_sum 5.55\n"
+            "latency_seconds_count 3\n"
+            "# HELP tokens_total Tokens.\n"
+            "# TYPE tokens_total counter\n"
+            "tokens_total 7\n");
+}
+
+TEST(MetricsSnapshotTest, Merge) {
+  MetricsRegistry registry1;
+  ASSERT_OK_AND_ASSIGN(Counter * counter1,
+                       registry1.RegisterCounter("tokens_total", "Tokens."));
+  ASSERT_OK_AND_ASSIGN(
+      Histogram * histogram1,
+      registry1.RegisterHistogram("latency_seconds", "Latency.", {0.1, 1}));
+  counter1->Increment(7);
+  histogram1->Observe(0.05);
+
+  MetricsRegistry registry2;
+  ASSERT_OK_AND_ASSIGN(Counter * counter2,
+                       registry2.RegisterCounter("tokens_total", "Tokens."));
+  ASSERT_OK_AND_ASSIGN(
+      Histogram * histogram2,
+      registry2.RegisterHistogram("latency_seconds", "Latency.", {0.1, 1}));
+  ASSERT_OK_AND_ASSIGN(Gauge * gauge,
+                       registry2.RegisterGauge("queue_depth", "Queue."));
+  counter2->Increment(3);
+  histogram2->Observe(0.5);
+  gauge->Set(2);
+
+  const MetricsSnapshot snapshots[] = {registry1.Snapshot(),
+                                       registry2.Snapshot()};
+  MetricsSnapshot merged = MetricsSnapshot::Merge(snapshots);
+  ASSERT_EQ(merged.metrics().size(), 3);
+  ASSERT_NE(merged.Find("tokens_total"), nullptr);
+  EXPECT_EQ(merged.Find("tokens_total")->value, 10);
+  ASSERT_NE(merged.Find("queue_depth"), nullptr);
+  EXPECT_EQ(merged.Find("queue_depth")->value, 2);
+  const MetricSnapshot* latency = merged.Find("latency_seconds");
+  ASSERT_NE(latency, nullptr);
+  EXPECT_EQ(latency->value, 2);
+  EXPECT_THAT(latency->histogram.bucket_counts, ElementsAre(1, 1, 0));
+  EXPECT_DOUBLE_EQ(latency->histogram.sum, 0.55);
+}
+
+TEST(EngineMetricsTest, CreateRegistersStandardMetrics) {
+  ASSERT_OK_AND_ASSIGN(auto metrics, EngineMetrics::Create());
+  metrics->sessions_created->Increment();
+  metrics->prefill_latency->Observe(0.2);
+
+  MetricsSnapshot snapshot = metrics->Snapshot();
+  ASSERT_THAT(snapshot.Find("litert_lm_sessions_created_total"), NotNull());
+  EXPECT_EQ(snapshot.Find("litert_lm_sessions_created_total")->value, 1);
+  ASSERT_THAT(snapshot.Find("litert_lm_prefill_seconds"), NotNull());
+  EXPECT_EQ(snapshot.Find("litert_lm_prefill_seconds")->histogram.count, 1);
+  EXPECT_THAT(snapshot.ToPrometheusText(),
+              HasSubstr("# TYPE litert_lm_queue_depth gauge\n"));
+}
+
+}  // namespace
+}  // namespace litert::lm
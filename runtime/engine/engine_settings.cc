@@ -15,6 +15,7 @@
 #include "runtime/engine/engine_settings.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -26,11 +27,14 @@
 #include "absl/log/absl_log.h"  // from @com_google_absl
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/escaping.h"  // from @com_google_absl
 #include "absl/strings/match.h"  // from @com_google_absl
 #include "absl/strings/str_cat.h"  // from @com_google_absl
 #include "absl/strings/str_split.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
+#include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/llm_executor_settings.h"
@@ -364,6 +368,38 @@ proto::BenchmarkParams& EngineSettings::GetMutableBenchmarkParams() {
   return benchmark_params_.value();
 }
 
+bool EngineSettings::GetWarmupOnInit() const { return warmup_on_init_; }
+
+void EngineSettings::SetWarmupOnInit(bool warmup_on_init) {
+  warmup_on_init_ = warmup_on_init;
+}
+
+const std::optional<int64_t>& EngineSettings::GetMemoryBudgetBytes() const {
+  return memory_budget_bytes_;
+}
+
+void EngineSettings::SetMemoryBudgetBytes(
+    std::optional<int64_t> memory_budget_bytes) {
+  memory_budget_bytes_ = memory_budget_bytes;
+}
+
+const std::optional<int>& EngineSettings::GetMaxResidentContexts() const {
+  return max_resident_contexts_;
+}
+
+void EngineSettings::SetMaxResidentContexts(
+    std::optional<int> max_resident_contexts) {
+  max_resident_contexts_ = max_resident_contexts;
+}
+
+int EngineSettings::GetNumExecutorReplicas() const {
+  return num_executor_replicas_;
+}
+
+void EngineSettings::SetNumExecutorReplicas(int num_executor_replicas) {
+  num_executor_replicas_ = num_executor_replicas;
+}
+
 const std::optional<proto::LlmMetadata>& EngineSettings::GetLlmMetadata()
     const {
   return metadata_;
@@ -383,6 +419,21 @@ std::ostream& operator<<(std::ostream& os, const EngineSettings& settings) {
   } else {
     os << "  BenchmarkParams: Not set" << std::endl;
   }
+  os << "  WarmupOnInit: " << settings.GetWarmupOnInit() << std::endl;
+  if (settings.GetMemoryBudgetBytes().has_value()) {
+    os << "  MemoryBudgetBytes: " << *settings.GetMemoryBudgetBytes()
+       << std::endl;
+  } else {
+    os << "  MemoryBudgetBytes: Not set" << std::endl;
+  }
+  if (settings.GetMaxResidentContexts().has_value()) {
+    os << "  MaxResidentContexts: " << *settings.GetMaxResidentContexts()
+       << std::endl;
+  } else {
+    os << "  MaxResidentContexts: Not set" << std::endl;
+  }
+  os << "  NumExecutorReplicas: " << settings.GetNumExecutorReplicas()
+     << std::endl;
   if (settings.GetVisionExecutorSettings().has_value()) {
     os << "  VisionExecutorSettings: "
        << settings.GetVisionExecutorSettings().value();
@@ -490,6 +541,12 @@ absl::Status SessionConfig::MaybeUpdateAndValidate(
         "Number of output candidates need to be at least 1, but got: ",
         num_output_candidates_));
   }
+  if (streaming_chunk_policy_.max_tokens < 0 ||
+      streaming_chunk_policy_.max_bytes < 0 ||
+      streaming_chunk_policy_.max_delay < absl::ZeroDuration()) {
+    return absl::InvalidArgumentError(
+        "The streaming chunk limits must not be negative.");
+  }
 
   if (sampler_backend_ == Backend::UNSPECIFIED) {
     if (engine_settings.GetMainExecutorSettings().GetBackend() ==
@@ -523,6 +580,14 @@ std::vector<std::vector<int>>& SessionConfig::GetMutableStopTokenIds() {
   return stop_token_ids_;
 }
 
+const std::vector<std::string>& SessionConfig::GetStopStrings() const {
+  return stop_strings_;
+}
+
+std::vector<std::string>& SessionConfig::GetMutableStopStrings() {
+  return stop_strings_;
+}
+
 int SessionConfig::GetStartTokenId() const { return start_token_id_; }
 
 void SessionConfig::SetStartTokenId(int start_token_id) {
@@ -576,6 +641,10 @@ std::ostream& operator<<(std::ostream& os, const SessionConfig& config) {
   for (const auto& stop_token_ids : config.GetStopTokenIds()) {
     os << "    " << stop_token_ids << std::endl;
   }
+  os << "  StopStrings: " << std::endl;
+  for (const auto& stop_string : config.GetStopStrings()) {
+    os << "    \"" << absl::CEscape(stop_string) << "\"" << std::endl;
+  }
   os << "  NumOutputCandidates: " << config.GetNumOutputCandidates()
      << std::endl;
   os << "  LlmModelType: " << config.GetLlmModelType().DebugString()
@@ -587,6 +656,8 @@ std::ostream& operator<<(std::ostream& os, const SessionConfig& config) {
   os << "  ScopedLoraFile: "
      << (config.GetScopedLoraFile() != nullptr ? "Present" : "Not present")
      << std::endl;
+  os << "  StreamingChunkPolicy: " << config.GetStreamingChunkPolicy()
+     << std::endl;
   return os;
 }
 
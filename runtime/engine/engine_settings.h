@@ -15,6 +15,7 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_ENGINE_SETTINGS_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_ENGINE_ENGINE_SETTINGS_H_
 
+#include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -27,6 +28,7 @@
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
+#include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/llm_executor_settings.h"
@@ -118,6 +120,52 @@ class EngineSettings {
   // Returns the mutable benchmark parameters.
   proto::BenchmarkParams& GetMutableBenchmarkParams();
 
+  // Warmup:
+  // Returns true if the executors run a warmup pass during engine creation.
+  bool GetWarmupOnInit() const;
+  // Sets whether the executors run every prefill signature, one decode step
+  // and the vision/audio encoders on dummy inputs during engine creation, so
+  // the first request does not pay for lazy buffer allocation and kernel
+  // preparation. The time spent is reported as the "Warmup" init phase.
+  void SetWarmupOnInit(bool warmup_on_init);
+
+  // Memory budget:
+  // Returns the memory budget of the engine in bytes, if set.
+  const std::optional<int64_t>& GetMemoryBudgetBytes() const;
+  // Sets the memory budget of the engine in bytes. When set, engine creation
+  // derives max_num_tokens, the CPU prefill chunk size and KV cache increment
+  // size, and the maximum number of resident session contexts from the tensor
+  // sizes of the model, and fails if the model does not fit. It never raises
+  // a max_num_tokens that was set explicitly.
+  void SetMemoryBudgetBytes(std::optional<int64_t> memory_budget_bytes);
+
+  // Returns the maximum number of sessions whose context the engine keeps at
+  // the same time, if limited.
+  const std::optional<int>& GetMaxResidentContexts() const;
+  // Limits the number of sessions whose context the engine keeps at the same
+  // time. Creating a session beyond the limit fails with RESOURCE_EXHAUSTED
+  // until another session is deleted. Only enforced by the advanced engine,
+  // which swaps the contexts of several sessions in and out of one executor.
+  // The basic engine ignores it, as its sessions run directly on the executor
+  // without keeping a context of their own. Derived from the memory budget
+  // when that is set.
+  void SetMaxResidentContexts(std::optional<int> max_resident_contexts);
+
+  // Executor replicas:
+  // Returns the number of executor replicas the engine runs.
+  int GetNumExecutorReplicas() const;
+  // Sets the number of executor replicas the engine runs (default 1). The
+  // replicas share the memory-mapped model weights and the weight cache but
+  // each owns its KV cache and thread pools, so sessions placed on different
+  // replicas run concurrently. New sessions go to the replica with the fewest
+  // resident contexts, then the shortest queue, and stay there. The memory
+  // budget covers all replicas. On CPU with a weight cache the packed weights
+  // are counted once and the rest is split evenly between them; otherwise each
+  // replica packs its own weights and the whole budget is split evenly. The
+  // maximum number of resident contexts applies per replica. Only used by the
+  // advanced engine.
+  void SetNumExecutorReplicas(int num_executor_replicas);
+
   // Returns the LlmMetadata parameters.
   const std::optional<proto::LlmMetadata>& GetLlmMetadata() const;
   // Returns the mutable LlmMetadata parameters. Note that is the metadata_ is
@@ -147,6 +195,18 @@ class EngineSettings {
   // Default metadata for the model. This is loaded from the model assets (if
   // present).
   std::optional<proto::LlmMetadata> metadata_;
+
+  // Whether to warm up the executors during engine creation.
+  bool warmup_on_init_ = false;
+
+  // Memory budget of the engine in bytes.
+  std::optional<int64_t> memory_budget_bytes_;
+
+  // Maximum number of resident session contexts.
+  std::optional<int> max_resident_contexts_;
+
+  // Number of executor replicas.
+  int num_executor_replicas_ = 1;
 };
 std::ostream& operator<<(std::ostream& os, const EngineSettings& settings);
 
@@ -185,6 +245,12 @@ class SessionConfig {
   const std::vector<std::vector<int>>& GetStopTokenIds() const;
   std::vector<std::vector<int>>& GetMutableStopTokenIds();
 
+  // Stop strings:
+  // Getters for the stop strings. Unlike the stop token ids, these are matched
+  // on the decoded text, across token boundaries.
+  const std::vector<std::string>& GetStopStrings() const;
+  std::vector<std::string>& GetMutableStopStrings();
+
   // Set the start token ids.
   int GetStartTokenId() const;
   void SetStartTokenId(int start_token_id);
@@ -236,6 +302,23 @@ class SessionConfig {
     max_output_tokens_ = max_output_tokens;
   }
 
+  // The number of alternatives to report with each generated token's
+  // log-probability:
+  // Getters for the number of top log-probabilities.
+  int GetNumTopLogProbs() const { return num_top_logprobs_; }
+  void SetNumTopLogProbs(int num_top_logprobs) {
+    num_top_logprobs_ = num_top_logprobs;
+  }
+
+  // Streaming chunk policy:
+  // Getters for how the streamed responses are coalesced into chunks.
+  const StreamingChunkPolicy& GetStreamingChunkPolicy() const {
+    return streaming_chunk_policy_;
+  }
+  StreamingChunkPolicy& GetMutableStreamingChunkPolicy() {
+    return streaming_chunk_policy_;
+  }
+
  private:
   // Private constructor for the SessionConfig. The user should use the
   // CreateDefault() method to create a SessionConfig.
@@ -256,6 +339,10 @@ class SessionConfig {
   // dimension is the sequence of token ids that constitutes the stop token.
   std::vector<std::vector<int>> stop_token_ids_;
 
+  // Stop strings for the session. The output text is cut before the first
+  // occurrence of any of them.
+  std::vector<std::string> stop_strings_;
+
   // Start token id for the session.
   int start_token_id_ = -1;
 
@@ -290,6 +377,14 @@ class SessionConfig {
   // tokens (input + output) stored in the KV cache over the lifetime of a
   // session.
   int max_output_tokens_ = std::numeric_limits<int>::max();
+
+  // The number of top alternatives to report with the log-probability of each
+  // generated token. Log-probabilities are only computed when it is positive.
+  int num_top_logprobs_ = 0;
+
+  // How the responses of streaming decodes are coalesced into chunks. Every
+  // decode step is streamed on its own by default.
+  StreamingChunkPolicy streaming_chunk_policy_;
 };
 
 std::ostream& operator<<(std::ostream& os, const SessionConfig& config);
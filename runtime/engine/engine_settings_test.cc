@@ -14,6 +14,7 @@
 
 #include "runtime/engine/engine_settings.h"
 
+#include <cstdint>
 #include <fstream>
 #include <memory>
 #include <optional>
@@ -27,6 +28,7 @@
 #include "absl/status/status.h"  // from @com_google_absl
 #include "absl/status/statusor.h"  // from @com_google_absl
 #include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/time/time.h"  // from @com_google_absl
 #include "absl/types/optional.h"  // from @com_google_absl
 #include "runtime/components/tokenizer.h"
 #include "runtime/executor/executor_settings_base.h"
@@ -50,11 +52,11 @@ using ::testing::status::StatusIs;
 class MockTokenizer : public Tokenizer {
  public:
   MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText,
-              (const std::vector<int>& token_ids), (override));
+              (const std::vector<int>& token_ids), (const, override));
   MOCK_METHOD(absl::StatusOr<std::vector<int>>, TextToTokenIds,
-              (absl::string_view text), (override));
+              (absl::string_view text), (const, override));
   MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view token),
-              (override));
+              (const, override));
   MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
   MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
 };
@@ -540,6 +542,42 @@ TEST(EngineSettingsTest, BenchmarkParamsUpdateAdvancedSettings) {
       settings.GetMainExecutorSettings().GetAdvancedSettings()->is_benchmark);
 }
 
+TEST(EngineSettingsTest, WarmupOnInit) {
+  auto model_assets = ModelAssets::Create("test_model_path_1");
+  ASSERT_OK(model_assets);
+  ASSERT_OK_AND_ASSIGN(auto settings,
+                       EngineSettings::CreateDefault(*model_assets));
+  EXPECT_FALSE(settings.GetWarmupOnInit());
+
+  settings.SetWarmupOnInit(true);
+  EXPECT_TRUE(settings.GetWarmupOnInit());
+}
+
+TEST(EngineSettingsTest, MemoryBudget) {
+  auto model_assets = ModelAssets::Create("test_model_path_1");
+  ASSERT_OK(model_assets);
+  ASSERT_OK_AND_ASSIGN(auto settings,
+                       EngineSettings::CreateDefault(*model_assets));
+  EXPECT_FALSE(settings.GetMemoryBudgetBytes().has_value());
+  EXPECT_FALSE(settings.GetMaxResidentContexts().has_value());
+
+  settings.SetMemoryBudgetBytes(int64_t{3} << 30);
+  settings.SetMaxResidentContexts(2);
+  EXPECT_EQ(settings.GetMemoryBudgetBytes(), int64_t{3} << 30);
+  EXPECT_EQ(settings.GetMaxResidentContexts(), 2);
+}
+
+TEST(EngineSettingsTest, NumExecutorReplicas) {
+  auto model_assets = ModelAssets::Create("test_model_path_1");
+  ASSERT_OK(model_assets);
+  ASSERT_OK_AND_ASSIGN(auto settings,
+                       EngineSettings::CreateDefault(*model_assets));
+  EXPECT_EQ(settings.GetNumExecutorReplicas(), 1);
+
+  settings.SetNumExecutorReplicas(3);
+  EXPECT_EQ(settings.GetNumExecutorReplicas(), 3);
+}
+
 TEST(EngineSettingsTest, LlmMetadata) {
   auto model_assets = ModelAssets::Create("test_model_path_1");
   ASSERT_OK(model_assets);
@@ -716,6 +754,47 @@ TEST(SessionConfigTest, SetAndGetStopTokenIds) {
   EXPECT_THAT(session_config.GetStopTokenIds()[1], ElementsAre(1, 2));
 }
 
+TEST(SessionConfigTest, SetAndGetStopStrings) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_TRUE(session_config.GetStopStrings().empty());
+  session_config.GetMutableStopStrings() = {"\nObservation:", "###"};
+  EXPECT_THAT(session_config.GetStopStrings(),
+              ElementsAre("\nObservation:", "###"));
+}
+
+TEST(SessionConfigTest, SetAndGetStreamingChunkPolicy) {
+  SessionConfig session_config = SessionConfig::CreateDefault();
+  EXPECT_EQ(session_config.GetStreamingChunkPolicy().max_tokens, 1);
+  EXPECT_EQ(session_config.GetStreamingChunkPolicy().max_bytes, 0);
+  EXPECT_EQ(session_config.GetStreamingChunkPolicy().max_delay,
+            absl::InfiniteDuration());
+  session_config.GetMutableStreamingChunkPolicy().max_tokens = 8;
+  session_config.GetMutableStreamingChunkPolicy().max_delay =
+      absl::Milliseconds(50);
+  EXPECT_EQ(session_config.GetStreamingChunkPolicy().max_tokens, 8);
+  EXPECT_EQ(session_config.GetStreamingChunkPolicy().max_delay,
+            absl::Milliseconds(50));
+}
+
+TEST(SessionConfigTest, MaybeUpdateAndValidateRejectsNegativeChunkLimits) {
+  ASSERT_OK_AND_ASSIGN(auto model_assets,
+                       ModelAssets::Create("test_model_path_1"));
+  ASSERT_OK_AND_ASSIGN(auto settings,
+                       EngineSettings::CreateDefault(model_assets));
+  MockTokenizer tokenizer;
+  EXPECT_CALL(tokenizer, TokenIdsToText).WillRepeatedly(Return("fake_text"));
+  EXPECT_CALL(tokenizer, TokenToId).WillRepeatedly(Return(1));
+  EXPECT_CALL(tokenizer, TextToTokenIds)
+      .WillRepeatedly(Return(std::vector<int>{1}));
+  proto::LlmMetadata llm_metadata = CreateLlmMetadata();
+  ASSERT_OK(settings.MaybeUpdateAndValidate(tokenizer, &llm_metadata));
+
+  auto session_config = SessionConfig::CreateDefault();
+  session_config.GetMutableStreamingChunkPolicy().max_bytes = -1;
+  EXPECT_THAT(session_config.MaybeUpdateAndValidate(settings),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(SessionConfigTest, SetAndGetNumOutputCandidates) {
   SessionConfig session_config = SessionConfig::CreateDefault();
   EXPECT_EQ(session_config.GetNumOutputCandidates(), 1);
@@ -553,6 +553,17 @@ std::ostream& operator<<(std::ostream& os, const BenchmarkInfo& info) {
 
 DecodeConfig DecodeConfig::CreateDefault() { return DecodeConfig(); }
 
+std::ostream& operator<<(std::ostream& os, const StreamingChunkPolicy& policy) {
+  os << "max_tokens: " << policy.max_tokens << ", max_bytes: "
+     << policy.max_bytes << ", max_delay: " << policy.max_delay
+     << ", flush_strings: [";
+  for (int i = 0; i < policy.flush_strings.size(); ++i) {
+    os << (i > 0 ? ", " : "") << "\"" << policy.flush_strings[i] << "\"";
+  }
+  os << "]";
+  return os;
+}
+
 std::ostream& operator<<(std::ostream& os,
                          const VisionExecutorProperties& properties) {
   os << "num_tokens_per_image: " << properties.num_tokens_per_image
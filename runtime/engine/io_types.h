@@ -309,6 +309,25 @@ std::ostream& operator<<(std::ostream& os, const TaskState& task_state);
 
 bool IsTaskEndState(const TaskState& task_state);
 
+// The log-probability of a single token.
+struct TokenLogProb {
+  // The token id.
+  int token_id;
+  // The decoded text of the token.
+  std::string token;
+  // The log-probability of the token under the model's output distribution.
+  float logprob;
+};
+
+// The log-probability of a generated token together with the most likely
+// alternatives at the same decode step.
+struct TokenLogProbs {
+  // The generated token.
+  TokenLogProb token;
+  // The most likely tokens at this step in descending order of probability.
+  std::vector<TokenLogProb> top_logprobs;
+};
+
 // A container to host the model responses.
 class Responses {
  public:
@@ -362,6 +381,21 @@ class Responses {
     return token_scores_;
   };
 
+  // Returns the const per-token log-probabilities vector, one vector per
+  // response text. Only set when log-probabilities are requested. The tokens
+  // of stop token sequences and stop strings are not included, so the tokens
+  // line up with the text.
+  const std::optional<std::vector<std::vector<TokenLogProbs>>>&
+  GetTokenLogProbs() const {
+    return token_logprobs_;
+  }
+
+  // Returns the mutable per-token log-probabilities vector.
+  std::optional<std::vector<std::vector<TokenLogProbs>>>&
+  GetMutableTokenLogProbs() {
+    return token_logprobs_;
+  };
+
  private:
   // The state of the task.
   TaskState task_state_;
@@ -378,6 +412,11 @@ class Responses {
 
   // The output vector of token scores for each response text. Optional.
   std::optional<std::vector<std::vector<float>>> token_scores_;
+
+  // The log-probabilities of the generated tokens for each response text.
+  // Optional. In streaming mode, each partial response only holds the tokens
+  // of its own chunk.
+  std::optional<std::vector<std::vector<TokenLogProbs>>> token_logprobs_;
 };
 std::ostream& operator<<(std::ostream& os, const Responses& responses);
 
@@ -406,6 +445,7 @@ class BenchmarkInfo {
     kTokenizer,
     kSession,
     kConversation,
+    kWarmup,
     kTotal,
   };
   static constexpr absl::string_view InitPhaseToString(InitPhase phase) {
@@ -422,6 +462,8 @@ class BenchmarkInfo {
         return "Init Session";
       case InitPhase::kConversation:
         return "Init Conversation";
+      case InitPhase::kWarmup:
+        return "Init Warmup";
       case InitPhase::kTotal:
         return "Init Total";
     }
@@ -527,13 +569,57 @@ class DecodeConfig {
   // Returns the max output tokens.
   std::optional<int> GetMaxOutputTokens() const { return max_output_tokens_; }
 
+  // Sets the number of most likely alternatives to report with the
+  // log-probability of each generated token. 0 disables log-probabilities.
+  void SetNumTopLogProbs(int num_top_logprobs) {
+    num_top_logprobs_ = num_top_logprobs;
+  }
+
+  // Returns the number of top log-probabilities to report. If not set, the
+  // value from the SessionConfig is used.
+  std::optional<int> GetNumTopLogProbs() const { return num_top_logprobs_; }
+
+  // Sets whether to report the log-probability of each generated token even
+  // when no top alternatives are requested. The vocabulary is then not ranked
+  // and no alternative is decoded.
+  void SetReturnTokenLogProbs(bool return_token_logprobs) {
+    return_token_logprobs_ = return_token_logprobs;
+  }
+
+  // Returns whether the log-probability of each generated token is reported
+  // even when no top alternatives are requested.
+  bool GetReturnTokenLogProbs() const { return return_token_logprobs_; }
+
  private:
   DecodeConfig() = default;
 
   Constraint* absl_nullable constraint_ = nullptr;
   std::optional<int> max_output_tokens_ = std::nullopt;
+  std::optional<int> num_top_logprobs_ = std::nullopt;
+  bool return_token_logprobs_ = false;
+};
+
+// Controls how the responses of a streaming decode are coalesced into chunks
+// before being passed to the callback, to save the per-call overhead of the
+// callback at high token rates. A chunk is sent as soon as any of the limits is
+// reached, and the pending chunk is always sent when the decode stops, fails or
+// is cancelled. The default sends every decode step on its own.
+struct StreamingChunkPolicy {
+  // The maximum number of decode steps in a chunk. 0 for no limit.
+  int max_tokens = 1;
+  // The number of bytes of text of any candidate from which a chunk is sent.
+  // 0 for no limit.
+  int max_bytes = 0;
+  // The maximum time the first decode step of a chunk is held back. It is
+  // checked at the end of each decode step.
+  absl::Duration max_delay = absl::InfiniteDuration();
+  // A chunk whose text contains any of these strings is sent right away, e.g.
+  // the code fences delimiting tool calls.
+  std::vector<std::string> flush_strings;
 };
 
+std::ostream& operator<<(std::ostream& os, const StreamingChunkPolicy& policy);
+
 // The properties of the audio model. These properties are populated by
 // inspecting the LiteRT compiled model and provide information about the model
 // parameters.
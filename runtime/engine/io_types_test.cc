@@ -1013,6 +1013,14 @@ TEST(DecodeConfigTest, SetAndGetMaxOutputTokens) {
   EXPECT_EQ(decode_config.GetMaxOutputTokens(), 42);
 }
 
+TEST(DecodeConfigTest, SetAndGetNumTopLogProbs) {
+  DecodeConfig decode_config = DecodeConfig::CreateDefault();
+  EXPECT_EQ(decode_config.GetNumTopLogProbs(), std::nullopt);
+
+  decode_config.SetNumTopLogProbs(5);
+  EXPECT_EQ(decode_config.GetNumTopLogProbs(), 5);
+}
+
 TEST(VisionExecutorPropertiesTest, OperatorOutput) {
   VisionExecutorProperties properties;
   properties.num_tokens_per_image = 128;
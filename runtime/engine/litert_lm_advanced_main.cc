@@ -130,6 +130,8 @@ absl::Status MainHelper(int argc, char** argv) {
            "[--async=<true|false>] [--force_f32=<true|false] "
            "[--report_peak_memory_footprint] [--multi_turns=<true|false>] "
            "[--num_cpu_threads=<num_cpu_threads>] "
+           "[--num_prefill_cpu_threads=<num_prefill_cpu_threads>] "
+           "[--num_decode_cpu_threads=<num_decode_cpu_threads>] "
            "[--gpu_external_tensor_mode=<true|false>] "
            "[--configure_magic_numbers=<true|false>] "
            "[--verify_magic_numbers=<true|false>] "
@@ -148,6 +150,8 @@ absl::Status MainHelper(int argc, char** argv) {
            "[--litert_dispatch_lib_dir=<litert_dispatch_lib_dir>]"
            "[--sampler_handles_input=<true|false>]"
            "[--disable_cache=<true|false>]"
+           "[--warmup=<true|false>]"
+           "[--memory_budget_mb=<memory_budget_mb>]"
            "[--cache_compiled_shader_only=<true|false>]"
            "[--conv_type=<auto|float|int8>]";
     ABSL_LOG(INFO)
@@ -189,6 +193,9 @@ absl::Status MainHelper(int argc, char** argv) {
   settings.force_f32 = absl::GetFlag(FLAGS_force_f32);
   settings.multi_turns = absl::GetFlag(FLAGS_multi_turns);
   settings.num_cpu_threads = absl::GetFlag(FLAGS_num_cpu_threads);
+  settings.num_prefill_cpu_threads =
+      absl::GetFlag(FLAGS_num_prefill_cpu_threads);
+  settings.num_decode_cpu_threads = absl::GetFlag(FLAGS_num_decode_cpu_threads);
   settings.gpu_external_tensor_mode =
       absl::GetFlag(FLAGS_gpu_external_tensor_mode);
   settings.configure_magic_numbers =
@@ -202,6 +209,8 @@ absl::Status MainHelper(int argc, char** argv) {
   settings.gpu_madvise_original_shared_tensors =
       absl::GetFlag(FLAGS_gpu_madvise_original_shared_tensors);
   settings.disable_cache = absl::GetFlag(FLAGS_disable_cache);
+  settings.warmup = absl::GetFlag(FLAGS_warmup);
+  settings.memory_budget_mb = absl::GetFlag(FLAGS_memory_budget_mb);
   settings.cache_compiled_shaders_only =
       absl::GetFlag(FLAGS_cache_compiled_shaders_only);
   settings.preferred_device_substr =
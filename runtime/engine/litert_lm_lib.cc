@@ -160,6 +160,11 @@ absl::StatusOr<EngineSettings> CreateEngineSettings(
           litert::lm::ActivationDataType::FLOAT32);
     }
   }
+  engine_settings.SetWarmupOnInit(settings.warmup);
+  if (settings.memory_budget_mb > 0) {
+    engine_settings.SetMemoryBudgetBytes(int64_t{settings.memory_budget_mb} *
+                                         1024 * 1024);
+  }
   if (settings.disable_cache) {
     engine_settings.GetMutableMainExecutorSettings().SetCacheDir(":nocache");
     if (settings.vision_backend.has_value()) {
@@ -194,6 +199,12 @@ absl::StatusOr<EngineSettings> CreateEngineSettings(
     if (settings.num_cpu_threads > 0) {
       cpu_settings.number_of_threads = settings.num_cpu_threads;
     }
+    if (settings.num_prefill_cpu_threads > 0) {
+      cpu_settings.prefill_number_of_threads = settings.num_prefill_cpu_threads;
+    }
+    if (settings.num_decode_cpu_threads > 0) {
+      cpu_settings.decode_number_of_threads = settings.num_decode_cpu_threads;
+    }
     cpu_settings.prefill_chunk_size = settings.prefill_chunk_size;
     executor_settings.SetBackendConfig(cpu_settings);
   }
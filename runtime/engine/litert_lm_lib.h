@@ -84,6 +84,10 @@ struct LiteRtLmSettings {
   bool force_f32 = false;
   bool multi_turns = false;
   int num_cpu_threads = 0;
+  // If greater than 0, override num_cpu_threads for the prefill and the decode
+  // signatures respectively.
+  int num_prefill_cpu_threads = 0;
+  int num_decode_cpu_threads = 0;
   // Set external tensor mode false by default since it runs slightly faster
   // during decode as the layout changes optimized for GPU inference is done by
   // GPU, not by CPU.
@@ -95,6 +99,8 @@ struct LiteRtLmSettings {
   std::optional<std::string> score_target_text = std::nullopt;
   bool gpu_madvise_original_shared_tensors = true;
   bool disable_cache = false;
+  bool warmup = false;
+  int memory_budget_mb = 0;
   std::string cache_dir = "";
   int prefill_chunk_size = -1;
   std::string preferred_device_substr = "";
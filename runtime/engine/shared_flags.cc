@@ -73,6 +73,12 @@ ABSL_FLAG(bool, multi_turns, false,
 ABSL_FLAG(int, num_cpu_threads, 0,
           "If greater than 0, the number of CPU threads to use for the LLM "
           "execution with CPU backend.");
+ABSL_FLAG(int, num_prefill_cpu_threads, 0,
+          "If greater than 0, the number of CPU threads to use for prefill "
+          "with CPU backend, overriding num_cpu_threads.");
+ABSL_FLAG(int, num_decode_cpu_threads, 0,
+          "If greater than 0, the number of CPU threads to use for decode "
+          "with CPU backend, overriding num_cpu_threads.");
 ABSL_FLAG(bool, gpu_external_tensor_mode, false,
           "If false (by default), the GPU backend will use no external tensor "
           "mode which runs slightly faster during decode. It should be set "
@@ -97,6 +103,12 @@ ABSL_FLAG(bool, gpu_madvise_original_shared_tensors, true,
           "If true, the GPU backend will madvise the original shared tensors "
           "after use.");
 ABSL_FLAG(bool, disable_cache, false, "Disable weight cache.");
+ABSL_FLAG(bool, warmup, false,
+          "If true, run every prefill signature, decode and the vision/audio "
+          "encoders on dummy inputs during engine creation.");
+ABSL_FLAG(int, memory_budget_mb, 0,
+          "If positive, size the KV cache, the prefill chunks and the number "
+          "of resident session contexts to fit in this many megabytes.");
 ABSL_FLAG(std::string, preferred_device_substr, "",
           "Preferred WebGPU device name substring, case-insensitive. "
           "If not empty, the adapter which the device name contains the "
@@ -43,6 +43,8 @@ ABSL_DECLARE_FLAG(bool, report_peak_memory_footprint);
 ABSL_DECLARE_FLAG(bool, force_f32);
 ABSL_DECLARE_FLAG(bool, multi_turns);
 ABSL_DECLARE_FLAG(int, num_cpu_threads);
+ABSL_DECLARE_FLAG(int, num_prefill_cpu_threads);
+ABSL_DECLARE_FLAG(int, num_decode_cpu_threads);
 ABSL_DECLARE_FLAG(bool, gpu_external_tensor_mode);
 ABSL_DECLARE_FLAG(bool, configure_magic_numbers);
 ABSL_DECLARE_FLAG(bool, verify_magic_numbers);
@@ -51,6 +53,8 @@ ABSL_DECLARE_FLAG(int, num_logits_to_print_after_decode);
 ABSL_DECLARE_FLAG(std::string, score_target_text);
 ABSL_DECLARE_FLAG(bool, gpu_madvise_original_shared_tensors);
 ABSL_DECLARE_FLAG(bool, disable_cache);
+ABSL_DECLARE_FLAG(bool, warmup);
+ABSL_DECLARE_FLAG(int, memory_budget_mb);
 ABSL_DECLARE_FLAG(std::string, preferred_device_substr);
 ABSL_DECLARE_FLAG(int, num_threads_to_upload);
 ABSL_DECLARE_FLAG(int, num_threads_to_compile);
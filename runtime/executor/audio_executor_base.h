@@ -42,6 +42,13 @@ class AudioExecutorBase {
     return absl::UnimplementedError("Not implemented.");
   }
 
+  // Runs the encoder once on a silent spectrogram so that lazily created
+  // buffers and kernel caches are ready before the first request, then resets
+  // the executor.
+  virtual absl::Status Warmup() {
+    return absl::UnimplementedError("Not implemented.");
+  }
+
   // Create a new audio context for the audio executor.
   virtual absl::StatusOr<std::unique_ptr<AudioContext>> CreateNewContext() {
     return absl::UnimplementedError("Not implemented.");
@@ -710,6 +710,20 @@ absl::StatusOr<ExecutorAudioData> AudioLiteRtCompiledModelExecutor::Encode(
   return audio_data;
 }
 
+absl::Status AudioLiteRtCompiledModelExecutor::Warmup() {
+  std::vector<float> spectrogram(
+      sequence_length_ * spectrogram_feature_dimensions_, 0.0f);
+  std::vector<uint8_t> spectrogram_mask(sequence_length_, 1);
+  std::vector<float> audio_embeddings(
+      CeilIntDiv(sequence_length_, encoder_shrinking_factor_) *
+      audio_embedding_dimensions_);
+  RETURN_IF_ERROR(EncodeInternal(absl::MakeSpan(spectrogram),
+                                 absl::MakeSpan(spectrogram_mask),
+                                 absl::MakeSpan(audio_embeddings))
+                      .status());
+  return Reset();
+}
+
 absl::StatusOr<ExecutorAudioData> AudioLiteRtCompiledModelExecutor::Encode(
     const TensorBuffer& spectrogram_tensor) {
   LITERT_ASSIGN_OR_RETURN(auto tensor_type, spectrogram_tensor.TensorType());
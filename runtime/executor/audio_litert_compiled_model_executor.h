@@ -111,6 +111,9 @@ class AudioLiteRtCompiledModelExecutor : public AudioExecutor {
   // model is used.
   absl::Status Reset() override { return audio_encoder_->Reset(); }
 
+  // Encodes one chunk of silent spectrogram and resets the audio encoder.
+  absl::Status Warmup() override;
+
   // Get the audio executor properties.
   absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties()
       const override {
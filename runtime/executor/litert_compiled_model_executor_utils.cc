@@ -374,6 +374,57 @@ absl::Status FillAttentionMask(litert::TensorBuffer& mask, int start_timestep,
   return absl::OkStatus();
 }
 
+absl::Status ExtendAttentionMask(litert::TensorBuffer& mask,
+                                 int start_position, int end_position) {
+  LITERT_ASSIGN_OR_RETURN(auto mask_tensor_type, mask.TensorType());
+  RET_CHECK_EQ(mask_tensor_type.Layout().Rank(), 4)
+          .SetCode(absl::StatusCode::kInvalidArgument)
+      << "Attention mask must be 4D.";
+  int batch_size = mask_tensor_type.Layout().Dimensions()[0];
+  int channel_size = mask_tensor_type.Layout().Dimensions()[3];
+  RET_CHECK(0 <= start_position && start_position <= end_position &&
+            end_position <= channel_size)
+          .SetCode(absl::StatusCode::kInvalidArgument)
+      << "Invalid mask range [" << start_position << ", " << end_position
+      << ") for " << channel_size << " positions.";
+  if (start_position == end_position) {
+    return absl::OkStatus();
+  }
+  LITERT_ASSIGN_OR_RETURN(auto mask_size, mask.PackedSize());
+  LITERT_ASSIGN_OR_RETURN(auto mask_lock_and_addr,
+                          litert::TensorBufferScopedLock::Create(
+                              mask, litert::TensorBuffer::LockMode::kWrite));
+
+  for (int b = 0; b < batch_size; ++b) {
+    switch (mask_tensor_type.ElementType()) {
+      case litert::ElementType::Bool: {
+        bool* bool_ptr = static_cast<bool*>(mask_lock_and_addr.second) +
+                         b * (mask_size / batch_size / sizeof(bool));
+        std::fill(bool_ptr + start_position, bool_ptr + end_position, true);
+        break;
+      }
+      case litert::ElementType::Float16: {
+        tflite::half* half_ptr =
+            static_cast<tflite::half*>(mask_lock_and_addr.second) +
+            b * (mask_size / batch_size / sizeof(tflite::half));
+        std::fill(half_ptr + start_position, half_ptr + end_position,
+                  tflite::half(0.0f));
+        break;
+      }
+      case litert::ElementType::Float32: {
+        float* float_ptr = static_cast<float*>(mask_lock_and_addr.second) +
+                           b * (mask_size / batch_size / sizeof(float));
+        std::fill(float_ptr + start_position, float_ptr + end_position, 0.0f);
+        break;
+      }
+      default:
+        return absl::InvalidArgumentError(
+            "Unsupported attention mask data type.");
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<ModelResources>>
 BuildLiteRtCompiledModelResources(const ModelAssets& model_assets) {
   ASSIGN_OR_RETURN(auto format, GetFileFormat(model_assets));
@@ -124,6 +124,14 @@ absl::Status InitializeAttentionMask(::litert::TensorBuffer& mask, bool is_f16);
 absl::Status FillAttentionMask(::litert::TensorBuffer& mask, int start_timestep,
                                int steps);
 
+// Marks the positions [start_position, end_position) as visible in the first
+// sequence row of every batch, leaving all other positions untouched. It lets
+// the decode mask grow by the newly visible positions instead of being
+// re-initialized and refilled at every step.
+// The mask is a 4D tensor with shape [batch, seq_len, 1, max_kv_len].
+absl::Status ExtendAttentionMask(::litert::TensorBuffer& mask,
+                                 int start_position, int end_position);
+
 // Fills the parameters used by single buffer cache update from
 // start_index to start_index + update_length.
 // Note that this parameter tensor is used by add_values_to_cache kernel and
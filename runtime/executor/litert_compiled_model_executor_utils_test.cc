@@ -476,6 +476,64 @@ TEST(LlmLiteRTCompiledModelExecutorUtilsTest, FillAttentionMask_Bool) {
   }
 }
 
+TEST(LlmLiteRTCompiledModelExecutorUtilsTest,
+     ExtendAttentionMask_MatchesFillAttentionMask) {
+  LITERT_ASSERT_OK_AND_ASSIGN(auto env, ::litert::Environment::Create({}));
+  // Mask shape: [batch=2, seq_len=1, 1, max_kv_len=10]
+  auto layout = ::litert::Layout(::litert::Dimensions({2, 1, 1, 10}));
+  RankedTensorType ranked_tensor_type(ElementType::Float32, std::move(layout));
+  auto extended_mask =
+      TensorBuffer::CreateManaged(env, ::litert::TensorBufferType::kHostMemory,
+                                  ranked_tensor_type, sizeof(float) * 20);
+  ASSERT_TRUE(extended_mask);
+  auto filled_mask =
+      TensorBuffer::CreateManaged(env, ::litert::TensorBufferType::kHostMemory,
+                                  ranked_tensor_type, sizeof(float) * 20);
+  ASSERT_TRUE(filled_mask);
+
+  // Decode steps 3, 4 and 5 extend the mask one position at a time after an
+  // initial [0, 3] fill.
+  ASSERT_OK(InitializeAttentionMask(*extended_mask, /*is_f16=*/false));
+  ASSERT_OK(ExtendAttentionMask(*extended_mask, /*start_position=*/0,
+                                /*end_position=*/4));
+  ASSERT_OK(ExtendAttentionMask(*extended_mask, /*start_position=*/4,
+                                /*end_position=*/5));
+  ASSERT_OK(ExtendAttentionMask(*extended_mask, /*start_position=*/5,
+                                /*end_position=*/6));
+  ASSERT_OK(InitializeAttentionMask(*filled_mask, /*is_f16=*/false));
+  ASSERT_OK(FillAttentionMask(*filled_mask, /*start_timestep=*/5, /*steps=*/1));
+
+  auto extended_lock = litert::TensorBufferScopedLock::Create(
+      *extended_mask, litert::TensorBuffer::LockMode::kRead);
+  ASSERT_TRUE(extended_lock);
+  auto filled_lock = litert::TensorBufferScopedLock::Create(
+      *filled_mask, litert::TensorBuffer::LockMode::kRead);
+  ASSERT_TRUE(filled_lock);
+  float* extended_ptr = static_cast<float*>(extended_lock->second);
+  float* filled_ptr = static_cast<float*>(filled_lock->second);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(extended_ptr[i], filled_ptr[i]) << " at index " << i;
+  }
+}
+
+TEST(LlmLiteRTCompiledModelExecutorUtilsTest,
+     ExtendAttentionMask_InvalidRange) {
+  LITERT_ASSERT_OK_AND_ASSIGN(auto env, ::litert::Environment::Create({}));
+  auto layout = ::litert::Layout(::litert::Dimensions({1, 1, 1, 8}));
+  RankedTensorType ranked_tensor_type(ElementType::Bool, std::move(layout));
+  auto mask_buffer =
+      TensorBuffer::CreateManaged(env, ::litert::TensorBufferType::kHostMemory,
+                                  ranked_tensor_type, sizeof(bool) * 8);
+  ASSERT_TRUE(mask_buffer);
+
+  EXPECT_THAT(ExtendAttentionMask(*mask_buffer, /*start_position=*/4,
+                                  /*end_position=*/9),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ExtendAttentionMask(*mask_buffer, /*start_position=*/5,
+                                  /*end_position=*/4),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST(LlmLiteRTCompiledModelExecutorUtilsTest,
      FillAttentionMask_Bool_MultipleBatches) {
   LITERT_ASSERT_OK_AND_ASSIGN(auto env, ::litert::Environment::Create({}));
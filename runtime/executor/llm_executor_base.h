@@ -135,6 +135,14 @@ class LlmExecutorBase {
     return absl::UnimplementedError(absl::StrCat(
         "Reset not implemented for backend: ", ExecutorBackendName()));
   };
+
+  // Runs the prefill and decode graphs once on dummy inputs so that lazily
+  // created buffers and kernel caches are ready before the first request. The
+  // executor is reset afterwards, leaving no trace of the dummy inputs.
+  virtual absl::Status Warmup() {
+    return absl::UnimplementedError(absl::StrCat(
+        "Warmup not implemented for backend: ", ExecutorBackendName()));
+  };
 };
 
 }  // namespace litert::lm
@@ -14,6 +14,7 @@
 
 #include "runtime/executor/llm_executor_settings.h"
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -55,6 +56,10 @@ std::ostream& operator<<(std::ostream& os, const CpuConfig& config) {
   os << "kv_increment_size: " << config.kv_increment_size << "\n";
   os << "prefill_chunk_size: " << config.prefill_chunk_size << "\n";
   os << "number_of_threads: " << config.number_of_threads << "\n";
+  os << "prefill_number_of_threads: " << config.prefill_number_of_threads
+     << "\n";
+  os << "decode_number_of_threads: " << config.decode_number_of_threads
+     << "\n";
   return os;
 }
 
@@ -170,4 +175,27 @@ absl::StatusOr<LlmExecutorSettings> LlmExecutorSettings::CreateDefault(
   return settings;
 }
 
+uint32_t GetPrefillNumThreads(const CpuConfig& config) {
+  return config.prefill_number_of_threads > 0
+             ? config.prefill_number_of_threads
+             : config.number_of_threads;
+}
+
+uint32_t GetDecodeNumThreads(const CpuConfig& config) {
+  return config.decode_number_of_threads > 0 ? config.decode_number_of_threads
+                                             : config.number_of_threads;
+}
+
+bool UsesSeparateDecodeCompiledModel(const LlmExecutorSettings& settings) {
+  if (settings.GetBackend() != Backend::CPU) {
+    return false;
+  }
+  auto cpu_config = settings.GetBackendConfig<CpuConfig>();
+  if (!cpu_config.ok() ||
+      GetDecodeNumThreads(*cpu_config) == GetPrefillNumThreads(*cpu_config)) {
+    return false;
+  }
+  return settings.GetWeightCacheFile(".xnnpack_cache").ok();
+}
+
 }  // namespace litert::lm
@@ -108,6 +108,18 @@ struct CpuConfig {
 
   // Number of threads. The default value is 4.
   uint32_t number_of_threads = 4;
+
+  // Number of threads for the prefill signatures, which are compute bound and
+  // scale with the number of cores. If 0, number_of_threads is used.
+  uint32_t prefill_number_of_threads = 0;
+
+  // Number of threads for the decode signature. Decoding a single sequence is
+  // memory bandwidth bound and may get slower with more threads. If 0,
+  // number_of_threads is used. A decode thread count different from the
+  // prefill one compiles the model a second time for decode, which shares the
+  // packed weights through the XNNPack weight cache. Without a weight cache,
+  // or for dynamically shaped models, decode runs with the prefill threads.
+  uint32_t decode_number_of_threads = 0;
 };
 std::ostream& operator<<(std::ostream& os, const CpuConfig& config);
 
@@ -355,6 +367,18 @@ class LlmExecutorSettings : public ExecutorSettingsBase {
 };
 std::ostream& operator<<(std::ostream& os, const LlmExecutorSettings& config);
 
+// Returns the number of threads running the prefill signatures.
+uint32_t GetPrefillNumThreads(const CpuConfig& config);
+
+// Returns the number of threads running the decode signature.
+uint32_t GetDecodeNumThreads(const CpuConfig& config);
+
+// Returns whether a statically shaped model is compiled a second time for the
+// decode signature: on CPU, when the decode thread count differs from the
+// prefill one. The second compiled model only shares the packed weights of the
+// first through the XNNPack weight cache, so it also requires one.
+bool UsesSeparateDecodeCompiledModel(const LlmExecutorSettings& settings);
+
 // Struct to host the runtime settings for the executor.
 // Settings will not be changed by the executor while executing task.
 // TODO: b/404279705 - Set default values in LLM Executor RuntimeConfig
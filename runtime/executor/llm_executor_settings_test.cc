@@ -509,6 +509,28 @@ TEST(LlmExecutorConfigTest, MutableBackendConfig) {
               StatusIs(kInvalidArgument));
 }
 
+TEST(LlmExecutorConfigTest, UsesSeparateDecodeCompiledModel) {
+  ASSERT_OK_AND_ASSIGN(auto model_assets, ModelAssets::Create(kPathToModel1));
+  ASSERT_OK_AND_ASSIGN(
+      auto settings,
+      LlmExecutorSettings::CreateDefault(model_assets, Backend::CPU));
+  ASSERT_OK_AND_ASSIGN(auto cpu_config,
+                       settings.MutableBackendConfig<CpuConfig>());
+  cpu_config.number_of_threads = 4;
+  settings.SetBackendConfig(cpu_config);
+  EXPECT_FALSE(UsesSeparateDecodeCompiledModel(settings));
+
+  cpu_config.decode_number_of_threads = 2;
+  settings.SetBackendConfig(cpu_config);
+  EXPECT_EQ(GetPrefillNumThreads(cpu_config), 4);
+  EXPECT_EQ(GetDecodeNumThreads(cpu_config), 2);
+  EXPECT_TRUE(UsesSeparateDecodeCompiledModel(settings));
+
+  // Without a weight cache, decode runs on the prefill compiled model.
+  settings.SetCacheDir(":nocache");
+  EXPECT_FALSE(UsesSeparateDecodeCompiledModel(settings));
+}
+
 TEST(LlmExecutorConfigTest, SetSupportedLoraRanks) {
   auto model_assets = ModelAssets::Create(kPathToModel1);
   ASSERT_OK(model_assets);
@@ -1010,12 +1010,20 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::DecodeInternal(
   }
 
   if (signatures_.input_attn_mask.has_value()) {
-    RETURN_IF_ERROR(InitializeAttentionMask(
-        decode_input_buffers_[signatures_.input_attn_mask.value()],
-        use_fp16_precision_));
-    RETURN_IF_ERROR(FillAttentionMask(
-        decode_input_buffers_[signatures_.input_attn_mask.value()], step,
-        /*steps=*/1));
+    // The causal decode mask only grows between steps, so only the newly
+    // visible positions are written. Moving backwards (rewind, reset or a
+    // context switch) or a replaced buffer requires a full re-initialization.
+    auto& decode_mask =
+        decode_input_buffers_[signatures_.input_attn_mask.value()];
+    if (decode_attn_mask_visible_length_ < 0 ||
+        decode_attn_mask_visible_length_ > step + 1) {
+      RETURN_IF_ERROR(
+          InitializeAttentionMask(decode_mask, use_fp16_precision_));
+      decode_attn_mask_visible_length_ = 0;
+    }
+    RETURN_IF_ERROR(ExtendAttentionMask(
+        decode_mask, decode_attn_mask_visible_length_, step + 1));
+    decode_attn_mask_visible_length_ = step + 1;
   }
   if (signatures_.input_int32_param.has_value()) {
     RETURN_IF_ERROR(FillSingleBufferCacheParamTensor(
@@ -1055,9 +1063,9 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::BindTensorsAndRunDecode(
   }
 
   bool async = true;
-  LITERT_RETURN_IF_ERROR(
-      compiled_model_.RunAsync(kDecodeSignatureRunner, decode_input_buffers,
-                               decode_output_buffers, async));
+  LITERT_RETURN_IF_ERROR(GetDecodeCompiledModel().RunAsync(
+      kDecodeSignatureRunner, decode_input_buffers, decode_output_buffers,
+      async));
 
   if (!gpu_optimized_single_buffer_cache_) {
     std::swap(input_kv_cache_buffers_, output_kv_cache_buffers_);
@@ -1297,7 +1305,8 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::InitializeSampler(
   sampler_handles_input_ =
       (!executor_settings_.GetAdvancedSettings().has_value() ||
        executor_settings_.GetAdvancedSettings()->sampler_handles_input) &&
-      sampler_->CanHandleInput() && !signatures_.input_tokens.empty();
+      AllowsSamplerToHandleInput() && sampler_->CanHandleInput() &&
+      !signatures_.input_tokens.empty();
   if (sampler_handles_input_) {
     ABSL_LOG(INFO) << "Sampler will handle decode input tensors.";
     if (!decode_prev_input_pos_) {
@@ -1350,12 +1359,15 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::SwapSamplerInputTensors() {
   if (has_input_attn_mask) {
     std::swap(decode_prev_mask_,
               decode_input_buffers_[*signatures_.input_attn_mask]);
+    decode_attn_mask_visible_length_ = -1;
   }
   return SetSamplerInputHandling(/*reset=*/false);
 }
 
 absl::Status LlmLiteRtCompiledModelExecutorBase::SetSamplerInputHandling(
     bool reset) {
+  // The sampler writes the decode mask itself while it handles the input.
+  decode_attn_mask_visible_length_ = -1;
   if (reset) {
     return sampler_->SetInputTensorsAndInferenceFunc(
         nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
@@ -1428,9 +1440,34 @@ absl::Status LlmLiteRtCompiledModelExecutorBase::SetCurrentStep(int new_step) {
 
 absl::Status LlmLiteRtCompiledModelExecutorBase::Reset() {
   llm_context_->runtime_state().current_step = 0;
+  decode_attn_mask_visible_length_ = -1;
   return absl::OkStatus();
 }
 
+absl::Status LlmLiteRtCompiledModelExecutorBase::Warmup() {
+  // Token id 0 exists in every vocabulary; the values do not matter as the
+  // executor is reset after each pass.
+  constexpr int kWarmupTokenId = 0;
+  for (int length : GetWarmupPrefillLengths()) {
+    std::vector<int> ids(length, kWarmupTokenId);
+    LITERT_ASSIGN_OR_RETURN(auto ids_buffer,
+                            CopyToTensorBuffer<int>(ids, {1, length}));
+    RETURN_IF_ERROR(Prefill(ExecutorInputs(
+        ExecutorTextData(std::move(ids_buffer)), std::nullopt, std::nullopt)));
+    RETURN_IF_ERROR(Reset());
+  }
+
+  // A single-token prefill leaves the token pending, so the following decode
+  // consumes it without needing a sampler.
+  std::vector<int> ids = {kWarmupTokenId};
+  LITERT_ASSIGN_OR_RETURN(auto ids_buffer,
+                          CopyToTensorBuffer<int>(ids, {1, 1}));
+  RETURN_IF_ERROR(Prefill(ExecutorInputs(
+      ExecutorTextData(std::move(ids_buffer)), std::nullopt, std::nullopt)));
+  RETURN_IF_ERROR(DecodeLogits(ExecutorInputs()).status());
+  return Reset();
+}
+
 absl::StatusOr<int> LlmLiteRtCompiledModelExecutorBase::GetVocabSize() {
   if (!decode_output_buffers_.contains(signatures_.output_logits)) {
     return absl::NotFoundError("Output logits info not found.");
@@ -1510,6 +1547,16 @@ absl::Status LlmLiteRtCompiledModelExecutorStatic::Prefill(
   return absl::OkStatus();
 }
 
+std::vector<int>
+LlmLiteRtCompiledModelExecutorStatic::GetWarmupPrefillLengths() const {
+  std::vector<int> lengths;
+  lengths.reserve(prefill_signature_map_.size());
+  for (const auto& [length, signature] : prefill_signature_map_) {
+    lengths.push_back(length);
+  }
+  return lengths;
+}
+
 // static
 // Creates a LlmLiteRtCompiledModelExecutorStatic from a LiteRt model.
 absl::StatusOr<std::unique_ptr<LlmLiteRtCompiledModelExecutorStatic>>
@@ -1532,6 +1579,12 @@ LlmLiteRtCompiledModelExecutorStatic::Create(
   const Backend backend = executor_settings.GetBackend();
   bool use_fp16_precision = true;
   bool gpu_optimized_single_buffer_cache = false;
+  // The number of threads of the decode signature, if it is compiled
+  // separately from the prefill signatures.
+  std::optional<uint32_t> decode_num_threads;
+  // The weight cache file shared by the compiled models, when it is given as
+  // a file rather than a path. Each compiled model takes its own descriptor.
+  std::shared_ptr<ScopedFile> scoped_weight_cache_file;
 
   if (!litert_model || !*litert_model) {
     return absl::InternalError("Failed to build LiteRt model");
@@ -1726,9 +1779,21 @@ LlmLiteRtCompiledModelExecutorStatic::Create(
       use_fp16_precision = false;
       LITERT_ASSIGN_OR_RETURN(auto& cpu_compilation_options,
                               compilation_options.GetCpuOptions());
-      const uint32_t num_threads =
-          executor_settings.GetBackendConfig<CpuConfig>()->number_of_threads;
-      cpu_compilation_options.SetNumThreads(num_threads);
+      ASSIGN_OR_RETURN(const CpuConfig cpu_config,
+                       executor_settings.GetBackendConfig<CpuConfig>());
+      const uint32_t prefill_num_threads = GetPrefillNumThreads(cpu_config);
+      cpu_compilation_options.SetNumThreads(prefill_num_threads);
+      if (GetDecodeNumThreads(cpu_config) != prefill_num_threads) {
+        if (UsesSeparateDecodeCompiledModel(executor_settings)) {
+          decode_num_threads = GetDecodeNumThreads(cpu_config);
+        } else {
+          // Without the weight cache, a second compiled model would pack its
+          // own copy of the weights.
+          ABSL_LOG(WARNING) << "No XNNPack weight cache, so decode runs with "
+                            << "the " << prefill_num_threads
+                            << " threads of prefill.";
+        }
+      }
       auto weight_cache_file =
           executor_settings.GetWeightCacheFile(".xnnpack_cache");
       if (weight_cache_file.ok()) {
@@ -1736,9 +1801,10 @@ LlmLiteRtCompiledModelExecutorStatic::Create(
           cache_path = std::get<std::string>(*weight_cache_file);
           cpu_compilation_options.SetXNNPackWeightCachePath(cache_path.c_str());
         } else {
-          auto scoped_cache_file =
+          scoped_weight_cache_file =
               std::get<std::shared_ptr<ScopedFile>>(*weight_cache_file);
-          ASSIGN_OR_RETURN(auto duplicated, scoped_cache_file->Duplicate());
+          ASSIGN_OR_RETURN(auto duplicated,
+                           scoped_weight_cache_file->Duplicate());
           ASSIGN_OR_RETURN(int fd, duplicated.Release());
           cpu_compilation_options.SetXNNPackWeightCacheFileDescriptor(fd);
         }
@@ -1783,6 +1849,31 @@ LlmLiteRtCompiledModelExecutorStatic::Create(
       auto compiled_model,
       CompiledModel::Create(lrt_env, litert_model->Get(), compilation_options));
 
+  // The number of threads is fixed when the model is compiled, so the decode
+  // signature gets its own compiled model when it runs with another number of
+  // threads. Both compiled models load the packed weights from the same
+  // XNNPack weight cache, and are bound to the same buffers.
+  std::unique_ptr<CompiledModel> decode_compiled_model;
+  if (decode_num_threads.has_value()) {
+    ABSL_LOG(INFO) << "Compiling the decode signature with "
+                   << *decode_num_threads << " threads.";
+    LITERT_ASSIGN_OR_RETURN(auto& cpu_compilation_options,
+                            compilation_options.GetCpuOptions());
+    cpu_compilation_options.SetNumThreads(*decode_num_threads);
+    if (scoped_weight_cache_file != nullptr) {
+      ASSIGN_OR_RETURN(auto duplicated,
+                       scoped_weight_cache_file->Duplicate());
+      ASSIGN_OR_RETURN(int fd, duplicated.Release());
+      cpu_compilation_options.SetXNNPackWeightCacheFileDescriptor(fd);
+    }
+    LITERT_ASSIGN_OR_RETURN(auto decode_model,
+                            CompiledModel::Create(lrt_env, litert_model->Get(),
+                                                  compilation_options));
+    decode_compiled_model =
+        std::make_unique<CompiledModel>(std::move(decode_model));
+  }
+
+  // The drafter runs during decode, with the threads of the decode signature.
   LITERT_ASSIGN_OR_RETURN(
       std::unique_ptr<CompiledModel> mtp_drafter_compiled_model,
       LlmLiteRtCompiledModelExecutorBase::CreateMtpDrafterCompiledModel(
@@ -1945,13 +2036,18 @@ LlmLiteRtCompiledModelExecutorStatic::Create(
       signatures, batch_size, std::move(cache_path),
       std::move(embedding_lookup), std::move(per_layer_embedding_lookup),
       use_fp16_precision, activation_data_type,
-      std::move(mtp_drafter_compiled_model)));
+      std::move(mtp_drafter_compiled_model), std::move(decode_compiled_model)));
 }
 
 /* ===========================================================================*/
 /* LlmLiteRtCompiledModelExecutorDynamic */
 /* ===========================================================================*/
 
+std::vector<int>
+LlmLiteRtCompiledModelExecutorDynamic::GetWarmupPrefillLengths() const {
+  return {prefill_chunk_size_ > 0 ? prefill_chunk_size_ : 1};
+}
+
 absl::Status LlmLiteRtCompiledModelExecutorDynamic::Prefill(
     const ExecutorInputs& inputs, const ExecutorPrefillParams& params) {
 
@@ -2116,13 +2212,24 @@ absl::Status LlmLiteRtCompiledModelExecutorDynamic::DecodeInternal(
     current_kv_len = new_kv_len;
   }
 
-  RETURN_IF_ERROR(ResolveDynamicShape(model_, compiled_model_, "decode",
-                                      signatures_.input_attn_mask.value(),
-                                      current_kv_len));
-  LITERT_ASSIGN_OR_RETURN(
-      decode_input_buffers_[signatures_.input_attn_mask.value()],
-      compiled_model_.CreateInputBuffer("decode",
-                                        signatures_.input_attn_mask.value()));
+  // Only re-create the decode mask when the KV cache has grown, so that the
+  // incremental mask updates in the base class can be kept between steps.
+  auto& decode_mask =
+      decode_input_buffers_[signatures_.input_attn_mask.value()];
+  int decode_mask_len = -1;
+  if (decode_mask) {
+    LITERT_ASSIGN_OR_RETURN(auto decode_mask_type, decode_mask.TensorType());
+    decode_mask_len = decode_mask_type.Layout().Dimensions().back();
+  }
+  if (decode_mask_len != current_kv_len) {
+    RETURN_IF_ERROR(ResolveDynamicShape(model_, compiled_model_, "decode",
+                                        signatures_.input_attn_mask.value(),
+                                        current_kv_len));
+    LITERT_ASSIGN_OR_RETURN(
+        decode_mask, compiled_model_.CreateInputBuffer(
+                         "decode", signatures_.input_attn_mask.value()));
+    decode_attn_mask_visible_length_ = -1;
+  }
 
   return LlmLiteRtCompiledModelExecutorBase::DecodeInternal(token,
                                                             output_logits);
@@ -2150,7 +2257,14 @@ LlmLiteRtCompiledModelExecutorDynamic::Create(
                      executor_settings.GetBackendConfig<CpuConfig>());
     kv_increament_size = cpu_config.kv_increment_size;
     prefill_chunk_size = cpu_config.prefill_chunk_size;
-    cpu_compilation_options.SetNumThreads(cpu_config.number_of_threads);
+    // The decode signature is resized on the compiled model as the kv-cache
+    // grows, so both phases share one compiled model and its threads.
+    if (GetDecodeNumThreads(cpu_config) != GetPrefillNumThreads(cpu_config)) {
+      ABSL_LOG(WARNING) << "Dynamically shaped models run decode with the "
+                        << GetPrefillNumThreads(cpu_config)
+                        << " threads of prefill.";
+    }
+    cpu_compilation_options.SetNumThreads(GetPrefillNumThreads(cpu_config));
     auto weight_cache_file =
         executor_settings.GetWeightCacheFile(".xnnpack_cache");
     if (weight_cache_file.ok()) {
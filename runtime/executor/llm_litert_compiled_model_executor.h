@@ -108,6 +108,10 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
   // Resets all of the internal states.
   absl::Status Reset() override;
 
+  // Runs every prefill length returned by GetWarmupPrefillLengths() and one
+  // decode step on dummy token ids, resetting the executor after each pass.
+  absl::Status Warmup() override;
+
   absl::StatusOr<int> GetVocabSize() override;
 
   // Initializes the sampler.
@@ -143,7 +147,8 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
       std::unique_ptr<EmbeddingLookupManager> embedding_lookup,
       std::unique_ptr<EmbeddingLookupManager> per_layer_embedding_lookup,
       bool use_fp16_precision, LogitsDataType logits_data_type,
-      std::unique_ptr<CompiledModel> mtp_drafter_model)
+      std::unique_ptr<CompiledModel> mtp_drafter_model,
+      std::unique_ptr<CompiledModel> decode_compiled_model = nullptr)
       : executor_settings_(std::move(executor_settings)),
         env_(env),
         model_(*model),
@@ -162,7 +167,8 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
         per_layer_embedding_lookup_(std::move(per_layer_embedding_lookup)),
         use_fp16_precision_(use_fp16_precision),
         logits_data_type_(logits_data_type),
-        mtp_drafter_model_(std::move(mtp_drafter_model)) {
+        mtp_drafter_model_(std::move(mtp_drafter_model)),
+        decode_compiled_model_(std::move(decode_compiled_model)) {
     auto processed_context = std::make_unique<LlmProcessedContext>(
         std::nullopt, absl::flat_hash_map<absl::string_view, TensorBuffer>(),
         ProcessedTokens());
@@ -182,6 +188,14 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
   CreateMtpDrafterCompiledModel(ModelResources& resources, Environment& lrt_env,
                                 Options& compilation_options);
 
+  // Returns the prefill lengths exercised by Warmup(), one per distinct
+  // prefill graph the executor may run.
+  virtual std::vector<int> GetWarmupPrefillLengths() const { return {1}; }
+
+  // Returns whether a sampler that can handle input may fill the decode inputs
+  // and run the next decode step while sampling the current one.
+  virtual bool AllowsSamplerToHandleInput() const { return true; }
+
   // Rolls back the processed tokens to the current step.
   absl::Status RollBackProcessedTokens();
 
@@ -262,6 +276,12 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
   absl::Status ConsumePendingOrAddProcessedToken(
       const std::vector<std::shared_ptr<TokenData>>& token);
 
+  // Returns the compiled model running the decode signature.
+  CompiledModel& GetDecodeCompiledModel() {
+    return decode_compiled_model_ != nullptr ? *decode_compiled_model_
+                                             : compiled_model_;
+  }
+
   LlmExecutorSettings executor_settings_;
   Environment& env_;
   const Model& model_;
@@ -302,6 +322,11 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
   TensorBuffer decode_prev_input_pos_;
   TensorBuffer decode_prev_mask_;
 
+  // Number of leading positions already visible in the decode attention mask,
+  // or -1 if the mask must be re-initialized before the next decode step. It
+  // is invalidated whenever the mask buffer is replaced or written elsewhere.
+  int decode_attn_mask_visible_length_ = -1;
+
   // The path to the weight cache directory. Executor will take the ownership of
   // this path to maintain the path lifecycle.
   std::string weight_cache_path_;
@@ -324,6 +349,11 @@ class LlmLiteRtCompiledModelExecutorBase : public LlmExecutor {
 
   // The MTP drafter model.
   std::unique_ptr<CompiledModel> mtp_drafter_model_;
+
+  // The model compiled for the decode signature when it runs with another
+  // number of threads than the prefill signatures, or null to decode with
+  // compiled_model_.
+  std::unique_ptr<CompiledModel> decode_compiled_model_;
 };
 
 // The static executor for the prefill-decode compiled model.
@@ -363,7 +393,8 @@ class LlmLiteRtCompiledModelExecutorStatic
           nullptr,
       bool use_fp16_precision = true,
       LogitsDataType logits_data_type = LogitsDataType::FLOAT32,
-      std::unique_ptr<CompiledModel> mtp_drafter_model = nullptr)
+      std::unique_ptr<CompiledModel> mtp_drafter_model = nullptr,
+      std::unique_ptr<CompiledModel> decode_compiled_model = nullptr)
       : LlmLiteRtCompiledModelExecutorBase(
             std::move(executor_settings), env, model, std::move(compiled_model),
             std::move(decode_input_buffers), std::move(decode_output_buffers),
@@ -373,9 +404,13 @@ class LlmLiteRtCompiledModelExecutorStatic
             std::move(decode_output_kv_cache_buffers), signatures,
             output_batch_size, std::move(weight_cache_path),
             std::move(embedding_lookup), std::move(per_layer_embedding_lookup),
-            use_fp16_precision, logits_data_type, std::move(mtp_drafter_model)),
+            use_fp16_precision, logits_data_type, std::move(mtp_drafter_model),
+            std::move(decode_compiled_model)),
         prefill_signature_map_(std::move(prefill_signature_map)) {}
 
+  // Returns the length of every prefill signature.
+  std::vector<int> GetWarmupPrefillLengths() const override;
+
   SortedPrefillSignatureMap prefill_signature_map_;
   // Signature names are unique across all signatures in a model so it is safe
   // to refer to them by just their unique name.
@@ -439,6 +474,14 @@ class LlmLiteRtCompiledModelExecutorDynamic
   absl::Status PrefillInternal(absl::Span<int> ids,
                                const ExecutorPrefillParams& params);
 
+  // Returns the prefill chunk size, or a single token when prefill is not
+  // chunked.
+  std::vector<int> GetWarmupPrefillLengths() const override;
+
+  // The KV cache and the decode mask are resized before each decode step,
+  // which a decode run ahead by the sampler would skip.
+  bool AllowsSamplerToHandleInput() const override { return false; }
+
   // Extends the base class DecodeInternal to handle KV cache buffers.
   absl::Status DecodeInternal(
       const std::vector<std::shared_ptr<TokenData>>& token,
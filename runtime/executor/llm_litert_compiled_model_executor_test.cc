@@ -209,6 +209,106 @@ TEST(LlmLiteRtCompiledModelExecutorStaticTest, DecodeTest) {
   }
 }
 
+TEST(LlmLiteRtCompiledModelExecutorStaticTest, DecodeWithPerPhaseThreadsTest) {
+  // The decode compiled model shares the packed weights through the weight
+  // cache, without which decode runs on the prefill compiled model.
+  auto cache_path = std::filesystem::path(::testing::TempDir()) /
+                    absl::StrCat("cache-", std::rand());
+  std::filesystem::remove_all(cache_path);
+  absl::Cleanup remove_cache = [cache_path] {
+    std::filesystem::remove_all(cache_path);
+  };
+
+  auto model_path =
+      std::filesystem::path(::testing::SrcDir()) / kTestStaticModelPath;
+  ASSERT_OK_AND_ASSIGN(auto model_resources,
+                       CreateExecutorModelResourcesTask(model_path.string()));
+  ASSERT_OK_AND_ASSIGN(auto model_assets,
+                       ModelAssets::Create(model_path.string()));
+  auto executor_settings =
+      LlmExecutorSettings::CreateDefault(model_assets, Backend::CPU);
+  executor_settings->SetCacheDir(cache_path.string());
+  executor_settings->SetMaxNumTokens(kMaxNumTokens);
+  ::litert::lm::CpuConfig config;
+  config.number_of_threads = kNumThreads;
+  config.prefill_number_of_threads = kNumThreads;
+  config.decode_number_of_threads = 1;
+  executor_settings->SetBackendConfig(config);
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto env, Environment::Create(std::vector<Environment::Option>()));
+  ASSERT_OK_AND_ASSIGN(auto executor,
+                       LlmLiteRtCompiledModelExecutorStatic::Create(
+                           *executor_settings, env, *model_resources));
+  ASSERT_NE(executor, nullptr);
+
+  ExecutorInputs inputs;
+  const std::vector<int> input_tokens = {1, 2, 0};
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto input_tokens_buffer,
+      CopyToTensorBuffer<int>(absl::MakeSpan(input_tokens), {1, 3}));
+  inputs.SetTextData(ExecutorTextData(std::move(input_tokens_buffer)));
+  EXPECT_OK(executor->Prefill(inputs));
+
+  // The decode signature sees the kv-cache written by prefill, so the tokens
+  // are the same as with a single number of threads.
+  LITERT_ASSERT_OK_AND_ASSIGN(auto output_tokens,
+                              CreateTensorBuffer<int>({1, 1}));
+  EXPECT_OK(executor->Decode(output_tokens));
+  auto output_tokens_span = ReferTensorBufferAsSpan<int>(output_tokens);
+  EXPECT_EQ((*output_tokens_span)[0], 8005);
+
+  EXPECT_OK(executor->Decode(output_tokens));
+  output_tokens_span = ReferTensorBufferAsSpan<int>(output_tokens);
+  EXPECT_EQ((*output_tokens_span)[0], 52530);
+}
+
+TEST(LlmLiteRtCompiledModelExecutorStaticTest, DecodeToEndOfContextTest) {
+  auto model_path =
+      std::filesystem::path(::testing::SrcDir()) / kTestStaticModelPath;
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto env, Environment::Create(std::vector<Environment::Option>()));
+  // The last position of the context must be decodable whether or not the
+  // sampler runs each next decode step ahead.
+  std::vector<int> num_decoded_steps;
+  for (bool sampler_handles_input : {true, false}) {
+    ASSERT_OK_AND_ASSIGN(auto model_resources,
+                         CreateExecutorModelResourcesTask(model_path.string()));
+    ASSERT_OK_AND_ASSIGN(auto model_assets,
+                         ModelAssets::Create(model_path.string()));
+    auto executor_settings =
+        LlmExecutorSettings::CreateDefault(model_assets, Backend::CPU);
+    executor_settings->SetCacheDir(":nocache");
+    executor_settings->SetMaxNumTokens(kMaxNumTokens);
+    ::litert::lm::CpuConfig config;
+    config.number_of_threads = kNumThreads;
+    executor_settings->SetBackendConfig(config);
+    AdvancedSettings advanced_settings;
+    advanced_settings.sampler_handles_input = sampler_handles_input;
+    executor_settings->SetAdvancedSettings(advanced_settings);
+    ASSERT_OK_AND_ASSIGN(auto executor,
+                         LlmLiteRtCompiledModelExecutorStatic::Create(
+                             *executor_settings, env, *model_resources));
+
+    ExecutorInputs inputs;
+    const std::vector<int> input_tokens = {1, 2, 0};
+    LITERT_ASSERT_OK_AND_ASSIGN(
+        auto input_tokens_buffer,
+        CopyToTensorBuffer<int>(absl::MakeSpan(input_tokens), {1, 3}));
+    inputs.SetTextData(ExecutorTextData(std::move(input_tokens_buffer)));
+    ASSERT_OK(executor->Prefill(inputs));
+
+    LITERT_ASSERT_OK_AND_ASSIGN(auto output_tokens,
+                                CreateTensorBuffer<int>({1, 1}));
+    int num_steps = 0;
+    while (num_steps < 4096 && executor->Decode(output_tokens).ok()) {
+      ++num_steps;
+    }
+    ASSERT_LT(num_steps, 4096);
+    num_decoded_steps.push_back(num_steps);
+  }
+  EXPECT_EQ(num_decoded_steps[0], num_decoded_steps[1]);
+}
+
 TEST(LlmLiteRtCompiledModelExecutorStaticTest, ConstrainedDecodeTest) {
   auto model_path =
       std::filesystem::path(::testing::SrcDir()) / kTestStaticModelPath;
@@ -789,7 +889,8 @@ absl::StatusOr<
               std::unique_ptr<LlmLiteRtCompiledModelExecutorDynamic>>>
 CreateDynamicExecutor(Environment& env, absl::string_view model_path,
                       uint32_t kv_increment_size = 8,
-                      int prefill_chunk_size = -1) {
+                      int prefill_chunk_size = -1,
+                      bool sampler_handles_input = true) {
   auto path = std::filesystem::path(::testing::SrcDir()) / model_path;
   ASSIGN_OR_RETURN(auto model_resources,
                    CreateExecutorModelResourcesLitertLm(path.string()));
@@ -803,6 +904,9 @@ CreateDynamicExecutor(Environment& env, absl::string_view model_path,
   config.kv_increment_size = kv_increment_size;
   config.prefill_chunk_size = prefill_chunk_size;
   executor_settings->SetBackendConfig(config);
+  AdvancedSettings advanced_settings;
+  advanced_settings.sampler_handles_input = sampler_handles_input;
+  executor_settings->SetAdvancedSettings(advanced_settings);
   ASSIGN_OR_RETURN(auto executor,
                    LlmLiteRtCompiledModelExecutorDynamic::Create(
                        *executor_settings, env, *model_resources));
@@ -870,5 +974,42 @@ TEST(LlmLiteRtCompiledModelExecutorDynamicTest, DecodeTest) {
   }
 }
 
+TEST(LlmLiteRtCompiledModelExecutorDynamicTest,
+     DecodeAcrossKvCacheGrowthMatchesExecutorDecode) {
+  LITERT_ASSERT_OK_AND_ASSIGN(
+      auto env, Environment::Create(std::vector<Environment::Option>()));
+  // The dynamic executor resizes the KV cache every 8 steps. The decoded tokens
+  // must not depend on whether the sampler is allowed to handle the input.
+  std::vector<std::vector<int>> decoded_tokens;
+  for (bool sampler_handles_input : {true, false}) {
+    ASSERT_OK_AND_ASSIGN(
+        auto p, CreateDynamicExecutor(env, kTestDynamicModelPath,
+                                      /*kv_increment_size=*/8,
+                                      /*prefill_chunk_size=*/-1,
+                                      sampler_handles_input));
+    auto& [model_resources, executor] = p;
+
+    ExecutorInputs inputs;
+    const std::vector<int> input_tokens = {1, 2, 0};
+    LITERT_ASSERT_OK_AND_ASSIGN(
+        auto input_tokens_buffer,
+        CopyToTensorBuffer<int>(absl::MakeSpan(input_tokens), {1, 3}));
+    inputs.SetTextData(ExecutorTextData(std::move(input_tokens_buffer)));
+    ASSERT_OK(executor->Prefill(inputs));
+
+    LITERT_ASSERT_OK_AND_ASSIGN(auto output_tokens,
+                                CreateTensorBuffer<int>({1}));
+    std::vector<int>& tokens = decoded_tokens.emplace_back();
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_OK(executor->Decode(output_tokens));
+      ASSERT_OK_AND_ASSIGN(auto current_step, executor->GetCurrentStep());
+      EXPECT_EQ(current_step, input_tokens.size() + (i + 1));
+      auto output_tokens_span = ReferTensorBufferAsSpan<int>(output_tokens);
+      tokens.push_back((*output_tokens_span)[0]);
+    }
+  }
+  EXPECT_EQ(decoded_tokens[0], decoded_tokens[1]);
+}
+
 }  // namespace
 }  // namespace litert::lm
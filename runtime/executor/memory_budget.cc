@@ -0,0 +1,303 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/memory_budget.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <ostream>
+#include <utility>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "absl/strings/match.h"  // from @com_google_absl
+#include "absl/strings/str_cat.h"  // from @com_google_absl
+#include "absl/strings/string_view.h"  // from @com_google_absl
+#include "absl/types/span.h"  // from @com_google_absl
+#include "litert/cc/litert_element_type.h"  // from @litert
+#include "litert/cc/litert_macros.h"  // from @litert
+#include "litert/cc/litert_model.h"  // from @litert
+#include "runtime/components/model_resources.h"
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_executor_settings.h"
+#include "runtime/executor/llm_litert_compiled_model_cache_utils.h"
+#include "runtime/util/status_macros.h"  // NOLINT
+
+namespace litert::lm {
+namespace {
+
+constexpr absl::string_view kDecodeSignaturePrefix = "decode";
+constexpr absl::string_view kMaskSubstr = "mask";
+constexpr int kDynamicDimValue = -1;
+
+// Share of the memory left after the weights that is set aside for the
+// transient activations of a prefill chunk.
+constexpr int64_t kPrefillActivationShareDivisor = 8;
+// Prefill activations of one token (Q/K/V projections, the MLP intermediate)
+// are estimated as a multiple of its KV cache entries, which scale with the
+// same number of layers and hidden size.
+constexpr int64_t kPrefillActivationBytesPerKvByte = 4;
+constexpr int kPrefillChunkAlignment = 32;
+constexpr int kKvIncrementAlignment = 16;
+constexpr int kMaxKvIncrementSize = 256;
+// Below this context length the engine is not useful, so the budget is
+// rejected instead.
+constexpr int kMinNumTokens = 128;
+
+int RoundDown(int64_t value, int multiple) {
+  return static_cast<int>(value / multiple * multiple);
+}
+
+// Returns the size of one element in bits, or nullopt for unknown types.
+std::optional<int> ElementBits(::litert::ElementType type) {
+  switch (type) {
+    case ::litert::ElementType::Bool:
+    case ::litert::ElementType::Int8:
+    case ::litert::ElementType::UInt8:
+      return 8;
+    case ::litert::ElementType::Int4:
+      return 4;
+    case ::litert::ElementType::Float16:
+    case ::litert::ElementType::BFloat16:
+    case ::litert::ElementType::Int16:
+    case ::litert::ElementType::UInt16:
+      return 16;
+    case ::litert::ElementType::Float32:
+    case ::litert::ElementType::Int32:
+    case ::litert::ElementType::UInt32:
+      return 32;
+    case ::litert::ElementType::Float64:
+    case ::litert::ElementType::Int64:
+    case ::litert::ElementType::UInt64:
+      return 64;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Returns the index of the token dimension of a KV cache tensor: the dynamic
+// dimension if there is one, otherwise the dimension matching the context
+// length, otherwise the largest one.
+int TokenDimIndex(absl::Span<const int32_t> dims, int context_length) {
+  int largest = 0;
+  for (int i = 0; i < dims.size(); ++i) {
+    if (dims[i] == kDynamicDimValue) return i;
+    if (dims[i] > dims[largest]) largest = i;
+  }
+  if (context_length > 0) {
+    for (int i = 0; i < dims.size(); ++i) {
+      if (dims[i] == context_length) return i;
+    }
+  }
+  return largest;
+}
+
+}  // namespace
+
+std::ostream& operator<<(std::ostream& os, const ModelMemoryProfile& profile) {
+  os << "weight_bytes: " << profile.weight_bytes
+     << ", kv_cache_bytes_per_token: " << profile.kv_cache_bytes_per_token
+     << ", fixed_context_length: " << profile.fixed_context_length
+     << ", num_compiled_models: " << profile.num_compiled_models;
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const MemoryBudgetPlan& plan) {
+  os << "max_num_tokens: " << plan.max_num_tokens
+     << ", prefill_chunk_size: " << plan.prefill_chunk_size
+     << ", kv_increment_size: " << plan.kv_increment_size
+     << ", max_resident_contexts: " << plan.max_resident_contexts
+     << ", estimated_peak_bytes: " << plan.estimated_peak_bytes;
+  return os;
+}
+
+absl::StatusOr<ModelMemoryProfile> GetModelMemoryProfile(
+    ModelResources& model_resources) {
+  ASSIGN_OR_RETURN(
+      absl::string_view model_buffer,
+      model_resources.GetTFLiteModelBuffer(ModelType::kTfLitePrefillDecode));
+  int64_t weight_bytes = model_buffer.size();
+  // Weights stored in a separate section are not part of the model buffer.
+  auto weights_section = model_resources.GetWeightsSectionOffset(
+      ModelType::kTfLitePrefillDecode);
+  if (weights_section.ok()) {
+    weight_bytes += weights_section->second - weights_section->first;
+  }
+  ASSIGN_OR_RETURN(
+      const ::litert::Model* model,
+      model_resources.GetTFLiteModel(ModelType::kTfLitePrefillDecode));
+  return GetModelMemoryProfile(*model, weight_bytes);
+}
+
+absl::StatusOr<ModelMemoryProfile> GetModelMemoryProfile(
+    const ::litert::Model& model, int64_t weight_bytes) {
+  std::optional<::litert::SimpleSignature> decode_signature;
+  for (int i = 0; i < model.GetNumSignatures(); ++i) {
+    LITERT_ASSIGN_OR_RETURN(auto signature, model.GetSignature(i));
+    if (signature.Key().starts_with(kDecodeSignaturePrefix)) {
+      decode_signature = std::move(signature);
+      break;
+    }
+  }
+  if (!decode_signature.has_value()) {
+    return absl::NotFoundError("The model has no decode signature.");
+  }
+
+  // The last dimension of the attention mask is the KV cache length.
+  int context_length = 0;
+  for (const auto& input_name : decode_signature->InputNames()) {
+    if (!absl::StrContains(input_name, kMaskSubstr)) continue;
+    LITERT_ASSIGN_OR_RETURN(const auto& tensor,
+                            decode_signature->InputTensor(input_name));
+    LITERT_ASSIGN_OR_RETURN(const auto type, tensor.RankedTensorType());
+    const auto& layout = type.Layout();
+    if (layout.Rank() > 0) {
+      context_length = std::max(0, layout.Dimensions()[layout.Rank() - 1]);
+    }
+    break;
+  }
+
+  ModelMemoryProfile profile{.weight_bytes = weight_bytes};
+  bool has_dynamic_kv_cache = false;
+  for (const auto& input_name : decode_signature->InputNames()) {
+    if (!IsKVCacheTensor(input_name)) continue;
+    LITERT_ASSIGN_OR_RETURN(const auto& tensor,
+                            decode_signature->InputTensor(input_name));
+    LITERT_ASSIGN_OR_RETURN(const auto type, tensor.RankedTensorType());
+    std::optional<int> bits = ElementBits(type.ElementType());
+    if (!bits.has_value()) {
+      return absl::UnimplementedError(
+          absl::StrCat("Unsupported element type for KV cache tensor ",
+                       input_name, "."));
+    }
+    const auto dims = type.Layout().Dimensions();
+    const int token_dim = TokenDimIndex(dims, context_length);
+    has_dynamic_kv_cache |= dims[token_dim] == kDynamicDimValue;
+    int64_t bits_per_token = *bits;
+    for (int i = 0; i < dims.size(); ++i) {
+      if (i != token_dim) bits_per_token *= std::max(1, dims[i]);
+    }
+    profile.kv_cache_bytes_per_token += (bits_per_token + 7) / 8;
+  }
+  if (profile.kv_cache_bytes_per_token == 0) {
+    return absl::NotFoundError(
+        "The decode signature has no KV cache inputs.");
+  }
+  if (!has_dynamic_kv_cache) {
+    profile.fixed_context_length = context_length;
+  }
+  return profile;
+}
+
+absl::StatusOr<MemoryBudgetPlan> PlanMemoryBudget(
+    int64_t budget_bytes, const ModelMemoryProfile& profile,
+    int requested_max_num_tokens) {
+  if (budget_bytes <= 0) {
+    return absl::InvalidArgumentError("Memory budget must be positive.");
+  }
+  RET_CHECK_GT(profile.kv_cache_bytes_per_token, 0);
+  const int64_t available_bytes = budget_bytes - profile.weight_bytes;
+  if (available_bytes <= 0) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Memory budget of ", budget_bytes, " bytes cannot hold the ",
+        profile.weight_bytes, " bytes of model weights."));
+  }
+  const int64_t per_token = profile.kv_cache_bytes_per_token;
+
+  MemoryBudgetPlan plan;
+  // Every compiled model holds the activations of a prefill chunk.
+  const int64_t activation_bytes_per_token =
+      per_token * kPrefillActivationBytesPerKvByte *
+      std::max(1, profile.num_compiled_models);
+  plan.prefill_chunk_size = std::max(
+      kPrefillChunkAlignment,
+      RoundDown(available_bytes / kPrefillActivationShareDivisor /
+                    activation_bytes_per_token,
+                kPrefillChunkAlignment));
+
+  int64_t context_limit = std::numeric_limits<int>::max();
+  if (requested_max_num_tokens > 0) {
+    context_limit = requested_max_num_tokens;
+  }
+  if (profile.fixed_context_length > 0) {
+    context_limit = std::min<int64_t>(context_limit,
+                                      profile.fixed_context_length);
+  }
+  plan.prefill_chunk_size =
+      static_cast<int>(std::min<int64_t>(plan.prefill_chunk_size,
+                                         context_limit));
+
+  const int64_t kv_bytes =
+      available_bytes -
+      int64_t{plan.prefill_chunk_size} * activation_bytes_per_token;
+  int64_t fitting_tokens = std::max<int64_t>(0, kv_bytes / per_token);
+  // A statically sized KV cache is allocated in full whatever max_num_tokens
+  // is, so it either fits or it does not.
+  const int64_t min_tokens = profile.fixed_context_length > 0
+                                 ? profile.fixed_context_length
+                                 : std::min<int64_t>(kMinNumTokens,
+                                                     context_limit);
+  if (fitting_tokens < min_tokens) {
+    return absl::ResourceExhaustedError(absl::StrCat(
+        "Memory budget of ", budget_bytes, " bytes leaves room for ",
+        fitting_tokens, " KV cache tokens, but at least ", min_tokens,
+        " are needed."));
+  }
+  if (profile.fixed_context_length == 0) {
+    fitting_tokens = std::max<int64_t>(
+        min_tokens, RoundDown(fitting_tokens, kKvIncrementAlignment));
+  }
+  plan.max_num_tokens =
+      static_cast<int>(std::min<int64_t>(fitting_tokens, context_limit));
+
+  const int64_t context_bytes =
+      per_token * (profile.fixed_context_length > 0
+                       ? profile.fixed_context_length
+                       : plan.max_num_tokens);
+  plan.max_resident_contexts =
+      static_cast<int>(std::min<int64_t>(kv_bytes / context_bytes,
+                                         std::numeric_limits<int>::max()));
+
+  // Growing a dynamic KV cache reallocates it, so grow in larger steps when
+  // the context is long, but never past the budgeted length.
+  plan.kv_increment_size = std::clamp(
+      RoundDown(plan.max_num_tokens / 32, kKvIncrementAlignment),
+      kKvIncrementAlignment, kMaxKvIncrementSize);
+
+  plan.estimated_peak_bytes =
+      profile.weight_bytes +
+      int64_t{plan.prefill_chunk_size} * activation_bytes_per_token +
+      int64_t{plan.max_resident_contexts} * context_bytes;
+  return plan;
+}
+
+absl::Status ApplyMemoryBudgetPlan(const MemoryBudgetPlan& plan,
+                                   LlmExecutorSettings& executor_settings) {
+  RET_CHECK_GT(plan.max_num_tokens, 0);
+  executor_settings.SetMaxNumTokens(plan.max_num_tokens);
+  if (executor_settings.GetBackend() == Backend::CPU) {
+    auto cpu_config = executor_settings.GetBackendConfig<CpuConfig>();
+    if (cpu_config.ok()) {
+      CpuConfig config = *cpu_config;
+      config.prefill_chunk_size = plan.prefill_chunk_size;
+      config.kv_increment_size = plan.kv_increment_size;
+      executor_settings.SetBackendConfig(config);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace litert::lm
@@ -0,0 +1,91 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_MEMORY_BUDGET_H_
+#define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_MEMORY_BUDGET_H_
+
+#include <cstdint>
+#include <ostream>
+
+#include "absl/status/status.h"  // from @com_google_absl
+#include "absl/status/statusor.h"  // from @com_google_absl
+#include "litert/cc/litert_model.h"  // from @litert
+#include "runtime/components/model_resources.h"
+#include "runtime/executor/llm_executor_settings.h"
+
+namespace litert::lm {
+
+// The memory footprint of a model, read from its tensor sizes.
+struct ModelMemoryProfile {
+  // Size of the model weights.
+  int64_t weight_bytes = 0;
+  // Size of the KV cache entries of one token, summed over all layers.
+  int64_t kv_cache_bytes_per_token = 0;
+  // Number of tokens the KV cache is statically sized for, or 0 if the model
+  // grows its KV cache at runtime and max_num_tokens can be chosen freely.
+  int fixed_context_length = 0;
+  // Number of compiled models of the executor. They share the weights, but
+  // each allocates its own activations.
+  int num_compiled_models = 1;
+};
+
+std::ostream& operator<<(std::ostream& os, const ModelMemoryProfile& profile);
+
+// Executor sizing derived from a memory budget.
+struct MemoryBudgetPlan {
+  // Upper bound on the number of tokens held in the KV cache.
+  int max_num_tokens = 0;
+  // Number of tokens processed per prefill call. Always set.
+  int prefill_chunk_size = 0;
+  // Number of tokens the KV cache grows by at a time. Only meaningful for
+  // models with a dynamic KV cache.
+  int kv_increment_size = 0;
+  // Number of session contexts that fit in the budget, including the one
+  // loaded in the executor. Every other session keeps a full copy of its KV
+  // cache while it is swapped out.
+  int max_resident_contexts = 1;
+  // Expected peak memory usage with `max_resident_contexts` sessions.
+  int64_t estimated_peak_bytes = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, const MemoryBudgetPlan& plan);
+
+// Reads the weight size and the per-token KV cache size from the decode
+// signature of the prefill/decode model.
+absl::StatusOr<ModelMemoryProfile> GetModelMemoryProfile(
+    ModelResources& model_resources);
+
+// Same as above, for an already loaded model. `weight_bytes` is the size of
+// the model buffer.
+absl::StatusOr<ModelMemoryProfile> GetModelMemoryProfile(
+    const ::litert::Model& model, int64_t weight_bytes);
+
+// Splits `budget_bytes` between the weights, the prefill activations and the
+// KV caches of the resident session contexts. `requested_max_num_tokens`
+// caps the context length (0 means no cap); the plan only ever lowers it.
+// Returns RESOURCE_EXHAUSTED if the budget cannot hold the weights and one
+// context of a useful length.
+absl::StatusOr<MemoryBudgetPlan> PlanMemoryBudget(
+    int64_t budget_bytes, const ModelMemoryProfile& profile,
+    int requested_max_num_tokens);
+
+// Applies `plan` to the executor settings. The prefill chunk size and the KV
+// increment size only apply to the CPU backend and are left untouched for
+// the others.
+absl::Status ApplyMemoryBudgetPlan(const MemoryBudgetPlan& plan,
+                                   LlmExecutorSettings& executor_settings);
+
+}  // namespace litert::lm
+
+#endif  // THIRD_PARTY_ODML_LITERT_LM_RUNTIME_EXECUTOR_MEMORY_BUDGET_H_
@@ -0,0 +1,135 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "runtime/executor/memory_budget.h"
+
+#include <cstdint>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"  // from @com_google_absl
+#include "runtime/executor/executor_settings_base.h"
+#include "runtime/executor/llm_executor_settings.h"
+#include "runtime/util/test_utils.h"  // IWYU pragma: keep
+
+namespace litert::lm {
+namespace {
+
+using ::testing::status::StatusIs;
+
+constexpr int64_t kMiB = 1024 * 1024;
+
+// 1 GiB of weights and 64 KiB of KV cache per token.
+ModelMemoryProfile DynamicProfile() {
+  return ModelMemoryProfile{
+      .weight_bytes = 1024 * kMiB,
+      .kv_cache_bytes_per_token = 64 * 1024,
+  };
+}
+
+TEST(MemoryBudgetTest, PlanFitsWithinBudget) {
+  const int64_t budget = 2048 * kMiB;
+  ASSERT_OK_AND_ASSIGN(
+      MemoryBudgetPlan plan,
+      PlanMemoryBudget(budget, DynamicProfile(),
+                       /*requested_max_num_tokens=*/4096));
+  EXPECT_EQ(plan.max_num_tokens, 4096);
+  EXPECT_GT(plan.prefill_chunk_size, 0);
+  EXPECT_EQ(plan.prefill_chunk_size % 32, 0);
+  EXPECT_EQ(plan.kv_increment_size % 16, 0);
+  // 256 MiB per context, about 7/8 of the remaining 1 GiB left for KV caches.
+  EXPECT_EQ(plan.max_resident_contexts, 3);
+  EXPECT_LE(plan.estimated_peak_bytes, budget);
+}
+
+TEST(MemoryBudgetTest, SmallerBudgetShortensContext) {
+  ASSERT_OK_AND_ASSIGN(
+      MemoryBudgetPlan plan,
+      PlanMemoryBudget(1024 * kMiB + 64 * kMiB, DynamicProfile(),
+                       /*requested_max_num_tokens=*/4096));
+  EXPECT_LT(plan.max_num_tokens, 4096);
+  EXPECT_GE(plan.max_num_tokens, 128);
+  EXPECT_EQ(plan.max_resident_contexts, 1);
+  EXPECT_LE(plan.estimated_peak_bytes, 1024 * kMiB + 64 * kMiB);
+}
+
+TEST(MemoryBudgetTest, UncappedContextUsesWholeBudget) {
+  ASSERT_OK_AND_ASSIGN(
+      MemoryBudgetPlan plan,
+      PlanMemoryBudget(2048 * kMiB, DynamicProfile(),
+                       /*requested_max_num_tokens=*/0));
+  EXPECT_GT(plan.max_num_tokens, 4096);
+  EXPECT_EQ(plan.max_resident_contexts, 1);
+  EXPECT_EQ(plan.kv_increment_size, 256);
+}
+
+TEST(MemoryBudgetTest, FixedContextIsChargedInFull) {
+  ModelMemoryProfile profile = DynamicProfile();
+  profile.fixed_context_length = 4096;
+  // Room for about 2300 tokens only: a static 4096 token cache does not fit.
+  EXPECT_THAT(PlanMemoryBudget(1024 * kMiB + 160 * kMiB, profile,
+                               /*requested_max_num_tokens=*/1024),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+
+  ASSERT_OK_AND_ASSIGN(MemoryBudgetPlan plan,
+                       PlanMemoryBudget(2048 * kMiB, profile,
+                                        /*requested_max_num_tokens=*/1024));
+  EXPECT_EQ(plan.max_num_tokens, 1024);
+  EXPECT_EQ(plan.max_resident_contexts, 3);
+}
+
+TEST(MemoryBudgetTest, SeparateDecodeModelHoldsItsOwnActivations) {
+  ASSERT_OK_AND_ASSIGN(
+      MemoryBudgetPlan single_model_plan,
+      PlanMemoryBudget(2048 * kMiB, DynamicProfile(),
+                       /*requested_max_num_tokens=*/4096));
+  ModelMemoryProfile profile = DynamicProfile();
+  profile.num_compiled_models = 2;
+  ASSERT_OK_AND_ASSIGN(MemoryBudgetPlan plan,
+                       PlanMemoryBudget(2048 * kMiB, profile,
+                                        /*requested_max_num_tokens=*/4096));
+  // The same share of the budget holds the activations of both models.
+  EXPECT_EQ(plan.prefill_chunk_size, single_model_plan.prefill_chunk_size / 2);
+  EXPECT_EQ(plan.max_resident_contexts,
+            single_model_plan.max_resident_contexts);
+  EXPECT_LE(plan.estimated_peak_bytes, 2048 * kMiB);
+}
+
+TEST(MemoryBudgetTest, BudgetSmallerThanWeightsFails) {
+  EXPECT_THAT(PlanMemoryBudget(512 * kMiB, DynamicProfile(),
+                               /*requested_max_num_tokens=*/4096),
+              StatusIs(absl::StatusCode::kResourceExhausted));
+  EXPECT_THAT(PlanMemoryBudget(0, DynamicProfile(),
+                               /*requested_max_num_tokens=*/4096),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(MemoryBudgetTest, ApplyUpdatesCpuSettings) {
+  ASSERT_OK_AND_ASSIGN(auto model_assets, ModelAssets::Create("model.tflite"));
+  ASSERT_OK_AND_ASSIGN(
+      auto settings,
+      LlmExecutorSettings::CreateDefault(model_assets, Backend::CPU));
+  MemoryBudgetPlan plan{.max_num_tokens = 2048,
+                        .prefill_chunk_size = 256,
+                        .kv_increment_size = 64,
+                        .max_resident_contexts = 2};
+  ASSERT_OK(ApplyMemoryBudgetPlan(plan, settings));
+  EXPECT_EQ(settings.GetMaxNumTokens(), 2048);
+  ASSERT_OK_AND_ASSIGN(auto cpu_config, settings.GetBackendConfig<CpuConfig>());
+  EXPECT_EQ(cpu_config.prefill_chunk_size, 256);
+  EXPECT_EQ(cpu_config.kv_increment_size, 64);
+}
+
+}  // namespace
+}  // namespace litert::lm
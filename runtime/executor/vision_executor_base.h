@@ -55,6 +55,13 @@ class VisionExecutorBase {
   virtual absl::StatusOr<std::vector<int>> GetExpectedInputDimension()
       const = 0;
 
+  // Runs the encoder once on a blank image of the expected input dimension so
+  // that lazily created buffers and kernel caches are ready before the first
+  // request.
+  virtual absl::Status Warmup() {
+    return absl::UnimplementedError("Not implemented.");
+  }
+
   // Get the vision executor properties.
   virtual absl::StatusOr<VisionExecutorProperties> GetVisionExecutorProperties()
       const {
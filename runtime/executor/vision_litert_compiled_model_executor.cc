@@ -361,6 +361,20 @@ VisionLiteRtCompiledModelExecutor::GetExpectedInputDimension() const {
   return expected_input_dimension_;
 }
 
+absl::Status VisionLiteRtCompiledModelExecutor::Warmup() {
+  int num_elements = 1;
+  for (int dim : expected_input_dimension_) {
+    num_elements *= dim;
+  }
+  std::vector<float> blank_image(num_elements, 0.0f);
+  LITERT_ASSIGN_OR_RETURN(
+      auto image_tensor,
+      CopyToTensorBuffer<float>(
+          blank_image, Dimensions(expected_input_dimension_.begin(),
+                                  expected_input_dimension_.end())));
+  return Encode(image_tensor).status();
+}
+
 absl::StatusOr<ExecutorVisionData> VisionLiteRtCompiledModelExecutor::Encode(
     const absl::flat_hash_map<std::string, litert::TensorBuffer>& input_maps) {
 
@@ -68,6 +68,10 @@ class VisionLiteRtCompiledModelExecutor : public VisionExecutor {
   absl::StatusOr<VisionExecutorProperties> GetVisionExecutorProperties()
       const override;
 
+  // Encodes a blank image of the expected input dimension and discards the
+  // result.
+  absl::Status Warmup() override;
+
  private:
   // The Vision Encoder LiteRT CompiledModel wrapper manage the input and
   // output buffers of the vision encoder model. It is not expected to be used
@@ -14,6 +14,7 @@
 
 #include "runtime/framework/resource_management/execution_manager.h"
 
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <optional>
@@ -40,6 +41,7 @@
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "litert/cc/litert_macros.h"  // from @litert
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
+#include "runtime/components/constrained_decoding/bitmap.h"
 #include "runtime/components/constrained_decoding/constraint.h"
 #include "runtime/components/model_resources.h"
 #include "runtime/components/sampler.h"
@@ -47,6 +49,7 @@
 #include "runtime/components/stop_token_detector.h"
 #include "runtime/components/tokenizer.h"
 #include "runtime/core/tasks.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor_settings.h"
@@ -62,6 +65,57 @@
 #include "runtime/util/tensor_buffer_util.h"
 
 namespace litert::lm {
+namespace {
+
+// Forwards to another constraint and records the time spent computing the
+// allowed tokens in `latency`.
+class TimedConstraint : public Constraint {
+ public:
+  TimedConstraint(const Constraint& constraint, Histogram& latency)
+      : constraint_(constraint), latency_(latency) {}
+
+  std::unique_ptr<State> Start() const override { return constraint_.Start(); }
+
+  bool IsEnded(const State& state) const override {
+    return constraint_.IsEnded(state);
+  }
+
+  int GetVocabularySize() const override {
+    return constraint_.GetVocabularySize();
+  }
+
+  absl::StatusOr<std::unique_ptr<State>> ComputeNext(const State& state,
+                                                     int token) const override {
+    const absl::Time start = absl::Now();
+    auto next = constraint_.ComputeNext(state, token);
+    latency_.ObserveDuration(absl::Now() - start);
+    return next;
+  }
+
+  absl::StatusOr<std::unique_ptr<Bitmap>> ComputeBitmap(
+      const State& state) const override {
+    const absl::Time start = absl::Now();
+    auto bitmap = constraint_.ComputeBitmap(state);
+    latency_.ObserveDuration(absl::Now() - start);
+    return bitmap;
+  }
+
+ private:
+  const Constraint& constraint_;
+  Histogram& latency_;
+};
+
+// Records the number of tokens the executor advanced by since `start_step`,
+// and the number of tokens now held in its KV cache.
+void RecordExecutorProgress(LlmExecutor& executor, int start_step,
+                            Counter& tokens, Gauge& kv_cache_tokens) {
+  auto current_step = executor.GetCurrentStep();
+  if (!current_step.ok()) return;
+  if (*current_step > start_step) tokens.Increment(*current_step - start_step);
+  kv_cache_tokens.Set(*current_step);
+}
+
+}  // namespace
 
 // Helper macro to check if the task has been cancelled.
 #define RETURN_IF_CANCELLED(cancelled, task_id, callback)             \
@@ -89,11 +143,11 @@ absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
   }
   auto stop_token_detector = std::make_unique<StopTokenDetector>(1);
   for (const auto& stop_token_sequence : session_config.GetStopTokenIds()) {
-    auto status =
-        stop_token_detector->AddStopTokenSequence(stop_token_sequence);
-    if (!status.ok()) {
-      ABSL_LOG(ERROR) << "Failed to add stop token sequence: " << status;
-    }
+    RETURN_IF_ERROR(
+        stop_token_detector->AddStopTokenSequence(stop_token_sequence));
+  }
+  for (const auto& stop_string : session_config.GetStopStrings()) {
+    RETURN_IF_ERROR(stop_token_detector->AddStopString(stop_string));
   }
   SessionId session_id = next_session_id_.fetch_add(1);
   auto session_info = std::make_shared<SessionInfo>(SessionInfo{
@@ -109,6 +163,13 @@ absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
       return absl::InvalidArgumentError(absl::StrCat(
           "Session ", session_id, " already exists in session list."));
     }
+    if (max_resident_contexts_.has_value() &&
+        session_lookup_.size() >= *max_resident_contexts_) {
+      return absl::ResourceExhaustedError(absl::StrCat(
+          "Cannot keep more than ", *max_resident_contexts_,
+          " session contexts within the memory budget. Delete a session "
+          "first."));
+    }
     if (session_info->session_config.AudioModalityEnabled()) {
       RETURN_IF_ERROR(resource_manager_->TryLoadingAudioExecutor());
     }
@@ -116,10 +177,28 @@ absl::StatusOr<SessionId> ExecutionManager::RegisterNewSession(
       RETURN_IF_ERROR(resource_manager_->TryLoadingVisionExecutor());
     }
     session_lookup_.insert({session_id, std::move(session_info)});
+    metrics_->resident_contexts->Set(session_lookup_.size());
   }
+  metrics_->sessions_created->Increment();
   return session_id;
 }
 
+absl::Status ExecutionManager::ReleaseSession(SessionId session_id) {
+  absl::MutexLock lock(session_and_task_lookup_mutex_);
+  auto it = session_lookup_.find(session_id);
+  if (it == session_lookup_.end()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Session ", session_id, " not found in session list."));
+  }
+  if (!it->second->active_tasks.empty()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Session ", session_id, " still has active tasks."));
+  }
+  session_lookup_.erase(it);
+  metrics_->resident_contexts->Set(session_lookup_.size());
+  return absl::OkStatus();
+}
+
 absl::Status ExecutionManager::CancelAllTasksInSession(SessionId session_id) {
   absl::MutexLock lock(session_and_task_lookup_mutex_);
   if (!session_lookup_.contains(session_id)) {
@@ -276,7 +355,16 @@ absl::Status ExecutionManager::QueueTask(TaskId task_id) {
   auto task = std::move(task_lookup_.at(task_id).task);
 
   if (execution_thread_pool_ != nullptr) {
-    RETURN_IF_ERROR(execution_thread_pool_->Schedule(std::move(task)));
+    // Paired with the decrement in StartTask, which every scheduled task
+    // calls first. Incremented before scheduling so it never goes negative.
+    metrics_->queue_depth->Add(1);
+    if (auto status = execution_thread_pool_->Schedule(std::move(task));
+        !status.ok()) {
+      metrics_->queue_depth->Add(-1);
+      return status;
+    }
+    queued_tasks_.push_back(task_id);
+    MaybePrefetchNextContext();
   } else {
     ABSL_LOG(ERROR) << "Execution thread pool is null, skipping task: "
                     << task_id;
@@ -292,7 +380,12 @@ absl::StatusOr<
     std::tuple<std::shared_ptr<SessionInfo>, std::shared_ptr<std::atomic<bool>>,
                absl::AnyInvocable<void(absl::StatusOr<Responses>)>>>
 ExecutionManager::StartTask(TaskId task_id) {
+  metrics_->queue_depth->Add(-1);
   absl::MutexLock lock(session_and_task_lookup_mutex_);
+  if (auto it = std::find(queued_tasks_.begin(), queued_tasks_.end(), task_id);
+      it != queued_tasks_.end()) {
+    queued_tasks_.erase(it);
+  }
   if (!task_lookup_.contains(task_id)) {
     return absl::InvalidArgumentError(
         absl::StrCat("Task ", task_id, " not found in task list."));
@@ -321,13 +414,53 @@ ExecutionManager::StartTask(TaskId task_id) {
   }
   std::shared_ptr<SessionInfo> session_info =
       session_lookup_.at(task_lookup_.at(task_id).session_id);
+  running_session_id_ = task_lookup_.at(task_id).session_id;
+  MaybePrefetchNextContext();
   return std::make_tuple(session_info, task_lookup_.at(task_id).cancelled,
                          std::move(task_lookup_.at(task_id).callback));
 }
 
+void ExecutionManager::MaybePrefetchNextContext() {
+  for (TaskId task_id : queued_tasks_) {
+    auto task_it = task_lookup_.find(task_id);
+    if (task_it == task_lookup_.end() ||
+        task_it->second.task_state == TaskState::kCancelled) {
+      continue;
+    }
+    const SessionId session_id = task_it->second.session_id;
+    if (session_id == running_session_id_) {
+      return;
+    }
+    auto session_it = session_lookup_.find(session_id);
+    if (session_it == session_lookup_.end() ||
+        session_it->second->context_handler == nullptr) {
+      return;
+    }
+    auto status = context_prefetch_thread_pool_->Schedule(
+        [this, context_handler = session_it->second->context_handler]() {
+          if (auto status =
+                  resource_manager_->PrefetchContextHandler(context_handler);
+              !status.ok()) {
+            ABSL_LOG(WARNING) << "Failed to prefetch context: " << status;
+          }
+        });
+    if (!status.ok()) {
+      ABSL_LOG(WARNING) << "Failed to schedule context prefetch: " << status;
+    }
+    return;
+  }
+}
+
 absl::Status ExecutionManager::FinishTask(
     TaskId task_id, absl::StatusOr<Responses> responses,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> absl_nonnull callback) {
+  if (!responses.ok()) {
+    metrics_->tasks_failed->Increment();
+  } else if (responses->GetTaskState() == TaskState::kCancelled) {
+    metrics_->tasks_cancelled->Increment();
+  } else {
+    metrics_->tasks_completed->Increment();
+  }
   auto invoke_callback_and_return =
       [&](absl::Status status) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
           session_and_task_lookup_mutex_) -> absl::Status {
@@ -620,15 +753,20 @@ absl::StatusOr<std::unique_ptr<ExecutionManager>> ExecutionManager::Create(
     vision_executor_settings,
     std::unique_ptr<AudioExecutorSettings> absl_nullable
     audio_executor_settings,
-    ::litert::Environment* absl_nullable litert_env) {
+    ::litert::Environment* absl_nullable litert_env,
+    std::optional<int> max_resident_contexts,
+    std::unique_ptr<AudioExecutor> absl_nullable audio_executor) {
   std::unique_ptr<Sampler> sampler;
+  ASSIGN_OR_RETURN(auto metrics, EngineMetrics::Create());
   ASSIGN_OR_RETURN(
       auto resource_manager,
       ResourceManager::Create(model_resources, std::move(llm_executor),
                               std::move(vision_executor_settings),
-                              std::move(audio_executor_settings), litert_env));
-  return absl::WrapUnique(
-      new ExecutionManager(tokenizer, std::move(resource_manager), litert_env));
+                              std::move(audio_executor_settings), litert_env,
+                              metrics.get(), std::move(audio_executor)));
+  return absl::WrapUnique(new ExecutionManager(
+      tokenizer, std::move(metrics), std::move(resource_manager), litert_env,
+      max_resident_contexts));
 }
 
 absl::Status ExecutionManager::WaitUntilDone(TaskId task_id,
@@ -715,10 +853,16 @@ absl::Status ExecutionManager::AddPrefillTask(
 
     RETURN_IF_CANCELLED(cancelled, task_id, callback);
 
+    const int start_step = llm_executor.value()->GetCurrentStep().value_or(0);
+    const absl::Time start_time = absl::Now();
     auto responses =
         Tasks::Prefill(*llm_executor.value(), *executor_inputs,
                        /*wait_for_completion=*/true,
                        /*benchmark_info=*/session_info->benchmark_info);
+    metrics_->prefill_latency->ObserveDuration(absl::Now() - start_time);
+    RecordExecutorProgress(*llm_executor.value(), start_step,
+                           *metrics_->prefill_tokens,
+                           *metrics_->kv_cache_tokens);
     if (!responses.ok()) {
       FinishTaskAndLogErrors(task_id, responses.status(), std::move(callback));
       return;
@@ -759,13 +903,13 @@ absl::Status ExecutionManager::AddDecodeTask(
     Constraint* absl_nullable constraint,
     std::shared_ptr<std::atomic<bool>> absl_nonnull cancelled,
     absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
-    int max_output_tokens) {
+    int max_output_tokens, std::optional<int> num_top_logprobs) {
   if (callback == nullptr) {
     callback = [](absl::StatusOr<Responses> responses) {};
   }
 
-  auto task = [this, task_id, constraint, cancelled,
-               max_output_tokens]() mutable -> void {
+  auto task = [this, task_id, constraint, cancelled, max_output_tokens,
+               num_top_logprobs]() mutable -> void {
     auto task_info = StartTask(task_id);
     if (!task_info.ok()) {
       FinishTaskAndLogErrors(task_id, task_info.status(),
@@ -809,11 +953,24 @@ absl::Status ExecutionManager::AddDecodeTask(
       decoded_ids_buffer = std::move(decoded_ids_buffer_or.Value());
     }
 
+    std::optional<TimedConstraint> timed_constraint;
+    if (constraint != nullptr) {
+      timed_constraint.emplace(*constraint, *metrics_->constraint_latency);
+    }
+    const int start_step = llm_executor.value()->GetCurrentStep().value_or(0);
+    const absl::Time start_time = absl::Now();
     auto responses = Tasks::Decode(
         *llm_executor.value(), *tokenizer_, *session_info->stop_token_detector,
         num_output_candidates, session_info->benchmark_info, optional_sampler,
-        constraint, std::move(decoded_ids_buffer), callback, cancelled.get(),
-        max_output_tokens);
+        timed_constraint.has_value() ? &*timed_constraint : nullptr,
+        std::move(decoded_ids_buffer), callback, cancelled.get(),
+        max_output_tokens, num_top_logprobs,
+        session_info->session_config.GetStreamingChunkPolicy(),
+        constraint_thread_pool_.get());
+    metrics_->decode_latency->ObserveDuration(absl::Now() - start_time);
+    RecordExecutorProgress(*llm_executor.value(), start_step,
+                           *metrics_->decode_tokens,
+                           *metrics_->kv_cache_tokens);
     if (!responses.ok() && absl::IsCancelled(responses.status())) {
       responses = Responses(TaskState::kCancelled);
     }
@@ -898,6 +1055,14 @@ absl::Status ExecutionManager::AddCloneSessionTask(
           return;
         }
       }
+      for (const auto& stop_string :
+           original_session_info->session_config.GetStopStrings()) {
+        auto status = cloned_stop_token_detector->AddStopString(stop_string);
+        if (!status.ok()) {
+          result = status;
+          return;
+        }
+      }
 
       {
         absl::MutexLock lock(session_and_task_lookup_mutex_);
@@ -1003,4 +1168,72 @@ absl::Status ExecutionManager::AddTextScoringTask(
                     cancelled, std::move(callback));
 }
 
+absl::Status ExecutionManager::AddTextClassificationTask(
+    SessionId session_id, TaskId task_id, absl::flat_hash_set<TaskId> dep_tasks,
+    std::vector<std::string> choices,
+    std::shared_ptr<std::atomic<bool>> absl_nonnull cancelled,
+    absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback) {
+  if (callback == nullptr) {
+    callback = [](absl::StatusOr<Responses> responses) {};
+  }
+
+  auto task = [this, task_id, choices = std::move(choices)]() mutable -> void {
+    auto task_info = StartTask(task_id);
+    if (!task_info.ok()) {
+      FinishTaskAndLogErrors(task_id, task_info.status(),
+                             [](absl::StatusOr<Responses> responses) {});
+      return;
+    }
+    auto [session_info, cancelled, callback] = std::move(task_info.value());
+    // If the session info is nullptr, it means the task is cancelled before it
+    // is started.
+    if (session_info == nullptr) {
+      return;
+    }
+
+    RETURN_IF_CANCELLED(cancelled, task_id, callback);
+
+    auto llm_executor = resource_manager_->AcquireExecutorWithContextHandler(
+        session_info->context_handler);
+    if (!llm_executor.ok()) {
+      FinishTaskAndLogErrors(task_id, llm_executor.status(),
+                             std::move(callback));
+      return;
+    }
+
+    RETURN_IF_CANCELLED(cancelled, task_id, callback);
+
+    const int num_output_candidates =
+        session_info->session_config.GetNumOutputCandidates();
+    std::vector<int> decoded_ids(num_output_candidates,
+                                 session_info->last_prefill_token_id);
+    auto decoded_ids_buffer =
+        CopyToTensorBuffer<int>(decoded_ids, {num_output_candidates, 1});
+    if (!decoded_ids_buffer.HasValue()) {
+      FinishTaskAndLogErrors(
+          task_id, absl::InternalError(decoded_ids_buffer.Error().Message()),
+          std::move(callback));
+      return;
+    }
+
+    // TODO(b/435040163): Handle the temperature the same way as scoring.
+    auto temperature = 1.0f;
+    std::vector<absl::string_view> choice_views(choices.begin(),
+                                                choices.end());
+    auto responses = Tasks::ScoreChoices(
+        *llm_executor.value(), *tokenizer_, choice_views, temperature,
+        std::move(decoded_ids_buffer.Value()));
+
+    if (cancelled != nullptr && cancelled->load()) {
+      responses = Responses(TaskState::kCancelled);
+    }
+
+    FinishTaskAndLogErrors(task_id, std::move(responses), std::move(callback));
+    return;
+  };
+
+  return CreateTask(session_id, task_id, std::move(task), std::move(dep_tasks),
+                    cancelled, std::move(callback));
+}
+
 }  // namespace litert::lm
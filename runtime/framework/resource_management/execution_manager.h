@@ -15,10 +15,14 @@
 #ifndef THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_EXECUTION_MANAGER_H_
 #define THIRD_PARTY_ODML_LITERT_LM_RUNTIME_FRAMEWORK_RESOURCE_MANAGEMENT_EXECUTION_MANAGER_H_
 
+#include <algorithm>
 #include <atomic>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <string>
+#include <thread>  // NOLINT
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -40,8 +44,10 @@
 #include "runtime/components/stop_token_detector.h"
 #include "runtime/components/tokenizer.h"
 #include "runtime/engine/engine.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
+#include "runtime/executor/audio_executor.h"
 #include "runtime/executor/audio_executor_settings.h"
 #include "runtime/executor/llm_executor.h"
 #include "runtime/executor/llm_executor_io_types.h"
@@ -113,6 +119,10 @@ class ExecutionManager {
   //   the audio executor. This can be null if no audio modality is used.
   // - litert_env: The LIRTER environment used for creating the LLM context.
   //   This can be null if no LLM context is needed.
+  // - max_resident_contexts: The maximum number of sessions registered at the
+  //   same time, each of which keeps its own context. Unlimited if not set.
+  // - audio_executor: An already created audio executor, used instead of
+  //   loading one from the audio executor settings. This can be null.
   static absl::StatusOr<std::unique_ptr<ExecutionManager>> Create(
       Tokenizer* absl_nonnull tokenizer,
       ModelResources* absl_nullable model_resources,
@@ -121,7 +131,9 @@ class ExecutionManager {
       vision_executor_settings,
       std::unique_ptr<AudioExecutorSettings> absl_nullable
       audio_executor_settings,
-      ::litert::Environment* absl_nullable litert_env);
+      ::litert::Environment* absl_nullable litert_env,
+      std::optional<int> max_resident_contexts = std::nullopt,
+      std::unique_ptr<AudioExecutor> absl_nullable audio_executor = nullptr);
 
   ~ExecutionManager() {
     WaitUntilAllDone(Engine::kDefaultTimeout).IgnoreError();
@@ -154,6 +166,15 @@ class ExecutionManager {
       std::optional<BenchmarkInfo> benchmark_info = std::nullopt)
       ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
 
+  // Removes the session with the given session ID, so that it no longer
+  // counts against the maximum number of resident contexts.
+  // Returns:
+  // - OK if the session is removed.
+  // - INVALID_ARGUMENT if the session ID is not found.
+  // - FAILED_PRECONDITION if the session still has active tasks.
+  absl::Status ReleaseSession(SessionId session_id)
+      ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
+
   // Cancels all tasks in the session with the given session ID.
   absl::Status CancelAllTasksInSession(SessionId session_id)
       ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
@@ -202,6 +223,10 @@ class ExecutionManager {
   // - constraint: The constraint for the decode task.
   // - cancelled: The cancelled flag for the decode task.
   // - callback: The callback function.
+  // - max_output_tokens: The maximum number of tokens to decode.
+  // - num_top_logprobs: If set, the responses carry the log-probability of
+  //   each decoded token and of its num_top_logprobs most likely
+  //   alternatives. Requires the session to use an external sampler.
   // Note: AddDecodeTask will acquire the task lookup mutex.
   absl::Status AddDecodeTask(
       SessionId session_id, TaskId task_id,
@@ -209,7 +234,8 @@ class ExecutionManager {
       Constraint* absl_nullable constraint,
       std::shared_ptr<std::atomic<bool>> absl_nonnull cancelled,
       absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback,
-      int max_output_tokens = std::numeric_limits<int>::max())
+      int max_output_tokens = std::numeric_limits<int>::max(),
+      std::optional<int> num_top_logprobs = std::nullopt)
       ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
 
   // Adds a clone session task to the execution manager.
@@ -248,6 +274,22 @@ class ExecutionManager {
       absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback)
       ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
 
+  // Adds a text classification task to the execution manager.
+  // - session_id: The ID of the session that created the task.
+  // - task_id: The task ID of the task.
+  // - dep_tasks: The dependent tasks that should be done before the text
+  //   classification task starts.
+  // - choices: The texts to score as continuations of the prefilled context.
+  // - cancelled: The cancelled flag for the text classification task.
+  // - callback: The callback function.
+  // Note: AddTextClassificationTask will acquire the task lookup mutex.
+  absl::Status AddTextClassificationTask(
+      SessionId session_id, TaskId task_id,
+      absl::flat_hash_set<TaskId> dep_tasks, std::vector<std::string> choices,
+      std::shared_ptr<std::atomic<bool>> absl_nonnull cancelled,
+      absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback)
+      ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
+
   // Returns the audio executor properties.
   absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties() const {
     return resource_manager_->GetAudioExecutorProperties();
@@ -258,21 +300,39 @@ class ExecutionManager {
     return resource_manager_->GetVisionExecutorProperties();
   }
 
+  // Returns the metrics recorded by the execution manager and its resource
+  // manager. Sessions may record their host-side work here as well.
+  EngineMetrics& GetMetrics() const { return *metrics_; }
+
  private:
   // Private constructor. Use the Create function instead.
   ExecutionManager(
       Tokenizer* absl_nonnull tokenizer,
+      std::unique_ptr<EngineMetrics> absl_nonnull metrics,
       std::unique_ptr<ResourceManager> absl_nonnull resource_manager,
-      ::litert::Environment* absl_nullable litert_env = nullptr)
+      ::litert::Environment* absl_nullable litert_env = nullptr,
+      std::optional<int> max_resident_contexts = std::nullopt)
       : tokenizer_(std::move(tokenizer)),
+        metrics_(std::move(metrics)),
         resource_manager_(std::move(resource_manager)),
-        litert_env_(litert_env) {
+        litert_env_(litert_env),
+        max_resident_contexts_(max_resident_contexts) {
     execution_thread_pool_ =
         std::make_unique<ThreadPool>(/*name_prefix=*/"execution_thread_pool",
                                      /*max_num_threads=*/1);
     callback_thread_pool_ =
         std::make_unique<ThreadPool>(/*name_prefix=*/"callback_thread_pool",
                                      /*max_num_threads=*/1);
+    context_prefetch_thread_pool_ =
+        std::make_unique<ThreadPool>(/*name_prefix=*/"context_prefetch",
+                                     /*max_num_threads=*/1);
+    // Only one decode runs at a time, with its first candidate on the
+    // execution thread, so one worker per other core is enough. Worker
+    // threads are only started on first use.
+    constraint_thread_pool_ = std::make_unique<ThreadPool>(
+        /*name_prefix=*/"constraint_pool",
+        /*max_num_threads=*/std::max<int>(
+            1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
   }
 
   // Creates a task with the given task ID, task, dependent tasks, and callback.
@@ -309,6 +369,14 @@ class ExecutionManager {
       absl::AnyInvocable<void(absl::StatusOr<Responses>)>>>
   StartTask(TaskId task_id) ABSL_LOCKS_EXCLUDED(session_and_task_lookup_mutex_);
 
+  // Schedules the context of the session of the next queued task to be
+  // prefetched by the resource manager, if that session is not the one whose
+  // task is running. The context switch to it then finds its context ready.
+  // Note: MaybePrefetchNextContext expects the callers to acquire the task
+  // lookup mutex before calling it.
+  void MaybePrefetchNextContext()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(session_and_task_lookup_mutex_);
+
   // Finishes the task with the given task ID, responses, and callback.
   // - task_id: The task ID of the task.
   // - responses: The responses of the task.
@@ -384,6 +452,14 @@ class ExecutionManager {
   // The value is the task info.
   absl::flat_hash_map<TaskId, TaskInfo> task_lookup_
       ABSL_GUARDED_BY(session_and_task_lookup_mutex_) = {};
+  // The tasks scheduled on the execution thread pool and not started yet, in
+  // execution order.
+  std::deque<TaskId> queued_tasks_
+      ABSL_GUARDED_BY(session_and_task_lookup_mutex_) = {};
+  // The session of the last started task, whose context is the one loaded in
+  // the executor.
+  std::optional<SessionId> running_session_id_
+      ABSL_GUARDED_BY(session_and_task_lookup_mutex_) = std::nullopt;
 
   // TODO b/409401231 - Use LLM Context which is will be wrapped in a session
   // state.
@@ -392,12 +468,29 @@ class ExecutionManager {
   // The tokenizer used for encoding the text input.
   Tokenizer* absl_nonnull tokenizer_;
 
+  // The live metrics of the engine. Declared before `resource_manager_` so
+  // that it outlives it.
+  std::unique_ptr<EngineMetrics> absl_nonnull metrics_;
+
   // The resource manager used for managing the resources.
   std::unique_ptr<ResourceManager> absl_nonnull resource_manager_;
 
   // The LIRTER environment used for creating the LLM context.
   ::litert::Environment* absl_nullable litert_env_;
 
+  // The maximum number of registered sessions. Unlimited if not set.
+  const std::optional<int> max_resident_contexts_;
+
+  // The thread pool with a single worker thread used for preparing the context
+  // of the next session while the current one is running. Declared before
+  // `execution_thread_pool_` so that it outlives the tasks scheduling on it.
+  std::unique_ptr<ThreadPool> absl_nonnull context_prefetch_thread_pool_;
+
+  // The thread pool the constraint masks of the output candidates are
+  // computed on, shared by all the decode tasks. Declared before
+  // `execution_thread_pool_` so that it outlives the tasks using it.
+  std::unique_ptr<ThreadPool> absl_nonnull constraint_thread_pool_;
+
   // The thread pool with a single worker thread used for executing the tasks.
   std::unique_ptr<ThreadPool> absl_nonnull execution_thread_pool_;
 
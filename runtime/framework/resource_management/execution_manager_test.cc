@@ -32,10 +32,17 @@
 #include "runtime/components/constrained_decoding/fake_constraint.h"
 #include "runtime/components/model_resources.h"
 #include "runtime/components/tokenizer.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
+#include "runtime/executor/audio_executor.h"
 #include "runtime/executor/executor_settings_base.h"
 #include "runtime/executor/fake_llm_executor.h"
+#include "runtime/executor/llm_executor.h"
+#include "runtime/executor/llm_executor_io_types.h"
+#include "runtime/framework/resource_management/context_handler/context_handler.h"
+#include "runtime/framework/resource_management/resource_manager.h"
+#include "runtime/proto/sampler_params.pb.h"
 #include "runtime/proto/token.pb.h"
 #include "runtime/util/status_macros.h"  // IWYU pragma: keep
 #include "runtime/util/test_utils.h"  // NOLINT
@@ -49,15 +56,73 @@ using ::testing::Return;
 class MockTokenizer : public Tokenizer {
  public:
   MOCK_METHOD(absl::StatusOr<std::vector<int>>, TextToTokenIds,
-              (absl::string_view text), (override));
+              (absl::string_view text), (const, override));
   MOCK_METHOD(absl::StatusOr<int>, TokenToId, (absl::string_view token),
-              (override));
+              (const, override));
   MOCK_METHOD(absl::StatusOr<std::string>, TokenIdsToText,
-              (const std::vector<int>& token_ids), (override));
+              (const std::vector<int>& token_ids), (const, override));
   MOCK_METHOD(TokenizerType, GetTokenizerType, (), (const, override));
   MOCK_METHOD(std::vector<std::string>, GetTokens, (), (const, override));
 };
 
+class FakeAudioContext : public AudioContext {
+ public:
+  explicit FakeAudioContext(int value) : value_(value) {}
+
+  absl::StatusOr<std::unique_ptr<AudioContext>> Clone() const override {
+    return std::make_unique<FakeAudioContext>(value_);
+  }
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+// A streaming audio executor whose contexts are plain integers. New contexts
+// are numbered from 1, and the context loaded in the executor starts as
+// `loaded_value`, so that the tests can tell which copy a switch restored.
+class FakeAudioExecutor : public AudioExecutor {
+ public:
+  explicit FakeAudioExecutor(int loaded_value) : loaded_value_(loaded_value) {}
+
+  absl::StatusOr<ExecutorAudioData> Encode(
+      const litert::TensorBuffer& spectrogram_tensor) override {
+    return absl::UnimplementedError("Not implemented.");
+  }
+
+  absl::StatusOr<AudioExecutorProperties> GetAudioExecutorProperties()
+      const override {
+    return AudioExecutorProperties{.is_streaming_model = true};
+  }
+
+  absl::StatusOr<std::unique_ptr<AudioContext>> CreateNewContext() override {
+    return std::make_unique<FakeAudioContext>(++num_created_contexts_);
+  }
+
+  absl::StatusOr<std::unique_ptr<AudioContext>> CloneContext() override {
+    return std::make_unique<FakeAudioContext>(loaded_value_);
+  }
+
+  absl::Status RestoreContext(
+      std::unique_ptr<AudioContext> audio_context) override {
+    loaded_value_ =
+        static_cast<const FakeAudioContext&>(*audio_context).value();
+    restored_values_.push_back(loaded_value_);
+    return absl::OkStatus();
+  }
+
+  // Sets the context loaded in the executor, as if it processed more audio.
+  void set_loaded_value(int loaded_value) { loaded_value_ = loaded_value; }
+
+  const std::vector<int>& restored_values() const { return restored_values_; }
+
+ private:
+  int loaded_value_;
+  int num_created_contexts_ = 0;
+  std::vector<int> restored_values_;
+};
+
 class ExecutionManagerTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -100,7 +165,9 @@ class ExecutionManagerTest : public ::testing::Test {
   };
 
   void CreateExecutionManager(
-      std::unique_ptr<FakeLlmExecutor> fake_llm_executor) {
+      std::unique_ptr<FakeLlmExecutor> fake_llm_executor,
+      std::optional<int> max_resident_contexts = std::nullopt,
+      std::unique_ptr<AudioExecutor> audio_executor = nullptr) {
     // The objects are moved to execution_manager_ so we can't access them
     // after creation.
     ASSERT_OK_AND_ASSIGN(execution_manager_,
@@ -110,7 +177,20 @@ class ExecutionManagerTest : public ::testing::Test {
                              /*llm_executor=*/std::move(fake_llm_executor),
                              /*vision_executor_settings=*/nullptr,
                              /*audio_executor_settings=*/nullptr,
-                             /*litert_env=*/nullptr));
+                             /*litert_env=*/nullptr, max_resident_contexts,
+                             std::move(audio_executor)));
+  }
+
+  // Adds a decode task to the given session, to be run after the tasks added
+  // before it.
+  absl::Status AddDecodeTask(SessionId session_id) {
+    ASSIGN_OR_RETURN(const TaskId task_id, execution_manager_->GetNewTaskId());
+    return execution_manager_->AddDecodeTask(
+        session_id, task_id,
+        /*dependency_task_ids=*/{},
+        /*constraint=*/nullptr,
+        /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+        /*callback=*/nullptr);
   }
 
   std::unique_ptr<FakeLlmExecutor> CreateDefaultFakeLlmExecutor(
@@ -155,6 +235,50 @@ TEST_F(ExecutionManagerTest, GetMutableBenchmarkInfoFailsIfNoBenchmarkInfo) {
               testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
 }
 
+TEST_F(ExecutionManagerTest, RegisterNewSessionRespectsMaxResidentContexts) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor(),
+                         /*max_resident_contexts=*/1);
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+  EXPECT_THAT(execution_manager_->RegisterNewSession(session_config),
+              testing::status::StatusIs(absl::StatusCode::kResourceExhausted));
+
+  ASSERT_OK(execution_manager_->ReleaseSession(session_id));
+  EXPECT_THAT(execution_manager_->GetSessionInfo(session_id),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_OK(execution_manager_->RegisterNewSession(session_config));
+}
+
+TEST_F(ExecutionManagerTest, RegisterNewSessionWithMinPNeedsExternalSampler) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.GetMutableSamplerParams().set_type(
+      proto::SamplerParameters::MIN_P);
+  EXPECT_THAT(execution_manager_->RegisterNewSession(session_config),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+
+  session_config.SetUseExternalSampler(true);
+  session_config.SetSamplerBackend(Backend::CPU);
+  EXPECT_OK(execution_manager_->RegisterNewSession(session_config));
+}
+
+TEST_F(ExecutionManagerTest, RegisterNewSessionFailsWithInvalidStopString) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.GetMutableStopStrings().push_back("");
+  EXPECT_THAT(execution_manager_->RegisterNewSession(session_config),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(ExecutionManagerTest, RegisterNewSessionFailsWithInvalidStopTokenIds) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.GetMutableStopTokenIds().push_back({});
+  EXPECT_THAT(execution_manager_->RegisterNewSession(session_config),
+              testing::status::StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(ExecutionManagerTest, AddPrefillTask) {
   CreateExecutionManager(CreateDefaultFakeLlmExecutor({{{1, 2, 3, -4}}}));
   ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
@@ -387,6 +511,110 @@ TEST_F(ExecutionManagerTest, AddDecodeTaskWithExternalSampler) {
   EXPECT_THAT(responses_texts, ElementsAre("4", "5"));
 }
 
+TEST_F(ExecutionManagerTest, AddDecodeTaskWithTopLogProbs) {
+  std::vector<std::vector<int>> prefill_tokens = {{1, 2, 3}, {6}};
+  std::vector<std::vector<int>> decode_tokens = {{4}, {5}, {6}};
+
+  CreateExecutionManager(std::make_unique<FakeLlmExecutor>(
+      /*vocab_size=*/10,
+      /*prefill_tokens=*/std::move(prefill_tokens),
+      /*decode_tokens=*/std::move(decode_tokens)));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig(
+                                                /*use_external_sampler=*/true));
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  std::vector<int> logprob_token_ids;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&logprob_token_ids](absl::StatusOr<Responses> responses) {
+        ASSERT_OK(responses);
+        if (!responses->GetTokenLogProbs().has_value()) {
+          return;
+        }
+        for (const auto& step_logprobs : (*responses->GetTokenLogProbs())[0]) {
+          logprob_token_ids.push_back(step_logprobs.token.token_id);
+          EXPECT_EQ(step_logprobs.top_logprobs.size(), 1);
+        }
+      };
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId prefill_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, prefill_task_id, std::move(inputs),
+      /*dependency_task_ids=*/{},
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      /*callback=*/[](absl::StatusOr<Responses> responses) {}));
+  ASSERT_OK(
+      execution_manager_->WaitUntilDone(prefill_task_id, absl::Seconds(3)));
+
+  ASSERT_OK_AND_ASSIGN(const TaskId decode_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddDecodeTask(
+      session_id, decode_task_id,
+      /*dependency_task_ids=*/{},
+      /*constraint=*/nullptr,
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      std::move(callback), /*max_output_tokens=*/10,
+      /*num_top_logprobs=*/1));
+
+  EXPECT_OK(
+      execution_manager_->WaitUntilDone(decode_task_id, absl::Seconds(3)));
+
+  EXPECT_THAT(logprob_token_ids, ElementsAre(4, 5));
+}
+
+TEST_F(ExecutionManagerTest, AddDecodeTaskWithTopLogProbsAndInternalSampler) {
+  CreateExecutionManager(CreateDefaultFakeLlmExecutor());
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  ASSERT_OK_AND_ASSIGN(const SessionId session_id,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  absl::Status decode_status;
+  absl::AnyInvocable<void(absl::StatusOr<Responses>)> callback =
+      [&decode_status](absl::StatusOr<Responses> responses) {
+        if (!responses.ok()) {
+          decode_status = responses.status();
+        }
+      };
+
+  std::vector<InputData> inputs;
+  ASSERT_OK_AND_ASSIGN(auto input_text,
+                       tokenizer_->TokenIdsToTensorBuffer({1, 2, 3}));
+  inputs.push_back(InputText(std::move(input_text)));
+  ASSERT_OK_AND_ASSIGN(const TaskId prefill_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddPrefillTask(
+      session_id, prefill_task_id, std::move(inputs),
+      /*dependency_task_ids=*/{},
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      /*callback=*/[](absl::StatusOr<Responses> responses) {}));
+  ASSERT_OK(
+      execution_manager_->WaitUntilDone(prefill_task_id, absl::Seconds(3)));
+
+  ASSERT_OK_AND_ASSIGN(const TaskId decode_task_id,
+                       execution_manager_->GetNewTaskId());
+  ASSERT_OK(execution_manager_->AddDecodeTask(
+      session_id, decode_task_id,
+      /*dependency_task_ids=*/{},
+      /*constraint=*/nullptr,
+      /*cancelled=*/std::make_shared<std::atomic<bool>>(false),
+      std::move(callback), /*max_output_tokens=*/10,
+      /*num_top_logprobs=*/1));
+
+  EXPECT_OK(
+      execution_manager_->WaitUntilDone(decode_task_id, absl::Seconds(3)));
+
+  // The log-probabilities are not silently dropped.
+  EXPECT_THAT(decode_status,
+              testing::status::StatusIs(absl::StatusCode::kUnimplemented));
+}
+
 TEST_F(ExecutionManagerTest, CreateAndRunDependentTasks) {
   CreateExecutionManager(CreateDefaultFakeLlmExecutor());
 
@@ -824,5 +1052,104 @@ TEST_F(ExecutionManagerTest, AddTextScoringTask) {
   EXPECT_FLOAT_EQ(scores[0], 0.0f);
 }
 
+TEST_F(ExecutionManagerTest, PrefetchesAudioContextOfNextQueuedSession) {
+  auto fake_llm_executor = CreateDefaultFakeLlmExecutor();
+  // Keeps the task of the first session running while the task of the second
+  // one is queued.
+  fake_llm_executor->SetDecodeDelay(absl::Seconds(0.5));
+  auto audio_executor =
+      std::make_unique<FakeAudioExecutor>(/*loaded_value=*/42);
+  FakeAudioExecutor* audio_executor_ptr = audio_executor.get();
+  CreateExecutionManager(std::move(fake_llm_executor),
+                         /*max_resident_contexts=*/std::nullopt,
+                         std::move(audio_executor));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.SetAudioModalityEnabled(true);
+  ASSERT_OK_AND_ASSIGN(const SessionId session_a,
+                       execution_manager_->RegisterNewSession(session_config));
+  ASSERT_OK_AND_ASSIGN(const SessionId session_b,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  ASSERT_OK(AddDecodeTask(session_a));
+  ASSERT_OK(AddDecodeTask(session_b));
+  ASSERT_OK(execution_manager_->WaitUntilAllDone(absl::Seconds(5)));
+
+  // Once the task of session A is started and removed from the queue, the
+  // audio context of session B is staged, and the switch to B uses it.
+  EXPECT_EQ(execution_manager_->GetMetrics().context_prefetch_hits->Value(), 1);
+  EXPECT_THAT(audio_executor_ptr->restored_values(), ElementsAre(2));
+}
+
+TEST_F(ExecutionManagerTest, PrefetchDoesNotRestoreStaleAudioContext) {
+  auto fake_llm_executor = CreateDefaultFakeLlmExecutor();
+  fake_llm_executor->SetDecodeDelay(absl::Seconds(0.5));
+  auto audio_executor =
+      std::make_unique<FakeAudioExecutor>(/*loaded_value=*/42);
+  FakeAudioExecutor* audio_executor_ptr = audio_executor.get();
+  CreateExecutionManager(std::move(fake_llm_executor),
+                         /*max_resident_contexts=*/std::nullopt,
+                         std::move(audio_executor));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.SetAudioModalityEnabled(true);
+  ASSERT_OK_AND_ASSIGN(const SessionId session_a,
+                       execution_manager_->RegisterNewSession(session_config));
+  ASSERT_OK_AND_ASSIGN(const SessionId session_b,
+                       execution_manager_->RegisterNewSession(session_config));
+
+  ASSERT_OK(AddDecodeTask(session_a));
+  ASSERT_OK(AddDecodeTask(session_b));
+  ASSERT_OK(AddDecodeTask(session_a));
+  ASSERT_OK(execution_manager_->WaitUntilAllDone(absl::Seconds(5)));
+
+  // Session A is staged again when the task of session B starts, which may
+  // happen before or after the switch away from A saves its audio context. A
+  // copy staged before the switch is dropped, so either way A gets back the
+  // context loaded when it was switched away from, and never its initial one.
+  EXPECT_GE(execution_manager_->GetMetrics().context_prefetch_hits->Value(), 1);
+  EXPECT_THAT(audio_executor_ptr->restored_values(), ElementsAre(2, 42));
+}
+
+TEST_F(ExecutionManagerTest, ResourceManagerDropsStagedContextOnSwitchAway) {
+  ASSERT_OK_AND_ASSIGN(auto metrics, EngineMetrics::Create());
+  auto audio_executor =
+      std::make_unique<FakeAudioExecutor>(/*loaded_value=*/42);
+  FakeAudioExecutor* audio_executor_ptr = audio_executor.get();
+  ASSERT_OK_AND_ASSIGN(
+      auto resource_manager,
+      ResourceManager::Create(
+          /*model_resources=*/nullptr, CreateDefaultFakeLlmExecutor(),
+          /*vision_executor_settings=*/nullptr,
+          /*audio_executor_settings=*/nullptr, /*litert_env=*/nullptr,
+          metrics.get(), std::move(audio_executor)));
+
+  ASSERT_OK_AND_ASSIGN(auto session_config, CreateDefaultSessionConfig());
+  session_config.SetAudioModalityEnabled(true);
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<ContextHandler> handler_a,
+                       resource_manager->CreateContextHandler(session_config));
+  ASSERT_OK_AND_ASSIGN(std::shared_ptr<ContextHandler> handler_b,
+                       resource_manager->CreateContextHandler(session_config));
+  auto switch_to = [&](std::shared_ptr<ContextHandler> handler) {
+    // The returned executor holds the executor lock until it is destroyed.
+    return resource_manager->AcquireExecutorWithContextHandler(handler)
+        .status();
+  };
+
+  ASSERT_OK(switch_to(handler_a));
+  ASSERT_OK(resource_manager->PrefetchContextHandler(handler_b));
+  ASSERT_OK(switch_to(handler_b));
+  EXPECT_EQ(metrics->context_prefetch_hits->Value(), 1);
+
+  // B is staged while it is still loaded, then moves on before the switch
+  // away from it, which makes the staged copy outdated.
+  ASSERT_OK(resource_manager->PrefetchContextHandler(handler_b));
+  audio_executor_ptr->set_loaded_value(7);
+  ASSERT_OK(switch_to(handler_a));
+  ASSERT_OK(switch_to(handler_b));
+  EXPECT_EQ(metrics->context_prefetch_hits->Value(), 1);
+  EXPECT_THAT(audio_executor_ptr->restored_values(), ElementsAre(2, 42, 7));
+}
+
 }  // namespace
 }  // namespace litert::lm
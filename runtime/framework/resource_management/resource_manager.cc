@@ -31,6 +31,7 @@
 #include "absl/types/span.h"  // from @com_google_absl
 #include "litert/cc/litert_tensor_buffer.h"  // from @litert
 #include "runtime/components/model_resources.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -533,6 +534,22 @@ ResourceManager::CreateContextHandler(const SessionConfig& session_config) {
       sampler_params.set_type(odml::infra::proto::SamplerParameters::TOP_P);
       break;
     }
+    case proto::SamplerParameters::MIN_P:
+    case proto::SamplerParameters::TYPICAL:
+    case proto::SamplerParameters::MIROSTAT: {
+      // The executor's internal sampler only knows about top-p, so these types
+      // are only sampled by the CPU sampler created from the session config.
+      // The executor's sampler params are then unused.
+      if (!session_config.UseExternalSampler() ||
+          session_config.GetSamplerBackend() != Backend::CPU) {
+        return absl::InvalidArgumentError(
+            absl::StrCat("Sampler type ",
+                         session_config.GetSamplerParams().type(),
+                         " is only supported with the external CPU sampler."));
+      }
+      sampler_params.set_type(odml::infra::proto::SamplerParameters::TOP_P);
+      break;
+    }
     case proto::SamplerParameters::GREEDY: {
       sampler_params.set_type(odml::infra::proto::SamplerParameters::GREEDY);
       break;
@@ -648,6 +665,7 @@ ResourceManager::AcquireExecutorWithContextHandler(
   // If the new handler is the same as the current handler, return the
   // executor directly.
   if (new_context_handler == current_handler_) {
+    if (metrics_ != nullptr) metrics_->context_reuse_hits->Increment();
     return std::make_unique<LockedLlmExecutor>(llm_executor_, std::move(lock),
                                                current_handler_);
   }
@@ -658,6 +676,7 @@ ResourceManager::AcquireExecutorWithContextHandler(
   if (current_handler_ != nullptr &&
       new_context_handler->shared_processed_context() ==
           current_handler_->shared_processed_context()) {
+    if (metrics_ != nullptr) metrics_->context_shared_switches->Increment();
     ASSIGN_OR_RETURN(auto current_runtime_config,
                      llm_executor_->GetRuntimeConfig());
     ASSIGN_OR_RETURN(auto current_runtime_state,
@@ -677,6 +696,7 @@ ResourceManager::AcquireExecutorWithContextHandler(
     // If the new handler is not sharing the same processed context with the
     // current handler, clone the processed context to the new handler. Then
     // restore the executor with the new LlmContext.
+    if (metrics_ != nullptr) metrics_->context_restores->Increment();
     if (current_handler_ != nullptr) {
       ASSIGN_OR_RETURN(auto current_llm_context, llm_executor_->CloneContext());
       ASSIGN_OR_RETURN(auto current_runtime_config,
@@ -717,15 +737,34 @@ ResourceManager::AcquireExecutorWithContextHandler(
       ASSIGN_OR_RETURN(auto audio_executor, AcquireAudioExecutor());
       ASSIGN_OR_RETURN(auto current_audio_context,
                        audio_executor->CloneContext());
+      absl::MutexLock prefetch_lock(prefetch_mutex_);
+      // A copy staged for the current handler is outdated from now on.
+      if (staged_handler_.lock() == current_handler_) {
+        staged_handler_.reset();
+        staged_audio_context_.reset();
+      }
       RETURN_IF_ERROR(
           current_handler_->SetAudioContext(std::move(current_audio_context)));
     }
     // If the new handler has an audio context, audio executor will restore
-    // the audio context from the new handler.
+    // the audio context from the new handler, using the copy staged by
+    // PrefetchContextHandler() if there is one.
     if (new_context_handler->HasAudioContext()) {
       ASSIGN_OR_RETURN(auto audio_executor, AcquireAudioExecutor());
-      ASSIGN_OR_RETURN(auto audio_context_cloned,
-                       new_context_handler->GetAudioContext().Clone());
+      std::unique_ptr<AudioContext> audio_context_cloned;
+      {
+        absl::MutexLock prefetch_lock(prefetch_mutex_);
+        if (staged_handler_.lock() == new_context_handler &&
+            staged_audio_context_ != nullptr) {
+          if (metrics_ != nullptr) metrics_->context_prefetch_hits->Increment();
+          audio_context_cloned = std::move(staged_audio_context_);
+          staged_handler_.reset();
+        }
+      }
+      if (audio_context_cloned == nullptr) {
+        ASSIGN_OR_RETURN(audio_context_cloned,
+                         new_context_handler->GetAudioContext().Clone());
+      }
       RETURN_IF_ERROR(
           audio_executor->RestoreContext(std::move(audio_context_cloned)));
     }
@@ -737,6 +776,27 @@ ResourceManager::AcquireExecutorWithContextHandler(
                                              current_handler_);
 }
 
+absl::Status ResourceManager::PrefetchContextHandler(
+    std::shared_ptr<ContextHandler> context_handler) {
+  RET_CHECK_NE(context_handler, nullptr)
+      << "The provided context handler should not be null.";
+  // The processed context and the runtime config and state are moved into the
+  // executor as is, only the audio context has to be copied on a switch.
+  absl::MutexLock lock(prefetch_mutex_);
+  if (staged_handler_.lock() == context_handler) {
+    return absl::OkStatus();
+  }
+  staged_handler_.reset();
+  staged_audio_context_.reset();
+  if (!context_handler->HasAudioContext()) {
+    return absl::OkStatus();
+  }
+  ASSIGN_OR_RETURN(staged_audio_context_,
+                   context_handler->GetAudioContext().Clone());
+  staged_handler_ = context_handler;
+  return absl::OkStatus();
+}
+
 absl::Status ResourceManager::TryLoadingVisionExecutor() {
   return absl::InvalidArgumentError(
       "Vision executor backend is not supported.");
@@ -795,14 +855,16 @@ absl::StatusOr<std::unique_ptr<ResourceManager>> ResourceManager::Create(
     vision_executor_settings,
     std::unique_ptr<litert::lm::AudioExecutorSettings> absl_nullable
     audio_executor_settings,
-    ::litert::Environment* absl_nullable litert_env) {
+    ::litert::Environment* absl_nullable litert_env,
+    EngineMetrics* absl_nullable metrics,
+    std::unique_ptr<AudioExecutor> absl_nullable audio_executor) {
   if (llm_executor == nullptr) {
     return absl::InvalidArgumentError("Llm executor is null.");
   }
   auto llm_resource_manager = std::make_unique<ResourceManager>(
       model_resources, std::move(llm_executor),
       std::move(vision_executor_settings), std::move(audio_executor_settings),
-      litert_env);
+      litert_env, metrics, std::move(audio_executor));
   return llm_resource_manager;
 }
 
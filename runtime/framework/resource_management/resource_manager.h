@@ -29,6 +29,7 @@
 #include "absl/synchronization/mutex.h"  // from @com_google_absl
 #include "litert/cc/litert_environment.h"  // from @litert
 #include "runtime/components/model_resources.h"
+#include "runtime/engine/engine_metrics.h"
 #include "runtime/engine/engine_settings.h"
 #include "runtime/engine/io_types.h"
 #include "runtime/executor/audio_executor.h"
@@ -49,14 +50,21 @@ class ResourceManager {
       std::unique_ptr<LlmExecutor> llm_executor,
       std::unique_ptr<VisionExecutorSettings> vision_executor_settings,
       std::unique_ptr<AudioExecutorSettings> audio_executor_settings,
-      ::litert::Environment* absl_nullable litert_env)
+      ::litert::Environment* absl_nullable litert_env,
+      EngineMetrics* absl_nullable metrics = nullptr,
+      std::unique_ptr<AudioExecutor> absl_nullable audio_executor = nullptr)
       :  // dummy comment to prevent clang-format from moving the next line here
         llm_executor_(std::move(llm_executor)),
         vision_executor_settings_(std::move(vision_executor_settings)),
+        audio_executor_(std::move(audio_executor)),
         audio_executor_settings_(std::move(audio_executor_settings)),
-        litert_env_(litert_env) {}
+        litert_env_(litert_env),
+        metrics_(metrics) {}
 
-  // Creates a ResourceManager with the provided llm_executor.
+  // Creates a ResourceManager with the provided llm_executor. If `metrics` is
+  // not null, context switches are recorded in it; it must outlive the
+  // ResourceManager. If `audio_executor` is set, it is used as is instead of
+  // being loaded from `audio_executor_settings`.
   static absl::StatusOr<std::unique_ptr<ResourceManager>> Create(
       ModelResources* absl_nullable model_resources,
       std::unique_ptr<LlmExecutor> absl_nonnull llm_executor,
@@ -64,7 +72,9 @@ class ResourceManager {
       vision_executor_settings,
       std::unique_ptr<AudioExecutorSettings> absl_nullable
       audio_executor_settings,
-      ::litert::Environment* absl_nullable litert_env);
+      ::litert::Environment* absl_nullable litert_env,
+      EngineMetrics* absl_nullable metrics = nullptr,
+      std::unique_ptr<AudioExecutor> absl_nullable audio_executor = nullptr);
 
   ~ResourceManager() = default;
 
@@ -118,7 +128,20 @@ class ResourceManager {
   AcquireExecutorWithContextHandler(
       std::shared_ptr<ContextHandler> new_context_handle)
       ABSL_LOCKS_EXCLUDED(executor_mutex_)
-          ABSL_LOCKS_EXCLUDED(audio_executor_mutex_);
+          ABSL_LOCKS_EXCLUDED(audio_executor_mutex_)
+              ABSL_LOCKS_EXCLUDED(prefetch_mutex_);
+
+  // Prepares the restore of the provided context handler ahead of the
+  // AcquireExecutorWithContextHandler() call that switches to it, so that the
+  // switch does not have to do the work itself. Meant to be called from a
+  // background thread while another context is loaded in the executor; it does
+  // not wait for the executor.
+  // Only one context handler is staged at a time: a call replaces the
+  // previously staged one, and the staged data is dropped if the handler is
+  // updated by switching away from it before it is acquired.
+  absl::Status PrefetchContextHandler(
+      std::shared_ptr<ContextHandler> context_handler)
+      ABSL_LOCKS_EXCLUDED(prefetch_mutex_);
 
   // Try to load the vision executor if the vision executor is not loaded.
   absl::Status TryLoadingVisionExecutor()
@@ -158,6 +181,16 @@ class ResourceManager {
   std::shared_ptr<ContextHandler> current_handler_
       ABSL_GUARDED_BY(executor_mutex_);
 
+  // Guards the audio context of the context handlers against concurrent
+  // prefetching, and the staged context below.
+  absl::Mutex prefetch_mutex_;
+
+  // The context handler staged by PrefetchContextHandler(), and the copy of its
+  // audio context the audio executor will be restored from.
+  std::weak_ptr<ContextHandler> staged_handler_ ABSL_GUARDED_BY(prefetch_mutex_);
+  std::unique_ptr<AudioContext> staged_audio_context_
+      ABSL_GUARDED_BY(prefetch_mutex_);
+
   // Map lora id from hash. If lora is provided by lora path, lora path will be
   // treated as the hash key.
   absl::flat_hash_map<std::string, uint32_t> lora_hash_to_id_;
@@ -189,6 +222,9 @@ class ResourceManager {
   // created.
   std::unique_ptr<::litert::Environment> backup_litert_env_;
 
+  // The engine metrics to record context switches in. Not owned, may be null.
+  EngineMetrics* absl_nullable metrics_;
+
   friend class LockedLlmExecutor;
 };
 
@@ -0,0 +1,76 @@
+// Copyright 2025 The ODML Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Microbenchmark for DecompressData, which inflates the zlib compressed
+// tokenizer sections of a .litertlm file at load time.
+//
+// bazel run -c opt //schema/core:litertlm_read_benchmark
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "benchmark/benchmark.h"  // from @com_google_benchmark
+#include "schema/core/litertlm_read.h"
+#include "zconf.h"  // from @zlib
+#include "zlib.h"  // from @zlib
+
+namespace litert::lm::schema {
+namespace {
+
+// Builds a section in the format DecompressData expects: the uncompressed size
+// as a uint64_t followed by the zlib stream.
+std::vector<uint8_t> MakeCompressedSection(int uncompressed_size) {
+  // Tokenizer json is highly repetitive text; mimic that compression ratio.
+  std::vector<uint8_t> data(uncompressed_size);
+  for (int i = 0; i < uncompressed_size; ++i) {
+    data[i] = static_cast<uint8_t>('a' + (i * 7 + i / 13) % 26);
+  }
+  uLongf compressed_size = compressBound(data.size());
+  std::vector<uint8_t> section(sizeof(uint64_t) + compressed_size);
+  const uint64_t size = data.size();
+  std::memcpy(section.data(), &size, sizeof(uint64_t));
+  if (compress(section.data() + sizeof(uint64_t), &compressed_size,
+               data.data(), data.size()) != Z_OK) {
+    return {};
+  }
+  section.resize(sizeof(uint64_t) + compressed_size);
+  return section;
+}
+
+// Args: uncompressed size in bytes.
+void BM_DecompressData(benchmark::State& state) {
+  const std::vector<uint8_t> section = MakeCompressedSection(state.range(0));
+  if (section.empty()) {
+    state.SkipWithError("Failed to compress the input.");
+    return;
+  }
+  std::vector<uint8_t> output;
+  for (auto _ : state) {
+    auto status = DecompressData(section.data(), section.size(), &output);
+    benchmark::DoNotOptimize(status);
+    benchmark::DoNotOptimize(output.data());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecompressData)
+    ->ArgNames({"bytes"})
+    ->Arg(64 << 10)
+    ->Arg(1 << 20)
+    ->Arg(16 << 20);
+
+}  // namespace
+}  // namespace litert::lm::schema
+
+BENCHMARK_MAIN();